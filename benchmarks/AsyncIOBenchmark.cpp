@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "AsyncIO.h"
+#include "Benchmark.h"
+
+namespace fs = std::filesystem;
+
+// Level load shaped reads: many megabyte sized files into one staging block. Files stay in the
+// page cache between runs, so this measures how well each path keeps the copies going rather
+// than the device itself.
+BENCHMARK(AsyncReads)
+{
+    const uint32_t fileCount = 64;
+    const uint32_t fileSize = 1024 * 1024;
+
+    fs::path root = fs::temp_directory_path() / "async_io_benchmark";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    std::vector<std::string> paths(fileCount);
+    std::vector<uint8_t> data(fileSize);
+
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        for (uint32_t j = 0; j < fileSize; j++)
+            data[j] = static_cast<uint8_t>(i + j);
+
+        paths[i] = (root / ("file" + std::to_string(i) + ".bin")).string();
+
+        FILE* file = fopen(paths[i].c_str(), "wb");
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    std::vector<uint8_t> staging(size_t(fileCount) * fileSize);
+    double megabytes = staging.size() / (1024.0 * 1024.0);
+
+    printf("  %u files, %.0f MB\n", fileCount, megabytes);
+
+    double ns = MeasureBest([&]()
+    {
+        for (uint32_t i = 0; i < fileCount; i++)
+        {
+            FILE* file = fopen(paths[i].c_str(), "rb");
+            fread(staging.data() + size_t(i) * fileSize, 1, fileSize, file);
+            fclose(file);
+        }
+    });
+    DoNotOptimize(staging[0]);
+
+    printf("  %-12s %8.0f MB/s\n", "fread", megabytes * 1e9 / ns);
+
+    for (bool forceThreadPool : { true, false })
+    {
+        AsyncIOSettings settings;
+        settings.forceThreadPool = forceThreadPool;
+
+        AsyncIO io(nullptr, settings);
+
+        // Falls back to the thread pool where io_uring isn't available, which was just measured.
+        if (!forceThreadPool && io.getBackend() != IoBackend::IoUring)
+            continue;
+
+        ns = MeasureBest([&]()
+        {
+            for (uint32_t i = 0; i < fileCount; i++)
+                io.read(paths[i].c_str(), 0, fileSize, staging.data() + size_t(i) * fileSize, IoPriority::Normal, nullptr);
+
+            io.waitIdle();
+        });
+        DoNotOptimize(staging[0]);
+
+        printf("  %-12s %8.0f MB/s\n", AsyncIO::getBackendName(io.getBackend()), megabytes * 1e9 / ns);
+    }
+
+    fs::remove_all(root);
+}
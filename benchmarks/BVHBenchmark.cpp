@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BoundingVolumeHierarchy.h"
+#include "JobSystem.h"
+
+// A 90 degree camera at eye looking along forward, which has to be one of the axes.
+static Frustum MakeAxisFrustum(const glm::vec3& eye, const glm::vec3& forward)
+{
+    glm::vec3 side = std::abs(forward.x) > 0.5f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 up = glm::cross(forward, side);
+
+    const glm::vec3 normals[Frustum::Count] =
+    {
+        glm::normalize(forward + side),
+        glm::normalize(forward - side),
+        glm::normalize(forward + up),
+        glm::normalize(forward - up),
+        forward,
+        -forward,
+    };
+
+    Frustum frustum;
+
+    for (int i = 0; i < Frustum::Count; i++)
+        frustum.planes[i] = { normals[i], -glm::dot(normals[i], eye) };
+
+    frustum.planes[Frustum::Near].distance -= 0.1f;
+    frustum.planes[Frustum::Far].distance += 300.0f;
+
+    return frustum;
+}
+
+// Same slab test as the tree's, over every live object.
+static RayHit BruteForceRaycast(const BoundingVolumeHierarchy& bvh, const Ray& ray, float maxDistance)
+{
+    RayHit hit;
+    float closest = maxDistance;
+
+    glm::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    for (uint32_t object = 0; object < bvh.getObjectCount(); object++)
+    {
+        if (!bvh.isAlive(object))
+            continue;
+
+        const AABB& box = bvh.getBounds(object);
+
+        glm::vec3 t1 = (box.min - ray.origin) * inverseDirection;
+        glm::vec3 t2 = (box.max - ray.origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t1, t2);
+        glm::vec3 tFar = glm::max(t1, t2);
+
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, closest));
+
+        if (enter <= exit && enter <= closest)
+        {
+            closest = enter;
+            hit.object = object;
+            hit.distance = enter;
+        }
+    }
+
+    return hit;
+}
+
+static void BruteForceFrustum(const BoundingVolumeHierarchy& bvh, const Frustum& frustum, std::vector<uint32_t>& results)
+{
+    for (uint32_t object = 0; object < bvh.getObjectCount(); object++)
+    {
+        if (bvh.isAlive(object) && frustum.intersects(bvh.getBounds(object)))
+            results.push_back(object);
+    }
+}
+
+struct QuerySet
+{
+    std::vector<Frustum> frustums;
+    std::vector<Ray> rays;
+};
+
+// Times the tree against scanning every object, and checks both give the same answers.
+static void CompareQueries(const char* name, const BoundingVolumeHierarchy& bvh, const QuerySet& queries)
+{
+    const float maxDistance = 2000.0f;
+
+    std::vector<uint32_t> treeResults, bruteResults;
+    uint32_t mismatches = 0;
+    size_t found = 0;
+
+    for (const Frustum& frustum : queries.frustums)
+    {
+        treeResults.clear();
+        bruteResults.clear();
+
+        bvh.queryFrustum(frustum, treeResults);
+        BruteForceFrustum(bvh, frustum, bruteResults);
+
+        std::sort(treeResults.begin(), treeResults.end());
+        mismatches += treeResults != bruteResults;
+        found += bruteResults.size();
+    }
+
+    uint32_t hits = 0;
+
+    for (const Ray& ray : queries.rays)
+    {
+        RayHit treeHit = bvh.raycast(ray, maxDistance);
+        RayHit bruteHit = BruteForceRaycast(bvh, ray, maxDistance);
+
+        // Boxes the ray enters at the same distance may be reported either way.
+        mismatches += treeHit.isHit() != bruteHit.isHit() || (treeHit.isHit() && treeHit.distance != bruteHit.distance);
+        hits += bruteHit.isHit();
+    }
+
+    double treeFrustumNs = MeasureBest([&]()
+    {
+        for (const Frustum& frustum : queries.frustums)
+        {
+            treeResults.clear();
+            bvh.queryFrustum(frustum, treeResults);
+        }
+
+        DoNotOptimize(treeResults.data());
+    });
+
+    double bruteFrustumNs = MeasureBest([&]()
+    {
+        for (const Frustum& frustum : queries.frustums)
+        {
+            bruteResults.clear();
+            BruteForceFrustum(bvh, frustum, bruteResults);
+        }
+
+        DoNotOptimize(bruteResults.data());
+    });
+
+    double treeRayNs = MeasureBest([&]()
+    {
+        for (const Ray& ray : queries.rays)
+        {
+            RayHit hit = bvh.raycast(ray, maxDistance);
+            DoNotOptimize(hit);
+        }
+    });
+
+    double bruteRayNs = MeasureBest([&]()
+    {
+        for (const Ray& ray : queries.rays)
+        {
+            RayHit hit = BruteForceRaycast(bvh, ray, maxDistance);
+            DoNotOptimize(hit);
+        }
+    }, 2.0e8, 2);
+
+    double frustumCount = double(queries.frustums.size());
+    double rayCount = double(queries.rays.size());
+
+    printf("  %-14s cost %5.2f  %5u unindexed  %s\n", name, bvh.getCost(), bvh.getUnindexedCount(), mismatches == 0 ? "matches brute force" : "MISMATCH");
+    printf("    frustum  tree %9.1f us  brute %9.1f us  %6.1fx  (%zu objects per query)\n",
+        treeFrustumNs / frustumCount / 1e3, bruteFrustumNs / frustumCount / 1e3, bruteFrustumNs / treeFrustumNs, found / queries.frustums.size());
+    printf("    ray      tree %9.3f us  brute %9.1f us  %6.1fx  (%u of %zu hit)\n",
+        treeRayNs / rayCount / 1e3, bruteRayNs / rayCount / 1e3, bruteRayNs / treeRayNs, hits, queries.rays.size());
+}
+
+BENCHMARK(BVH)
+{
+    const uint32_t objectCount = 100000;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    auto randomBox = [&]()
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+
+        return AABB{ center - extent, center + extent };
+    };
+
+    QuerySet queries;
+
+    const glm::vec3 axes[] =
+    {
+        glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+    };
+
+    for (const glm::vec3& axis : axes)
+        queries.frustums.push_back(MakeAxisFrustum(glm::vec3(position(random), position(random), position(random)) * 0.5f, axis));
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        Ray ray;
+        ray.origin = glm::vec3(position(random), position(random), position(random));
+        ray.direction = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(1e-3f));
+        queries.rays.push_back(ray);
+    }
+
+    BoundingVolumeHierarchy bvh;
+
+    for (uint32_t i = 0; i < objectCount; i++)
+        bvh.insert(randomBox());
+
+    BenchmarkTimer timer;
+    bvh.build();
+    printf("  %u objects, built in %.2f ms, %u nodes\n", objectCount, timer.getNanoseconds() / 1e6, bvh.getNodeCount());
+
+    CompareQueries("built", bvh, queries);
+
+    // A frame's worth of small moves, picked up by a refit.
+    for (uint32_t i = 0; i < objectCount / 10; i++)
+    {
+        uint32_t object = random() % objectCount;
+        AABB box = bvh.getBounds(object);
+        glm::vec3 offset(unit(random), unit(random), unit(random));
+
+        bvh.update(object, { box.min + offset, box.max + offset });
+    }
+
+    timer.reset();
+    bvh.refit();
+    printf("  refit of %u moves in %.2f ms\n", objectCount / 10, timer.getNanoseconds() / 1e6);
+
+    CompareQueries("refitted", bvh, queries);
+
+    // Scatter most of the scene and add more, so the tree degrades and maintain() rebuilds it on
+    // a worker, then adopts the result.
+    for (uint32_t i = 0; i < objectCount / 2; i++)
+        bvh.update(random() % objectCount, randomBox());
+
+    for (uint32_t i = 0; i < objectCount / 20; i++)
+        bvh.insert(randomBox());
+
+    for (uint32_t i = 0; i < objectCount / 100; i++)
+        bvh.remove(random() % objectCount);
+
+    JobSystem jobs;
+    bvh.maintain(jobs);
+
+    if (!bvh.isRebuilding())
+    {
+        printf("  maintain() didn't start a rebuild\n");
+        return;
+    }
+
+    CompareQueries("while building", bvh, queries);
+
+    timer.reset();
+    jobs.waitIdle();
+    bvh.maintain(jobs);
+    printf("  background rebuild adopted after %.2f ms more\n", timer.getNanoseconds() / 1e6);
+
+    CompareQueries("rebuilt", bvh, queries);
+}
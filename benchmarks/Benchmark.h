@@ -0,0 +1,122 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+using BenchmarkFunction = void(*)();
+
+struct BenchmarkEntry
+{
+    const char* name;
+    BenchmarkFunction function;
+};
+
+inline std::vector<BenchmarkEntry>& GetBenchmarks()
+{
+    static std::vector<BenchmarkEntry> benchmarks;
+    return benchmarks;
+}
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, BenchmarkFunction function)
+    {
+        GetBenchmarks().push_back({ name, function });
+    }
+};
+
+// Registers a benchmark that BenchmarkMain can run by name.
+#define BENCHMARK(name) \
+    static void name(); \
+    static BenchmarkRegistrar name##Registrar(#name, name); \
+    static void name()
+
+class BenchmarkTimer
+{
+public:
+    BenchmarkTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void reset() { start = std::chrono::steady_clock::now(); }
+
+    double getNanoseconds() const
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Runs fn until at least minTime has passed and returns the fastest single run in nanoseconds.
+template<typename Fn>
+double MeasureBest(Fn&& fn, double minTimeNs = 2.0e8, uint32_t minRuns = 5)
+{
+    double best = 1e300;
+    double total = 0.0;
+    uint32_t runs = 0;
+
+    while (runs < minRuns || total < minTimeNs)
+    {
+        BenchmarkTimer timer;
+        fn();
+        double elapsed = timer.getNanoseconds();
+
+        best = elapsed < best ? elapsed : best;
+        total += elapsed;
+        runs++;
+    }
+
+    return best;
+}
+
+// Time stamp counter ticks per nanosecond, measured once. These are reference cycles at the
+// nominal clock rather than core cycles, close enough to compare runs on one machine. Returns 0
+// where there is no counter.
+inline double GetCyclesPerNanosecond()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    static const double cyclesPerNs = []()
+    {
+        BenchmarkTimer timer;
+        uint64_t start = __rdtsc();
+
+        double elapsed = 0.0;
+
+        while (elapsed < 2.0e7)
+            elapsed = timer.getNanoseconds();
+
+        return double(__rdtsc() - start) / elapsed;
+    }();
+
+    return cyclesPerNs;
+#else
+    return 0.0;
+#endif
+}
+
+// Stops the optimiser from discarding work whose result is otherwise unused. The value has to be
+// in memory at this point, and the compiler has to assume anything may have read it.
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    // No inline assembly, so read the value through a volatile pointer into a volatile sink and
+    // read that back. Neither access can be dropped, and the barrier keeps the work in front of them.
+    static volatile char sink;
+
+    _ReadWriteBarrier();
+    sink = *reinterpret_cast<const volatile char*>(&value);
+    (void)sink;
+    _ReadWriteBarrier();
+#endif
+}
@@ -0,0 +1,31 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark.h"
+
+// Usage: Benchmarks [filter]
+// Runs every registered benchmark whose name contains the filter.
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int ran = 0;
+
+    for (const auto& benchmark : GetBenchmarks())
+    {
+        if (filter != nullptr && strstr(benchmark.name, filter) == nullptr)
+            continue;
+
+        printf("[%s]\n", benchmark.name);
+        benchmark.function();
+        printf("\n");
+        ran++;
+    }
+
+    if (ran == 0)
+    {
+        fprintf(stderr, "no benchmarks matched.\n");
+        return 1;
+    }
+
+    return 0;
+}
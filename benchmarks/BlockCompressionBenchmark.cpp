@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BlockCompression.h"
+#include "JobSystem.h"
+
+// Smooth gradients with some noise, hard edges and a cut out alpha region, so every encoder
+// sees a mix of easy and hard blocks.
+static std::vector<uint8_t> MakeBenchmarkImage(uint32_t width, uint32_t height)
+{
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> noise(-12, 12);
+
+    std::vector<uint8_t> image(size_t(width) * height * 4);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float u = static_cast<float>(x) / width, v = static_cast<float>(y) / height;
+            uint8_t* texel = &image[(size_t(y) * width + x) * 4];
+
+            int values[4] =
+            {
+                static_cast<int>(128.0f + 100.0f * std::sin(u * 17.0f)),
+                static_cast<int>(255.0f * v),
+                ((x / 32 + y / 32) % 2) ? 200 : 40,
+                (u - 0.5f) * (u - 0.5f) + (v - 0.5f) * (v - 0.5f) < 0.1f ? 255 : static_cast<int>(255.0f * u),
+            };
+
+            for (int c = 0; c < 4; c++)
+                texel[c] = static_cast<uint8_t>(std::clamp(values[c] + (c < 3 ? noise(random) : 0), 0, 255));
+        }
+    }
+
+    return image;
+}
+
+static uint32_t GetChannelCount(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return 3;
+    case BlockFormat::BC4: return 1;
+    case BlockFormat::BC5: return 2;
+    default: return 4;
+    }
+}
+
+BENCHMARK(BlockCompression)
+{
+    const uint32_t width = 512, height = 512;
+
+    JobSystem jobs;
+    std::vector<uint8_t> image = MakeBenchmarkImage(width, height);
+
+    printf("  %u worker threads, %ux%u image\n", jobs.getThreadCount(), width, height);
+
+    const struct { BlockFormat format; const char* name; } formats[] =
+    {
+        { BlockFormat::BC1, "BC1" },
+        { BlockFormat::BC3, "BC3" },
+        { BlockFormat::BC4, "BC4" },
+        { BlockFormat::BC5, "BC5" },
+        { BlockFormat::BC7, "BC7" },
+    };
+
+    const BlockPath paths[] = { BlockPath::Scalar, BlockPath::SSE2, BlockPath::AVX2 };
+
+    for (const auto& format : formats)
+    {
+        std::vector<uint8_t> blocks(GetBlockCompressedSize(format.format, width, height));
+
+        for (BlockQuality quality : { BlockQuality::Fast, BlockQuality::Quality })
+        {
+            for (bool parallel : { false, true })
+            {
+                for (BlockPath path : paths)
+                {
+                    if (!BlockCompressor::isSupported(path))
+                        continue;
+
+                    BlockCompressor compressor(parallel ? &jobs : nullptr);
+                    compressor.setPath(path);
+
+                    double error = 0.0;
+                    double ns = MeasureBest([&]() { error = compressor.compress(image.data(), width, height, width * 4, format.format, quality, blocks.data()); });
+                    DoNotOptimize(blocks[0]);
+
+                    double meanError = error / (double(width) * height * GetChannelCount(format.format));
+                    double psnr = meanError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanError) : INFINITY;
+
+                    printf("  %s %-7s %-8s %-8s %8.2f MP/s  PSNR %.2f dB\n", format.name, quality == BlockQuality::Fast ? "fast" : "quality",
+                        BlockCompressor::getPathName(path), parallel ? "parallel" : "serial", width * height * 1000.0 / ns, psnr);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include <random>
+
+#include "Benchmark.h"
+#include "DrawQueue.h"
+#include "FrustumCulling.h"
+#include "JobSystem.h"
+
+static Frustum MakeBenchmarkFrustum()
+{
+    // Roughly a 90 degree camera looking down -z, so a fair fraction of the objects are culled.
+    Frustum frustum;
+
+    const glm::vec3 normals[Frustum::Count] =
+    {
+        glm::normalize(glm::vec3(0.7071f, 0.0f, -0.7071f)),
+        glm::normalize(glm::vec3(-0.7071f, 0.0f, -0.7071f)),
+        glm::normalize(glm::vec3(0.0f, 0.7071f, -0.7071f)),
+        glm::normalize(glm::vec3(0.0f, -0.7071f, -0.7071f)),
+        glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f),
+    };
+
+    const float distances[Frustum::Count] = { 0.0f, 0.0f, 0.0f, 0.0f, -0.1f, 500.0f };
+
+    for (int i = 0; i < Frustum::Count; i++)
+        frustum.planes[i] = { normals[i], distances[i] };
+
+    return frustum;
+}
+
+static void RunCullingBenchmark(uint32_t count, JobSystem& jobs)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+    SphereBoundsSoA spheres;
+    BoxBoundsSoA boxes;
+
+    spheres.reserve(count);
+    boxes.reserve(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        float extent = size(random);
+
+        spheres.add({ center, extent });
+        boxes.add({ center - glm::vec3(extent), center + glm::vec3(extent) });
+    }
+
+    Frustum frustum = MakeBenchmarkFrustum();
+    std::vector<uint32_t> visible;
+
+    const CullPath paths[] = { CullPath::Scalar, CullPath::SSE2, CullPath::AVX2, CullPath::AVX512 };
+
+    for (bool parallel : { false, true })
+    {
+        for (CullPath path : paths)
+        {
+            if (!FrustumCuller::isSupported(path))
+                continue;
+
+            FrustumCuller culler(parallel ? &jobs : nullptr);
+            culler.setPath(path);
+
+            uint32_t visibleSpheres = 0, visibleBoxes = 0;
+
+            double sphereNs = MeasureBest([&]() { visibleSpheres = culler.cull(frustum, spheres, visible); });
+            double boxNs = MeasureBest([&]() { visibleBoxes = culler.cull(frustum, boxes, visible); });
+
+            printf("  %8u objects  %-8s %-8s  spheres %7.3f obj/ns (%u visible)  boxes %7.3f obj/ns (%u visible)\n",
+                count, FrustumCuller::getPathName(path), parallel ? "parallel" : "serial",
+                count / sphereNs, visibleSpheres, count / boxNs, visibleBoxes);
+        }
+    }
+}
+
+BENCHMARK(FrustumCulling)
+{
+    JobSystem jobs;
+
+    printf("  %u worker threads\n", jobs.getThreadCount());
+
+    for (uint32_t count : { 10000u, 100000u, 1000000u })
+        RunCullingBenchmark(count, jobs);
+}
+
+// A frame's CPU side from culling to recording: the visible indices go straight into the draw
+// queue, which sorts them.
+BENCHMARK(CulledDraws)
+{
+    const uint32_t objectCount = 100000;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 5.0f);
+
+    SphereBoundsSoA spheres;
+    std::vector<DrawItem> items(objectCount);
+    std::vector<float> depths(objectCount);
+
+    spheres.reserve(objectCount);
+
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        spheres.add({ center, size(random) });
+
+        DrawItem& item = items[i];
+        item.pipeline = random() % 16;
+        item.material = random() % 1024;
+        item.mesh = random() % 2048;
+        item.indexCount = 36 + random() % 3000;
+        item.firstInstance = i;
+
+        // The camera sits at the origin looking down -z.
+        depths[i] = -center.z;
+    }
+
+    JobSystem jobs;
+    FrustumCuller culler(&jobs);
+    DrawQueue queue(&jobs);
+    Frustum frustum = MakeBenchmarkFrustum();
+    std::vector<uint32_t> visible;
+
+    uint32_t visibleCount = 0;
+    queue.reserve(objectCount);
+
+    double cullNs = MeasureBest([&]() { visibleCount = culler.cull(frustum, spheres, visible); });
+
+    double addNs = MeasureBest([&]()
+    {
+        queue.clear();
+        queue.addVisible(items.data(), depths.data(), visible.data(), visibleCount);
+    });
+
+    double sortNs = MeasureBest([&]() { queue.sort(); });
+    DoNotOptimize(queue.getItem(0));
+
+    printf("  %u objects, %u visible, %s, %u worker threads\n", objectCount, visibleCount, FrustumCuller::getPathName(culler.getPath()), jobs.getThreadCount());
+    printf("  cull %8.3f ms  queue %8.3f ms  sort %8.3f ms\n", cullNs / 1e6, addNs / 1e6, sortNs / 1e6);
+
+    // Every queued draw has to be one the cull kept.
+    for (uint32_t i = 0; i < queue.size(); i++)
+    {
+        uint32_t object = queue.getItem(i).firstInstance;
+
+        if (!frustum.intersects(spheres.get(object)))
+        {
+            printf("  queued object %u is outside the frustum\n", object);
+            break;
+        }
+    }
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "DrawQueue.h"
+#include "JobSystem.h"
+
+// Stands in for the Vulkan recorder, counting what it would have bound.
+struct CountingRecorder
+{
+    DrawStateChanges binds;
+    uint64_t indices = 0;
+
+    void bindPipeline(uint32_t) { binds.pipelines++; }
+    void bindMaterial(uint32_t) { binds.materials++; }
+    void bindMesh(uint32_t) { binds.meshes++; }
+    void draw(const DrawItem& item) { indices += item.indexCount; }
+};
+
+static void PrintChanges(const char* name, const DrawStateChanges& changes)
+{
+    printf("  %-10s %7u pipelines %7u materials %7u meshes\n", name, changes.pipelines, changes.materials, changes.meshes);
+}
+
+// A frame's worth of draws in scene order, a few pipelines, many materials and meshes.
+BENCHMARK(SortedDraws)
+{
+    const uint32_t drawCount = 100000;
+
+    std::mt19937 random(1234);
+    std::vector<DrawItem> items(drawCount);
+    std::vector<float> depths(drawCount);
+
+    for (uint32_t i = 0; i < drawCount; i++)
+    {
+        DrawItem& item = items[i];
+        item.pipeline = random() % 16;
+        item.material = random() % 1024;
+        item.mesh = random() % 2048;
+        item.indexCount = 36 + random() % 3000;
+        item.firstInstance = i;
+
+        depths[i] = std::uniform_real_distribution<float>(0.1f, 1000.0f)(random);
+    }
+
+    JobSystem jobs;
+    DrawQueue serial;
+    DrawQueue parallel(&jobs);
+
+    for (DrawQueue* queue : { &serial, &parallel })
+    {
+        queue->reserve(drawCount);
+
+        for (uint32_t i = 0; i < drawCount; i++)
+            queue->add(items[i], depths[i]);
+    }
+
+    printf("  %u draws, %u job threads\n", drawCount, jobs.getThreadCount());
+
+    // What sorting the same keys costs the usual way.
+    std::vector<std::pair<uint64_t, uint32_t>> pairs(drawCount);
+
+    double ns = MeasureBest([&]()
+    {
+        for (uint32_t i = 0; i < drawCount; i++)
+            pairs[i] = { DrawQueue::makeKey(items[i].pipeline, items[i].material, items[i].mesh, depths[i]), i };
+
+        std::sort(pairs.begin(), pairs.end());
+    });
+    DoNotOptimize(pairs[0]);
+
+    printf("  %-10s %8.3f ms\n", "std::sort", ns / 1e6);
+
+    const struct { const char* name; DrawQueue* queue; } queues[] =
+    {
+        { "radix", &serial },
+        { "parallel", &parallel },
+    };
+
+    for (const auto& entry : queues)
+    {
+        ns = MeasureBest([&]() { entry.queue->sort(); });
+        printf("  %-10s %8.3f ms\n", entry.name, ns / 1e6);
+    }
+
+    const DrawQueueStats& stats = parallel.getStats();
+
+    PrintChanges("submitted", stats.submitted);
+    PrintChanges("sorted", stats.sorted);
+
+    CountingRecorder recorder;
+    parallel.record(recorder);
+    DoNotOptimize(recorder.indices);
+
+    if (recorder.binds.pipelines != stats.sorted.pipelines || recorder.binds.materials != stats.sorted.materials ||
+        recorder.binds.meshes != stats.sorted.meshes)
+    {
+        printf("  recorded binds don't match the stats\n");
+    }
+
+    for (uint32_t i = 1; i < drawCount; i++)
+    {
+        const DrawItem& a = parallel.getItem(i - 1);
+        const DrawItem& b = parallel.getItem(i);
+
+        if (a.pipeline > b.pipeline || (a.pipeline == b.pipeline && a.material > b.material))
+        {
+            printf("  draws out of order at %u\n", i);
+            break;
+        }
+    }
+}
+
+// Skips the binds of pipelines that aren't ready like DrawRecorder does, and tracks what each
+// draw would really have had bound.
+struct SkippingRecorder
+{
+    const std::vector<bool>& ready;
+    bool skipping = false;
+    uint32_t boundMesh = ~0u;
+    uint32_t wrongMeshes = 0;
+
+    void bindPipeline(uint32_t pipeline) { skipping = !ready[pipeline]; }
+    void bindMaterial(uint32_t) {}
+
+    void bindMesh(uint32_t mesh)
+    {
+        if (!skipping)
+            boundMesh = mesh;
+    }
+
+    void draw(const DrawItem& item)
+    {
+        if (!skipping)
+            wrongMeshes += item.mesh != boundMesh;
+    }
+};
+
+// A pipeline still compiling, sorted right before a ready one drawing the same mesh.
+BENCHMARK(SkippedPipelineDraws)
+{
+    std::vector<bool> ready = { false, true, false, true };
+
+    DrawQueue queue;
+
+    for (uint32_t pipeline = 0; pipeline < ready.size(); pipeline++)
+    {
+        for (uint32_t mesh = 0; mesh < 3; mesh++)
+        {
+            DrawItem item;
+            item.pipeline = pipeline;
+            item.mesh = pipeline == 0 ? 0 : mesh; // the first ready pipeline starts on mesh 0 too
+            item.indexCount = 3;
+            queue.add(item, 1.0f);
+        }
+    }
+
+    queue.sort();
+
+    SkippingRecorder recorder{ ready };
+    queue.record(recorder);
+
+    printf("  %u draws, %s\n", queue.size(), recorder.wrongMeshes == 0 ? "every ready draw has its mesh bound" : "DRAWS WITH THE WRONG MESH BOUND");
+}
@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <imgui.h>
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+static void JobSystemParallelFor(void* userData, int count, void (*job)(void* jobData, int index), void* jobData)
+{
+    static_cast<JobSystem*>(userData)->parallelFor(uint32_t(count), 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+            job(jobData, int(i));
+    });
+}
+
+// Every font under fonts/ at two sizes with Latin, Greek, Cyrillic and Vietnamese ranges, run from
+// the repository root. Falls back to the embedded font when there are none.
+static void AddFonts(ImFontAtlas& atlas)
+{
+    static const char* files[] = { "Cousine-Regular.ttf", "DroidSans.ttf", "Karla-Regular.ttf", "ProggyClean.ttf", "ProggyTiny.ttf", "Roboto-Medium.ttf" };
+    static const ImWchar ranges[] = { 0x0020, 0x024F, 0x0370, 0x03FF, 0x0400, 0x052F, 0x1E00, 0x1EFF, 0x2000, 0x206F, 0 };
+
+    for (const char* file : files)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "fonts/%s", file);
+
+        FILE* handle = fopen(path, "rb");
+
+        if (!handle)
+            continue;
+
+        fclose(handle);
+
+        for (float size : { 16.0f, 32.0f })
+        {
+            ImFontConfig config;
+            config.OversampleH = 3;
+            snprintf(config.Name, sizeof(config.Name), "%s, %.0fpx", file, size);
+            atlas.AddFontFromFileTTF(path, size, &config, ranges);
+        }
+    }
+
+    if (atlas.ConfigData.Size == 0)
+    {
+        for (float size : { 13.0f, 26.0f, 39.0f })
+        {
+            ImFontConfig config;
+            config.SizePixels = size;
+            atlas.AddFontDefault(&config);
+        }
+    }
+}
+
+BENCHMARK(FontAtlasBuild)
+{
+    JobSystem jobs;
+    printf("  %u worker threads\n", jobs.getThreadCount());
+
+    std::vector<unsigned char> serialPixels;
+
+    for (bool parallel : { false, true })
+    {
+        ImFontAtlas atlas;
+        AddFonts(atlas);
+
+        if (parallel)
+        {
+            atlas.ParallelFor = JobSystemParallelFor;
+            atlas.ParallelForUserData = &jobs;
+        }
+
+        double ns = MeasureBest([&]()
+        {
+            atlas.ClearTexData();
+            atlas.Build();
+        }, 1.0e9, 3);
+
+        printf("  %-8s build %8.2f ms, %dx%d\n", parallel ? "parallel" : "serial", ns * 1e-6, atlas.TexWidth, atlas.TexHeight);
+
+        for (const ImFontConfig& config : atlas.ConfigData)
+            printf("    %-32s %8.2f ms\n", config.Name, config.BuildTimeMs);
+
+        unsigned char* pixels = atlas.TexPixelsAlpha8;
+        size_t size = size_t(atlas.TexWidth) * atlas.TexHeight;
+
+        if (!parallel)
+            serialPixels.assign(pixels, pixels + size);
+        else if (serialPixels.size() != size || memcmp(serialPixels.data(), pixels, size) != 0)
+            printf("  parallel build differs from the serial one\n");
+    }
+}
@@ -0,0 +1,335 @@
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "Benchmark.h"
+
+// A context with a built atlas and one NewFrame behind it, which is what gives the shared draw
+// list data its font, clip rect and arc tables.
+class DrawListContext
+{
+public:
+    DrawListContext()
+    {
+        context = ImGui::CreateContext();
+
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+        io.DeltaTime = 1.0f / 60.0f;
+
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+        ImGui::NewFrame();
+    }
+
+    ~DrawListContext()
+    {
+        ImGui::EndFrame();
+        ImGui::DestroyContext(context);
+    }
+
+private:
+    ImGuiContext* context = nullptr;
+};
+
+struct PrimitiveCase
+{
+    const char* name;
+    ImDrawListFlags flags;
+    std::function<void(ImDrawList&)> draw;
+};
+
+// Draws each case into a list that keeps its capacity between runs, so only tessellation is timed.
+// The clip rect is huge so text isn't culled, and with 16 bit indices no single call may make more
+// than 64k vertices, hence the larger shapes being drawn in pieces.
+static void RunPrimitiveCases(const std::vector<PrimitiveCase>& cases)
+{
+    ImDrawList list(ImGui::GetDrawListSharedData());
+    double cyclesPerNs = GetCyclesPerNanosecond();
+
+    for (const PrimitiveCase& entry : cases)
+    {
+        auto reset = [&]()
+        {
+            list._ResetForNewFrame();
+            list.Flags = entry.flags | ImDrawListFlags_AllowVtxOffset;
+            list.PushClipRect(ImVec2(-65536.0f, -65536.0f), ImVec2(65536.0f, 65536.0f));
+            list.PushTextureID(ImGui::GetIO().Fonts->TexID);
+        };
+
+        reset();
+        entry.draw(list);
+
+        double ns = MeasureBest([&]()
+        {
+            reset();
+            entry.draw(list);
+        }, 1.0e8);
+
+        DoNotOptimize(list.VtxBuffer.Data[0]);
+
+        double vertices = list.VtxBuffer.Size;
+
+        printf("  %-28s %8.0f verts %8.2f Mverts/s", entry.name, vertices, vertices / ns * 1e3);
+
+        if (cyclesPerNs > 0.0)
+            printf(" %7.2f cycles/vert", ns * cyclesPerNs / vertices);
+
+        printf("\n");
+    }
+}
+
+// Once per tessellation level the CPU supports, every level makes the same vertices.
+static void RunPrimitiveCasesPerSimdLevel(const std::vector<PrimitiveCase>& cases)
+{
+    static const char* names[ImDrawSimd_COUNT] = { "scalar", "sse2", "avx2", "neon" };
+    ImDrawSimd best = ImDrawSimdGetCurrent();
+
+    for (ImDrawSimd simd = 0; simd < ImDrawSimd_COUNT; simd++)
+    {
+        if (!ImDrawSimdIsSupported(simd))
+            continue;
+
+        printf("  %s%s\n", names[simd], simd == best ? " (default)" : "");
+        ImDrawSimdSetCurrent(simd);
+        RunPrimitiveCases(cases);
+    }
+
+    ImDrawSimdSetCurrent(best);
+}
+
+static std::vector<ImVec2> MakeWave(int count, float width, float height)
+{
+    std::vector<ImVec2> points(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        float t = float(i) / float(count - 1);
+        points[i] = ImVec2(t * width, height * 0.5f + sinf(t * 40.0f) * height * 0.4f);
+    }
+
+    return points;
+}
+
+static std::vector<ImVec2> MakeCircle(int count, ImVec2 center, float radius)
+{
+    std::vector<ImVec2> points(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        float angle = float(i) / float(count) * 6.2831853f;
+        points[i] = ImVec2(center.x + cosf(angle) * radius, center.y + sinf(angle) * radius);
+    }
+
+    return points;
+}
+
+static std::vector<ImVec2> MakeStar(int count, ImVec2 center, float radius)
+{
+    std::vector<ImVec2> points(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        float angle = float(i) / float(count) * 6.2831853f;
+        float r = i % 2 ? radius * 0.4f : radius;
+        points[i] = ImVec2(center.x + cosf(angle) * r, center.y + sinf(angle) * r);
+    }
+
+    return points;
+}
+
+static constexpr ImDrawListFlags AA_LINES = ImDrawListFlags_AntiAliasedLines;
+static constexpr ImDrawListFlags AA_TEX_LINES = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AntiAliasedLinesUseTex;
+static constexpr ImDrawListFlags AA_FILL = ImDrawListFlags_AntiAliasedFill;
+static constexpr ImU32 COLOR = IM_COL32(200, 220, 255, 255);
+
+// Long plot lines, the case that dominates node graphs and profilers. 100k points per case.
+BENCHMARK(DrawListPolyline)
+{
+    static constexpr int POINTS = 2000;
+    static constexpr int REPEAT = 50;
+
+    DrawListContext context;
+
+    std::vector<ImVec2> wave = MakeWave(POINTS, 1900.0f, 1000.0f);
+    std::vector<ImVec2> ring = MakeCircle(POINTS, ImVec2(960.0f, 540.0f), 500.0f);
+
+    auto polyline = [](const std::vector<ImVec2>& points, ImDrawFlags flags, float thickness)
+    {
+        return [&points, flags, thickness](ImDrawList& list)
+        {
+            for (int i = 0; i < REPEAT; i++)
+                list.AddPolyline(points.data(), int(points.size()), COLOR, flags, thickness);
+        };
+    };
+
+    RunPrimitiveCasesPerSimdLevel({
+        { "aa textured 1px", AA_TEX_LINES, polyline(wave, 0, 1.0f) },
+        { "aa 1px", AA_LINES, polyline(wave, 0, 1.0f) },
+        { "aa 4px", AA_LINES, polyline(wave, 0, 4.0f) },
+        { "aa 4px closed", AA_LINES, polyline(ring, ImDrawFlags_Closed, 4.0f) },
+        { "plain 1px", 0, polyline(wave, 0, 1.0f) },
+        { "plain 4px", 0, polyline(wave, 0, 4.0f) },
+    });
+}
+
+BENCHMARK(DrawListPolyFilled)
+{
+    DrawListContext context;
+
+    std::vector<ImVec2> circle = MakeCircle(64, ImVec2(100.0f, 100.0f), 80.0f);
+    std::vector<ImVec2> bigCircle = MakeCircle(4096, ImVec2(960.0f, 540.0f), 500.0f);
+    std::vector<ImVec2> star = MakeStar(64, ImVec2(100.0f, 100.0f), 80.0f);
+
+    auto convex = [](const std::vector<ImVec2>& points, int repeat)
+    {
+        return [&points, repeat](ImDrawList& list)
+        {
+            for (int i = 0; i < repeat; i++)
+                list.AddConvexPolyFilled(points.data(), int(points.size()), COLOR);
+        };
+    };
+
+    auto concave = [](const std::vector<ImVec2>& points, int repeat)
+    {
+        return [&points, repeat](ImDrawList& list)
+        {
+            for (int i = 0; i < repeat; i++)
+                list.AddConcavePolyFilled(points.data(), int(points.size()), COLOR);
+        };
+    };
+
+    RunPrimitiveCasesPerSimdLevel({
+        { "convex aa 64 x1000", AA_FILL, convex(circle, 1000) },
+        { "convex aa 4096 x20", AA_FILL, convex(bigCircle, 20) },
+        { "convex plain 64 x1000", 0, convex(circle, 1000) },
+        { "concave aa star 64 x1000", AA_FILL, concave(star, 1000) },
+        { "concave plain star 64 x1000", 0, concave(star, 1000) },
+    });
+}
+
+// Shapes the widgets themselves are made of: frames, buttons, check marks and radio buttons.
+BENCHMARK(DrawListShapes)
+{
+    DrawListContext context;
+
+    auto circles = [](int segments, float thickness)
+    {
+        return [segments, thickness](ImDrawList& list)
+        {
+            for (int i = 0; i < 1000; i++)
+                list.AddCircle(ImVec2(float(i % 40) * 48.0f, float(i / 40) * 40.0f), 16.0f, COLOR, segments, thickness);
+        };
+    };
+
+    auto arcs = [](float radius)
+    {
+        return [radius](ImDrawList& list)
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                ImVec2 center(float(i % 40) * 48.0f, float(i / 40) * 40.0f);
+                list.PathArcTo(center, radius, 0.0f, 3.14159265f * 1.5f);
+                list.PathStroke(COLOR, 0, 1.0f);
+            }
+        };
+    };
+
+    auto rects = [](float rounding)
+    {
+        return [rounding](ImDrawList& list)
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                ImVec2 min(float(i % 40) * 48.0f, float(i / 40) * 40.0f);
+                list.AddRectFilled(min, ImVec2(min.x + 44.0f, min.y + 24.0f), COLOR, rounding);
+            }
+        };
+    };
+
+    RunPrimitiveCases({
+        { "circle aa auto x1000", AA_TEX_LINES | AA_FILL, circles(0, 1.0f) },
+        { "circle aa 64 x1000", AA_TEX_LINES | AA_FILL, circles(64, 1.0f) },
+        { "circle aa 3px x1000", AA_LINES | AA_FILL, circles(0, 3.0f) },
+        { "arc r16 x1000", AA_TEX_LINES | AA_FILL, arcs(16.0f) },
+        { "arc r200 x1000", AA_TEX_LINES | AA_FILL, arcs(200.0f) },
+        { "rect filled x1000", AA_FILL, rects(0.0f) },
+        { "rect rounded 4 x1000", AA_FILL, rects(4.0f) },
+        { "rect rounded 12 x1000", AA_FILL, rects(12.0f) },
+    });
+}
+
+// Words with a line break every 12 of them, like a log or console panel.
+static std::vector<char> MakeText(size_t size)
+{
+    std::vector<char> text;
+    const char* words[] = { "vertex ", "buffer ", "descriptor ", "pipeline ", "shader ", "frame ", "queue ", "fence " };
+
+    for (int i = 0; text.size() < size; i++)
+    {
+        for (const char* c = words[(i * 5 + i / 7) % 8]; *c; c++)
+            text.push_back(*c);
+
+        if (i % 12 == 11)
+            text.push_back('\n');
+    }
+
+    return text;
+}
+
+BENCHMARK(DrawListText)
+{
+    DrawListContext context;
+
+    std::vector<char> text = MakeText(16384);
+
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+
+    auto drawText = [begin, end](float wrapWidth, bool fineClip)
+    {
+        return [begin, end, wrapWidth, fineClip](ImDrawList& list)
+        {
+            ImFont* font = ImGui::GetFont();
+            ImVec4 clipRect(0.0f, 0.0f, 400.0f, 65536.0f);
+            list.AddText(font, font->FontSize, ImVec2(0.0f, 0.0f), COLOR, begin, end, wrapWidth, fineClip ? &clipRect : nullptr);
+        };
+    };
+
+    RunPrimitiveCases({
+        { "text 16k", AA_FILL, drawText(0.0f, false) },
+        { "text 16k wrapped 400", AA_FILL, drawText(400.0f, false) },
+        { "text 16k fine clip 400", AA_FILL, drawText(0.0f, true) },
+    });
+}
+
+BENCHMARK(FontCalcTextSize)
+{
+    DrawListContext context;
+
+    std::vector<char> text = MakeText(16384);
+    ImFont* font = ImGui::GetFont();
+
+    for (float wrapWidth : { 0.0f, 400.0f })
+    {
+        ImVec2 size;
+
+        double ns = MeasureBest([&]()
+        {
+            size = font->CalcTextSizeA(font->FontSize, FLT_MAX, wrapWidth, text.data(), text.data() + text.size());
+        }, 1.0e8);
+
+        DoNotOptimize(size);
+
+        printf("  text 16k wrap %-6.0f %8.2f MB/s (%.0f x %.0f)\n", wrapWidth, text.size() / ns * 1e3, size.x, size.y);
+    }
+}
@@ -0,0 +1,64 @@
+#include <cstdio>
+#include <vector>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "Benchmark.h"
+
+// Tree node IDs as a window's state storage sees them, hashes of a label under a parent ID.
+static std::vector<ImGuiID> MakeKeys(int count, ImGuiID seed)
+{
+    std::vector<ImGuiID> keys(count);
+
+    for (int i = 0; i < count; i++)
+        keys[i] = ImHashData(&i, sizeof(i), seed);
+
+    return keys;
+}
+
+// Builds storages of growing size one insert at a time, the way tree and tab states accumulate, then
+// looks up every key and as many missing ones. Build with and without IMGUI_USE_HASHED_STORAGE in
+// imconfig.h to compare the two layouts.
+BENCHMARK(ImStorage)
+{
+#ifdef IMGUI_USE_HASHED_STORAGE
+    printf("  layout: hashed\n");
+#else
+    printf("  layout: sorted\n");
+#endif
+
+    for (int count : { 100, 1000, 10000, 50000 })
+    {
+        std::vector<ImGuiID> keys = MakeKeys(count, 0x1234);
+        std::vector<ImGuiID> missing = MakeKeys(count, 0x5678);
+
+        ImGuiStorage storage;
+
+        double insertNs = MeasureBest([&]()
+        {
+            storage.Clear();
+
+            for (ImGuiID key : keys)
+                storage.SetInt(key, 1);
+        }, 1.0e8, 3);
+
+        int found = 0;
+
+        double hitNs = MeasureBest([&]()
+        {
+            for (ImGuiID key : keys)
+                found += storage.GetInt(key);
+        }, 1.0e8);
+
+        double missNs = MeasureBest([&]()
+        {
+            for (ImGuiID key : missing)
+                found += storage.GetInt(key);
+        }, 1.0e8);
+
+        DoNotOptimize(found);
+
+        printf("  %6d entries  insert %8.2f ns  hit %6.2f ns  miss %6.2f ns\n", count, insertNs / count, hitNs / count, missNs / count);
+    }
+}
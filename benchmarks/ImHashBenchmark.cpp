@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "Benchmark.h"
+
+// Widget labels as they show up in a window's ID stack: short names, longer ones with a ## suffix,
+// and a few using ### to keep their ID when the visible part changes.
+static std::vector<std::string> MakeLabels(size_t minLength, size_t maxLength)
+{
+    std::vector<std::string> labels;
+    const char* words[] = { "Position", "Rotation", "Scale", "Material", "Shadows", "Enabled", "Texture", "Mesh" };
+
+    for (int i = 0; labels.size() < 4096; i++)
+    {
+        std::string label = words[i % 8];
+
+        while (label.size() < minLength + size_t(i * 7) % (maxLength - minLength + 1))
+            label += words[(i / 8 + label.size()) % 8];
+
+        if (i % 4 == 1)
+            label += "##" + std::to_string(i);
+        else if (i % 16 == 2)
+            label += "###" + std::to_string(i);
+
+        labels.push_back(label);
+    }
+
+    return labels;
+}
+
+// Each hash is seeded with the previous one the way PushID() chains them, so this is latency bound.
+BENCHMARK(ImHash)
+{
+    double cyclesPerNs = GetCyclesPerNanosecond();
+
+    auto report = [&](const char* name, size_t count, size_t bytes, double ns)
+    {
+        printf("  %-28s %8.2f ns/hash %8.2f MB/s", name, ns / count, bytes / ns * 1e3);
+
+        if (cyclesPerNs > 0.0)
+            printf(" %7.2f cycles/hash", ns * cyclesPerNs / count);
+
+        printf("\n");
+    };
+
+    struct LabelCase
+    {
+        const char* name;
+        size_t minLength;
+        size_t maxLength;
+    };
+
+    for (const LabelCase& entry : { LabelCase{ "labels 4-16", 4, 16 }, LabelCase{ "labels 16-64", 16, 64 }, LabelCase{ "labels 64-256", 64, 256 } })
+    {
+        std::vector<std::string> labels = MakeLabels(entry.minLength, entry.maxLength);
+        size_t bytes = 0;
+
+        for (const std::string& label : labels)
+            bytes += label.size();
+
+        for (bool terminated : { true, false })
+        {
+            ImGuiID id = 0;
+
+            double ns = MeasureBest([&]()
+            {
+                for (const std::string& label : labels)
+                    id = ImHashStr(label.c_str(), terminated ? 0 : label.size(), id);
+            }, 1.0e8);
+
+            DoNotOptimize(id);
+
+            std::string name = std::string(entry.name) + (terminated ? " str" : " sized");
+            report(name.c_str(), labels.size(), bytes, ns);
+        }
+    }
+
+    std::vector<int> ints(4096);
+    std::vector<const void*> pointers(4096);
+
+    for (int i = 0; i < 4096; i++)
+    {
+        ints[i] = i * 37;
+        pointers[i] = &ints[i];
+    }
+
+    ImGuiID id = 0;
+
+    double ns = MeasureBest([&]()
+    {
+        for (int value : ints)
+            id = ImHashData(&value, sizeof(value), id);
+    }, 1.0e8);
+
+    report("int", ints.size(), ints.size() * sizeof(int), ns);
+
+    ns = MeasureBest([&]()
+    {
+        for (const void* pointer : pointers)
+            id = ImHashData(&pointer, sizeof(pointer), id);
+    }, 1.0e8);
+
+    DoNotOptimize(id);
+
+    report("pointer", pointers.size(), pointers.size() * sizeof(void*), ns);
+}
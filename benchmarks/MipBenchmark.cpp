@@ -0,0 +1,46 @@
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "MipGenerator.h"
+
+BENCHMARK(MipGeneration)
+{
+    const uint32_t width = 2048, height = 2048;
+
+    JobSystem jobs;
+    std::mt19937 random(1234);
+
+    std::vector<uint8_t> image(size_t(width) * height * 4);
+
+    for (uint8_t& value : image)
+        value = static_cast<uint8_t>(random());
+
+    std::vector<uint8_t> mip(size_t(width / 2) * (height / 2) * 4);
+
+    printf("  %u worker threads, %ux%u source\n", jobs.getThreadCount(), width, height);
+
+    const MipPath paths[] = { MipPath::Scalar, MipPath::SSE2, MipPath::AVX2 };
+
+    for (bool srgb : { false, true })
+    {
+        for (bool parallel : { false, true })
+        {
+            for (MipPath path : paths)
+            {
+                if (!MipGenerator::isSupported(path))
+                    continue;
+
+                MipGenerator generator(parallel ? &jobs : nullptr);
+                generator.setPath(path);
+
+                double ns = MeasureBest([&]() { generator.downsample(image.data(), width, height, srgb, mip.data()); });
+                DoNotOptimize(mip[0]);
+
+                printf("  %-6s %-8s %-8s %8.1f source MP/s\n", srgb ? "sRGB" : "linear", MipGenerator::getPathName(path),
+                    parallel ? "parallel" : "serial", width * height * 1000.0 / ns);
+            }
+        }
+    }
+}
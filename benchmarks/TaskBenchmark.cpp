@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Task.h"
+
+static Task<uint32_t> Leaf(uint32_t value)
+{
+    co_return value + 1;
+}
+
+static Task<uint32_t> Sum(uint32_t count)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+        sum += co_await Leaf(i);
+
+    co_return sum;
+}
+
+// Awaiting a task per small operation, the shape of an async loading chain, and the frame
+// allocation behind each one against plain new/delete.
+BENCHMARK(Tasks)
+{
+    const uint32_t taskCount = 100000;
+    uint32_t sum = 0;
+
+    double ns = MeasureBest([&]()
+    {
+        sum += SyncWait(Sum(taskCount));
+    });
+    DoNotOptimize(sum);
+
+    printf("  create + await %8.1f ns/task\n", ns / taskCount);
+
+    // Frames of a few sizes freed in a different order than allocated, as finishing loads do.
+    const size_t sizes[] = { 96, 160, 256, 384, 640 };
+    const uint32_t frameCount = 4096;
+    std::vector<void*> frames(frameCount);
+
+    ns = MeasureBest([&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+            frames[i] = ::operator new(sizes[i % 5]);
+
+        for (uint32_t i = 0; i < frameCount; i++)
+            ::operator delete(frames[(i * 7) % frameCount]);
+    });
+    DoNotOptimize(frames[0]);
+
+    printf("  heap frames    %8.1f ns/frame\n", ns / frameCount);
+
+    ns = MeasureBest([&]()
+    {
+        for (uint32_t i = 0; i < frameCount; i++)
+            frames[i] = CoroutineFramePool::allocate(sizes[i % 5]);
+
+        for (uint32_t i = 0; i < frameCount; i++)
+        {
+            uint32_t index = (i * 7) % frameCount;
+            CoroutineFramePool::deallocate(frames[index], sizes[index % 5]);
+        }
+    });
+    DoNotOptimize(frames[0]);
+
+    printf("  pooled frames  %8.1f ns/frame\n", ns / frameCount);
+}
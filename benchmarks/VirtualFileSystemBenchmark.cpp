@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "PackFile.h"
+#include "VirtualFileSystem.h"
+
+namespace fs = std::filesystem;
+
+// Thousands of small files, the shape of a material or shader heavy scene, opened once loose
+// and once from a pack holding the same files.
+BENCHMARK(PackedFiles)
+{
+    const uint32_t fileCount = 4000;
+
+    fs::path root = fs::temp_directory_path() / "vfs_benchmark";
+    fs::remove_all(root);
+    fs::create_directories(root / "loose");
+
+    std::mt19937 random(1234);
+    std::vector<PackFileSource> sources(fileCount);
+    std::vector<std::string> paths(fileCount);
+    size_t totalSize = 0;
+
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        paths[i] = "assets/group" + std::to_string(i % 16) + "/file" + std::to_string(i) + ".bin";
+
+        // Half noise, half runs, so roughly half the entries end up compressed.
+        std::vector<uint8_t>& data = sources[i].data;
+        data.resize(512 + random() % 4096);
+
+        for (size_t j = 0; j < data.size(); j++)
+            data[j] = static_cast<uint8_t>(i % 2 ? random() : j / 64);
+
+        sources[i].path = paths[i];
+        totalSize += data.size();
+
+        fs::path loosePath = root / "loose" / paths[i];
+        fs::create_directories(loosePath.parent_path());
+
+        FILE* file = fopen(loosePath.string().c_str(), "wb");
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+    }
+
+    std::string error;
+    std::string packPath = (root / "assets.vpak").string();
+
+    if (!WritePackFile(packPath.c_str(), sources, error))
+    {
+        printf("  failed to write the pack: %s\n", error.c_str());
+        return;
+    }
+
+    VirtualFileSystem loose;
+    loose.mountDirectory((root / "loose").string().c_str());
+
+    VirtualFileSystem packed;
+    packed.mountPack(packPath.c_str());
+
+    printf("  %u files, %.1f MB\n", fileCount, totalSize / (1024.0 * 1024.0));
+
+    const struct { const char* name; const VirtualFileSystem* vfs; } mounts[] =
+    {
+        { "loose", &loose },
+        { "pack", &packed },
+    };
+
+    for (const auto& mount : mounts)
+    {
+        uint64_t checksum = 0;
+
+        double ns = MeasureBest([&]()
+        {
+            VfsFile file;
+
+            for (const std::string& path : paths)
+            {
+                if (mount.vfs->open(path.c_str(), file))
+                    checksum += file.data()[file.size() - 1];
+            }
+        });
+        DoNotOptimize(checksum);
+
+        printf("  %-6s open + touch %8.2f us/file\n", mount.name, ns / fileCount / 1000.0);
+    }
+
+    fs::remove_all(root);
+}
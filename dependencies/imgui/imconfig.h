@@ -50,6 +50,7 @@
 //#define IMGUI_DISABLE_DEFAULT_FILE_FUNCTIONS              // Don't implement ImFileOpen/ImFileClose/ImFileRead/ImFileWrite and ImFileHandle so you can implement them yourself if you don't want to link with fopen/fclose/fread/fwrite. This will also disable the LogToTTY() function.
 //#define IMGUI_DISABLE_DEFAULT_ALLOCATORS                  // Don't implement default allocators calling malloc()/free() to avoid linking with them. You will need to call ImGui::SetAllocatorFunctions().
 //#define IMGUI_DISABLE_SSE                                 // Disable use of SSE intrinsics even if available
+// NEON intrinsics are used automatically on arm64, signalled by IMGUI_ENABLE_NEON (formerly IMGUI_ENABLE_NEON_TESSELLATION, which is still defined alongside it).
 
 //---- Enable Test Engine / Automation features.
 //#define IMGUI_ENABLE_TEST_ENGINE                          // Enable imgui_test_engine hooks. Generally set automatically by include "imgui_te_config.h", see Test Engine for details.
@@ -65,6 +66,14 @@
 //---- Use 32-bit for ImWchar (default is 16-bit) to support Unicode planes 1-16. (e.g. point beyond 0xFFFF like emoticons, dingbats, symbols, shapes, ancient languages, etc...)
 //#define IMGUI_USE_WCHAR32
 
+//---- Hash IDs with the CRC32 of upstream Dear ImGui instead of CRC32C (which uses SSE4.2 or ARMv8 CRC instructions when available).
+// Table and docking settings in .ini files are keyed by these IDs, define this to keep the ones saved by older builds valid.
+//#define IMGUI_USE_LEGACY_CRC32_HASH
+
+//---- Back ImGuiStorage with an open addressing hash index instead of a sorted vector. Insertions become O(1) instead of O(N), which matters
+// for windows holding tens of thousands of tree node or tab states. Data is then in insertion order rather than sorted by key.
+//#define IMGUI_USE_HASHED_STORAGE
+
 //---- Avoid multiple STB libraries implementations, or redefine path/filenames to prioritize another version
 // By default the embedded implementations are declared static and not available outside of Dear ImGui sources files.
 //#define IMGUI_STB_TRUETYPE_FILENAME   "my_folder/stb_truetype.h"
@@ -2219,6 +2219,7 @@ void ImFormatStringToTempBufferV(const char** out_buf, const char** out_buf_end,
 // CRC32 needs a 1KB lookup table (not cache friendly)
 // Although the code to generate the table is simple and shorter than the table itself, using a const table allows us to easily:
 // - avoid an unnecessary branch/memory tap, - keep the ImHashXXX functions usable by static constructors, - make it thread-safe.
+#ifdef IMGUI_USE_LEGACY_CRC32_HASH
 static const ImU32 GCrc32LookupTable[256] =
 {
     0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
@@ -2238,14 +2239,146 @@ static const ImU32 GCrc32LookupTable[256] =
     0xA00AE278,0xD70DD2EE,0x4E048354,0x3903B3C2,0xA7672661,0xD06016F7,0x4969474D,0x3E6E77DB,0xAED16A4A,0xD9D65ADC,0x40DF0B66,0x37D83BF0,0xA9BCAE53,0xDEBB9EC5,0x47B2CF7F,0x30B5FFE9,
     0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D,
 };
+#else
+// CRC32C (Castagnoli polynomial) rather than CRC32, so hashes match the SSE4.2 and ARMv8 crc32c instructions used below when
+// available. IDs differ from upstream Dear ImGui, define IMGUI_USE_LEGACY_CRC32_HASH to keep IDs stored in older .ini files.
+static const ImU32 GCrc32LookupTable[256] =
+{
+    0x00000000,0xF26B8303,0xE13B70F7,0x1350F3F4,0xC79A971F,0x35F1141C,0x26A1E7E8,0xD4CA64EB,0x8AD958CF,0x78B2DBCC,0x6BE22838,0x9989AB3B,0x4D43CFD0,0xBF284CD3,0xAC78BF27,0x5E133C24,
+    0x105EC76F,0xE235446C,0xF165B798,0x030E349B,0xD7C45070,0x25AFD373,0x36FF2087,0xC494A384,0x9A879FA0,0x68EC1CA3,0x7BBCEF57,0x89D76C54,0x5D1D08BF,0xAF768BBC,0xBC267848,0x4E4DFB4B,
+    0x20BD8EDE,0xD2D60DDD,0xC186FE29,0x33ED7D2A,0xE72719C1,0x154C9AC2,0x061C6936,0xF477EA35,0xAA64D611,0x580F5512,0x4B5FA6E6,0xB93425E5,0x6DFE410E,0x9F95C20D,0x8CC531F9,0x7EAEB2FA,
+    0x30E349B1,0xC288CAB2,0xD1D83946,0x23B3BA45,0xF779DEAE,0x05125DAD,0x1642AE59,0xE4292D5A,0xBA3A117E,0x4851927D,0x5B016189,0xA96AE28A,0x7DA08661,0x8FCB0562,0x9C9BF696,0x6EF07595,
+    0x417B1DBC,0xB3109EBF,0xA0406D4B,0x522BEE48,0x86E18AA3,0x748A09A0,0x67DAFA54,0x95B17957,0xCBA24573,0x39C9C670,0x2A993584,0xD8F2B687,0x0C38D26C,0xFE53516F,0xED03A29B,0x1F682198,
+    0x5125DAD3,0xA34E59D0,0xB01EAA24,0x42752927,0x96BF4DCC,0x64D4CECF,0x77843D3B,0x85EFBE38,0xDBFC821C,0x2997011F,0x3AC7F2EB,0xC8AC71E8,0x1C661503,0xEE0D9600,0xFD5D65F4,0x0F36E6F7,
+    0x61C69362,0x93AD1061,0x80FDE395,0x72966096,0xA65C047D,0x5437877E,0x4767748A,0xB50CF789,0xEB1FCBAD,0x197448AE,0x0A24BB5A,0xF84F3859,0x2C855CB2,0xDEEEDFB1,0xCDBE2C45,0x3FD5AF46,
+    0x7198540D,0x83F3D70E,0x90A324FA,0x62C8A7F9,0xB602C312,0x44694011,0x5739B3E5,0xA55230E6,0xFB410CC2,0x092A8FC1,0x1A7A7C35,0xE811FF36,0x3CDB9BDD,0xCEB018DE,0xDDE0EB2A,0x2F8B6829,
+    0x82F63B78,0x709DB87B,0x63CD4B8F,0x91A6C88C,0x456CAC67,0xB7072F64,0xA457DC90,0x563C5F93,0x082F63B7,0xFA44E0B4,0xE9141340,0x1B7F9043,0xCFB5F4A8,0x3DDE77AB,0x2E8E845F,0xDCE5075C,
+    0x92A8FC17,0x60C37F14,0x73938CE0,0x81F80FE3,0x55326B08,0xA759E80B,0xB4091BFF,0x466298FC,0x1871A4D8,0xEA1A27DB,0xF94AD42F,0x0B21572C,0xDFEB33C7,0x2D80B0C4,0x3ED04330,0xCCBBC033,
+    0xA24BB5A6,0x502036A5,0x4370C551,0xB11B4652,0x65D122B9,0x97BAA1BA,0x84EA524E,0x7681D14D,0x2892ED69,0xDAF96E6A,0xC9A99D9E,0x3BC21E9D,0xEF087A76,0x1D63F975,0x0E330A81,0xFC588982,
+    0xB21572C9,0x407EF1CA,0x532E023E,0xA145813D,0x758FE5D6,0x87E466D5,0x94B49521,0x66DF1622,0x38CC2A06,0xCAA7A905,0xD9F75AF1,0x2B9CD9F2,0xFF56BD19,0x0D3D3E1A,0x1E6DCDEE,0xEC064EED,
+    0xC38D26C4,0x31E6A5C7,0x22B65633,0xD0DDD530,0x0417B1DB,0xF67C32D8,0xE52CC12C,0x1747422F,0x49547E0B,0xBB3FFD08,0xA86F0EFC,0x5A048DFF,0x8ECEE914,0x7CA56A17,0x6FF599E3,0x9D9E1AE0,
+    0xD3D3E1AB,0x21B862A8,0x32E8915C,0xC083125F,0x144976B4,0xE622F5B7,0xF5720643,0x07198540,0x590AB964,0xAB613A67,0xB831C993,0x4A5A4A90,0x9E902E7B,0x6CFBAD78,0x7FAB5E8C,0x8DC0DD8F,
+    0xE330A81A,0x115B2B19,0x020BD8ED,0xF0605BEE,0x24AA3F05,0xD6C1BC06,0xC5914FF2,0x37FACCF1,0x69E9F0D5,0x9B8273D6,0x88D28022,0x7AB90321,0xAE7367CA,0x5C18E4C9,0x4F48173D,0xBD23943E,
+    0xF36E6F75,0x0105EC76,0x12551F82,0xE03E9C81,0x34F4F86A,0xC69F7B69,0xD5CF889D,0x27A40B9E,0x79B737BA,0x8BDCB4B9,0x988C474D,0x6AE7C44E,0xBE2DA0A5,0x4C4623A6,0x5F16D052,0xAD7D5351,
+};
+#endif
+
+#if !defined(IMGUI_USE_LEGACY_CRC32_HASH) && defined(IMGUI_ENABLE_SSE)
+#define IMGUI_ENABLE_CRC32C_HW
+#if defined(_MSC_VER)
+#include <intrin.h>     // __cpuid
+#else
+#include <cpuid.h>      // __get_cpuid
+#endif
+// SSE4.2 has to be enabled per function with GCC and Clang, MSVC allows it anywhere.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define IM_TARGET_CRC32C
+#else
+#define IM_TARGET_CRC32C __attribute__((target("sse4.2")))
+#endif
+static bool ImHashCrc32cDetect()
+{
+#if defined(__SSE4_2__) || defined(__AVX__)
+    return true;
+#elif defined(_MSC_VER)
+    int leaf1[4] = {};
+    __cpuid(leaf1, 1);
+    return (leaf1[2] & (1 << 20)) != 0;
+#else
+    unsigned int eax, ebx, ecx = 0, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 20)) != 0;
+#endif
+}
+IM_TARGET_CRC32C static inline ImU32 ImCrc32cU64(ImU32 crc, ImU64 v)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return (ImU32)_mm_crc32_u64(crc, v);
+#else
+    return _mm_crc32_u32(_mm_crc32_u32(crc, (ImU32)v), (ImU32)(v >> 32));
+#endif
+}
+IM_TARGET_CRC32C static inline ImU32 ImCrc32cU32(ImU32 crc, ImU32 v)    { return _mm_crc32_u32(crc, v); }
+IM_TARGET_CRC32C static inline ImU32 ImCrc32cU8(ImU32 crc, unsigned char v) { return _mm_crc32_u8(crc, v); }
+#elif !defined(IMGUI_USE_LEGACY_CRC32_HASH) && defined(__ARM_FEATURE_CRC32)
+#define IMGUI_ENABLE_CRC32C_HW
+#include <arm_acle.h>
+#define IM_TARGET_CRC32C
+static bool ImHashCrc32cDetect()                                    { return true; }
+static inline ImU32 ImCrc32cU64(ImU32 crc, ImU64 v)                 { return __crc32cd(crc, v); }
+static inline ImU32 ImCrc32cU32(ImU32 crc, ImU32 v)                 { return __crc32cw(crc, v); }
+static inline ImU32 ImCrc32cU8(ImU32 crc, unsigned char v)          { return __crc32cb(crc, v); }
+#endif
+
+#ifdef IMGUI_ENABLE_CRC32C_HW
+static inline bool ImHashCrc32cIsSupported()
+{
+    static const bool supported = ImHashCrc32cDetect();
+    return supported;
+}
+
+// 8 bytes per instruction, loads through memcpy() as keys have no particular alignment.
+IM_TARGET_CRC32C static ImU32 ImHashDataCrc32c(ImU32 crc, const unsigned char* data, size_t data_size)
+{
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        ImU64 v;
+        memcpy(&v, data, 8);
+        crc = ImCrc32cU64(crc, v);
+    }
+    if (data_size >= 4)
+    {
+        ImU32 v;
+        memcpy(&v, data, 4);
+        crc = ImCrc32cU32(crc, v);
+        data += 4;
+        data_size -= 4;
+    }
+    while (data_size-- != 0)
+        crc = ImCrc32cU8(crc, *data++);
+    return crc;
+}
+
+// Same result as the table loop in ImHashStr(). Words without a '#' byte are hashed whole, the rest a byte at a time for ### handling.
+IM_TARGET_CRC32C static ImU32 ImHashStrCrc32c(ImU32 seed, const unsigned char* data, size_t data_size)
+{
+    ImU32 crc = seed;
+    const unsigned char* data_end = data + data_size;
+    while (data < data_end)
+    {
+        if (data_end - data >= 8)
+        {
+            ImU64 v;
+            memcpy(&v, data, 8);
+            ImU64 x = v ^ 0x2323232323232323ULL;
+            if (((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) == 0)
+            {
+                crc = ImCrc32cU64(crc, v);
+                data += 8;
+                continue;
+            }
+        }
+        for (const unsigned char* run_end = ImMin(data + 8, data_end); data < run_end; )
+        {
+            unsigned char c = *data++;
+            if (c == '#' && data_end - data >= 2 && data[0] == '#' && data[1] == '#')
+                crc = seed;
+            crc = ImCrc32cU8(crc, c);
+        }
+    }
+    return crc;
+}
+#endif
 
 // Known size hash
 // It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
 {
     ImU32 crc = ~seed;
     const unsigned char* data = (const unsigned char*)data_p;
+#ifdef IMGUI_ENABLE_CRC32C_HW
+    if (ImHashCrc32cIsSupported())
+        return ~ImHashDataCrc32c(crc, data, data_size);
+#endif
     const ImU32* crc32_lut = GCrc32LookupTable;
     while (data_size-- != 0)
         crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ *data++];
@@ -2257,12 +2390,15 @@ ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
 // Because this syntax is rarely used we are optimizing for the common case.
 // - If we reach ### in the string we discard the hash so far and reset to the seed.
 // - We don't do 'current += 2; continue;' after handling ### to keep the code smaller/faster (measured ~10% diff in Debug build)
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
 {
     seed = ~seed;
     ImU32 crc = seed;
     const unsigned char* data = (const unsigned char*)data_p;
+#ifdef IMGUI_ENABLE_CRC32C_HW
+    if (ImHashCrc32cIsSupported())
+        return ~ImHashStrCrc32c(seed, data, data_size != 0 ? data_size : strlen(data_p));
+#endif
     const ImU32* crc32_lut = GCrc32LookupTable;
     if (data_size != 0)
     {
@@ -2691,18 +2827,93 @@ static int IMGUI_CDECL PairComparerByID(const void* lhs, const void* rhs)
     return (lhs_v > rhs_v ? +1 : lhs_v < rhs_v ? -1 : 0);
 }
 
+#ifdef IMGUI_USE_HASHED_STORAGE
+// Most keys are hashes already, but e.g. ImGuiSelectionBasicStorage stores plain indices by default. Fold the high bits down too.
+static inline int ImStorageSlot(ImGuiID key, int mask)
+{
+    ImU32 h = key * 0x9E3779B1u;
+    return (int)(h ^ (h >> 16)) & mask;
+}
+
+static void ImStorageRebuildSlots(ImGuiStorage* storage)
+{
+    int slots_count = 16;
+    while (slots_count < storage->Data.Size * 2)
+        slots_count *= 2;
+    storage->Slots.resize(slots_count);
+    memset(storage->Slots.Data, 0xFF, (size_t)slots_count * sizeof(int));
+    const int mask = slots_count - 1;
+    for (int n = 0; n < storage->Data.Size; n++)
+    {
+        int slot = ImStorageSlot(storage->Data.Data[n].key, mask);
+        while (storage->Slots.Data[slot] >= 0)
+            slot = (slot + 1) & mask;
+        storage->Slots.Data[slot] = n;
+    }
+}
+
+// Linear probing, terminated by the empty slots the table always has.
+static ImGuiStoragePair* ImStorageFind(const ImGuiStorage* storage, ImGuiID key)
+{
+    const int mask = storage->Slots.Size - 1;
+    if (mask < 0)
+        return NULL;
+    for (int slot = ImStorageSlot(key, mask); ; slot = (slot + 1) & mask)
+    {
+        const int idx = storage->Slots.Data[slot];
+        if (idx < 0)
+            return NULL;
+        if (storage->Data.Data[idx].key == key)
+            return const_cast<ImGuiStoragePair*>(&storage->Data.Data[idx]);
+    }
+}
+
+static ImGuiStoragePair* ImStorageFindOrInsert(ImGuiStorage* storage, const ImGuiStoragePair& pair)
+{
+    const int mask = storage->Slots.Size - 1;
+    int slot = (mask < 0) ? 0 : ImStorageSlot(pair.key, mask);
+    if (mask >= 0)
+        for (; storage->Slots.Data[slot] >= 0; slot = (slot + 1) & mask)
+            if (storage->Data.Data[storage->Slots.Data[slot]].key == pair.key)
+                return &storage->Data.Data[storage->Slots.Data[slot]];
+    storage->Data.push_back(pair);
+    if (storage->Data.Size * 2 > storage->Slots.Size)
+        ImStorageRebuildSlots(storage);
+    else
+        storage->Slots.Data[slot] = storage->Data.Size - 1;
+    return &storage->Data.back();
+}
+#else
+static inline ImGuiStoragePair* ImStorageFind(const ImGuiStorage* storage, ImGuiID key)
+{
+    ImGuiStoragePair* it_begin = const_cast<ImGuiStoragePair*>(storage->Data.Data);
+    ImGuiStoragePair* it_end = it_begin + storage->Data.Size;
+    ImGuiStoragePair* it = ImLowerBound(it_begin, it_end, key);
+    return (it != it_end && it->key == key) ? it : NULL;
+}
+
+static inline ImGuiStoragePair* ImStorageFindOrInsert(ImGuiStorage* storage, const ImGuiStoragePair& pair)
+{
+    ImGuiStoragePair* it = ImLowerBound(storage->Data.Data, storage->Data.Data + storage->Data.Size, pair.key);
+    if (it == storage->Data.Data + storage->Data.Size || it->key != pair.key)
+        it = storage->Data.insert(it, pair);
+    return it;
+}
+#endif
+
 // For quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
 void ImGuiStorage::BuildSortByKey()
 {
     ImQsort(Data.Data, (size_t)Data.Size, sizeof(ImGuiStoragePair), PairComparerByID);
+#ifdef IMGUI_USE_HASHED_STORAGE
+    ImStorageRebuildSlots(this);
+#endif
 }
 
 int ImGuiStorage::GetInt(ImGuiID key, int default_val) const
 {
-    ImGuiStoragePair* it = ImLowerBound(const_cast<ImGuiStoragePair*>(Data.Data), const_cast<ImGuiStoragePair*>(Data.Data + Data.Size), key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        return default_val;
-    return it->val_i;
+    ImGuiStoragePair* it = ImStorageFind(this, key);
+    return it ? it->val_i : default_val;
 }
 
 bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
@@ -2712,27 +2923,20 @@ bool ImGuiStorage::GetBool(ImGuiID key, bool default_val) const
 
 float ImGuiStorage::GetFloat(ImGuiID key, float default_val) const
 {
-    ImGuiStoragePair* it = ImLowerBound(const_cast<ImGuiStoragePair*>(Data.Data), const_cast<ImGuiStoragePair*>(Data.Data + Data.Size), key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        return default_val;
-    return it->val_f;
+    ImGuiStoragePair* it = ImStorageFind(this, key);
+    return it ? it->val_f : default_val;
 }
 
 void* ImGuiStorage::GetVoidPtr(ImGuiID key) const
 {
-    ImGuiStoragePair* it = ImLowerBound(const_cast<ImGuiStoragePair*>(Data.Data), const_cast<ImGuiStoragePair*>(Data.Data + Data.Size), key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        return NULL;
-    return it->val_p;
+    ImGuiStoragePair* it = ImStorageFind(this, key);
+    return it ? it->val_p : NULL;
 }
 
 // References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
 int* ImGuiStorage::GetIntRef(ImGuiID key, int default_val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_i;
+    return &ImStorageFindOrInsert(this, ImGuiStoragePair(key, default_val))->val_i;
 }
 
 bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
@@ -2742,28 +2946,17 @@ bool* ImGuiStorage::GetBoolRef(ImGuiID key, bool default_val)
 
 float* ImGuiStorage::GetFloatRef(ImGuiID key, float default_val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_f;
+    return &ImStorageFindOrInsert(this, ImGuiStoragePair(key, default_val))->val_f;
 }
 
 void** ImGuiStorage::GetVoidPtrRef(ImGuiID key, void* default_val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        it = Data.insert(it, ImGuiStoragePair(key, default_val));
-    return &it->val_p;
+    return &ImStorageFindOrInsert(this, ImGuiStoragePair(key, default_val))->val_p;
 }
 
-// FIXME-OPT: Need a way to reuse the result of lower_bound when doing GetInt()/SetInt() - not too bad because it only happens on explicit interaction (maximum one a frame)
 void ImGuiStorage::SetInt(ImGuiID key, int val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        Data.insert(it, ImGuiStoragePair(key, val));
-    else
-        it->val_i = val;
+    ImStorageFindOrInsert(this, ImGuiStoragePair(key, val))->val_i = val;
 }
 
 void ImGuiStorage::SetBool(ImGuiID key, bool val)
@@ -2773,20 +2966,12 @@ void ImGuiStorage::SetBool(ImGuiID key, bool val)
 
 void ImGuiStorage::SetFloat(ImGuiID key, float val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        Data.insert(it, ImGuiStoragePair(key, val));
-    else
-        it->val_f = val;
+    ImStorageFindOrInsert(this, ImGuiStoragePair(key, val))->val_f = val;
 }
 
 void ImGuiStorage::SetVoidPtr(ImGuiID key, void* val)
 {
-    ImGuiStoragePair* it = ImLowerBound(Data.Data, Data.Data + Data.Size, key);
-    if (it == Data.Data + Data.Size || it->key != key)
-        Data.insert(it, ImGuiStoragePair(key, val));
-    else
-        it->val_p = val;
+    ImStorageFindOrInsert(this, ImGuiStoragePair(key, val))->val_p = val;
 }
 
 void ImGuiStorage::SetAllInt(int v)
@@ -21974,8 +22159,8 @@ void ImGui::DebugNodeFont(ImFont* font)
     for (int config_i = 0; config_i < font->ConfigDataCount; config_i++)
         if (font->ConfigData)
             if (const ImFontConfig* cfg = &font->ConfigData[config_i])
-                BulletText("Input %d: \'%s\', Oversample: (%d,%d), PixelSnapH: %d, Offset: (%.1f,%.1f)",
-                    config_i, cfg->Name, cfg->OversampleH, cfg->OversampleV, cfg->PixelSnapH, cfg->GlyphOffset.x, cfg->GlyphOffset.y);
+                BulletText("Input %d: \'%s\', Oversample: (%d,%d), PixelSnapH: %d, Offset: (%.1f,%.1f), Build: %.2f ms",
+                    config_i, cfg->Name, cfg->OversampleH, cfg->OversampleV, cfg->PixelSnapH, cfg->GlyphOffset.x, cfg->GlyphOffset.y, cfg->BuildTimeMs);
 
     // Display all glyphs of the fonts in separate pages of 256 characters
     if (TreeNode("Glyphs", "Glyphs (%d)", font->Glyphs.Size))
@@ -287,6 +287,7 @@ typedef int     (*ImGuiInputTextCallback)(ImGuiInputTextCallbackData* data);
 typedef void    (*ImGuiSizeCallback)(ImGuiSizeCallbackData* data);              // Callback function for ImGui::SetNextWindowSizeConstraints()
 typedef void*   (*ImGuiMemAllocFunc)(size_t sz, void* user_data);               // Function signature for ImGui::SetAllocatorFunctions()
 typedef void    (*ImGuiMemFreeFunc)(void* ptr, void* user_data);                // Function signature for ImGui::SetAllocatorFunctions()
+typedef void    (*ImFontAtlasParallelForFn)(void* user_data, int count, void (*job)(void* job_data, int index), void* job_data); // Function signature for ImFontAtlas::ParallelFor
 
 // ImVec2: 2D vector used to store positions, sizes etc. [Compile-time configurable type]
 // - This is a frequently used type in the API. Consider using IM_VEC2_CLASS_EXTRA to create implicit cast from/to our preferred type.
@@ -2724,11 +2725,19 @@ struct ImGuiStorage
 {
     // [Internal]
     ImVector<ImGuiStoragePair>      Data;
+#ifdef IMGUI_USE_HASHED_STORAGE
+    ImVector<int>                   Slots;      // Open addressing index of Data, power of two sized and at most half full, -1 for empty slots
+#endif
 
     // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
     // - Set***() functions find pair, insertion on demand if missing.
     // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
+    // - With IMGUI_USE_HASHED_STORAGE pairs are kept in insertion order instead and found through Slots, queries and insertions are O(1).
+#ifdef IMGUI_USE_HASHED_STORAGE
+    void                Clear() { Data.clear(); Slots.clear(); }
+#else
     void                Clear() { Data.clear(); }
+#endif
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -2748,6 +2757,7 @@ struct ImGuiStorage
     IMGUI_API void**    GetVoidPtrRef(ImGuiID key, void* default_val = NULL);
 
     // Advanced: for quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
+    // With IMGUI_USE_HASHED_STORAGE this also rebuilds Slots, call it after adding to Data directly.
     IMGUI_API void      BuildSortByKey();
     // Obsolete: use on your own storage if you know only integer are being stored (open/close all tree nodes)
     IMGUI_API void      SetAllInt(int val);
@@ -3373,6 +3383,7 @@ struct ImFontConfig
     // [Internal]
     char            Name[40];               // Name (strictly to ease debugging)
     ImFont*         DstFont;
+    float           BuildTimeMs;            // Time spent rasterizing this source's glyphs in the last Build(), summed over threads
 
     IMGUI_API ImFontConfig();
 };
@@ -3517,6 +3528,8 @@ struct ImFontAtlas
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1. If your rendering method doesn't rely on bilinear filtering you may set this to 0 (will also need to set AntiAliasedLinesUseTex = false).
     bool                        Locked;             // Marked as Locked by ImGui::NewFrame() so attempt to modify the atlas will assert.
     void*                       UserData;           // Store your own atlas related user-data (if e.g. you have multiple font atlas).
+    ImFontAtlasParallelForFn    ParallelFor;        // Optional: let the stb_truetype builder rasterize glyphs on other threads. Must call job(job_data, n) once for every n in [0, count), in any order and on any thread, and return when all have finished.
+    void*                       ParallelForUserData; // Passed as user_data to ParallelFor.
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
@@ -39,6 +39,7 @@ Index of this file:
 #endif
 
 #include <stdio.h>      // vsnprintf, sscanf, printf
+#include <chrono>       // steady_clock, font build times
 
 // Visual Studio warnings
 #ifdef _MSC_VER
@@ -130,8 +131,29 @@ namespace IMGUI_STB_NAMESPACE
 #ifdef  IMGUI_ENABLE_STB_TRUETYPE
 #ifndef STB_TRUETYPE_IMPLEMENTATION                         // in case the user already have an implementation in the _same_ compilation unit (e.g. unity builds)
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION           // in case the user already have an implementation in another compilation unit
-#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
-#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+// Glyphs may be rasterized on other threads (see ImFontAtlas::ParallelFor), their allocations are made with a non-NULL user data
+// and go straight to the allocator functions, as IM_ALLOC() also records them in the current context.
+static void* ImFontAtlasBuildStbttAlloc(size_t size, void* user_data)
+{
+    if (user_data == NULL)
+        return IM_ALLOC(size);
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* alloc_user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &alloc_user_data);
+    return alloc_func(size, alloc_user_data);
+}
+static void ImFontAtlasBuildStbttFree(void* ptr, void* user_data)
+{
+    if (user_data == NULL)
+    {
+        IM_FREE(ptr);
+        return;
+    }
+    ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* alloc_user_data;
+    ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &alloc_user_data);
+    free_func(ptr, alloc_user_data);
+}
+#define STBTT_malloc(x,u)   ImFontAtlasBuildStbttAlloc(x,u)
+#define STBTT_free(x,u)     ImFontAtlasBuildStbttFree(x,u)
 #define STBTT_assert(x)     do { IM_ASSERT(x); } while(0)
 #define STBTT_fmod(x,y)     ImFmod(x,y)
 #define STBTT_sqrt(x)       ImSqrt(x)
@@ -749,6 +771,410 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
 #define IM_FIXNORMAL2F_MAX_INVLEN2          100.0f // 500.0f (see #4053, #3366)
 #define IM_FIXNORMAL2F(VX,VY)               { float d2 = VX*VX + VY*VY; if (d2 > 0.000001f) { float inv_len2 = 1.0f / d2; if (inv_len2 > IM_FIXNORMAL2F_MAX_INVLEN2) inv_len2 = IM_FIXNORMAL2F_MAX_INVLEN2; VX *= inv_len2; VY *= inv_len2; } } (void)0
 
+//-----------------------------------------------------------------------------
+// Tessellation kernels for AddPolyline() and AddConvexPolyFilled()
+//-----------------------------------------------------------------------------
+// - SegmentNormals: out_normals[i] = normal of the segment p0[i] -> p1[i], as IM_NORMALIZE2F_OVER_ZERO() then (dy, -dx).
+// - EdgePoints2/4: the normals either side of points[i] (n0[i], n1[i]) averaged and fixed as IM_FIXNORMAL2F(), then offset
+//   from the point by +/-scale into 2 or 4 consecutive out_points.
+// - The SIMD versions run the exact same IEEE operations in the same order, so their output is bit identical to the scalar
+//   ones: _mm_rsqrt_ps() matches _mm_rsqrt_ss() lane for lane, and on NEON ImRsqrt() is 1.0f/sqrtf() which vsqrtq/vdivq match.
+//   Nothing may be fused into FMA: the AVX2 target doesn't enable it and MSVC doesn't contract without /fp:contract.
+//   GCC on ARM64 contracts by default, build with -ffp-contract=off there if NEON and scalar output must match.
+//-----------------------------------------------------------------------------
+
+struct ImDrawTessFuncs
+{
+    void (*SegmentNormals)(const ImVec2* p0, const ImVec2* p1, int count, ImVec2* out_normals);
+    void (*EdgePoints2)(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale, ImVec2* out_points);
+    void (*EdgePoints4)(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale_outer, float scale_inner, ImVec2* out_points);
+};
+
+static void ImDrawTess_SegmentNormals_Scalar(const ImVec2* p0, const ImVec2* p1, int count, ImVec2* out_normals)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float dx = p1[i].x - p0[i].x;
+        float dy = p1[i].y - p0[i].y;
+        IM_NORMALIZE2F_OVER_ZERO(dx, dy);
+        out_normals[i].x = dy;
+        out_normals[i].y = -dx;
+    }
+}
+
+static void ImDrawTess_EdgePoints2_Scalar(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale, ImVec2* out_points)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float dm_x = (n0[i].x + n1[i].x) * 0.5f;
+        float dm_y = (n0[i].y + n1[i].y) * 0.5f;
+        IM_FIXNORMAL2F(dm_x, dm_y);
+        dm_x *= scale;
+        dm_y *= scale;
+        out_points[i * 2 + 0].x = points[i].x + dm_x;
+        out_points[i * 2 + 0].y = points[i].y + dm_y;
+        out_points[i * 2 + 1].x = points[i].x - dm_x;
+        out_points[i * 2 + 1].y = points[i].y - dm_y;
+    }
+}
+
+static void ImDrawTess_EdgePoints4_Scalar(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale_outer, float scale_inner, ImVec2* out_points)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float dm_x = (n0[i].x + n1[i].x) * 0.5f;
+        float dm_y = (n0[i].y + n1[i].y) * 0.5f;
+        IM_FIXNORMAL2F(dm_x, dm_y);
+        float dm_out_x = dm_x * scale_outer;
+        float dm_out_y = dm_y * scale_outer;
+        float dm_in_x = dm_x * scale_inner;
+        float dm_in_y = dm_y * scale_inner;
+        out_points[i * 4 + 0].x = points[i].x + dm_out_x;
+        out_points[i * 4 + 0].y = points[i].y + dm_out_y;
+        out_points[i * 4 + 1].x = points[i].x + dm_in_x;
+        out_points[i * 4 + 1].y = points[i].y + dm_in_y;
+        out_points[i * 4 + 2].x = points[i].x - dm_in_x;
+        out_points[i * 4 + 2].y = points[i].y - dm_in_y;
+        out_points[i * 4 + 3].x = points[i].x - dm_out_x;
+        out_points[i * 4 + 3].y = points[i].y - dm_out_y;
+    }
+}
+
+static const ImDrawTessFuncs GImDrawTessScalar = { ImDrawTess_SegmentNormals_Scalar, ImDrawTess_EdgePoints2_Scalar, ImDrawTess_EdgePoints4_Scalar };
+
+#ifdef IMGUI_ENABLE_SSE
+
+// Two points per register as x0,y0,x1,y1. Lengths are summed with a pair swap, so both lanes of a point hold its length.
+static void ImDrawTess_SegmentNormals_SSE2(const ImVec2* p0, const ImVec2* p1, int count, ImVec2* out_normals)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 negate_y = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(&p1[i].x), _mm_loadu_ps(&p0[i].x));
+        __m128 sq = _mm_mul_ps(d, d);
+        __m128 d2 = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        __m128 mask = _mm_cmpgt_ps(d2, zero);
+        __m128 n = _mm_mul_ps(d, _mm_rsqrt_ps(d2));
+        n = _mm_or_ps(_mm_and_ps(mask, n), _mm_andnot_ps(mask, d));
+        n = _mm_xor_ps(_mm_shuffle_ps(n, n, _MM_SHUFFLE(2, 3, 0, 1)), negate_y);
+        _mm_storeu_ps(&out_normals[i].x, n);
+    }
+    ImDrawTess_SegmentNormals_Scalar(p0 + i, p1 + i, count - i, out_normals + i);
+}
+
+static inline __m128 ImDrawTess_FixNormals_SSE2(const ImVec2* n0, const ImVec2* n1)
+{
+    __m128 dm = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&n0->x), _mm_loadu_ps(&n1->x)), _mm_set1_ps(0.5f));
+    __m128 sq = _mm_mul_ps(dm, dm);
+    __m128 d2 = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+    __m128 mask = _mm_cmpgt_ps(d2, _mm_set1_ps(0.000001f));
+    __m128 inv_len2 = _mm_min_ps(_mm_div_ps(_mm_set1_ps(1.0f), d2), _mm_set1_ps(IM_FIXNORMAL2F_MAX_INVLEN2));
+    return _mm_or_ps(_mm_and_ps(mask, _mm_mul_ps(dm, inv_len2)), _mm_andnot_ps(mask, dm));
+}
+
+static void ImDrawTess_EdgePoints2_SSE2(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale, ImVec2* out_points)
+{
+    const __m128 scale4 = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128 dm = _mm_mul_ps(ImDrawTess_FixNormals_SSE2(n0 + i, n1 + i), scale4);
+        __m128 p = _mm_loadu_ps(&points[i].x);
+        __m128d a = _mm_castps_pd(_mm_add_ps(p, dm));
+        __m128d b = _mm_castps_pd(_mm_sub_ps(p, dm));
+        _mm_storeu_pd((double*)&out_points[i * 2 + 0], _mm_unpacklo_pd(a, b));
+        _mm_storeu_pd((double*)&out_points[i * 2 + 2], _mm_unpackhi_pd(a, b));
+    }
+    ImDrawTess_EdgePoints2_Scalar(points + i, n0 + i, n1 + i, count - i, scale, out_points + i * 2);
+}
+
+static void ImDrawTess_EdgePoints4_SSE2(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale_outer, float scale_inner, ImVec2* out_points)
+{
+    const __m128 outer4 = _mm_set1_ps(scale_outer);
+    const __m128 inner4 = _mm_set1_ps(scale_inner);
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128 dm = ImDrawTess_FixNormals_SSE2(n0 + i, n1 + i);
+        __m128 dm_out = _mm_mul_ps(dm, outer4);
+        __m128 dm_in = _mm_mul_ps(dm, inner4);
+        __m128 p = _mm_loadu_ps(&points[i].x);
+        __m128d a = _mm_castps_pd(_mm_add_ps(p, dm_out));
+        __m128d b = _mm_castps_pd(_mm_add_ps(p, dm_in));
+        __m128d c = _mm_castps_pd(_mm_sub_ps(p, dm_in));
+        __m128d d = _mm_castps_pd(_mm_sub_ps(p, dm_out));
+        _mm_storeu_pd((double*)&out_points[i * 4 + 0], _mm_unpacklo_pd(a, b));
+        _mm_storeu_pd((double*)&out_points[i * 4 + 2], _mm_unpacklo_pd(c, d));
+        _mm_storeu_pd((double*)&out_points[i * 4 + 4], _mm_unpackhi_pd(a, b));
+        _mm_storeu_pd((double*)&out_points[i * 4 + 6], _mm_unpackhi_pd(c, d));
+    }
+    ImDrawTess_EdgePoints4_Scalar(points + i, n0 + i, n1 + i, count - i, scale_outer, scale_inner, out_points + i * 4);
+}
+
+static const ImDrawTessFuncs GImDrawTessSSE2 = { ImDrawTess_SegmentNormals_SSE2, ImDrawTess_EdgePoints2_SSE2, ImDrawTess_EdgePoints4_SSE2 };
+
+// AVX2 has to be enabled per function with GCC and Clang, MSVC allows it anywhere. Deliberately without "fma".
+#if defined(_MSC_VER) && !defined(__clang__)
+#define IM_TARGET_AVX2
+#else
+#define IM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Four points per register, two per 128-bit lane as in the SSE2 versions. Only the final interleave crosses lanes.
+// The upper halves are cleared before handing the remainder to SSE2, not every compiler does it for a tail call.
+IM_TARGET_AVX2 static void ImDrawTess_SegmentNormals_AVX2(const ImVec2* p0, const ImVec2* p1, int count, ImVec2* out_normals)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 negate_y = _mm256_set_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(&p1[i].x), _mm256_loadu_ps(&p0[i].x));
+        __m256 sq = _mm256_mul_ps(d, d);
+        __m256 d2 = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        __m256 mask = _mm256_cmp_ps(d2, zero, _CMP_GT_OQ);
+        __m256 n = _mm256_blendv_ps(d, _mm256_mul_ps(d, _mm256_rsqrt_ps(d2)), mask);
+        n = _mm256_xor_ps(_mm256_permute_ps(n, _MM_SHUFFLE(2, 3, 0, 1)), negate_y);
+        _mm256_storeu_ps(&out_normals[i].x, n);
+    }
+    _mm256_zeroupper();
+    ImDrawTess_SegmentNormals_SSE2(p0 + i, p1 + i, count - i, out_normals + i);
+}
+
+IM_TARGET_AVX2 static inline __m256 ImDrawTess_FixNormals_AVX2(const ImVec2* n0, const ImVec2* n1)
+{
+    __m256 dm = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(&n0->x), _mm256_loadu_ps(&n1->x)), _mm256_set1_ps(0.5f));
+    __m256 sq = _mm256_mul_ps(dm, dm);
+    __m256 d2 = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+    __m256 mask = _mm256_cmp_ps(d2, _mm256_set1_ps(0.000001f), _CMP_GT_OQ);
+    __m256 inv_len2 = _mm256_min_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), d2), _mm256_set1_ps(IM_FIXNORMAL2F_MAX_INVLEN2));
+    return _mm256_blendv_ps(dm, _mm256_mul_ps(dm, inv_len2), mask);
+}
+
+IM_TARGET_AVX2 static void ImDrawTess_EdgePoints2_AVX2(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale, ImVec2* out_points)
+{
+    const __m256 scale8 = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256 dm = _mm256_mul_ps(ImDrawTess_FixNormals_AVX2(n0 + i, n1 + i), scale8);
+        __m256 p = _mm256_loadu_ps(&points[i].x);
+        __m256d a = _mm256_castps_pd(_mm256_add_ps(p, dm));
+        __m256d b = _mm256_castps_pd(_mm256_sub_ps(p, dm));
+        __m256d lo = _mm256_unpacklo_pd(a, b); // points 0 and 2
+        __m256d hi = _mm256_unpackhi_pd(a, b); // points 1 and 3
+        _mm256_storeu_pd((double*)&out_points[i * 2 + 0], _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd((double*)&out_points[i * 2 + 4], _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+    _mm256_zeroupper();
+    ImDrawTess_EdgePoints2_SSE2(points + i, n0 + i, n1 + i, count - i, scale, out_points + i * 2);
+}
+
+IM_TARGET_AVX2 static void ImDrawTess_EdgePoints4_AVX2(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale_outer, float scale_inner, ImVec2* out_points)
+{
+    const __m256 outer8 = _mm256_set1_ps(scale_outer);
+    const __m256 inner8 = _mm256_set1_ps(scale_inner);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256 dm = ImDrawTess_FixNormals_AVX2(n0 + i, n1 + i);
+        __m256 dm_out = _mm256_mul_ps(dm, outer8);
+        __m256 dm_in = _mm256_mul_ps(dm, inner8);
+        __m256 p = _mm256_loadu_ps(&points[i].x);
+        __m256d a = _mm256_castps_pd(_mm256_add_ps(p, dm_out));
+        __m256d b = _mm256_castps_pd(_mm256_add_ps(p, dm_in));
+        __m256d c = _mm256_castps_pd(_mm256_sub_ps(p, dm_in));
+        __m256d d = _mm256_castps_pd(_mm256_sub_ps(p, dm_out));
+        __m256d ab_lo = _mm256_unpacklo_pd(a, b), cd_lo = _mm256_unpacklo_pd(c, d); // points 0 and 2
+        __m256d ab_hi = _mm256_unpackhi_pd(a, b), cd_hi = _mm256_unpackhi_pd(c, d); // points 1 and 3
+        _mm256_storeu_pd((double*)&out_points[i * 4 + 0], _mm256_permute2f128_pd(ab_lo, cd_lo, 0x20));
+        _mm256_storeu_pd((double*)&out_points[i * 4 + 4], _mm256_permute2f128_pd(ab_hi, cd_hi, 0x20));
+        _mm256_storeu_pd((double*)&out_points[i * 4 + 8], _mm256_permute2f128_pd(ab_lo, cd_lo, 0x31));
+        _mm256_storeu_pd((double*)&out_points[i * 4 + 12], _mm256_permute2f128_pd(ab_hi, cd_hi, 0x31));
+    }
+    _mm256_zeroupper();
+    ImDrawTess_EdgePoints4_SSE2(points + i, n0 + i, n1 + i, count - i, scale_outer, scale_inner, out_points + i * 4);
+}
+
+static const ImDrawTessFuncs GImDrawTessAVX2 = { ImDrawTess_SegmentNormals_AVX2, ImDrawTess_EdgePoints2_AVX2, ImDrawTess_EdgePoints4_AVX2 };
+
+#endif // #ifdef IMGUI_ENABLE_SSE
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define IMGUI_ENABLE_NEON
+#ifndef IMGUI_ENABLE_NEON_TESSELLATION
+#define IMGUI_ENABLE_NEON_TESSELLATION  // Older name from when only tessellation used NEON, kept as an alias of IMGUI_ENABLE_NEON.
+#endif
+#include <arm_neon.h>
+
+static inline float32x4_t ImDrawTess_SwapPairs_NEON(float32x4_t v) { return vrev64q_f32(v); }
+static inline float32x4_t ImDrawTess_Select_NEON(uint32x4_t mask, float32x4_t a, float32x4_t b) { return vbslq_f32(mask, a, b); }
+
+static void ImDrawTess_SegmentNormals_NEON(const ImVec2* p0, const ImVec2* p1, int count, ImVec2* out_normals)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const uint32x4_t negate_y = vreinterpretq_u32_f32(vsetq_lane_f32(-0.0f, vsetq_lane_f32(-0.0f, zero, 1), 3));
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        float32x4_t d = vsubq_f32(vld1q_f32(&p1[i].x), vld1q_f32(&p0[i].x));
+        float32x4_t sq = vmulq_f32(d, d);
+        float32x4_t d2 = vaddq_f32(sq, ImDrawTess_SwapPairs_NEON(sq));
+        float32x4_t n = ImDrawTess_Select_NEON(vcgtq_f32(d2, zero), vmulq_f32(d, vdivq_f32(one, vsqrtq_f32(d2))), d);
+        n = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(ImDrawTess_SwapPairs_NEON(n)), negate_y));
+        vst1q_f32(&out_normals[i].x, n);
+    }
+    ImDrawTess_SegmentNormals_Scalar(p0 + i, p1 + i, count - i, out_normals + i);
+}
+
+static inline float32x4_t ImDrawTess_FixNormals_NEON(const ImVec2* n0, const ImVec2* n1)
+{
+    float32x4_t dm = vmulq_f32(vaddq_f32(vld1q_f32(&n0->x), vld1q_f32(&n1->x)), vdupq_n_f32(0.5f));
+    float32x4_t sq = vmulq_f32(dm, dm);
+    float32x4_t d2 = vaddq_f32(sq, ImDrawTess_SwapPairs_NEON(sq));
+    float32x4_t inv_len2 = vminq_f32(vdivq_f32(vdupq_n_f32(1.0f), d2), vdupq_n_f32(IM_FIXNORMAL2F_MAX_INVLEN2));
+    return ImDrawTess_Select_NEON(vcgtq_f32(d2, vdupq_n_f32(0.000001f)), vmulq_f32(dm, inv_len2), dm);
+}
+
+static void ImDrawTess_EdgePoints2_NEON(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale, ImVec2* out_points)
+{
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        float32x4_t dm = vmulq_n_f32(ImDrawTess_FixNormals_NEON(n0 + i, n1 + i), scale);
+        float32x4_t p = vld1q_f32(&points[i].x);
+        float32x4_t a = vaddq_f32(p, dm);
+        float32x4_t b = vsubq_f32(p, dm);
+        vst1q_f32(&out_points[i * 2 + 0].x, vcombine_f32(vget_low_f32(a), vget_low_f32(b)));
+        vst1q_f32(&out_points[i * 2 + 2].x, vcombine_f32(vget_high_f32(a), vget_high_f32(b)));
+    }
+    ImDrawTess_EdgePoints2_Scalar(points + i, n0 + i, n1 + i, count - i, scale, out_points + i * 2);
+}
+
+static void ImDrawTess_EdgePoints4_NEON(const ImVec2* points, const ImVec2* n0, const ImVec2* n1, int count, float scale_outer, float scale_inner, ImVec2* out_points)
+{
+    int i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        float32x4_t dm = ImDrawTess_FixNormals_NEON(n0 + i, n1 + i);
+        float32x4_t dm_out = vmulq_n_f32(dm, scale_outer);
+        float32x4_t dm_in = vmulq_n_f32(dm, scale_inner);
+        float32x4_t p = vld1q_f32(&points[i].x);
+        float32x4_t a = vaddq_f32(p, dm_out);
+        float32x4_t b = vaddq_f32(p, dm_in);
+        float32x4_t c = vsubq_f32(p, dm_in);
+        float32x4_t d = vsubq_f32(p, dm_out);
+        vst1q_f32(&out_points[i * 4 + 0].x, vcombine_f32(vget_low_f32(a), vget_low_f32(b)));
+        vst1q_f32(&out_points[i * 4 + 2].x, vcombine_f32(vget_low_f32(c), vget_low_f32(d)));
+        vst1q_f32(&out_points[i * 4 + 4].x, vcombine_f32(vget_high_f32(a), vget_high_f32(b)));
+        vst1q_f32(&out_points[i * 4 + 6].x, vcombine_f32(vget_high_f32(c), vget_high_f32(d)));
+    }
+    ImDrawTess_EdgePoints4_Scalar(points + i, n0 + i, n1 + i, count - i, scale_outer, scale_inner, out_points + i * 4);
+}
+
+static const ImDrawTessFuncs GImDrawTessNEON = { ImDrawTess_SegmentNormals_NEON, ImDrawTess_EdgePoints2_NEON, ImDrawTess_EdgePoints4_NEON };
+
+#endif // #if defined(__aarch64__) || defined(_M_ARM64)
+
+#if defined(IMGUI_ENABLE_SSE) && defined(_MSC_VER)
+#include <intrin.h>     // __cpuidex, _xgetbv
+#elif defined(IMGUI_ENABLE_SSE)
+#include <cpuid.h>      // __cpuid_count
+#endif
+
+#ifdef IMGUI_ENABLE_SSE
+// AVX state has to be enabled by the OS (OSXSAVE and XCR0) as well as AVX2 supported by the CPU.
+static bool ImDrawSimdDetectAVX2()
+{
+    unsigned int leaf1[4] = {}, leaf7[4] = {};
+#ifdef _MSC_VER
+    __cpuidex((int*)leaf1, 1, 0);
+    __cpuidex((int*)leaf7, 7, 0);
+#else
+    __cpuid_count(1, 0, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#endif
+    if ((leaf1[2] & (1u << 27)) == 0)
+        return false;
+#ifdef _MSC_VER
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    unsigned long long xcr0 = ((unsigned long long)xcr0_hi << 32) | xcr0_lo;
+#endif
+    return (xcr0 & 0x6) == 0x6 && (leaf7[1] & (1u << 5)) != 0;
+}
+#endif
+
+bool ImDrawSimdIsSupported(ImDrawSimd simd)
+{
+    switch (simd)
+    {
+    case ImDrawSimd_Scalar:
+        return true;
+#ifdef IMGUI_ENABLE_SSE
+    case ImDrawSimd_SSE2:
+        return true;
+    case ImDrawSimd_AVX2:
+    {
+        static const bool supported = ImDrawSimdDetectAVX2();
+        return supported;
+    }
+#endif
+#ifdef IMGUI_ENABLE_NEON
+    case ImDrawSimd_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+static ImDrawSimd ImDrawSimdGetBest()
+{
+    if (ImDrawSimdIsSupported(ImDrawSimd_AVX2))
+        return ImDrawSimd_AVX2;
+    if (ImDrawSimdIsSupported(ImDrawSimd_NEON))
+        return ImDrawSimd_NEON;
+    if (ImDrawSimdIsSupported(ImDrawSimd_SSE2))
+        return ImDrawSimd_SSE2;
+    return ImDrawSimd_Scalar;
+}
+
+static ImDrawSimd GImDrawSimd = -1;
+
+ImDrawSimd ImDrawSimdGetCurrent()
+{
+    if (GImDrawSimd < 0)
+        GImDrawSimd = ImDrawSimdGetBest();
+    return GImDrawSimd;
+}
+
+void ImDrawSimdSetCurrent(ImDrawSimd simd)
+{
+    if (ImDrawSimdIsSupported(simd))
+        GImDrawSimd = simd;
+}
+
+static const ImDrawTessFuncs& ImDrawTessGetFuncs()
+{
+    switch (ImDrawSimdGetCurrent())
+    {
+#ifdef IMGUI_ENABLE_SSE
+    case ImDrawSimd_SSE2: return GImDrawTessSSE2;
+    case ImDrawSimd_AVX2: return GImDrawTessAVX2;
+#endif
+#ifdef IMGUI_ENABLE_NEON
+    case ImDrawSimd_NEON: return GImDrawTessNEON;
+#endif
+    default: return GImDrawTessScalar;
+    }
+}
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 // We avoid using the ImVec2 math operators here to reduce cost to a minimum for debug/non-inlined builds.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness)
@@ -791,17 +1217,13 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         ImVec2* temp_points = temp_normals + points_count;
 
         // Calculate normals (tangents) for each line segment
-        for (int i1 = 0; i1 < count; i1++)
-        {
-            const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
-            float dx = points[i2].x - points[i1].x;
-            float dy = points[i2].y - points[i1].y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            temp_normals[i1].x = dy;
-            temp_normals[i1].y = -dx;
-        }
-        if (!closed)
-            temp_normals[points_count - 1] = temp_normals[points_count - 2];
+        const ImDrawTessFuncs& tess = ImDrawTessGetFuncs();
+        const int points_last = points_count - 1;
+        tess.SegmentNormals(points, points + 1, points_last, temp_normals);
+        if (closed)
+            tess.SegmentNormals(points + points_last, points, 1, temp_normals + points_last);
+        else
+            temp_normals[points_last] = temp_normals[points_last - 1];
 
         // If we are drawing a one-pixel-wide line without a texture, or a textured line of any width, we only need 2 or 3 vertices per point
         if (use_texture || !thick_line)
@@ -816,38 +1238,27 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
             //   allow scaling geometry while preserving one-screen-pixel AA fringe).
             const float half_draw_size = use_texture ? ((thickness * 0.5f) + 1) : AA_SIZE;
 
-            // If line is not closed, the first and last points need to be generated differently as there are no normals to blend
-            if (!closed)
+            // Add temporary vertexes for the outer edges, from the averaged normals either side of each point
+            // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
+            // If line is not closed, the first point needs to be generated differently as there are no normals to blend
+            tess.EdgePoints2(points + 1, temp_normals, temp_normals + 1, points_last, half_draw_size, temp_points + 2);
+            if (closed)
+            {
+                tess.EdgePoints2(points, temp_normals + points_last, temp_normals, 1, half_draw_size, temp_points);
+            }
+            else
             {
                 temp_points[0] = points[0] + temp_normals[0] * half_draw_size;
                 temp_points[1] = points[0] - temp_normals[0] * half_draw_size;
-                temp_points[(points_count-1)*2+0] = points[points_count-1] + temp_normals[points_count-1] * half_draw_size;
-                temp_points[(points_count-1)*2+1] = points[points_count-1] - temp_normals[points_count-1] * half_draw_size;
             }
 
-            // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
-            // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
+            // Generate the indices to form a number of triangles for each line segment
             // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
             unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
             for (int i1 = 0; i1 < count; i1++) // i1 is the first point of the line segment
             {
-                const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1; // i2 is the second point of the line segment
                 const unsigned int idx2 = ((i1 + 1) == points_count) ? _VtxCurrentIdx : (idx1 + (use_texture ? 2 : 3)); // Vertex index for end of segment
 
-                // Average normals
-                float dm_x = (temp_normals[i1].x + temp_normals[i2].x) * 0.5f;
-                float dm_y = (temp_normals[i1].y + temp_normals[i2].y) * 0.5f;
-                IM_FIXNORMAL2F(dm_x, dm_y);
-                dm_x *= half_draw_size; // dm_x, dm_y are offset to the outer edge of the AA area
-                dm_y *= half_draw_size;
-
-                // Add temporary vertexes for the outer edges
-                ImVec2* out_vtx = &temp_points[i2 * 2];
-                out_vtx[0].x = points[i2].x + dm_x;
-                out_vtx[0].y = points[i2].y + dm_y;
-                out_vtx[1].x = points[i2].x - dm_x;
-                out_vtx[1].y = points[i2].y - dm_y;
-
                 if (use_texture)
                 {
                     // Add indices for two triangles
@@ -907,49 +1318,28 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
             // [PATH 2] Non texture-based lines (thick): we need to draw the solid line core and thus require four vertices per point
             const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
 
-            // If line is not closed, the first and last points need to be generated differently as there are no normals to blend
-            if (!closed)
+            // Add temporary vertices, as above
+            // If line is not closed, the first point needs to be generated differently as there are no normals to blend
+            tess.EdgePoints4(points + 1, temp_normals, temp_normals + 1, points_last, half_inner_thickness + AA_SIZE, half_inner_thickness, temp_points + 4);
+            if (closed)
+            {
+                tess.EdgePoints4(points, temp_normals + points_last, temp_normals, 1, half_inner_thickness + AA_SIZE, half_inner_thickness, temp_points);
+            }
+            else
             {
-                const int points_last = points_count - 1;
                 temp_points[0] = points[0] + temp_normals[0] * (half_inner_thickness + AA_SIZE);
                 temp_points[1] = points[0] + temp_normals[0] * (half_inner_thickness);
                 temp_points[2] = points[0] - temp_normals[0] * (half_inner_thickness);
                 temp_points[3] = points[0] - temp_normals[0] * (half_inner_thickness + AA_SIZE);
-                temp_points[points_last * 4 + 0] = points[points_last] + temp_normals[points_last] * (half_inner_thickness + AA_SIZE);
-                temp_points[points_last * 4 + 1] = points[points_last] + temp_normals[points_last] * (half_inner_thickness);
-                temp_points[points_last * 4 + 2] = points[points_last] - temp_normals[points_last] * (half_inner_thickness);
-                temp_points[points_last * 4 + 3] = points[points_last] - temp_normals[points_last] * (half_inner_thickness + AA_SIZE);
             }
 
-            // Generate the indices to form a number of triangles for each line segment, and the vertices for the line edges
-            // This takes points n and n+1 and writes into n+1, with the first point in a closed line being generated from the final one (as n+1 wraps)
+            // Generate the indices to form a number of triangles for each line segment
             // FIXME-OPT: Merge the different loops, possibly remove the temporary buffer.
             unsigned int idx1 = _VtxCurrentIdx; // Vertex index for start of line segment
             for (int i1 = 0; i1 < count; i1++) // i1 is the first point of the line segment
             {
-                const int i2 = (i1 + 1) == points_count ? 0 : (i1 + 1); // i2 is the second point of the line segment
                 const unsigned int idx2 = (i1 + 1) == points_count ? _VtxCurrentIdx : (idx1 + 4); // Vertex index for end of segment
 
-                // Average normals
-                float dm_x = (temp_normals[i1].x + temp_normals[i2].x) * 0.5f;
-                float dm_y = (temp_normals[i1].y + temp_normals[i2].y) * 0.5f;
-                IM_FIXNORMAL2F(dm_x, dm_y);
-                float dm_out_x = dm_x * (half_inner_thickness + AA_SIZE);
-                float dm_out_y = dm_y * (half_inner_thickness + AA_SIZE);
-                float dm_in_x = dm_x * half_inner_thickness;
-                float dm_in_y = dm_y * half_inner_thickness;
-
-                // Add temporary vertices
-                ImVec2* out_vtx = &temp_points[i2 * 4];
-                out_vtx[0].x = points[i2].x + dm_out_x;
-                out_vtx[0].y = points[i2].y + dm_out_y;
-                out_vtx[1].x = points[i2].x + dm_in_x;
-                out_vtx[1].y = points[i2].y + dm_in_y;
-                out_vtx[2].x = points[i2].x - dm_in_x;
-                out_vtx[2].y = points[i2].y - dm_in_y;
-                out_vtx[3].x = points[i2].x - dm_out_x;
-                out_vtx[3].y = points[i2].y - dm_out_y;
-
                 // Add indexes
                 _IdxWritePtr[0]  = (ImDrawIdx)(idx2 + 1); _IdxWritePtr[1]  = (ImDrawIdx)(idx1 + 1); _IdxWritePtr[2]  = (ImDrawIdx)(idx1 + 2);
                 _IdxWritePtr[3]  = (ImDrawIdx)(idx1 + 2); _IdxWritePtr[4]  = (ImDrawIdx)(idx2 + 2); _IdxWritePtr[5]  = (ImDrawIdx)(idx2 + 1);
@@ -981,22 +1371,27 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         const int vtx_count = count * 4;    // FIXME-OPT: Not sharing edges
         PrimReserve(idx_count, vtx_count);
 
+        // Calculate normals for each line segment, (dy, -dx) of the normalized direction
+        const ImDrawTessFuncs& tess = ImDrawTessGetFuncs();
+        _Data->TempBuffer.reserve_discard(count);
+        ImVec2* temp_normals = _Data->TempBuffer.Data;
+        tess.SegmentNormals(points, points + 1, points_count - 1, temp_normals);
+        if (closed)
+            tess.SegmentNormals(points + points_count - 1, points, 1, temp_normals + points_count - 1);
+
         for (int i1 = 0; i1 < count; i1++)
         {
             const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
             const ImVec2& p1 = points[i1];
             const ImVec2& p2 = points[i2];
 
-            float dx = p2.x - p1.x;
-            float dy = p2.y - p1.y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            dx *= (thickness * 0.5f);
-            dy *= (thickness * 0.5f);
+            const float nx = temp_normals[i1].x * (thickness * 0.5f);
+            const float ny = temp_normals[i1].y * (thickness * 0.5f);
 
-            _VtxWritePtr[0].pos.x = p1.x + dy; _VtxWritePtr[0].pos.y = p1.y - dx; _VtxWritePtr[0].uv = opaque_uv; _VtxWritePtr[0].col = col;
-            _VtxWritePtr[1].pos.x = p2.x + dy; _VtxWritePtr[1].pos.y = p2.y - dx; _VtxWritePtr[1].uv = opaque_uv; _VtxWritePtr[1].col = col;
-            _VtxWritePtr[2].pos.x = p2.x - dy; _VtxWritePtr[2].pos.y = p2.y + dx; _VtxWritePtr[2].uv = opaque_uv; _VtxWritePtr[2].col = col;
-            _VtxWritePtr[3].pos.x = p1.x - dy; _VtxWritePtr[3].pos.y = p1.y + dx; _VtxWritePtr[3].uv = opaque_uv; _VtxWritePtr[3].col = col;
+            _VtxWritePtr[0].pos.x = p1.x + nx; _VtxWritePtr[0].pos.y = p1.y + ny; _VtxWritePtr[0].uv = opaque_uv; _VtxWritePtr[0].col = col;
+            _VtxWritePtr[1].pos.x = p2.x + nx; _VtxWritePtr[1].pos.y = p2.y + ny; _VtxWritePtr[1].uv = opaque_uv; _VtxWritePtr[1].col = col;
+            _VtxWritePtr[2].pos.x = p2.x - nx; _VtxWritePtr[2].pos.y = p2.y - ny; _VtxWritePtr[2].uv = opaque_uv; _VtxWritePtr[2].col = col;
+            _VtxWritePtr[3].pos.x = p1.x - nx; _VtxWritePtr[3].pos.y = p1.y - ny; _VtxWritePtr[3].uv = opaque_uv; _VtxWritePtr[3].col = col;
             _VtxWritePtr += 4;
 
             _IdxWritePtr[0] = (ImDrawIdx)(_VtxCurrentIdx); _IdxWritePtr[1] = (ImDrawIdx)(_VtxCurrentIdx + 1); _IdxWritePtr[2] = (ImDrawIdx)(_VtxCurrentIdx + 2);
@@ -1034,34 +1429,22 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
             _IdxWritePtr += 3;
         }
 
-        // Compute normals
-        _Data->TempBuffer.reserve_discard(points_count);
+        // Compute normals, then the outer and inner edge points from the averaged normals either side of each point
+        const ImDrawTessFuncs& tess = ImDrawTessGetFuncs();
+        const int points_last = points_count - 1;
+        _Data->TempBuffer.reserve_discard(points_count * 3);
         ImVec2* temp_normals = _Data->TempBuffer.Data;
-        for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
-        {
-            const ImVec2& p0 = points[i0];
-            const ImVec2& p1 = points[i1];
-            float dx = p1.x - p0.x;
-            float dy = p1.y - p0.y;
-            IM_NORMALIZE2F_OVER_ZERO(dx, dy);
-            temp_normals[i0].x = dy;
-            temp_normals[i0].y = -dx;
-        }
+        ImVec2* temp_points = temp_normals + points_count;
+        tess.SegmentNormals(points, points + 1, points_last, temp_normals);
+        tess.SegmentNormals(points + points_last, points, 1, temp_normals + points_last);
+        tess.EdgePoints2(points + 1, temp_normals, temp_normals + 1, points_last, AA_SIZE * 0.5f, temp_points + 2);
+        tess.EdgePoints2(points, temp_normals + points_last, temp_normals, 1, AA_SIZE * 0.5f, temp_points);
 
         for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
         {
-            // Average normals
-            const ImVec2& n0 = temp_normals[i0];
-            const ImVec2& n1 = temp_normals[i1];
-            float dm_x = (n0.x + n1.x) * 0.5f;
-            float dm_y = (n0.y + n1.y) * 0.5f;
-            IM_FIXNORMAL2F(dm_x, dm_y);
-            dm_x *= AA_SIZE * 0.5f;
-            dm_y *= AA_SIZE * 0.5f;
-
             // Add vertices
-            _VtxWritePtr[0].pos.x = (points[i1].x - dm_x); _VtxWritePtr[0].pos.y = (points[i1].y - dm_y); _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
-            _VtxWritePtr[1].pos.x = (points[i1].x + dm_x); _VtxWritePtr[1].pos.y = (points[i1].y + dm_y); _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
+            _VtxWritePtr[0].pos = temp_points[i1 * 2 + 1]; _VtxWritePtr[0].uv = uv; _VtxWritePtr[0].col = col;        // Inner
+            _VtxWritePtr[1].pos = temp_points[i1 * 2 + 0]; _VtxWritePtr[1].uv = uv; _VtxWritePtr[1].col = col_trans;  // Outer
             _VtxWritePtr += 2;
 
             // Add indexes for fringes
@@ -2790,6 +3173,51 @@ struct ImFontBuildDstData
     ImBitVector         GlyphsSet;          // This is used to resolve collision when multiple sources are merged into a same destination font.
 };
 
+// A slice of one source font's glyphs, rasterized by ImFontAtlasBuildRasterizeJob() on whichever thread runs it.
+struct ImFontBuildRasterJob
+{
+    ImFontAtlas*                Atlas;
+    const stbtt_pack_context*   PackContext;
+    ImFontBuildSrcData*         Src;
+    int                         SrcIndex;           // Index into atlas->ConfigData[] and src_tmp_array[]
+    int                         GlyphsStart;        // First glyph, index into Src->GlyphsList
+    int                         GlyphsCount;
+    double                      TimeMs;
+};
+
+// Every glyph has its own rectangle in the texture and its own packed char, so slices don't share any output.
+// The pack context and font info are copied: stbtt_PackFontRangesRenderIntoRects() writes to the former and the latter carries the allocator user data.
+static void ImFontAtlasBuildRasterizeJob(void* job_data, int job_index)
+{
+    ImFontBuildRasterJob& job = ((ImFontBuildRasterJob*)job_data)[job_index];
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ImFontBuildSrcData& src_tmp = *job.Src;
+    stbtt_pack_context spc = *job.PackContext;
+    stbtt_fontinfo font_info = src_tmp.FontInfo;
+    font_info.userdata = &job;
+    stbtt_pack_range range = src_tmp.PackRange;
+    range.array_of_unicode_codepoints = src_tmp.GlyphsList.Data + job.GlyphsStart;
+    range.num_chars = job.GlyphsCount;
+    range.chardata_for_range = src_tmp.PackedChars + job.GlyphsStart;
+    stbrp_rect* rects = src_tmp.Rects + job.GlyphsStart;
+    stbtt_PackFontRangesRenderIntoRects(&spc, &font_info, &range, 1, rects);
+
+    // Apply multiply operator
+    const ImFontConfig& cfg = job.Atlas->ConfigData[job.SrcIndex];
+    if (cfg.RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        stbrp_rect* r = rects;
+        for (int glyph_i = 0; glyph_i < job.GlyphsCount; glyph_i++, r++)
+            if (r->was_packed)
+                ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, job.Atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, job.Atlas->TexWidth * 1);
+    }
+
+    job.TimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>* out)
 {
     IM_ASSERT(sizeof(in->Storage.Data[0]) == sizeof(int));
@@ -2995,27 +3423,28 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.height = atlas->TexHeight;
 
     // 8. Render/rasterize font characters into the texture
+    // Sources are split in slices of glyphs which atlas->ParallelFor may run on other threads. The output doesn't depend on the order they run in.
+    const int GLYPHS_PER_JOB = 32;
+    ImVector<ImFontBuildRasterJob> raster_jobs;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
     {
-        ImFontConfig& cfg = atlas->ConfigData[src_i];
         ImFontBuildSrcData& src_tmp = src_tmp_array[src_i];
-        if (src_tmp.GlyphsCount == 0)
-            continue;
-
-        stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &src_tmp.PackRange, 1, src_tmp.Rects);
-
-        // Apply multiply operator
-        if (cfg.RasterizerMultiply != 1.0f)
+        atlas->ConfigData[src_i].BuildTimeMs = 0.0f;
+        for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i += GLYPHS_PER_JOB)
         {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            stbrp_rect* r = &src_tmp.Rects[0];
-            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++, r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
+            ImFontBuildRasterJob job = { atlas, &spc, &src_tmp, src_i, glyph_i, ImMin(GLYPHS_PER_JOB, src_tmp.GlyphsCount - glyph_i), 0.0 };
+            raster_jobs.push_back(job);
         }
-        src_tmp.Rects = NULL;
     }
+    if (atlas->ParallelFor != NULL && raster_jobs.Size > 1)
+        atlas->ParallelFor(atlas->ParallelForUserData, raster_jobs.Size, ImFontAtlasBuildRasterizeJob, raster_jobs.Data);
+    else
+        for (int job_i = 0; job_i < raster_jobs.Size; job_i++)
+            ImFontAtlasBuildRasterizeJob(raster_jobs.Data, job_i);
+    for (int job_i = 0; job_i < raster_jobs.Size; job_i++)
+        atlas->ConfigData[raster_jobs[job_i].SrcIndex].BuildTimeMs += (float)raster_jobs[job_i].TimeMs;
+    for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
+        src_tmp_array[src_i].Rects = NULL;
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -3959,6 +4388,41 @@ const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const c
     return s;
 }
 
+// Returns the end of the run of printable ASCII (0x20..0x7F) starting at text: characters which need no UTF-8 decoding
+// and aren't '\n' or '\r'. A signed compare against 0x20 catches both control characters and UTF-8 lead/trail bytes.
+static inline const char* ImTextFindPrintableAsciiEnd(const char* text, const char* text_end)
+{
+#if defined(IMGUI_ENABLE_SSE)
+    const __m128i space = _mm_set1_epi8(0x20);
+    while (text_end - text >= 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128((const __m128i*)(const void*)text), space));
+        if (mask != 0)
+        {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, (unsigned long)mask);
+            return text + bit;
+#else
+            return text + __builtin_ctz((unsigned int)mask);
+#endif
+        }
+        text += 16;
+    }
+#elif defined(IMGUI_ENABLE_NEON)
+    const int8x16_t space = vdupq_n_s8(0x20);
+    while (text_end - text >= 16)
+    {
+        if (vmaxvq_u8(vcltq_s8(vld1q_s8((const int8_t*)text), space)) != 0)
+            break;
+        text += 16;
+    }
+#endif
+    while (text < text_end && (unsigned int)(unsigned char)*text - 0x20 < 0x60)
+        text++;
+    return text;
+}
+
 ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, const char* text_begin, const char* text_end, const char** remaining) const
 {
     if (!text_end)
@@ -3994,6 +4458,27 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
             }
         }
 
+        // Printable ASCII runs need no decoding and no newline checks
+        if ((unsigned int)(unsigned char)*s - 0x20 < 0x60)
+        {
+            const char* run_end = ImTextFindPrintableAsciiEnd(s, word_wrap_enabled ? word_wrap_eol : text_end);
+            bool reached_max_width = false;
+            for (; s < run_end; s++)
+            {
+                const int c = (unsigned char)*s;
+                const float char_width = (c < IndexAdvanceX.Size ? IndexAdvanceX.Data[c] : FallbackAdvanceX) * scale;
+                if (line_width + char_width >= max_width)
+                {
+                    reached_max_width = true;
+                    break;
+                }
+                line_width += char_width;
+            }
+            if (reached_max_width)
+                break;
+            continue;
+        }
+
         // Decode and advance source
         const char* prev_s = s;
         unsigned int c = (unsigned int)*s;
@@ -4052,6 +4537,124 @@ void ImFont::RenderChar(ImDrawList* draw_list, float size, const ImVec2& pos, Im
     draw_list->PrimRectUV(ImVec2(x + glyph->X0 * scale, y + glyph->Y0 * scale), ImVec2(x + glyph->X1 * scale, y + glyph->Y1 * scale), ImVec2(glyph->U0, glyph->V0), ImVec2(glyph->U1, glyph->V1), col);
 }
 
+#if defined(IMGUI_ENABLE_SSE) && !defined(IMGUI_OVERRIDE_DRAWVERT_STRUCT_LAYOUT)
+#define IMGUI_ENABLE_SSE_TEXT
+
+// Renders a run of printable ASCII for ImFont::RenderText(), with exactly the same output as its per-character loop.
+// Needs no decoding or newline checks, computes the 4 corners of a glyph at once and writes each quad's vertices
+// with 5 stores and its indices with 2.
+static void ImFontRenderAsciiRun(const ImFont* font, const char* s, const char* s_end, float scale, float& inout_x, float y, ImU32 col, const ImVec4& clip_rect, bool cpu_fine_clip, ImDrawVert*& inout_vtx_write, ImDrawIdx*& inout_idx_write, unsigned int& inout_vtx_index)
+{
+    // Work on locals, the float stores below could otherwise alias the references
+    float x = inout_x;
+    ImDrawVert* vtx_write = inout_vtx_write;
+    ImDrawIdx* idx_write = inout_idx_write;
+    unsigned int vtx_index = inout_vtx_index;
+
+    const ImWchar* index_lookup = font->IndexLookup.Data;
+    const unsigned int index_lookup_size = (unsigned int)font->IndexLookup.Size;
+    const __m128 scale4 = _mm_set1_ps(scale);
+    const __m128 negate_x2 = _mm_setr_ps(0.0f, 0.0f, -0.0f, 0.0f);
+    const __m128 clip_test = _mm_setr_ps(clip_rect.z, FLT_MAX, -clip_rect.x, FLT_MAX); // x1 <= clip_rect.z && -x2 <= -clip_rect.x
+    const __m128 col4 = _mm_castsi128_ps(_mm_set1_epi32((int)col));
+    const __m128 col4_untinted = _mm_castsi128_ps(_mm_set1_epi32((int)(col | ~IM_COL32_A_MASK)));
+    const __m128i idx_pattern = _mm_setr_epi16(0, 1, 2, 0, 2, 3, 0, 0);
+
+    for (; s < s_end; s++)
+    {
+        // Same as FindGlyph(), inlined
+        const unsigned int c = (unsigned char)*s;
+        const ImFontGlyph* glyph = (c < index_lookup_size && index_lookup[c] != (ImWchar)-1) ? &font->Glyphs.Data[index_lookup[c]] : font->FallbackGlyph;
+        if (glyph == NULL)
+            continue;
+
+        const float glyph_x = x;
+        x += glyph->AdvanceX * scale;
+        if (!glyph->Visible)
+            continue;
+
+        // (x1, y1, x2, y2) and (u1, v1, u2, v2)
+        __m128 pos = _mm_add_ps(_mm_setr_ps(glyph_x, y, glyph_x, y), _mm_mul_ps(_mm_loadu_ps(&glyph->X0), scale4));
+        if ((_mm_movemask_ps(_mm_cmple_ps(_mm_xor_ps(pos, negate_x2), clip_test)) & 5) != 5)
+            continue;
+        __m128 uv = _mm_loadu_ps(&glyph->U0);
+
+        // CPU side clipping used to fit text in their frame when the frame is too small. Only does clipping for axis aligned quads.
+        if (cpu_fine_clip)
+        {
+            float p[4], t[4];
+            _mm_storeu_ps(p, pos);
+            _mm_storeu_ps(t, uv);
+            float& x1 = p[0]; float& y1 = p[1]; float& x2 = p[2]; float& y2 = p[3];
+            float& u1 = t[0]; float& v1 = t[1]; float& u2 = t[2]; float& v2 = t[3];
+            if (x1 < clip_rect.x)
+            {
+                u1 = u1 + (1.0f - (x2 - clip_rect.x) / (x2 - x1)) * (u2 - u1);
+                x1 = clip_rect.x;
+            }
+            if (y1 < clip_rect.y)
+            {
+                v1 = v1 + (1.0f - (y2 - clip_rect.y) / (y2 - y1)) * (v2 - v1);
+                y1 = clip_rect.y;
+            }
+            if (x2 > clip_rect.z)
+            {
+                u2 = u1 + ((clip_rect.z - x1) / (x2 - x1)) * (u2 - u1);
+                x2 = clip_rect.z;
+            }
+            if (y2 > clip_rect.w)
+            {
+                v2 = v1 + ((clip_rect.w - y1) / (y2 - y1)) * (v2 - v1);
+                y2 = clip_rect.w;
+            }
+            if (y1 >= y2)
+                continue;
+            pos = _mm_loadu_ps(p);
+            uv = _mm_loadu_ps(t);
+        }
+
+        // Support for untinted glyphs
+        const __m128 glyph_col = glyph->Colored ? col4_untinted : col4;
+
+        // Vertices 0..3 are (x1,y1,u1,v1), (x2,y1,u2,v1), (x2,y2,u2,v2), (x1,y2,u1,v2), each followed by the color
+        const __m128 c_x2 = _mm_shuffle_ps(glyph_col, pos, _MM_SHUFFLE(2, 2, 0, 0));    // c  c  x2 x2
+        const __m128 y1_u2 = _mm_shuffle_ps(pos, uv, _MM_SHUFFLE(2, 2, 1, 1));          // y1 y1 u2 u2
+        const __m128 v1_c = _mm_shuffle_ps(uv, glyph_col, _MM_SHUFFLE(0, 0, 1, 1));     // v1 v1 c  c
+        const __m128 c_x1 = _mm_shuffle_ps(glyph_col, pos, _MM_SHUFFLE(0, 0, 0, 0));    // c  c  x1 x1
+        const __m128 y2_u1 = _mm_shuffle_ps(pos, uv, _MM_SHUFFLE(0, 0, 3, 3));          // y2 y2 u1 u1
+        const __m128 v2_c = _mm_shuffle_ps(uv, glyph_col, _MM_SHUFFLE(0, 0, 3, 3));     // v2 v2 c  c
+        float* out = &vtx_write[0].pos.x;
+        _mm_storeu_ps(out + 0, _mm_movelh_ps(pos, uv));                                 // x1 y1 u1 v1
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(c_x2, y1_u2, _MM_SHUFFLE(2, 0, 2, 0)));   // c  x2 y1 u2
+        _mm_storeu_ps(out + 8, _mm_shuffle_ps(v1_c, pos, _MM_SHUFFLE(3, 2, 2, 0)));     // v1 c  x2 y2
+        _mm_storeu_ps(out + 12, _mm_shuffle_ps(uv, c_x1, _MM_SHUFFLE(2, 0, 3, 2)));     // u2 v2 c  x1
+        _mm_storeu_ps(out + 16, _mm_shuffle_ps(y2_u1, v2_c, _MM_SHUFFLE(2, 0, 2, 0)));  // y2 u1 v2 c
+        vtx_write += 4;
+
+        if (sizeof(ImDrawIdx) == 2)
+        {
+            const __m128i idx = _mm_add_epi16(_mm_set1_epi16((short)vtx_index), idx_pattern);
+            _mm_storel_epi64((__m128i*)(void*)idx_write, idx);
+            const int idx_45 = _mm_cvtsi128_si32(_mm_srli_si128(idx, 8));
+            memcpy(idx_write + 4, &idx_45, sizeof(idx_45));     // Only 2 bytes aligned
+        }
+        else
+        {
+            idx_write[0] = (ImDrawIdx)(vtx_index); idx_write[1] = (ImDrawIdx)(vtx_index + 1); idx_write[2] = (ImDrawIdx)(vtx_index + 2);
+            idx_write[3] = (ImDrawIdx)(vtx_index); idx_write[4] = (ImDrawIdx)(vtx_index + 2); idx_write[5] = (ImDrawIdx)(vtx_index + 3);
+        }
+        idx_write += 6;
+        vtx_index += 4;
+    }
+
+    inout_x = x;
+    inout_vtx_write = vtx_write;
+    inout_idx_write = idx_write;
+    inout_vtx_index = vtx_index;
+}
+
+#endif // #if defined(IMGUI_ENABLE_SSE) && !defined(IMGUI_OVERRIDE_DRAWVERT_STRUCT_LAYOUT)
+
 // Note: as with every ImDrawList drawing function, this expects that the font atlas texture is bound.
 void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, float wrap_width, bool cpu_fine_clip) const
 {
@@ -4139,6 +4742,17 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
             }
         }
 
+#ifdef IMGUI_ENABLE_SSE_TEXT
+        // Printable ASCII runs are rendered in batches
+        if ((unsigned int)(unsigned char)*s - 0x20 < 0x60)
+        {
+            const char* run_end = ImTextFindPrintableAsciiEnd(s, word_wrap_enabled ? word_wrap_eol : text_end);
+            ImFontRenderAsciiRun(this, s, run_end, scale, x, y, col, clip_rect, cpu_fine_clip, vtx_write, idx_write, vtx_index);
+            s = run_end;
+            continue;
+        }
+#endif
+
         // Decode and advance source
         unsigned int c = (unsigned int)*s;
         if (c < 0x80)
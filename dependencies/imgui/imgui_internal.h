@@ -499,6 +499,14 @@ IMGUI_API void       ImTriangleBarycentricCoords(const ImVec2& a, const ImVec2&
 inline float         ImTriangleArea(const ImVec2& a, const ImVec2& b, const ImVec2& c)          { return ImFabs((a.x * (b.y - c.y)) + (b.x * (c.y - a.y)) + (c.x * (a.y - b.y))) * 0.5f; }
 inline bool          ImTriangleIsClockwise(const ImVec2& a, const ImVec2& b, const ImVec2& c)   { return ((b.x - a.x) * (c.y - b.y)) - ((c.x - b.x) * (b.y - a.y)) > 0.0f; }
 
+// Helpers: SIMD tessellation for ImDrawList::AddPolyline() and ImDrawList::AddConvexPolyFilled()
+// Every level produces identical vertices. The best one the CPU supports is picked on first use.
+typedef int ImDrawSimd;
+enum ImDrawSimd_ { ImDrawSimd_Scalar, ImDrawSimd_SSE2, ImDrawSimd_AVX2, ImDrawSimd_NEON, ImDrawSimd_COUNT };
+IMGUI_API bool       ImDrawSimdIsSupported(ImDrawSimd simd);
+IMGUI_API ImDrawSimd ImDrawSimdGetCurrent();
+IMGUI_API void       ImDrawSimdSetCurrent(ImDrawSimd simd);                                      // Ignored if unsupported. For comparing levels in benchmarks and tests.
+
 // Helper: ImVec1 (1D vector)
 // (this odd construct is used to facilitate the transition between 1D and 2D, and the maintenance of some branches/patches)
 IM_MSVC_RUNTIME_CHECKS_OFF
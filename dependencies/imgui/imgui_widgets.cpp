@@ -8011,6 +8011,9 @@ void ImGuiSelectionBasicStorage::Clear()
     Size = 0;
     _SelectionOrder = 1; // Always >0
     _Storage.Data.resize(0);
+#ifdef IMGUI_USE_HASHED_STORAGE
+    _Storage.Slots.resize(0);
+#endif
 }
 
 void ImGuiSelectionBasicStorage::Swap(ImGuiSelectionBasicStorage& r)
@@ -8018,6 +8021,9 @@ void ImGuiSelectionBasicStorage::Swap(ImGuiSelectionBasicStorage& r)
     ImSwap(Size, r.Size);
     ImSwap(_SelectionOrder, r._SelectionOrder);
     _Storage.Data.swap(r._Storage.Data);
+#ifdef IMGUI_USE_HASHED_STORAGE
+    _Storage.Slots.swap(r._Storage.Slots);
+#endif
 }
 
 bool ImGuiSelectionBasicStorage::Contains(ImGuiID id) const
@@ -8065,6 +8071,14 @@ void ImGuiSelectionBasicStorage::SetItemSelected(ImGuiID id, bool selected)
 static void ImGuiSelectionBasicStorage_BatchSetItemSelected(ImGuiSelectionBasicStorage* selection, ImGuiID id, bool selected, int size_before_amends, int selection_order)
 {
     ImGuiStorage* storage = &selection->_Storage;
+#ifdef IMGUI_USE_HASHED_STORAGE
+    // Data isn't sorted, but inserting through the storage is cheap anyway.
+    IM_UNUSED(size_before_amends);
+    if (selected == (storage->GetInt(id, 0) != 0))
+        return;
+    storage->SetInt(id, selected ? selection_order : 0);
+    selection->Size += selected ? +1 : -1;
+#else
     ImGuiStoragePair* it = ImLowerBound(storage->Data.Data, storage->Data.Data + size_before_amends, id);
     const bool is_contained = (it != storage->Data.Data + size_before_amends) && (it->key == id);
     if (selected == (is_contained && it->val_i != 0))
@@ -8074,6 +8088,7 @@ static void ImGuiSelectionBasicStorage_BatchSetItemSelected(ImGuiSelectionBasicS
     else if (is_contained)
         it->val_i = selected ? selection_order : 0; // Modify in-place.
     selection->Size += selected ? +1 : -1;
+#endif
 }
 
 static void ImGuiSelectionBasicStorage_BatchFinish(ImGuiSelectionBasicStorage* selection, bool selected, int size_before_amends)
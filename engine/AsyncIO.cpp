@@ -0,0 +1,757 @@
+#include "AsyncIO.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+#include "JobSystem.h"
+#include "Lz.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+static constexpr intptr_t INVALID_FILE = -1;
+
+struct AsyncIO::Request
+{
+    IoPriority priority = IoPriority::Normal;
+
+    std::string path;
+    const VirtualFileSystem* vfs = nullptr;
+
+    uint64_t offset = 0;
+    uint64_t size = 0;          // once decompressed
+    uint8_t* dst = nullptr;     // null to read the whole file into file.storage
+    bool checkSize = false;     // VFS reads into dst must match its size exactly
+
+    IoCallback callback;
+    IoFileCallback fileCallback;
+
+    // Filled in by prepare().
+    intptr_t handle = INVALID_FILE;
+    bool ownsHandle = false;
+    bool compressed = false;
+    uint64_t storedSize = 0;
+    uint8_t* target = nullptr;  // where the stored bytes go
+    std::vector<uint8_t> stored;
+    VfsFile file;
+
+    uint32_t remainingReads = 0;
+    bool failed = false;
+};
+
+#ifdef _WIN32
+
+static intptr_t OpenForRead(const char* path)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return file == INVALID_HANDLE_VALUE ? INVALID_FILE : reinterpret_cast<intptr_t>(file);
+}
+
+static void CloseFile(intptr_t file)
+{
+    CloseHandle(reinterpret_cast<HANDLE>(file));
+}
+
+// Positional reads through OVERLAPPED leave the handle's file pointer alone, so any number of
+// threads can read the same handle.
+static bool ReadAt(intptr_t file, uint64_t offset, uint8_t* dst, uint64_t size)
+{
+    while (size > 0)
+    {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD chunk = static_cast<DWORD>(std::min<uint64_t>(size, 1u << 30));
+        DWORD read = 0;
+
+        if (!ReadFile(reinterpret_cast<HANDLE>(file), dst, chunk, &read, &overlapped) || read == 0)
+            return false;
+
+        offset += read;
+        dst += read;
+        size -= read;
+    }
+
+    return true;
+}
+
+#else
+
+static intptr_t OpenForRead(const char* path)
+{
+    int file = open(path, O_RDONLY | O_CLOEXEC);
+    return file < 0 ? INVALID_FILE : file;
+}
+
+static void CloseFile(intptr_t file)
+{
+    close(static_cast<int>(file));
+}
+
+static bool ReadAt(intptr_t file, uint64_t offset, uint8_t* dst, uint64_t size)
+{
+    while (size > 0)
+    {
+        ssize_t read = pread(static_cast<int>(file), dst, std::min<uint64_t>(size, 1u << 30), static_cast<off_t>(offset));
+
+        if (read < 0 && errno == EINTR)
+            continue;
+
+        if (read <= 0)
+            return false;
+
+        offset += read;
+        dst += read;
+        size -= read;
+    }
+
+    return true;
+}
+
+#endif
+
+#ifdef __linux__
+
+// The ring set up through the raw system calls, which saves a dependency on liburing for the
+// handful of operations used here.
+struct AsyncIO::Ring
+{
+    // A piece of a request no bigger than maxReadSize.
+    struct Read
+    {
+        Request* request;
+        uint64_t offset;
+        uint8_t* dst;
+        uint32_t size;
+    };
+
+    int fd = -1;
+
+    void* sqMapping = nullptr;
+    size_t sqMappingSize = 0;
+    void* cqMapping = nullptr;
+    size_t cqMappingSize = 0;
+
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned cqMask = 0;
+
+    unsigned entries = 0;
+
+    ~Ring()
+    {
+        if (sqes)
+            munmap(sqes, sqesSize);
+
+        if (cqMapping && cqMapping != sqMapping)
+            munmap(cqMapping, cqMappingSize);
+
+        if (sqMapping)
+            munmap(sqMapping, sqMappingSize);
+
+        if (fd >= 0)
+            close(fd);
+    }
+
+    bool init(unsigned depth)
+    {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+
+        // IORING_OP_READ arrived in the same kernel as this feature flag.
+        if (fd < 0 || !(params.features & IORING_FEAT_RW_CUR_POS))
+            return false;
+
+        sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+        if (singleMapping)
+            sqMappingSize = cqMappingSize = std::max(sqMappingSize, cqMappingSize);
+
+        sqMapping = mmap(nullptr, sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+
+        if (sqMapping == MAP_FAILED)
+        {
+            sqMapping = nullptr;
+            return false;
+        }
+
+        cqMapping = singleMapping ? sqMapping : mmap(nullptr, cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+        if (cqMapping == MAP_FAILED)
+        {
+            cqMapping = nullptr;
+            return false;
+        }
+
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMapping = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+        if (sqeMapping == MAP_FAILED)
+            return false;
+
+        auto sq = static_cast<uint8_t*>(sqMapping);
+        auto cq = static_cast<uint8_t*>(cqMapping);
+
+        sqes = static_cast<io_uring_sqe*>(sqeMapping);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+
+        entries = params.sq_entries;
+        return true;
+    }
+
+    // Only the ring thread touches the tail, the kernel only reads it.
+    void pushRead(const Read* read)
+    {
+        unsigned tail = *sqTail;
+        unsigned index = tail & sqMask;
+
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = static_cast<int>(read->request->handle);
+        sqe.off = read->offset;
+        sqe.addr = reinterpret_cast<uint64_t>(read->dst);
+        sqe.len = read->size;
+        sqe.user_data = reinterpret_cast<uint64_t>(read);
+
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Pushed but not yet consumed by the kernel, which moves the head as it takes them.
+    unsigned getUnsubmitted() const
+    {
+        return *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    }
+
+    int enter(unsigned submitCount, unsigned waitCount)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, submitCount, waitCount, waitCount > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+    }
+};
+
+#else
+
+struct AsyncIO::Ring
+{
+};
+
+#endif
+
+AsyncIO::AsyncIO(JobSystem* jobs, const AsyncIOSettings& settings)
+    : jobs(jobs), settings(settings)
+{
+    this->settings.maxReadSize = std::max(this->settings.maxReadSize, 4096u);
+
+#ifdef __linux__
+    if (!settings.forceThreadPool)
+    {
+        ring = std::make_unique<Ring>();
+
+        if (ring->init(std::max(settings.queueDepth, 1u)))
+        {
+            backend = IoBackend::IoUring;
+            threads.emplace_back(&AsyncIO::ringLoop, this);
+            return;
+        }
+
+        ring.reset();
+    }
+#endif
+
+    for (uint32_t i = 0; i < std::max(settings.threadCount, 1u); i++)
+        threads.emplace_back(&AsyncIO::workerLoop, this);
+}
+
+AsyncIO::~AsyncIO()
+{
+    waitIdle();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wakeCondition.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& handle : handles)
+        CloseFile(handle.second);
+}
+
+void AsyncIO::read(const char* path, uint64_t offset, uint64_t size, void* dst, IoPriority priority, IoCallback callback)
+{
+    auto request = std::make_unique<Request>();
+    request->priority = priority;
+    request->path = path;
+    request->offset = offset;
+    request->size = size;
+    request->dst = static_cast<uint8_t*>(dst);
+    request->callback = std::move(callback);
+
+    enqueue(std::move(request));
+}
+
+void AsyncIO::read(const VirtualFileSystem& vfs, const char* path, void* dst, uint64_t size, IoPriority priority, IoCallback callback)
+{
+    auto request = std::make_unique<Request>();
+    request->priority = priority;
+    request->path = path;
+    request->vfs = &vfs;
+    request->size = size;
+    request->dst = static_cast<uint8_t*>(dst);
+    request->checkSize = true;
+    request->callback = std::move(callback);
+
+    enqueue(std::move(request));
+}
+
+void AsyncIO::read(const VirtualFileSystem& vfs, const char* path, IoPriority priority, IoFileCallback callback)
+{
+    auto request = std::make_unique<Request>();
+    request->priority = priority;
+    request->path = path;
+    request->vfs = &vfs;
+    request->fileCallback = std::move(callback);
+
+    enqueue(std::move(request));
+}
+
+void AsyncIO::ReadAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    // Another thread's submit() can finish the read and resume the coroutine before ours, which
+    // destroys the awaiter, so nothing of it is touched after read().
+    AsyncIO& io = this->io;
+
+    io.read(vfs, path, dst, size, priority, [this, handle](const IoResult& result)
+    {
+        this->result = result;
+        handle.resume();
+    });
+
+    io.submit();
+}
+
+void AsyncIO::FileAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    AsyncIO& io = this->io;
+
+    io.read(vfs, path, priority, [this, handle](bool succeeded, VfsFile&& file)
+    {
+        if (succeeded)
+            this->file = std::move(file);
+
+        handle.resume();
+    });
+
+    io.submit();
+}
+
+void AsyncIO::enqueue(std::unique_ptr<Request> request)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    queued.push_back(std::move(request));
+}
+
+void AsyncIO::submit()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (queued.empty())
+            return;
+
+        for (auto& request : queued)
+            pending[static_cast<uint32_t>(request->priority)].push_back(std::move(request));
+
+        outstanding += static_cast<uint32_t>(queued.size());
+        queued.clear();
+    }
+
+    wakeCondition.notify_all();
+}
+
+void AsyncIO::waitIdle()
+{
+    submit();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this]() { return outstanding == 0; });
+}
+
+// Caller holds the lock.
+std::unique_ptr<AsyncIO::Request> AsyncIO::takeRequest()
+{
+    for (auto& queue : pending)
+    {
+        if (!queue.empty())
+        {
+            std::unique_ptr<Request> request = std::move(queue.front());
+            queue.pop_front();
+            return request;
+        }
+    }
+
+    return nullptr;
+}
+
+intptr_t AsyncIO::openFile(const std::string& path, bool keepOpen)
+{
+    if (!keepOpen)
+        return OpenForRead(path.c_str());
+
+    std::lock_guard<std::mutex> lock(handleMutex);
+
+    auto found = handles.find(path);
+
+    if (found != handles.end())
+        return found->second;
+
+    intptr_t handle = OpenForRead(path.c_str());
+
+    if (handle != INVALID_FILE)
+        handles.emplace(path, handle);
+
+    return handle;
+}
+
+// Resolves the request to a file and offset, opens the file and sets up where the bytes go.
+bool AsyncIO::prepare(Request& request)
+{
+    std::string filePath = request.path;
+    request.storedSize = request.size;
+    bool packed = false;
+
+    if (request.vfs)
+    {
+        VfsLocation location;
+
+        if (!request.vfs->locate(request.path.c_str(), location))
+            return false;
+
+        if (request.checkSize && location.size != request.size)
+            return false;
+
+        filePath = std::move(location.filePath);
+        request.offset = location.offset;
+        request.size = location.size;
+        request.storedSize = location.storedSize;
+        request.compressed = location.compressed;
+        packed = location.packed;
+    }
+
+    request.handle = openFile(filePath, packed);
+    request.ownsHandle = !packed;
+
+    if (request.handle == INVALID_FILE)
+        return false;
+
+    if (!request.dst)
+        request.file.storage.resize(request.size);
+
+    if (request.compressed)
+    {
+        request.stored.resize(request.storedSize);
+        request.target = request.stored.data();
+    }
+    else
+    {
+        request.target = request.dst ? request.dst : request.file.storage.data();
+    }
+
+    return true;
+}
+
+// Called once every read of the request is done, on the I/O thread.
+void AsyncIO::finish(Request* request)
+{
+    if (request->ownsHandle && request->handle != INVALID_FILE)
+        CloseFile(request->handle);
+
+    request->handle = INVALID_FILE;
+
+    if (jobs)
+        jobs->submit([this, request]() { complete(request); });
+    else
+        complete(request);
+}
+
+void AsyncIO::complete(Request* request)
+{
+    if (!request->failed && request->compressed)
+    {
+        uint8_t* dst = request->dst ? request->dst : request->file.storage.data();
+        request->failed = !LzDecompress(request->stored.data(), request->stored.size(), dst, request->size);
+    }
+
+    if (request->callback)
+    {
+        IoResult result;
+        result.succeeded = !request->failed;
+        result.size = request->failed ? 0 : request->size;
+
+        request->callback(result);
+    }
+
+    if (request->fileCallback)
+    {
+        VfsFile& file = request->file;
+
+        if (request->failed)
+        {
+            file.close();
+        }
+        else
+        {
+            // Empty files still need a non null pointer to count as open.
+            static const uint8_t empty = 0;
+
+            file.bytes = file.storage.empty() ? &empty : file.storage.data();
+            file.length = file.storage.size();
+        }
+
+        request->fileCallback(!request->failed, std::move(file));
+    }
+
+    delete request;
+
+    // Notified under the lock, waitIdle() returning may be the destructor about to free it.
+    std::lock_guard<std::mutex> lock(mutex);
+    outstanding--;
+    idleCondition.notify_all();
+}
+
+void AsyncIO::workerLoop()
+{
+    while (true)
+    {
+        std::unique_ptr<Request> request;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]() { return stopping || std::any_of(std::begin(pending), std::end(pending), [](const auto& queue) { return !queue.empty(); }); });
+
+            request = takeRequest();
+
+            if (!request)
+                return;
+        }
+
+        if (!prepare(*request))
+        {
+            request->failed = true;
+        }
+        else
+        {
+            // Piece by piece, so a stop or a burst of high priority reads waits at most one piece.
+            for (uint64_t done = 0; done < request->storedSize && !request->failed; done += settings.maxReadSize)
+            {
+                uint64_t size = std::min<uint64_t>(request->storedSize - done, settings.maxReadSize);
+                request->failed = !ReadAt(request->handle, request->offset + done, request->target + done, size);
+            }
+        }
+
+        finish(request.release());
+    }
+}
+
+void AsyncIO::ringLoop()
+{
+#ifdef __linux__
+    std::deque<Ring::Read*> waiting; // split into reads, not yet on the ring
+    std::unordered_set<Ring::Read*> reads; // waiting or on the ring
+    uint32_t inFlight = 0;
+
+    auto hasPending = [this]()
+    {
+        return std::any_of(std::begin(pending), std::end(pending), [](const auto& queue) { return !queue.empty(); });
+    };
+
+    while (true)
+    {
+        std::vector<std::unique_ptr<Request>> taken;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (inFlight == 0 && waiting.empty())
+            {
+                wakeCondition.wait(lock, [&]() { return stopping || hasPending(); });
+
+                if (!hasPending())
+                    return;
+            }
+
+            // Only take what fits, the rest stays in the priority queues where a later high
+            // priority read can still get ahead of it.
+            while (inFlight + waiting.size() + taken.size() < ring->entries)
+            {
+                std::unique_ptr<Request> request = takeRequest();
+
+                if (!request)
+                    break;
+
+                taken.push_back(std::move(request));
+            }
+        }
+
+        for (auto& owned : taken)
+        {
+            Request* request = owned.release();
+
+            if (!prepare(*request))
+            {
+                request->failed = true;
+                finish(request);
+                continue;
+            }
+
+            if (request->storedSize == 0)
+            {
+                finish(request);
+                continue;
+            }
+
+            request->remainingReads = static_cast<uint32_t>((request->storedSize + settings.maxReadSize - 1) / settings.maxReadSize);
+
+            for (uint64_t done = 0; done < request->storedSize; done += settings.maxReadSize)
+            {
+                uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(request->storedSize - done, settings.maxReadSize));
+                waiting.push_back(new Ring::Read{ request, request->offset + done, request->target + done, size });
+                reads.insert(waiting.back());
+            }
+        }
+
+        while (!waiting.empty() && inFlight < ring->entries)
+        {
+            ring->pushRead(waiting.front());
+            waiting.pop_front();
+            inFlight++;
+        }
+
+        if (inFlight == 0)
+            continue;
+
+        // Submits the batch and blocks for the first completion. New submissions are picked up
+        // once it arrives, a read's worth of latency at most.
+        int entered;
+
+        do
+        {
+            entered = ring->enter(ring->getUnsubmitted(), 1);
+        }
+        while (entered < 0 && errno == EINTR);
+
+        if (entered < 0)
+        {
+            // The ring is unusable. Fail everything on it, and serve the rest of the queue and any
+            // later reads with plain blocking reads on this thread instead.
+            fprintf(stderr, "[io] io_uring_enter failed: %s, falling back to blocking reads\n", strerror(errno));
+
+            std::unordered_set<Request*> failed;
+
+            for (Ring::Read* read : reads)
+            {
+                failed.insert(read->request);
+                delete read;
+            }
+
+            for (Request* request : failed)
+            {
+                request->failed = true;
+                finish(request);
+            }
+
+            workerLoop();
+            return;
+        }
+
+        unsigned head = *ring->cqHead;
+        unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++)
+        {
+            const io_uring_cqe& cqe = ring->cqes[head & ring->cqMask];
+            auto read = reinterpret_cast<Ring::Read*>(cqe.user_data);
+            inFlight--;
+
+            if (cqe.res == -EAGAIN || cqe.res == -EINTR)
+            {
+                waiting.push_front(read);
+                continue;
+            }
+
+            Request* request = read->request;
+
+            if (cqe.res <= 0)
+            {
+                request->failed = true;
+            }
+            else if (static_cast<uint32_t>(cqe.res) < read->size)
+            {
+                // Short read, the rest goes back on the ring.
+                read->offset += cqe.res;
+                read->dst += cqe.res;
+                read->size -= cqe.res;
+                waiting.push_front(read);
+                continue;
+            }
+
+            reads.erase(read);
+            delete read;
+
+            if (--request->remainingReads == 0)
+                finish(request);
+        }
+
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+#endif
+}
+
+const char* AsyncIO::getBackendName(IoBackend backend)
+{
+    switch (backend)
+    {
+    case IoBackend::IoUring: return "io_uring";
+    default: return "thread pool";
+    }
+}
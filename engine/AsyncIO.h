@@ -0,0 +1,173 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "VirtualFileSystem.h"
+
+class JobSystem;
+
+enum class IoPriority : uint32_t
+{
+    High,   // the player is waiting on it
+    Normal,
+    Low,    // prefetch and speculative loads
+};
+
+static constexpr uint32_t IO_PRIORITY_COUNT = 3;
+
+enum class IoBackend
+{
+    ThreadPool, // blocking positional reads on a few worker threads, works everywhere
+    IoUring,    // one thread keeping a Linux io_uring full
+};
+
+struct AsyncIOSettings
+{
+    // Reads the io_uring backend keeps in flight at once, also the size of its ring.
+    uint32_t queueDepth = 64;
+
+    // Workers of the thread pool backend.
+    uint32_t threadCount = 4;
+
+    // Larger reads are split so the device sees several requests at once and a big file can't
+    // hold up a high priority one for long.
+    uint32_t maxReadSize = 1024 * 1024;
+
+    // Use the thread pool even where io_uring is available.
+    bool forceThreadPool = false;
+};
+
+struct IoResult
+{
+    bool succeeded = false;
+    uint64_t size = 0; // bytes written to the destination
+};
+
+using IoCallback = std::function<void(const IoResult& result)>;
+using IoFileCallback = std::function<void(bool succeeded, VfsFile&& file)>;
+
+// Reads files in the background so loading never blocks on the disk. Reads queue up until
+// submit(), which hands the whole batch to the backend, and the backend always starts the highest
+// priority read waiting. Completion callbacks run on the job system when there is one, otherwise
+// on the I/O thread, and decompression of packed entries happens there too.
+//
+// On Linux the reads go through io_uring when the kernel supports it, which keeps up to
+// queueDepth reads in flight from a single thread. Everywhere else, or when io_uring can't be
+// set up, a small pool of threads does blocking reads.
+class AsyncIO
+{
+public:
+    explicit AsyncIO(JobSystem* jobs = nullptr, const AsyncIOSettings& settings = {});
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    // Reads size bytes at offset of a file on disk into dst.
+    void read(const char* path, uint64_t offset, uint64_t size, void* dst, IoPriority priority, IoCallback callback);
+
+    // Reads a file through the VFS into dst, typically staging memory, decompressing packed
+    // entries on the way. Fails if the file isn't size bytes once decompressed.
+    void read(const VirtualFileSystem& vfs, const char* path, void* dst, uint64_t size, IoPriority priority, IoCallback callback);
+
+    // Reads a whole file through the VFS into memory owned by the file handed to the callback.
+    void read(const VirtualFileSystem& vfs, const char* path, IoPriority priority, IoFileCallback callback);
+
+    // Starts every read queued since the last submit.
+    void submit();
+
+    // Submits and waits for every read and its callback.
+    void waitIdle();
+
+    struct ReadAwaiter
+    {
+        AsyncIO& io;
+        const VirtualFileSystem& vfs;
+        const char* path;
+        void* dst;
+        uint64_t size;
+        IoPriority priority;
+        IoResult result;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        IoResult await_resume() const noexcept { return result; }
+    };
+
+    struct FileAwaiter
+    {
+        AsyncIO& io;
+        const VirtualFileSystem& vfs;
+        const char* path;
+        IoPriority priority;
+        VfsFile file;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        VfsFile await_resume() noexcept { return std::move(file); }
+    };
+
+    // co_await versions of the VFS reads, submitted right away. The coroutine continues where the
+    // callback would have run, so give AsyncIO a job system when it goes on to do real work, and
+    // never call waitIdle() from it. A failed whole file read gives back a closed file.
+    ReadAwaiter readAsync(const VirtualFileSystem& vfs, const char* path, void* dst, uint64_t size, IoPriority priority)
+    {
+        return { *this, vfs, path, dst, size, priority, {} };
+    }
+
+    FileAwaiter readAsync(const VirtualFileSystem& vfs, const char* path, IoPriority priority)
+    {
+        return { *this, vfs, path, priority, {} };
+    }
+
+    IoBackend getBackend() const { return backend; }
+    static const char* getBackendName(IoBackend backend);
+
+private:
+    struct Request;
+    struct Ring;
+
+    void enqueue(std::unique_ptr<Request> request);
+    std::unique_ptr<Request> takeRequest();
+
+    bool prepare(Request& request);
+    void finish(Request* request);
+    void complete(Request* request);
+
+    intptr_t openFile(const std::string& path, bool keepOpen);
+
+    void workerLoop();
+    void ringLoop();
+
+private:
+    JobSystem* jobs;
+    AsyncIOSettings settings;
+    IoBackend backend = IoBackend::ThreadPool;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+
+    std::vector<std::unique_ptr<Request>> queued; // waiting for submit()
+    std::deque<std::unique_ptr<Request>> pending[IO_PRIORITY_COUNT];
+    uint32_t outstanding = 0; // submitted, callback not yet run
+    bool stopping = false;
+
+    // Packs are read from over and over, so their handles stay open. Loose files are closed
+    // once read.
+    std::mutex handleMutex;
+    std::unordered_map<std::string, intptr_t> handles;
+
+    std::unique_ptr<Ring> ring;
+    std::vector<std::thread> threads;
+};
@@ -0,0 +1,1044 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Simd.h"
+
+// One array per channel so the kernels can load four or eight pixels of a channel at once.
+struct BlockPixels
+{
+    alignas(32) float channels[4][16];
+};
+
+// Matches every pixel against the palette over channels [first, first + count), writes the index
+// of the closest entry and returns the summed squared error.
+using FindNearestFn = float(*)(const BlockPixels& pixels, uint32_t first, uint32_t count, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices);
+
+struct EncodeContext
+{
+    BlockQuality quality;
+    FindNearestFn findNearest;
+};
+
+// Fraction of the second endpoint each index selects.
+static const float BC1_WEIGHTS4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+static const float BC1_WEIGHTS3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+static const float BC4_WEIGHTS8[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+// BC7 interpolation weights out of 64.
+static const uint32_t BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+static const uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static float FindNearestScalar(const BlockPixels& pixels, uint32_t first, uint32_t count, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices)
+{
+    float total = 0.0f;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float best = FLT_MAX;
+        uint32_t bestIndex = 0;
+
+        for (uint32_t k = 0; k < paletteSize; k++)
+        {
+            float distance = 0.0f;
+
+            for (uint32_t c = first; c < first + count; c++)
+            {
+                float difference = pixels.channels[c][i] - palette[k][c];
+                distance += difference * difference;
+            }
+
+            if (distance < best)
+            {
+                best = distance;
+                bestIndex = k;
+            }
+        }
+
+        indices[i] = static_cast<uint8_t>(bestIndex);
+        total += best;
+    }
+
+    return total;
+}
+
+#if defined(ENGINE_SIMD_X86)
+
+static float FindNearestSSE2(const BlockPixels& pixels, uint32_t first, uint32_t count, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices)
+{
+    __m128 total = _mm_setzero_ps();
+
+    for (uint32_t i = 0; i < 16; i += 4)
+    {
+        __m128 values[4];
+
+        for (uint32_t c = 0; c < count; c++)
+            values[c] = _mm_load_ps(&pixels.channels[first + c][i]);
+
+        __m128 best = _mm_set1_ps(FLT_MAX);
+        __m128 bestIndex = _mm_setzero_ps();
+
+        for (uint32_t k = 0; k < paletteSize; k++)
+        {
+            __m128 distance = _mm_setzero_ps();
+
+            for (uint32_t c = 0; c < count; c++)
+            {
+                __m128 difference = _mm_sub_ps(values[c], _mm_set1_ps(palette[k][first + c]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(difference, difference));
+            }
+
+            __m128 closer = _mm_cmplt_ps(distance, best);
+            best = _mm_min_ps(distance, best);
+            bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(static_cast<float>(k))), _mm_andnot_ps(closer, bestIndex));
+        }
+
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(bestIndex));
+
+        for (uint32_t j = 0; j < 4; j++)
+            indices[i + j] = static_cast<uint8_t>(lanes[j]);
+
+        total = _mm_add_ps(total, best);
+    }
+
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+ENGINE_TARGET_AVX2
+static float FindNearestAVX2(const BlockPixels& pixels, uint32_t first, uint32_t count, const float (*palette)[4], uint32_t paletteSize, uint8_t* indices)
+{
+    __m256 total = _mm256_setzero_ps();
+
+    for (uint32_t i = 0; i < 16; i += 8)
+    {
+        __m256 values[4];
+
+        for (uint32_t c = 0; c < count; c++)
+            values[c] = _mm256_load_ps(&pixels.channels[first + c][i]);
+
+        __m256 best = _mm256_set1_ps(FLT_MAX);
+        __m256 bestIndex = _mm256_setzero_ps();
+
+        for (uint32_t k = 0; k < paletteSize; k++)
+        {
+            __m256 distance = _mm256_setzero_ps();
+
+            for (uint32_t c = 0; c < count; c++)
+            {
+                __m256 difference = _mm256_sub_ps(values[c], _mm256_set1_ps(palette[k][first + c]));
+                distance = _mm256_fmadd_ps(difference, difference, distance);
+            }
+
+            __m256 closer = _mm256_cmp_ps(distance, best, _CMP_LT_OQ);
+            best = _mm256_min_ps(distance, best);
+            bestIndex = _mm256_blendv_ps(bestIndex, _mm256_set1_ps(static_cast<float>(k)), closer);
+        }
+
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_cvttps_epi32(bestIndex));
+
+        for (uint32_t j = 0; j < 8; j++)
+            indices[i + j] = static_cast<uint8_t>(lanes[j]);
+
+        total = _mm256_add_ps(total, best);
+    }
+
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+    return _mm_cvtss_f32(sum);
+}
+
+#endif // ENGINE_SIMD_X86
+
+static void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, size_t rowPitch, uint32_t blockX, uint32_t blockY, BlockPixels& pixels)
+{
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        const uint8_t* row = rgba + std::min(blockY * 4 + y, height - 1) * rowPitch;
+
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            const uint8_t* texel = row + std::min(blockX * 4 + x, width - 1) * 4;
+
+            for (uint32_t c = 0; c < 4; c++)
+                pixels.channels[c][y * 4 + x] = texel[c];
+        }
+    }
+}
+
+// Principal axis of the pixels by power iteration on their covariance. A zero axis means every
+// pixel is the same.
+static void ComputePrincipalAxis(const BlockPixels& pixels, uint32_t first, uint32_t count, const float* mask, float mean[4], float axis[4])
+{
+    float weight = 0.0f;
+
+    for (uint32_t c = 0; c < 4; c++)
+        mean[c] = axis[c] = 0.0f;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float m = mask ? mask[i] : 1.0f;
+        weight += m;
+
+        for (uint32_t c = 0; c < count; c++)
+            mean[c] += m * pixels.channels[first + c][i];
+    }
+
+    if (weight == 0.0f)
+        return;
+
+    for (uint32_t c = 0; c < count; c++)
+        mean[c] /= weight;
+
+    float covariance[4][4] = {};
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float m = mask ? mask[i] : 1.0f;
+        float d[4];
+
+        for (uint32_t c = 0; c < count; c++)
+            d[c] = pixels.channels[first + c][i] - mean[c];
+
+        for (uint32_t a = 0; a < count; a++)
+        {
+            for (uint32_t b = a; b < count; b++)
+                covariance[a][b] += m * d[a] * d[b];
+        }
+    }
+
+    for (uint32_t a = 0; a < count; a++)
+    {
+        for (uint32_t b = 0; b < a; b++)
+            covariance[a][b] = covariance[b][a];
+    }
+
+    float vector[4];
+
+    for (uint32_t c = 0; c < count; c++)
+        vector[c] = covariance[c][c];
+
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        float largest = 0.0f;
+
+        for (uint32_t a = 0; a < count; a++)
+        {
+            for (uint32_t b = 0; b < count; b++)
+                next[a] += covariance[a][b] * vector[b];
+
+            largest = std::max(largest, std::fabs(next[a]));
+        }
+
+        if (largest == 0.0f)
+            return;
+
+        for (uint32_t c = 0; c < count; c++)
+            vector[c] = next[c] / largest;
+    }
+
+    float length = 0.0f;
+
+    for (uint32_t c = 0; c < count; c++)
+        length += vector[c] * vector[c];
+
+    length = std::sqrt(length);
+
+    for (uint32_t c = 0; c < count; c++)
+        axis[c] = vector[c] / length;
+}
+
+// Endpoints at the extremes of the pixels projected onto the axis.
+static void ProjectExtremes(const BlockPixels& pixels, uint32_t first, uint32_t count, const float* mask, const float mean[4], const float axis[4], float e0[4], float e1[4])
+{
+    float low = FLT_MAX, high = -FLT_MAX;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        if (mask && mask[i] == 0.0f)
+            continue;
+
+        float t = 0.0f;
+
+        for (uint32_t c = 0; c < count; c++)
+            t += (pixels.channels[first + c][i] - mean[c]) * axis[c];
+
+        low = std::min(low, t);
+        high = std::max(high, t);
+    }
+
+    if (low > high)
+        low = high = 0.0f;
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        e0[c] = std::clamp(mean[c] + low * axis[c], 0.0f, 255.0f);
+        e1[c] = std::clamp(mean[c] + high * axis[c], 0.0f, 255.0f);
+    }
+}
+
+// Least squares endpoints for fixed indices, weights[index] being the fraction of e1 it selects.
+static bool SolveEndpoints(const BlockPixels& pixels, uint32_t first, uint32_t count, const uint8_t* indices, const float* weights, const float* mask, float e0[4], float e1[4])
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float x0[4] = {}, x1[4] = {};
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        float m = mask ? mask[i] : 1.0f;
+        float w = weights[indices[i]];
+        float a = 1.0f - w;
+
+        aa += m * a * a;
+        ab += m * a * w;
+        bb += m * w * w;
+
+        for (uint32_t c = 0; c < count; c++)
+        {
+            x0[c] += m * a * pixels.channels[first + c][i];
+            x1[c] += m * w * pixels.channels[first + c][i];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        e0[c] = std::clamp((bb * x0[c] - ab * x1[c]) / determinant, 0.0f, 255.0f);
+        e1[c] = std::clamp((aa * x1[c] - ab * x0[c]) / determinant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+static void WriteIndices(uint8_t* out, const uint8_t* indices, uint32_t bits)
+{
+    uint64_t packed = 0;
+
+    for (uint32_t i = 0; i < 16; i++)
+        packed |= static_cast<uint64_t>(indices[i]) << (i * bits);
+
+    for (uint32_t i = 0; i < bits * 2; i++)
+        out[i] = static_cast<uint8_t>(packed >> (i * 8));
+}
+
+// BC1 and the color half of BC3
+
+static uint16_t PackRgb565(const float color[4])
+{
+    uint32_t r = static_cast<uint32_t>(std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+    uint32_t g = static_cast<uint32_t>(std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+    uint32_t b = static_cast<uint32_t>(std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRgb565(uint16_t packed, float color[4])
+{
+    uint32_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+
+    color[0] = static_cast<float>((r << 3) | (r >> 2));
+    color[1] = static_cast<float>((g << 2) | (g >> 4));
+    color[2] = static_cast<float>((b << 3) | (b >> 2));
+    color[3] = 255.0f;
+}
+
+struct ColorBlock
+{
+    uint16_t c0, c1;
+    uint8_t indices[16];
+    float error;
+};
+
+// Transparent pixels need three color mode, opaque blocks may use it too but never index 3.
+static void EncodeColorEndpoints(const BlockPixels& pixels, const EncodeContext& ctx, const float e0[4], const float e1[4], bool threeColor, uint32_t transparent, ColorBlock& block)
+{
+    // Four colors need c0 > c1, three colors and transparency need c0 <= c1.
+    block.c0 = PackRgb565(e0);
+    block.c1 = PackRgb565(e1);
+
+    if (threeColor ? block.c0 > block.c1 : block.c0 < block.c1)
+        std::swap(block.c0, block.c1);
+
+    float palette[4][4];
+    UnpackRgb565(block.c0, palette[0]);
+    UnpackRgb565(block.c1, palette[1]);
+
+    uint32_t paletteSize = 1;
+
+    if (threeColor)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+            palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f;
+
+        paletteSize = 3;
+    }
+    else if (block.c0 != block.c1)
+    {
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        paletteSize = 4;
+    }
+
+    if (!threeColor)
+    {
+        block.error = ctx.findNearest(pixels, 0, 3, palette, paletteSize, block.indices);
+        return;
+    }
+
+    // Transparent pixels match the first entry exactly so they add no error, then take index 3.
+    BlockPixels opaque = pixels;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        if (transparent & (1u << i))
+        {
+            for (uint32_t c = 0; c < 3; c++)
+                opaque.channels[c][i] = palette[0][c];
+        }
+    }
+
+    block.error = ctx.findNearest(opaque, 0, 3, palette, paletteSize, block.indices);
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        if (transparent & (1u << i))
+            block.indices[i] = 3;
+    }
+}
+
+// Least squares refinement of the endpoints for the indices best ended up with.
+static void RefineColorBlock(const BlockPixels& pixels, const EncodeContext& ctx, bool threeColor, uint32_t transparent, const float mask[16], float e0[4], float e1[4], ColorBlock& best)
+{
+    const float* weights = threeColor ? BC1_WEIGHTS3 : BC1_WEIGHTS4;
+
+    for (int iteration = 0; iteration < 2 && best.error > 0.0f; iteration++)
+    {
+        ColorBlock refined;
+
+        if (!SolveEndpoints(pixels, 0, 3, best.indices, weights, mask, e0, e1))
+            break;
+
+        EncodeColorEndpoints(pixels, ctx, e0, e1, threeColor, transparent, refined);
+
+        if (refined.error >= best.error)
+            break;
+
+        best = refined;
+    }
+}
+
+static float EncodeColorBlock(const BlockPixels& pixels, const EncodeContext& ctx, bool allowTransparent, uint8_t* out)
+{
+    uint32_t transparent = 0;
+    float mask[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        bool clear = allowTransparent && pixels.channels[3][i] < 128.0f;
+        transparent |= clear ? 1u << i : 0u;
+        mask[i] = clear ? 0.0f : 1.0f;
+    }
+
+    if (transparent == 0xFFFF)
+    {
+        const uint8_t clear[8] = { 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+        memcpy(out, clear, sizeof(clear));
+        return 0.0f;
+    }
+
+    bool threeColor = transparent != 0;
+    float e0[4], e1[4];
+
+    if (ctx.quality == BlockQuality::Fast)
+    {
+        // Corners of the bounding box, along whichever diagonal the colors are spread on, pulled in
+        // slightly since the extremes are rarely worth representing exactly.
+        float low[3] = { 255.0f, 255.0f, 255.0f }, high[3] = { 0.0f, 0.0f, 0.0f }, mean[3] = {};
+        float count = 0.0f;
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (mask[i] == 0.0f)
+                continue;
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                low[c] = std::min(low[c], pixels.channels[c][i]);
+                high[c] = std::max(high[c], pixels.channels[c][i]);
+                mean[c] += pixels.channels[c][i];
+            }
+
+            count += 1.0f;
+        }
+
+        float redGreen = 0.0f, blueGreen = 0.0f;
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            float g = (pixels.channels[1][i] - mean[1] / count) * mask[i];
+            redGreen += (pixels.channels[0][i] - mean[0] / count) * g;
+            blueGreen += (pixels.channels[2][i] - mean[2] / count) * g;
+        }
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            e0[c] = high[c];
+            e1[c] = low[c];
+        }
+
+        if (redGreen < 0.0f)
+            std::swap(e0[0], e1[0]);
+
+        if (blueGreen < 0.0f)
+            std::swap(e0[2], e1[2]);
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            float inset = (e0[c] - e1[c]) / 16.0f;
+            e0[c] -= inset;
+            e1[c] += inset;
+        }
+    }
+    else
+    {
+        float mean[4], axis[4];
+        ComputePrincipalAxis(pixels, 0, 3, mask, mean, axis);
+        ProjectExtremes(pixels, 0, 3, mask, mean, axis, e0, e1);
+    }
+
+    ColorBlock best;
+    EncodeColorEndpoints(pixels, ctx, e0, e1, threeColor, transparent, best);
+
+    if (ctx.quality == BlockQuality::Quality)
+    {
+        float start0[4], start1[4];
+        memcpy(start0, e0, sizeof(start0));
+        memcpy(start1, e1, sizeof(start1));
+
+        RefineColorBlock(pixels, ctx, threeColor, transparent, mask, e0, e1, best);
+
+        // An opaque BC1 block can still come out closer in three color mode, its midpoint lands
+        // between the four color palette's thirds. BC3's color half always decodes as four colors.
+        if (allowTransparent && !threeColor && best.error > 0.0f)
+        {
+            ColorBlock candidate;
+            EncodeColorEndpoints(pixels, ctx, start0, start1, true, 0, candidate);
+            RefineColorBlock(pixels, ctx, true, 0, mask, start0, start1, candidate);
+
+            if (candidate.error < best.error)
+                best = candidate;
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(best.c0);
+    out[1] = static_cast<uint8_t>(best.c0 >> 8);
+    out[2] = static_cast<uint8_t>(best.c1);
+    out[3] = static_cast<uint8_t>(best.c1 >> 8);
+    WriteIndices(out + 4, best.indices, 2);
+
+    return best.error;
+}
+
+// BC4, the alpha half of BC3 and both halves of BC5
+
+struct AlphaBlock
+{
+    uint8_t e0, e1;
+    uint8_t indices[16];
+    float error;
+};
+
+static void EncodeAlphaEndpoints(const BlockPixels& pixels, uint32_t channel, const EncodeContext& ctx, uint8_t e0, uint8_t e1, AlphaBlock& block)
+{
+    float palette[8][4];
+    uint32_t paletteSize = 8;
+
+    palette[0][channel] = e0;
+    palette[1][channel] = e1;
+
+    if (e0 > e1)
+    {
+        for (uint32_t i = 2; i < 8; i++)
+            palette[i][channel] = ((8 - i) * e0 + (i - 1) * e1) / 7.0f;
+    }
+    else
+    {
+        for (uint32_t i = 2; i < 6; i++)
+            palette[i][channel] = ((6 - i) * e0 + (i - 1) * e1) / 5.0f;
+
+        palette[6][channel] = 0.0f;
+        palette[7][channel] = 255.0f;
+    }
+
+    block.e0 = e0;
+    block.e1 = e1;
+    block.error = ctx.findNearest(pixels, channel, 1, palette, paletteSize, block.indices);
+}
+
+static float EncodeAlphaBlock(const BlockPixels& pixels, uint32_t channel, const EncodeContext& ctx, uint8_t* out)
+{
+    const float* values = pixels.channels[channel];
+
+    float low = 255.0f, high = 0.0f;
+    float innerLow = 255.0f, innerHigh = 0.0f;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        low = std::min(low, values[i]);
+        high = std::max(high, values[i]);
+
+        if (values[i] > 0.0f && values[i] < 255.0f)
+        {
+            innerLow = std::min(innerLow, values[i]);
+            innerHigh = std::max(innerHigh, values[i]);
+        }
+    }
+
+    AlphaBlock best;
+    EncodeAlphaEndpoints(pixels, channel, ctx, static_cast<uint8_t>(high), static_cast<uint8_t>(low), best);
+
+    if (ctx.quality == BlockQuality::Quality && best.error > 0.0f)
+    {
+        // Refine the eight value mode, whose interpolated values no longer need to include the extremes.
+        for (int iteration = 0; iteration < 2; iteration++)
+        {
+            float e0[4], e1[4];
+
+            if (!SolveEndpoints(pixels, channel, 1, best.indices, BC4_WEIGHTS8, nullptr, e0, e1))
+                break;
+
+            uint8_t a = static_cast<uint8_t>(std::lround(e0[0]));
+            uint8_t b = static_cast<uint8_t>(std::lround(e1[0]));
+
+            if (a == b)
+                break;
+
+            AlphaBlock refined;
+            EncodeAlphaEndpoints(pixels, channel, ctx, std::max(a, b), std::min(a, b), refined);
+
+            if (refined.error >= best.error)
+                break;
+
+            best = refined;
+        }
+
+        // The six value mode has exact 0 and 255, so it only has to span the values in between.
+        if (innerLow <= innerHigh && (low == 0.0f || high == 255.0f))
+        {
+            AlphaBlock six;
+            EncodeAlphaEndpoints(pixels, channel, ctx, static_cast<uint8_t>(innerLow), static_cast<uint8_t>(innerHigh), six);
+
+            if (six.error < best.error)
+                best = six;
+        }
+    }
+
+    out[0] = best.e0;
+    out[1] = best.e1;
+    WriteIndices(out + 2, best.indices, 3);
+
+    return best.error;
+}
+
+// BC7, modes 5 and 6. Both have a single subset, so no partition search is needed.
+
+class BitWriter
+{
+public:
+    explicit BitWriter(uint8_t* out) : out(out) { memset(out, 0, 16); }
+
+    void write(uint32_t value, uint32_t bits)
+    {
+        for (uint32_t i = 0; i < bits; i++, position++)
+            out[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (position & 7));
+    }
+
+private:
+    uint8_t* out;
+    uint32_t position = 0;
+};
+
+struct Bc7Subset
+{
+    uint32_t q0[4], q1[4]; // quantized endpoints
+    uint32_t p0 = 0, p1 = 0;
+    uint8_t indices[16];
+    float error = FLT_MAX;
+};
+
+// With a p-bit the endpoint is the quantized value then the p-bit, otherwise the high bits repeat.
+static uint32_t QuantizeBc7(float value, uint32_t bits, int pbit)
+{
+    uint32_t limit = (1u << bits) - 1;
+
+    if (pbit >= 0)
+        return static_cast<uint32_t>(std::clamp(std::lround((value - pbit) * 0.5f), 0l, static_cast<long>(limit)));
+
+    return static_cast<uint32_t>(std::clamp(std::lround(value * limit / 255.0f), 0l, static_cast<long>(limit)));
+}
+
+static uint32_t ExpandBc7(uint32_t quantized, uint32_t bits, int pbit)
+{
+    if (pbit >= 0)
+        return (quantized << 1) | static_cast<uint32_t>(pbit);
+
+    return bits == 8 ? quantized : (quantized << (8 - bits)) | (quantized >> (2 * bits - 8));
+}
+
+static int ChooseBc7PBit(const float endpoint[4], uint32_t first, uint32_t count, uint32_t bits)
+{
+    float errors[2] = {};
+
+    for (int pbit = 0; pbit < 2; pbit++)
+    {
+        for (uint32_t c = first; c < first + count; c++)
+        {
+            float d = endpoint[c] - static_cast<float>(ExpandBc7(QuantizeBc7(endpoint[c], bits, pbit), bits, pbit));
+            errors[pbit] += d * d;
+        }
+    }
+
+    return errors[1] < errors[0] ? 1 : 0;
+}
+
+static void EncodeBc7Endpoints(const BlockPixels& pixels, const EncodeContext& ctx, uint32_t first, uint32_t count, uint32_t bits,
+    int p0, int p1, const uint32_t* weights, uint32_t weightCount, const float e0[4], const float e1[4], Bc7Subset& subset)
+{
+    float palette[16][4];
+    uint32_t a[4], b[4];
+
+    for (uint32_t c = first; c < first + count; c++)
+    {
+        subset.q0[c] = QuantizeBc7(e0[c], bits, p0);
+        subset.q1[c] = QuantizeBc7(e1[c], bits, p1);
+
+        a[c] = ExpandBc7(subset.q0[c], bits, p0);
+        b[c] = ExpandBc7(subset.q1[c], bits, p1);
+    }
+
+    for (uint32_t k = 0; k < weightCount; k++)
+    {
+        for (uint32_t c = first; c < first + count; c++)
+            palette[k][c] = static_cast<float>(((64 - weights[k]) * a[c] + weights[k] * b[c] + 32) >> 6);
+    }
+
+    subset.p0 = p0 < 0 ? 0 : static_cast<uint32_t>(p0);
+    subset.p1 = p1 < 0 ? 0 : static_cast<uint32_t>(p1);
+    subset.error = ctx.findNearest(pixels, first, count, palette, weightCount, subset.indices);
+}
+
+static void FitBc7Subset(const BlockPixels& pixels, const EncodeContext& ctx, uint32_t first, uint32_t count, uint32_t bits, bool pbits,
+    const uint32_t* weights, uint32_t weightCount, Bc7Subset& best)
+{
+    // The helpers work on channels relative to first, the encoder on absolute ones.
+    float mean[4], axis[4], e0[4], e1[4];
+    ComputePrincipalAxis(pixels, first, count, nullptr, mean, axis);
+    ProjectExtremes(pixels, first, count, nullptr, mean, axis, e0 + first, e1 + first);
+
+    float fractions[16];
+
+    for (uint32_t k = 0; k < weightCount; k++)
+        fractions[k] = weights[k] / 64.0f;
+
+    bool quality = ctx.quality == BlockQuality::Quality;
+    best.error = FLT_MAX;
+
+    for (int iteration = 0; iteration < (quality ? 3 : 1); iteration++)
+    {
+        Bc7Subset candidate;
+        float before = best.error;
+
+        if (!pbits)
+        {
+            EncodeBc7Endpoints(pixels, ctx, first, count, bits, -1, -1, weights, weightCount, e0, e1, candidate);
+
+            if (candidate.error < best.error)
+                best = candidate;
+        }
+        else if (!quality)
+        {
+            int p0 = ChooseBc7PBit(e0, first, count, bits);
+            int p1 = ChooseBc7PBit(e1, first, count, bits);
+
+            EncodeBc7Endpoints(pixels, ctx, first, count, bits, p0, p1, weights, weightCount, e0, e1, candidate);
+
+            if (candidate.error < best.error)
+                best = candidate;
+        }
+        else
+        {
+            for (int combination = 0; combination < 4; combination++)
+            {
+                EncodeBc7Endpoints(pixels, ctx, first, count, bits, combination & 1, combination >> 1, weights, weightCount, e0, e1, candidate);
+
+                if (candidate.error < best.error)
+                    best = candidate;
+            }
+        }
+
+        if (best.error == 0.0f || best.error >= before)
+            break;
+
+        if (!SolveEndpoints(pixels, first, count, best.indices, fractions, nullptr, e0 + first, e1 + first))
+            break;
+    }
+}
+
+static void WriteBc7Mode6(Bc7Subset subset, uint8_t* out)
+{
+    // The first index drops its top bit, so it has to be in the lower half of the range.
+    if (subset.indices[0] & 8)
+    {
+        std::swap(subset.q0, subset.q1);
+        std::swap(subset.p0, subset.p1);
+
+        for (auto& index : subset.indices)
+            index = static_cast<uint8_t>(15 - index);
+    }
+
+    BitWriter writer(out);
+    writer.write(1u << 6, 7);
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        writer.write(subset.q0[c], 7);
+        writer.write(subset.q1[c], 7);
+    }
+
+    writer.write(subset.p0, 1);
+    writer.write(subset.p1, 1);
+    writer.write(subset.indices[0], 3);
+
+    for (uint32_t i = 1; i < 16; i++)
+        writer.write(subset.indices[i], 4);
+}
+
+static void WriteBc7Mode5(uint32_t rotation, Bc7Subset color, Bc7Subset alpha, uint8_t* out)
+{
+    if (color.indices[0] & 2)
+    {
+        std::swap(color.q0, color.q1);
+
+        for (auto& index : color.indices)
+            index = static_cast<uint8_t>(3 - index);
+    }
+
+    if (alpha.indices[0] & 2)
+    {
+        std::swap(alpha.q0, alpha.q1);
+
+        for (auto& index : alpha.indices)
+            index = static_cast<uint8_t>(3 - index);
+    }
+
+    BitWriter writer(out);
+    writer.write(1u << 5, 6);
+    writer.write(rotation, 2);
+
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        writer.write(color.q0[c], 7);
+        writer.write(color.q1[c], 7);
+    }
+
+    writer.write(alpha.q0[3], 8);
+    writer.write(alpha.q1[3], 8);
+
+    writer.write(color.indices[0], 1);
+
+    for (uint32_t i = 1; i < 16; i++)
+        writer.write(color.indices[i], 2);
+
+    writer.write(alpha.indices[0], 1);
+
+    for (uint32_t i = 1; i < 16; i++)
+        writer.write(alpha.indices[i], 2);
+}
+
+static float EncodeBc7Block(const BlockPixels& pixels, const EncodeContext& ctx, uint8_t* out)
+{
+    Bc7Subset mode6;
+    FitBc7Subset(pixels, ctx, 0, 4, 7, true, BC7_WEIGHTS4, 16, mode6);
+
+    bool opaque = true;
+
+    for (uint32_t i = 0; i < 16; i++)
+        opaque &= pixels.channels[3][i] == 255.0f;
+
+    // Mode 5 fits alpha, or whichever channel is rotated into it, separately from the rest. That
+    // also helps opaque blocks whose colors do not lie along one line.
+    float bestError = mode6.error;
+    int bestRotation = -1;
+    Bc7Subset bestColor, bestAlpha;
+
+    if (ctx.quality == BlockQuality::Quality && mode6.error > 0.0f)
+    {
+        for (uint32_t rotation = opaque ? 1 : 0; rotation < 4; rotation++)
+        {
+            BlockPixels rotated = pixels;
+
+            if (rotation > 0)
+                std::swap(rotated.channels[rotation - 1], rotated.channels[3]);
+
+            Bc7Subset color, alpha;
+            FitBc7Subset(rotated, ctx, 0, 3, 7, false, BC7_WEIGHTS2, 4, color);
+            FitBc7Subset(rotated, ctx, 3, 1, 8, false, BC7_WEIGHTS2, 4, alpha);
+
+            if (color.error + alpha.error < bestError)
+            {
+                bestError = color.error + alpha.error;
+                bestRotation = static_cast<int>(rotation);
+                bestColor = color;
+                bestAlpha = alpha;
+            }
+        }
+    }
+
+    if (bestRotation < 0)
+        WriteBc7Mode6(mode6, out);
+    else
+        WriteBc7Mode5(static_cast<uint32_t>(bestRotation), bestColor, bestAlpha, out);
+
+    return bestError;
+}
+
+static float EncodeBlock(const BlockPixels& pixels, BlockFormat format, const EncodeContext& ctx, uint8_t* out)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return EncodeColorBlock(pixels, ctx, true, out);
+    case BlockFormat::BC3: return EncodeAlphaBlock(pixels, 3, ctx, out) + EncodeColorBlock(pixels, ctx, false, out + 8);
+    case BlockFormat::BC4: return EncodeAlphaBlock(pixels, 0, ctx, out);
+    case BlockFormat::BC5: return EncodeAlphaBlock(pixels, 0, ctx, out) + EncodeAlphaBlock(pixels, 1, ctx, out + 8);
+    case BlockFormat::BC7: return EncodeBc7Block(pixels, ctx, out);
+    }
+
+    return 0.0f;
+}
+
+uint32_t GetBlockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+size_t GetBlockCompressedSize(BlockFormat format, uint32_t width, uint32_t height)
+{
+    return size_t((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+BlockCompressor::BlockCompressor(JobSystem* jobs)
+    : jobs(jobs), path(getBestPath())
+{
+}
+
+double BlockCompressor::compress(const uint8_t* rgba, uint32_t width, uint32_t height, size_t rowPitch,
+    BlockFormat format, BlockQuality quality, uint8_t* out) const
+{
+    EncodeContext ctx{ quality, FindNearestScalar };
+
+#if defined(ENGINE_SIMD_X86)
+    if (path == BlockPath::SSE2)
+        ctx.findNearest = FindNearestSSE2;
+    else if (path == BlockPath::AVX2)
+        ctx.findNearest = FindNearestAVX2;
+#endif
+
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    uint32_t blockBytes = GetBlockBytes(format);
+
+    auto encodeRows = [&](uint32_t begin, uint32_t end)
+    {
+        BlockPixels pixels;
+        double error = 0.0;
+
+        for (uint32_t y = begin; y < end; y++)
+        {
+            for (uint32_t x = 0; x < blocksX; x++)
+            {
+                LoadBlock(rgba, width, height, rowPitch, x, y, pixels);
+                error += EncodeBlock(pixels, format, ctx, out + (size_t(y) * blocksX + x) * blockBytes);
+            }
+        }
+
+        return error;
+    };
+
+    if (jobs == nullptr || blocksY <= CHUNK_ROWS)
+        return encodeRows(0, blocksY);
+
+    std::vector<double> chunkErrors(jobs->getChunkCount(blocksY, CHUNK_ROWS));
+
+    jobs->parallelFor(blocksY, CHUNK_ROWS, [&](uint32_t begin, uint32_t end)
+    {
+        chunkErrors[begin / CHUNK_ROWS] = encodeRows(begin, end);
+    });
+
+    double error = 0.0;
+
+    for (double chunkError : chunkErrors)
+        error += chunkError;
+
+    return error;
+}
+
+void BlockCompressor::setPath(BlockPath path)
+{
+    this->path = isSupported(path) ? path : getBestPath();
+}
+
+BlockPath BlockCompressor::getBestPath()
+{
+    const auto& features = CpuFeatures::get();
+
+    if (features.avx2)
+        return BlockPath::AVX2;
+
+    if (features.sse2)
+        return BlockPath::SSE2;
+
+    return BlockPath::Scalar;
+}
+
+bool BlockCompressor::isSupported(BlockPath path)
+{
+    const auto& features = CpuFeatures::get();
+
+    switch (path)
+    {
+    case BlockPath::SSE2: return features.sse2;
+    case BlockPath::AVX2: return features.avx2;
+    default: return true;
+    }
+}
+
+const char* BlockCompressor::getPathName(BlockPath path)
+{
+    switch (path)
+    {
+    case BlockPath::SSE2: return "SSE2";
+    case BlockPath::AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class JobSystem;
+
+enum class BlockFormat
+{
+    BC1, // RGB with 1 bit alpha, 8 bytes per block
+    BC3, // RGBA with interpolated alpha, 16 bytes per block
+    BC4, // R, 8 bytes per block
+    BC5, // RG, 16 bytes per block
+    BC7, // RGBA, 16 bytes per block
+};
+
+enum class BlockQuality
+{
+    Fast,    // bounding box or principal axis endpoints, no refinement
+    Quality, // least squares refinement and a search over the encodings each format allows
+};
+
+enum class BlockPath
+{
+    Scalar,
+    SSE2, // 4 pixels per batch
+    AVX2, // 8 pixels per batch
+};
+
+uint32_t GetBlockBytes(BlockFormat format);
+size_t GetBlockCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+// Encodes RGBA8 images into 4x4 blocks. Partial blocks at the right and bottom edges repeat the
+// last column and row. The part of every kernel that runs per pixel, matching each pixel against
+// the block's palette, has SSE2 and AVX2 versions.
+class BlockCompressor
+{
+public:
+    // Block rows per parallel chunk.
+    static constexpr uint32_t CHUNK_ROWS = 4;
+
+    explicit BlockCompressor(JobSystem* jobs = nullptr);
+
+    // Writes blocks row by row to out, which must hold GetBlockCompressedSize bytes, and returns
+    // the summed squared error over every channel the format stores.
+    double compress(const uint8_t* rgba, uint32_t width, uint32_t height, size_t rowPitch,
+        BlockFormat format, BlockQuality quality, uint8_t* out) const;
+
+    void setPath(BlockPath path);
+    BlockPath getPath() const { return path; }
+
+    static BlockPath getBestPath();
+    static bool isSupported(BlockPath path);
+    static const char* getPathName(BlockPath path);
+
+private:
+    JobSystem* jobs;
+    BlockPath path;
+};
@@ -0,0 +1,789 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include "JobSystem.h"
+#include "Simd.h"
+
+static constexpr uint32_t SAH_BIN_COUNT = 16;
+
+// Rebuild once refitting has made the tree this much worse than it was when built.
+static constexpr float REBUILD_COST_RATIO = 1.5f;
+static constexpr uint32_t MIN_UNINDEXED_BEFORE_REBUILD = 64;
+
+static constexpr float FLOAT_MAX = 3.402823466e+38f;
+
+// Builds a binary SAH tree first, then collapses it into four wide nodes.
+struct BoundingVolumeHierarchy::Builder
+{
+    struct BuildNode
+    {
+        AABB bounds;
+        uint32_t left = INVALID;
+        uint32_t right = INVALID;
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        bool isLeaf() const { return left == INVALID; }
+    };
+
+    const std::vector<AABB>& bounds;
+    std::vector<glm::vec3> centroids;
+    std::vector<uint32_t> indices;
+    std::vector<BuildNode> nodes;
+
+    uint32_t buildBinary(uint32_t first, uint32_t count);
+    uint32_t collapse(Tree& tree, uint32_t binaryNode, uint32_t parentRef);
+};
+
+static float Area(const AABB& box)
+{
+    if (box.min.x > box.max.x)
+        return 0.0f;
+
+    return box.getSurfaceArea();
+}
+
+static void SetSlot(BVHNode& node, uint32_t slot, const AABB& box)
+{
+    node.minX[slot] = box.min.x;
+    node.minY[slot] = box.min.y;
+    node.minZ[slot] = box.min.z;
+    node.maxX[slot] = box.max.x;
+    node.maxY[slot] = box.max.y;
+    node.maxZ[slot] = box.max.z;
+}
+
+static AABB GetSlot(const BVHNode& node, uint32_t slot)
+{
+    return { glm::vec3(node.minX[slot], node.minY[slot], node.minZ[slot]), glm::vec3(node.maxX[slot], node.maxY[slot], node.maxZ[slot]) };
+}
+
+static uint32_t ValidSlots(const BVHNode& node)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t slot = 0; slot < 4; slot++)
+        mask |= (node.child[slot] != BoundingVolumeHierarchy::INVALID ? 1u : 0u) << slot;
+
+    return mask;
+}
+
+static bool Overlaps(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static bool Overlaps(const AABB& box, const BoundingSphere& sphere)
+{
+    glm::vec3 closest = glm::min(glm::max(sphere.center, box.min), box.max);
+    glm::vec3 delta = closest - sphere.center;
+
+    return glm::dot(delta, delta) <= sphere.radius * sphere.radius;
+}
+
+static bool RayBoxDistance(const Ray& ray, const glm::vec3& inverseDirection, const AABB& box, float maxDistance, float& distance)
+{
+    glm::vec3 t1 = (box.min - ray.origin) * inverseDirection;
+    glm::vec3 t2 = (box.max - ray.origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+    distance = enter;
+    return enter <= exit;
+}
+
+// Returns a bit per slot whose box is not entirely outside one of the frustum planes.
+static uint32_t FrustumSlotMask(const BVHNode& node, const Frustum& frustum)
+{
+#if defined(ENGINE_SIMD_X86)
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    __m128 minX = _mm_load_ps(node.minX), maxX = _mm_load_ps(node.maxX);
+    __m128 minY = _mm_load_ps(node.minY), maxY = _mm_load_ps(node.maxY);
+    __m128 minZ = _mm_load_ps(node.minZ), maxZ = _mm_load_ps(node.maxZ);
+
+    __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half), ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+    __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half), ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+    __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+    __m128 outside = _mm_setzero_ps();
+
+    for (const auto& plane : frustum.planes)
+    {
+        __m128 distance = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.normal.y))),
+            _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.distance)));
+
+        __m128 radius = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::fabs(plane.normal.x))), _mm_mul_ps(ey, _mm_set1_ps(std::fabs(plane.normal.y)))),
+            _mm_mul_ps(ez, _mm_set1_ps(std::fabs(plane.normal.z))));
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+    }
+
+    return ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xF;
+#else
+    uint32_t mask = 0;
+
+    for (uint32_t slot = 0; slot < 4; slot++)
+        mask |= (frustum.intersects(GetSlot(node, slot)) ? 1u : 0u) << slot;
+
+    return mask;
+#endif
+}
+
+uint32_t BoundingVolumeHierarchy::Builder::buildBinary(uint32_t first, uint32_t count)
+{
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    AABB nodeBounds = AABB::empty();
+    AABB centroidBounds = AABB::empty();
+
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        nodeBounds.expand(bounds[indices[i]]);
+        centroidBounds.expand(centroids[indices[i]]);
+    }
+
+    nodes[index].bounds = nodeBounds;
+
+    if (count <= BoundingVolumeHierarchy::MAX_LEAF_SIZE)
+    {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        return index;
+    }
+
+    struct Bin
+    {
+        AABB bounds = AABB::empty();
+        uint32_t count = 0;
+    };
+
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+    float bestCost = FLOAT_MAX;
+
+    glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (extent[axis] <= 0.0f)
+            continue;
+
+        Bin bins[SAH_BIN_COUNT];
+        float scale = SAH_BIN_COUNT / extent[axis];
+
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            uint32_t bin = std::min(static_cast<uint32_t>((centroids[indices[i]][axis] - centroidBounds.min[axis]) * scale), SAH_BIN_COUNT - 1);
+            bins[bin].bounds.expand(bounds[indices[i]]);
+            bins[bin].count++;
+        }
+
+        // Sweep from the right to get the cost of everything right of each split plane.
+        float rightArea[SAH_BIN_COUNT];
+        uint32_t rightCount[SAH_BIN_COUNT];
+        AABB accumulated = AABB::empty();
+        uint32_t accumulatedCount = 0;
+
+        for (uint32_t bin = SAH_BIN_COUNT - 1; bin > 0; bin--)
+        {
+            accumulated.expand(bins[bin].bounds);
+            accumulatedCount += bins[bin].count;
+            rightArea[bin] = Area(accumulated);
+            rightCount[bin] = accumulatedCount;
+        }
+
+        accumulated = AABB::empty();
+        accumulatedCount = 0;
+
+        for (uint32_t split = 1; split < SAH_BIN_COUNT; split++)
+        {
+            accumulated.expand(bins[split - 1].bounds);
+            accumulatedCount += bins[split - 1].count;
+
+            if (accumulatedCount == 0 || rightCount[split] == 0)
+                continue;
+
+            float cost = Area(accumulated) * accumulatedCount + rightArea[split] * rightCount[split];
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t middle;
+
+    if (bestAxis >= 0)
+    {
+        float scale = SAH_BIN_COUNT / extent[bestAxis];
+        float origin = centroidBounds.min[bestAxis];
+
+        auto begin = indices.begin() + first;
+        auto split = std::partition(begin, begin + count, [&](uint32_t object)
+        {
+            uint32_t bin = std::min(static_cast<uint32_t>((centroids[object][bestAxis] - origin) * scale), SAH_BIN_COUNT - 1);
+            return bin < bestSplit;
+        });
+
+        middle = static_cast<uint32_t>(split - indices.begin());
+    }
+    else
+    {
+        // Every centroid is in the same place, any split is as good as another.
+        middle = first + count / 2;
+    }
+
+    uint32_t left = buildBinary(first, middle - first);
+    uint32_t right = buildBinary(middle, first + count - middle);
+
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+uint32_t BoundingVolumeHierarchy::Builder::collapse(Tree& tree, uint32_t binaryNode, uint32_t parentRef)
+{
+    // Pull the grandchildren of the largest inner children up until there are four slots.
+    uint32_t candidates[4];
+    uint32_t candidateCount = 0;
+
+    if (nodes[binaryNode].isLeaf())
+    {
+        candidates[candidateCount++] = binaryNode;
+    }
+    else
+    {
+        candidates[candidateCount++] = nodes[binaryNode].left;
+        candidates[candidateCount++] = nodes[binaryNode].right;
+
+        while (candidateCount < 4)
+        {
+            int largest = -1;
+            float largestArea = -1.0f;
+
+            for (uint32_t i = 0; i < candidateCount; i++)
+            {
+                const auto& candidate = nodes[candidates[i]];
+                float area = Area(candidate.bounds);
+
+                if (!candidate.isLeaf() && area > largestArea)
+                {
+                    largest = static_cast<int>(i);
+                    largestArea = area;
+                }
+            }
+
+            if (largest < 0)
+                break;
+
+            uint32_t expanded = candidates[largest];
+            candidates[largest] = nodes[expanded].left;
+            candidates[candidateCount++] = nodes[expanded].right;
+        }
+    }
+
+    uint32_t index = static_cast<uint32_t>(tree.nodes.size());
+
+    BVHNode node{};
+    for (uint32_t slot = 0; slot < 4; slot++)
+    {
+        SetSlot(node, slot, AABB::empty());
+        node.child[slot] = BoundingVolumeHierarchy::INVALID;
+        node.count[slot] = 0;
+    }
+
+    tree.nodes.push_back(node);
+    tree.nodeParents.push_back(parentRef);
+
+    for (uint32_t slot = 0; slot < candidateCount; slot++)
+    {
+        const BuildNode candidate = nodes[candidates[slot]];
+
+        SetSlot(tree.nodes[index], slot, candidate.bounds);
+        tree.slotArea += Area(candidate.bounds);
+
+        if (candidate.isLeaf())
+        {
+            tree.nodes[index].child[slot] = candidate.first;
+            tree.nodes[index].count[slot] = candidate.count;
+
+            for (uint32_t i = candidate.first; i < candidate.first + candidate.count; i++)
+                tree.objectLeaves[indices[i]] = (index << 2) | slot;
+        }
+        else
+        {
+            uint32_t child = collapse(tree, candidates[slot], (index << 2) | slot);
+            tree.nodes[index].child[slot] = child;
+        }
+    }
+
+    return index;
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() = default;
+
+void BoundingVolumeHierarchy::buildTree(Tree& tree, const std::vector<AABB>& bounds, const std::vector<uint8_t>& alive)
+{
+    Builder builder{ bounds, {}, {}, {} };
+    builder.centroids.resize(bounds.size());
+
+    for (uint32_t object = 0; object < bounds.size(); object++)
+    {
+        if (!alive[object])
+            continue;
+
+        builder.centroids[object] = bounds[object].getCenter();
+        builder.indices.push_back(object);
+    }
+
+    tree = Tree{};
+    tree.objectLeaves.assign(bounds.size(), INVALID);
+
+    if (builder.indices.empty())
+        return;
+
+    uint32_t count = static_cast<uint32_t>(builder.indices.size());
+    builder.nodes.reserve(count * 2 / MAX_LEAF_SIZE + 1);
+
+    uint32_t root = builder.buildBinary(0, count);
+    builder.collapse(tree, root, INVALID);
+
+    tree.rootBounds = builder.nodes[root].bounds;
+    tree.primitives = std::move(builder.indices);
+
+    float rootArea = Area(tree.rootBounds);
+    tree.builtCost = rootArea > 0.0f ? static_cast<float>(tree.slotArea / rootArea) : 0.0f;
+}
+
+uint32_t BoundingVolumeHierarchy::insert(const AABB& bounds)
+{
+    uint32_t object = static_cast<uint32_t>(objectBounds.size());
+
+    objectBounds.push_back(bounds);
+    objectAlive.push_back(1);
+    objectDirty.push_back(0);
+    tree.objectLeaves.push_back(INVALID);
+    unindexed.push_back(object);
+
+    return object;
+}
+
+void BoundingVolumeHierarchy::remove(uint32_t object)
+{
+    objectAlive[object] = 0;
+    objectBounds[object] = AABB::empty();
+
+    auto found = std::find(unindexed.begin(), unindexed.end(), object);
+
+    if (found != unindexed.end())
+    {
+        *found = unindexed.back();
+        unindexed.pop_back();
+    }
+    else if (!objectDirty[object])
+    {
+        objectDirty[object] = 1;
+        dirtyObjects.push_back(object);
+    }
+}
+
+void BoundingVolumeHierarchy::update(uint32_t object, const AABB& bounds)
+{
+    objectBounds[object] = bounds;
+
+    if (!objectDirty[object])
+    {
+        objectDirty[object] = 1;
+        dirtyObjects.push_back(object);
+    }
+}
+
+void BoundingVolumeHierarchy::build()
+{
+    pendingBuild.reset();
+
+    Tree built;
+    buildTree(built, objectBounds, objectAlive);
+    adopt(std::move(built), getObjectCount());
+}
+
+void BoundingVolumeHierarchy::refitSlot(uint32_t node, uint32_t slot, const AABB& bounds)
+{
+    tree.slotArea += Area(bounds) - Area(GetSlot(tree.nodes[node], slot));
+    SetSlot(tree.nodes[node], slot, bounds);
+}
+
+AABB BoundingVolumeHierarchy::computeNodeBounds(uint32_t node) const
+{
+    AABB bounds = AABB::empty();
+
+    for (uint32_t slot = 0; slot < 4; slot++)
+    {
+        if (tree.nodes[node].child[slot] != INVALID)
+            bounds.expand(GetSlot(tree.nodes[node], slot));
+    }
+
+    return bounds;
+}
+
+void BoundingVolumeHierarchy::refit()
+{
+    if (dirtyObjects.empty())
+        return;
+
+    // Parents always have lower indices than their children, so visiting dirty nodes from the
+    // highest index down finishes every child before its parent.
+    std::priority_queue<uint32_t> dirtyNodes;
+    std::vector<uint32_t> queuedLeaves;
+
+    for (uint32_t object : dirtyObjects)
+    {
+        objectDirty[object] = 0;
+
+        uint32_t leaf = tree.objectLeaves[object];
+
+        if (leaf != INVALID)
+            queuedLeaves.push_back(leaf);
+    }
+
+    dirtyObjects.clear();
+
+    std::sort(queuedLeaves.begin(), queuedLeaves.end());
+    queuedLeaves.erase(std::unique(queuedLeaves.begin(), queuedLeaves.end()), queuedLeaves.end());
+
+    uint32_t lastNode = INVALID;
+
+    for (uint32_t leaf : queuedLeaves)
+    {
+        uint32_t node = leaf >> 2, slot = leaf & 3;
+        uint32_t first = tree.nodes[node].child[slot];
+        AABB bounds = AABB::empty();
+
+        for (uint32_t i = first; i < first + tree.nodes[node].count[slot]; i++)
+            bounds.expand(objectBounds[tree.primitives[i]]);
+
+        refitSlot(node, slot, bounds);
+
+        if (node != lastNode)
+            dirtyNodes.push(node);
+
+        lastNode = node;
+    }
+
+    while (!dirtyNodes.empty())
+    {
+        uint32_t node = dirtyNodes.top();
+
+        while (!dirtyNodes.empty() && dirtyNodes.top() == node)
+            dirtyNodes.pop();
+
+        AABB bounds = computeNodeBounds(node);
+        uint32_t parent = tree.nodeParents[node];
+
+        if (parent == INVALID)
+        {
+            tree.rootBounds = bounds;
+            continue;
+        }
+
+        refitSlot(parent >> 2, parent & 3, bounds);
+        dirtyNodes.push(parent >> 2);
+    }
+}
+
+void BoundingVolumeHierarchy::adopt(Tree&& built, uint32_t objectCount)
+{
+    tree = std::move(built);
+    tree.objectLeaves.resize(objectBounds.size(), INVALID);
+
+    // Objects inserted after the snapshot was taken are still waiting for the next build.
+    unindexed.erase(std::remove_if(unindexed.begin(), unindexed.end(), [&](uint32_t object)
+    {
+        return object < objectCount;
+    }), unindexed.end());
+
+    for (uint32_t object : dirtyObjects)
+        objectDirty[object] = 0;
+
+    dirtyObjects.clear();
+
+    // Objects may also have moved while a background build was running, so refit everything
+    // once. Visiting nodes from the back finishes children before their parents.
+    tree.slotArea = 0.0;
+
+    for (uint32_t node = static_cast<uint32_t>(tree.nodes.size()); node-- > 0;)
+    {
+        for (uint32_t slot = 0; slot < 4; slot++)
+        {
+            uint32_t child = tree.nodes[node].child[slot];
+
+            if (child == INVALID)
+                continue;
+
+            AABB bounds = AABB::empty();
+
+            if (tree.nodes[node].count[slot] > 0)
+            {
+                for (uint32_t i = child; i < child + tree.nodes[node].count[slot]; i++)
+                    bounds.expand(objectBounds[tree.primitives[i]]);
+            }
+            else
+            {
+                bounds = computeNodeBounds(child);
+            }
+
+            SetSlot(tree.nodes[node], slot, bounds);
+            tree.slotArea += Area(bounds);
+        }
+    }
+
+    tree.rootBounds = tree.nodes.empty() ? AABB::empty() : computeNodeBounds(0);
+}
+
+void BoundingVolumeHierarchy::maintain(JobSystem& jobs)
+{
+    refit();
+
+    if (pendingBuild != nullptr)
+    {
+        if (!pendingBuild->ready.load(std::memory_order_acquire))
+            return;
+
+        adopt(std::move(pendingBuild->tree), pendingBuild->objectCount);
+        pendingBuild.reset();
+    }
+
+    bool degraded = tree.builtCost > 0.0f && getCost() > tree.builtCost * REBUILD_COST_RATIO;
+    bool tooManyUnindexed = unindexed.size() > std::max(MIN_UNINDEXED_BEFORE_REBUILD, getObjectCount() / 16);
+
+    if (!degraded && !tooManyUnindexed)
+        return;
+
+    auto build = std::make_shared<PendingBuild>();
+    build->objectCount = getObjectCount();
+
+    jobs.submit([build, bounds = objectBounds, alive = objectAlive]()
+    {
+        buildTree(build->tree, bounds, alive);
+        build->ready.store(true, std::memory_order_release);
+    });
+
+    pendingBuild = std::move(build);
+}
+
+float BoundingVolumeHierarchy::getCost() const
+{
+    float rootArea = Area(tree.rootBounds);
+    return rootArea > 0.0f ? static_cast<float>(tree.slotArea / rootArea) : 0.0f;
+}
+
+template<typename Overlaps>
+void BoundingVolumeHierarchy::query(const Overlaps& overlaps, std::vector<uint32_t>& results) const
+{
+    if (!tree.nodes.empty())
+    {
+        std::vector<uint32_t> stack;
+        stack.reserve(64);
+        stack.push_back(0);
+
+        while (!stack.empty())
+        {
+            const BVHNode& node = tree.nodes[stack.back()];
+            stack.pop_back();
+
+            uint32_t mask = overlaps.slots(node) & ValidSlots(node);
+
+            while (mask)
+            {
+                uint32_t slot = CountTrailingZeros(mask);
+                mask &= mask - 1;
+
+                if (node.count[slot] == 0)
+                {
+                    stack.push_back(node.child[slot]);
+                    continue;
+                }
+
+                for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+                {
+                    uint32_t object = tree.primitives[i];
+
+                    if (objectAlive[object] && overlaps.object(objectBounds[object]))
+                        results.push_back(object);
+                }
+            }
+        }
+    }
+
+    for (uint32_t object : unindexed)
+    {
+        if (overlaps.object(objectBounds[object]))
+            results.push_back(object);
+    }
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const
+{
+    struct
+    {
+        const Frustum& frustum;
+
+        uint32_t slots(const BVHNode& node) const { return FrustumSlotMask(node, frustum); }
+        bool object(const AABB& box) const { return frustum.intersects(box); }
+    } overlaps{ frustum };
+
+    query(overlaps, results);
+}
+
+void BoundingVolumeHierarchy::querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& results) const
+{
+    struct
+    {
+        const BoundingSphere& sphere;
+
+        uint32_t slots(const BVHNode& node) const
+        {
+            uint32_t mask = 0;
+
+            for (uint32_t slot = 0; slot < 4; slot++)
+                mask |= (Overlaps(GetSlot(node, slot), sphere) ? 1u : 0u) << slot;
+
+            return mask;
+        }
+
+        bool object(const AABB& box) const { return Overlaps(box, sphere); }
+    } overlaps{ sphere };
+
+    query(overlaps, results);
+}
+
+void BoundingVolumeHierarchy::queryBox(const AABB& box, std::vector<uint32_t>& results) const
+{
+    struct
+    {
+        const AABB& box;
+
+        uint32_t slots(const BVHNode& node) const
+        {
+            uint32_t mask = 0;
+
+            for (uint32_t slot = 0; slot < 4; slot++)
+            {
+                bool overlap = node.minX[slot] <= box.max.x && node.maxX[slot] >= box.min.x &&
+                               node.minY[slot] <= box.max.y && node.maxY[slot] >= box.min.y &&
+                               node.minZ[slot] <= box.max.z && node.maxZ[slot] >= box.min.z;
+
+                mask |= (overlap ? 1u : 0u) << slot;
+            }
+
+            return mask;
+        }
+
+        bool object(const AABB& other) const { return Overlaps(box, other); }
+    } overlaps{ box };
+
+    query(overlaps, results);
+}
+
+RayHit BoundingVolumeHierarchy::raycast(const Ray& ray, float maxDistance, const RayIntersector& intersect) const
+{
+    RayHit hit;
+    float closest = maxDistance;
+
+    glm::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    auto testObject = [&](uint32_t object)
+    {
+        float distance;
+
+        if (!RayBoxDistance(ray, inverseDirection, objectBounds[object], closest, distance))
+            return;
+
+        if (intersect && !intersect(object, ray, distance))
+            return;
+
+        if (distance <= closest)
+        {
+            closest = distance;
+            hit.object = object;
+            hit.distance = distance;
+        }
+    };
+
+    if (!tree.nodes.empty())
+    {
+        struct Entry
+        {
+            uint32_t node;
+            float distance;
+        };
+
+        std::vector<Entry> stack;
+        stack.reserve(64);
+        stack.push_back({ 0, 0.0f });
+
+        while (!stack.empty())
+        {
+            Entry entry = stack.back();
+            stack.pop_back();
+
+            if (entry.distance > closest)
+                continue;
+
+            const BVHNode& node = tree.nodes[entry.node];
+
+            Entry children[4];
+            uint32_t childCount = 0;
+
+            for (uint32_t slot = 0; slot < 4; slot++)
+            {
+                float distance;
+
+                if (node.child[slot] == INVALID || !RayBoxDistance(ray, inverseDirection, GetSlot(node, slot), closest, distance))
+                    continue;
+
+                if (node.count[slot] > 0)
+                {
+                    for (uint32_t i = node.child[slot]; i < node.child[slot] + node.count[slot]; i++)
+                    {
+                        if (objectAlive[tree.primitives[i]])
+                            testObject(tree.primitives[i]);
+                    }
+                }
+                else
+                {
+                    children[childCount++] = { node.child[slot], distance };
+                }
+            }
+
+            // Push the farthest first so the nearest child is visited next and can shrink closest.
+            for (uint32_t i = 1; i < childCount; i++)
+            {
+                for (uint32_t j = i; j > 0 && children[j - 1].distance < children[j].distance; j--)
+                    std::swap(children[j - 1], children[j]);
+            }
+
+            stack.insert(stack.end(), children, children + childCount);
+        }
+    }
+
+    for (uint32_t object : unindexed)
+        testObject(object);
+
+    return hit;
+}
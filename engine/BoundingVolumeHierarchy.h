@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Bounds.h"
+
+class JobSystem;
+
+struct Ray
+{
+    glm::vec3 origin{ 0.0f };
+    glm::vec3 direction{ 0.0f, 0.0f, -1.0f };
+};
+
+struct RayHit
+{
+    uint32_t object = ~0u;
+    float distance = 0.0f;
+
+    bool isHit() const { return object != ~0u; }
+};
+
+// Four children per node, stored as structure of arrays so one node is two cache lines and
+// all four child boxes can be tested together.
+struct alignas(64) BVHNode
+{
+    float minX[4], minY[4], minZ[4];
+    float maxX[4], maxY[4], maxZ[4];
+
+    // When count is zero child is an inner node index (or INVALID for an unused slot),
+    // otherwise it is the first entry in the primitive list of a leaf.
+    uint32_t child[4];
+    uint32_t count[4];
+};
+
+// Scene query acceleration. Built with a binned SAH on load, refitted incrementally as objects
+// move, and rebuilt on a worker thread once refitting has degraded the tree too far.
+class BoundingVolumeHierarchy
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+    // Return true and the hit distance if the ray hits the object, used for exact picking.
+    using RayIntersector = std::function<bool(uint32_t object, const Ray& ray, float& distance)>;
+
+    BoundingVolumeHierarchy() = default;
+    ~BoundingVolumeHierarchy();
+
+    BoundingVolumeHierarchy(const BoundingVolumeHierarchy&) = delete;
+    BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&) = delete;
+
+    uint32_t insert(const AABB& bounds);
+    void remove(uint32_t object);
+    void update(uint32_t object, const AABB& bounds);
+
+    const AABB& getBounds(uint32_t object) const { return objectBounds[object]; }
+    bool isAlive(uint32_t object) const { return objectAlive[object] != 0; }
+
+    // Builds the whole tree on the calling thread.
+    void build();
+
+    // Refits the boxes of every object updated since the last refit, from the leaves up.
+    void refit();
+
+    // Call once per frame: refits, adopts a finished background rebuild, and starts a new one
+    // when the tree has degraded or too many objects were inserted since the last build.
+    void maintain(JobSystem& jobs);
+
+    bool isRebuilding() const { return pendingBuild != nullptr; }
+
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& results) const;
+    void querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& results) const;
+    void queryBox(const AABB& box, std::vector<uint32_t>& results) const;
+
+    // Closest hit along the ray. Without an intersector the distance to the object's box is used.
+    RayHit raycast(const Ray& ray, float maxDistance, const RayIntersector& intersect = nullptr) const;
+
+    uint32_t getObjectCount() const { return static_cast<uint32_t>(objectBounds.size()); }
+    uint32_t getNodeCount() const { return static_cast<uint32_t>(tree.nodes.size()); }
+    uint32_t getUnindexedCount() const { return static_cast<uint32_t>(unindexed.size()); }
+
+    // Sum of the surface areas of all node slots relative to the root, lower is better.
+    float getCost() const;
+
+private:
+    struct Tree
+    {
+        std::vector<BVHNode> nodes;
+        std::vector<uint32_t> nodeParents;   // (parent node << 2) | slot, INVALID for the root
+        std::vector<uint32_t> primitives;    // object indices referenced by leaves
+        std::vector<uint32_t> objectLeaves;  // (node << 2) | slot for every indexed object
+        AABB rootBounds = AABB::empty();
+        double slotArea = 0.0;
+        float builtCost = 0.0f;
+    };
+
+    struct PendingBuild
+    {
+        Tree tree;
+        uint32_t objectCount = 0;
+        std::atomic<bool> ready{ false };
+    };
+
+    struct Builder;
+
+    static void buildTree(Tree& tree, const std::vector<AABB>& bounds, const std::vector<uint8_t>& alive);
+
+    void refitSlot(uint32_t node, uint32_t slot, const AABB& bounds);
+    AABB computeNodeBounds(uint32_t node) const;
+    void adopt(Tree&& built, uint32_t objectCount);
+
+    template<typename Overlaps>
+    void query(const Overlaps& overlaps, std::vector<uint32_t>& results) const;
+
+private:
+    Tree tree;
+
+    std::vector<AABB> objectBounds;
+    std::vector<uint8_t> objectAlive;
+    std::vector<uint8_t> objectDirty;
+    std::vector<uint32_t> dirtyObjects;
+
+    // Objects inserted since the last build, scanned linearly until the next one picks them up.
+    std::vector<uint32_t> unindexed;
+
+    std::shared_ptr<PendingBuild> pendingBuild;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+struct BoundingSphere
+{
+    glm::vec3 center{ 0.0f };
+    float radius = 0.0f;
+};
+
+struct AABB
+{
+    glm::vec3 min{ 0.0f };
+    glm::vec3 max{ 0.0f };
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+    float getSurfaceArea() const
+    {
+        glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    void expand(const glm::vec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    static AABB empty()
+    {
+        return { glm::vec3(3.402823466e+38f), glm::vec3(-3.402823466e+38f) };
+    }
+};
+
+// Points p with dot(normal, p) + distance >= 0 are on the inside.
+struct Plane
+{
+    glm::vec3 normal{ 0.0f };
+    float distance = 0.0f;
+};
+
+struct Frustum
+{
+    enum Side { Left, Right, Bottom, Top, Near, Far, Count };
+
+    Plane planes[Count];
+
+    // Extracts the planes from a Vulkan style projection (depth in [0, 1]).
+    static Frustum fromMatrix(const glm::mat4& viewProjection)
+    {
+        Frustum frustum;
+
+        auto row = [&](int i)
+        {
+            return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        };
+
+        glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+        glm::vec4 sides[Count] = { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r2, r3 - r2 };
+
+        for (int i = 0; i < Count; i++)
+        {
+            glm::vec3 normal(sides[i].x, sides[i].y, sides[i].z);
+            float length = glm::length(normal);
+
+            frustum.planes[i].normal = normal / length;
+            frustum.planes[i].distance = sides[i].w / length;
+        }
+
+        return frustum;
+    }
+
+    bool intersects(const BoundingSphere& sphere) const
+    {
+        for (const auto& plane : planes)
+        {
+            if (glm::dot(plane.normal, sphere.center) + plane.distance < -sphere.radius)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool intersects(const AABB& box) const
+    {
+        glm::vec3 center = box.getCenter();
+        glm::vec3 extents = box.getExtents();
+
+        for (const auto& plane : planes)
+        {
+            float radius = glm::dot(glm::abs(plane.normal), extents);
+
+            if (glm::dot(plane.normal, center) + plane.distance < -radius)
+                return false;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,238 @@
+#include "DrawQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "JobSystem.h"
+
+static constexpr uint32_t RADIX_SIZE = 256;
+static constexpr uint32_t KEY_BYTES = 8;
+
+static constexpr uint32_t MESH_SHIFT = DrawQueue::DEPTH_BITS;
+static constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + DrawQueue::MESH_BITS;
+static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + DrawQueue::MATERIAL_BITS;
+
+static_assert(PIPELINE_SHIFT + DrawQueue::PIPELINE_BITS == 64, "sort key fields must fill 64 bits");
+
+DrawQueue::DrawQueue(JobSystem* jobs)
+    : jobs(jobs)
+{
+}
+
+uint64_t DrawQueue::makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+{
+    // Non negative floats order the same as their bits, so the top of those is a fine depth key.
+    float clamped = depth > 0.0f ? depth : 0.0f;
+
+    uint32_t bits;
+    memcpy(&bits, &clamped, sizeof(bits));
+
+    uint64_t key = bits >> (31 - DEPTH_BITS);
+    key |= uint64_t(mesh & ((1u << MESH_BITS) - 1)) << MESH_SHIFT;
+    key |= uint64_t(material & ((1u << MATERIAL_BITS) - 1)) << MATERIAL_SHIFT;
+    key |= uint64_t(pipeline & ((1u << PIPELINE_BITS) - 1)) << PIPELINE_SHIFT;
+
+    return key;
+}
+
+void DrawQueue::clear()
+{
+    items.clear();
+    keys.clear();
+    order.clear();
+    stats = {};
+}
+
+void DrawQueue::reserve(uint32_t capacity)
+{
+    items.reserve(capacity);
+    keys.reserve(capacity);
+    order.reserve(capacity);
+}
+
+void DrawQueue::add(const DrawItem& item, float depth)
+{
+    // Anything added after a sort goes unsorted until the next one.
+    order.clear();
+
+    items.push_back(item);
+    keys.push_back(makeKey(item.pipeline, item.material, item.mesh, depth));
+}
+
+void DrawQueue::addVisible(const DrawItem* objectItems, const float* objectDepths, const uint32_t* visible, uint32_t count)
+{
+    order.clear();
+
+    uint32_t first = size();
+
+    items.resize(first + count);
+    keys.resize(first + count);
+
+    auto fill = [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const DrawItem& item = objectItems[visible[i]];
+
+            items[first + i] = item;
+            keys[first + i] = makeKey(item.pipeline, item.material, item.mesh, objectDepths[visible[i]]);
+        }
+    };
+
+    if (jobs && count > CHUNK_SIZE)
+        jobs->parallelFor(count, CHUNK_SIZE, fill);
+    else
+        fill(0, count);
+}
+
+void DrawQueue::sort()
+{
+    uint32_t count = size();
+
+    sortedKeys.assign(keys.begin(), keys.end());
+    order.resize(count);
+
+    for (uint32_t i = 0; i < count; i++)
+        order[i] = i;
+
+    radixSort();
+
+    stats.draws = count;
+    stats.submitted = countStateChanges(items, nullptr);
+    stats.sorted = countStateChanges(items, order.data());
+}
+
+void DrawQueue::radixSort()
+{
+    uint32_t count = size();
+
+    if (count < 2)
+        return;
+
+    bool parallel = jobs && count > CHUNK_SIZE;
+    uint32_t chunkSize = parallel ? CHUNK_SIZE : count;
+    uint32_t chunkCount = parallel ? jobs->getChunkCount(count, chunkSize) : 1;
+
+    keyScratch.resize(count);
+    orderScratch.resize(count);
+    histograms.resize(size_t(chunkCount) * RADIX_SIZE);
+
+    // A byte that is the same in every key would leave the order as it is.
+    uint64_t differing = 0;
+
+    for (uint32_t i = 1; i < count; i++)
+        differing |= keys[i] ^ keys[0];
+
+    auto forEachChunk = [&](auto&& function)
+    {
+        if (!parallel)
+        {
+            function(0u);
+            return;
+        }
+
+        jobs->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t chunk = begin; chunk < end; chunk++)
+                function(chunk);
+        });
+    };
+
+    uint64_t* srcKeys = sortedKeys.data();
+    uint64_t* dstKeys = keyScratch.data();
+    uint32_t* srcOrder = order.data();
+    uint32_t* dstOrder = orderScratch.data();
+
+    for (uint32_t byte = 0; byte < KEY_BYTES; byte++)
+    {
+        uint32_t shift = byte * 8;
+
+        if (((differing >> shift) & 0xFF) == 0)
+            continue;
+
+        forEachChunk([&](uint32_t chunk)
+        {
+            uint32_t* histogram = &histograms[size_t(chunk) * RADIX_SIZE];
+            std::fill(histogram, histogram + RADIX_SIZE, 0);
+
+            uint32_t end = std::min(count, (chunk + 1) * chunkSize);
+
+            for (uint32_t i = chunk * chunkSize; i < end; i++)
+                histogram[(srcKeys[i] >> shift) & 0xFF]++;
+        });
+
+        // Digits in order, and within a digit the chunks in order, which keeps the sort stable.
+        uint32_t offset = 0;
+
+        for (uint32_t digit = 0; digit < RADIX_SIZE; digit++)
+        {
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                uint32_t& bucket = histograms[size_t(chunk) * RADIX_SIZE + digit];
+                uint32_t bucketCount = bucket;
+
+                bucket = offset;
+                offset += bucketCount;
+            }
+        }
+
+        forEachChunk([&](uint32_t chunk)
+        {
+            uint32_t* histogram = &histograms[size_t(chunk) * RADIX_SIZE];
+            uint32_t end = std::min(count, (chunk + 1) * chunkSize);
+
+            for (uint32_t i = chunk * chunkSize; i < end; i++)
+            {
+                uint32_t slot = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+                dstKeys[slot] = srcKeys[i];
+                dstOrder[slot] = srcOrder[i];
+            }
+        });
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcOrder, dstOrder);
+    }
+
+    // After an odd number of passes the result is in the scratch buffers.
+    if (srcKeys != sortedKeys.data())
+    {
+        sortedKeys.swap(keyScratch);
+        order.swap(orderScratch);
+    }
+}
+
+DrawStateChanges DrawQueue::countStateChanges(const std::vector<DrawItem>& items, const uint32_t* order)
+{
+    DrawStateChanges changes;
+
+    uint32_t pipeline = ~0u;
+    uint32_t material = ~0u;
+    uint32_t mesh = ~0u;
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const DrawItem& item = items[order ? order[i] : i];
+
+        if (item.pipeline != pipeline)
+        {
+            pipeline = item.pipeline;
+            material = ~0u;
+            mesh = ~0u;
+            changes.pipelines++;
+        }
+
+        if (item.material != material)
+        {
+            material = item.material;
+            changes.materials++;
+        }
+
+        if (item.mesh != mesh)
+        {
+            mesh = item.mesh;
+            changes.meshes++;
+        }
+    }
+
+    return changes;
+}
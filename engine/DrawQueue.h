@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// Pipeline, material and mesh are indices into the recorder's tables.
+struct DrawItem
+{
+    uint32_t pipeline = 0;
+    uint32_t material = 0;
+    uint32_t mesh = 0;
+
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 1;
+
+    // Dynamic offset of the draw's constants in the frame allocator, ~0u when it has none.
+    uint32_t constants = ~0u;
+};
+
+// Binds a draw sequence needs, a pipeline change counts as a material and mesh change too since
+// both are bound again with the new pipeline. A recorder skipping a pipeline that isn't ready
+// skips its binds as well, so the next one can't rely on them.
+struct DrawStateChanges
+{
+    uint32_t pipelines = 0;
+    uint32_t materials = 0;
+    uint32_t meshes = 0;
+};
+
+struct DrawQueueStats
+{
+    uint32_t draws = 0;
+    DrawStateChanges submitted; // in the order draws were added
+    DrawStateChanges sorted;
+};
+
+// Collects a frame's draws and records them sorted by a 64 bit key, so draws sharing state end up
+// next to each other and most binds can be skipped. From the top the key holds the pipeline,
+// material, mesh and depth, nearest first within the same state.
+//
+// The keys are sorted with an LSD radix sort, a byte per pass, histograms and scatters split
+// across the job system. Passes where every key has the same byte are skipped, so narrow indices
+// cost fewer passes.
+class DrawQueue
+{
+public:
+    static constexpr uint32_t PIPELINE_BITS = 12;
+    static constexpr uint32_t MATERIAL_BITS = 16;
+    static constexpr uint32_t MESH_BITS = 16;
+    static constexpr uint32_t DEPTH_BITS = 20;
+
+    // Keys per parallel chunk, smaller queues sort on the calling thread.
+    static constexpr uint32_t CHUNK_SIZE = 16384;
+
+    explicit DrawQueue(JobSystem* jobs = nullptr);
+
+    static uint64_t makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+    void clear();
+    void reserve(uint32_t capacity);
+
+    // Depth is the view space distance, only its order matters.
+    void add(const DrawItem& item, float depth);
+
+    // Adds the draws of the objects FrustumCuller::cull() found visible, straight from its output.
+    // Items and depths are per object, visible holds count object indices.
+    void addVisible(const DrawItem* objectItems, const float* objectDepths, const uint32_t* visible, uint32_t count);
+
+    // Sorts what was added since clear() and updates the stats.
+    void sort();
+
+    // Calls the recorder's bindPipeline, bindMaterial and bindMesh whenever the state changes and
+    // draw for every item, in sorted order once sort() has run.
+    template<typename Recorder>
+    void record(Recorder& recorder) const;
+
+    uint32_t size() const { return static_cast<uint32_t>(items.size()); }
+    const DrawItem& getItem(uint32_t index) const { return items[order.empty() ? index : order[index]]; }
+
+    const DrawQueueStats& getStats() const { return stats; }
+
+    static DrawStateChanges countStateChanges(const std::vector<DrawItem>& items, const uint32_t* order);
+
+private:
+    void radixSort();
+
+private:
+    JobSystem* jobs;
+
+    std::vector<DrawItem> items;
+    std::vector<uint64_t> keys;
+
+    // Indices into items in sorted order, empty until sort().
+    std::vector<uint32_t> order;
+
+    // Ping pong buffers of the sort.
+    std::vector<uint64_t> sortedKeys;
+    std::vector<uint64_t> keyScratch;
+    std::vector<uint32_t> orderScratch;
+    std::vector<uint32_t> histograms;
+
+    DrawQueueStats stats;
+};
+
+template<typename Recorder>
+void DrawQueue::record(Recorder& recorder) const
+{
+    uint32_t count = size();
+
+    uint32_t pipeline = ~0u;
+    uint32_t material = ~0u;
+    uint32_t mesh = ~0u;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const DrawItem& item = getItem(i);
+
+        if (item.pipeline != pipeline)
+        {
+            pipeline = item.pipeline;
+            material = ~0u;
+            mesh = ~0u;
+            recorder.bindPipeline(pipeline);
+        }
+
+        if (item.material != material)
+        {
+            material = item.material;
+            recorder.bindMaterial(material);
+        }
+
+        if (item.mesh != mesh)
+        {
+            mesh = item.mesh;
+            recorder.bindMesh(mesh);
+        }
+
+        recorder.draw(item);
+    }
+}
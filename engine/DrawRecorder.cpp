@@ -0,0 +1,62 @@
+#include "DrawRecorder.h"
+
+#include "Mesh.h"
+
+DrawRecorder::DrawRecorder(VkCommandBuffer commandBuffer, const DrawTables& tables)
+    : commandBuffer(commandBuffer)
+    , tables(tables)
+{
+}
+
+void DrawRecorder::bindPipeline(uint32_t pipeline)
+{
+    const DrawPipeline& entry = tables.pipelines[pipeline];
+
+    skipping = entry.pipeline == VK_NULL_HANDLE;
+
+    if (skipping)
+        return;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.pipeline);
+
+    // Pipelines sharing a layout keep the sets bound, so the constants only need rebinding after
+    // switching to a different one.
+    if (entry.layout != layout)
+        constantsOffset = ~0u;
+
+    layout = entry.layout;
+}
+
+void DrawRecorder::bindMaterial(uint32_t material)
+{
+    if (skipping)
+        return;
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, tables.materialSet, 1, &tables.materials[material], 0, nullptr);
+}
+
+void DrawRecorder::bindMesh(uint32_t mesh)
+{
+    if (skipping)
+        return;
+
+    const Mesh& entry = *tables.meshes[mesh];
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &entry.buffer.buffer, &entry.vertexOffset);
+    vkCmdBindIndexBuffer(commandBuffer, entry.buffer.buffer, entry.indexOffset, entry.indexType);
+}
+
+void DrawRecorder::draw(const DrawItem& item)
+{
+    if (skipping)
+        return;
+
+    // Only the offset changes between draws, the set itself was written once.
+    if (item.constants != ~0u && item.constants != constantsOffset)
+    {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, tables.constantsSet, 1, &tables.constants, 1, &item.constants);
+        constantsOffset = item.constants;
+    }
+
+    vkCmdDrawIndexed(commandBuffer, item.indexCount, item.instanceCount, item.firstIndex, item.vertexOffset, item.firstInstance);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "DrawQueue.h"
+#include "VulkanUtils.h"
+
+struct Mesh;
+
+struct DrawPipeline
+{
+    // Null skips the pipeline's draws, for a variant still compiling with nothing to fall back on.
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    uint32_t constantsOffset = ~0u;
+    bool skipping = false;
+};
+
+// What the indices of a DrawItem refer to.
+struct DrawTables
+{
+    std::vector<DrawPipeline> pipelines;
+    std::vector<VkDescriptorSet> materials;
+    std::vector<const Mesh*> meshes;
+
+    // The set materials are bound to, the sets below it are the caller's, bound once per frame
+    // with layouts every pipeline is compatible with.
+    uint32_t materialSet = 1;
+
+    // The frame allocator's uniform set, bound at each draw's constants offset.
+    VkDescriptorSet constants = VK_NULL_HANDLE;
+    uint32_t constantsSet = 2;
+};
+
+// Records a DrawQueue into a command buffer: queue.record(recorder).
+class DrawRecorder
+{
+public:
+    DrawRecorder(VkCommandBuffer commandBuffer, const DrawTables& tables);
+
+    void bindPipeline(uint32_t pipeline);
+    void bindMaterial(uint32_t material);
+    void bindMesh(uint32_t mesh);
+    void draw(const DrawItem& item);
+
+private:
+    VkCommandBuffer commandBuffer;
+    const DrawTables& tables;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    uint32_t constantsOffset = ~0u;
+    bool skipping = false;
+};
@@ -0,0 +1,134 @@
+#include "FrameAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static VkDescriptorSetLayout CreateLayout(VkDevice device, VkDescriptorType type)
+{
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = type;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    VkDescriptorSetLayout layout;
+    CheckVkResult(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout));
+
+    return layout;
+}
+
+void FrameAllocator::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight, VkDeviceSize capacity)
+{
+    this->device = device;
+    this->framesInFlight = framesInFlight;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // Both are powers of two, so the larger suits either kind of descriptor.
+    alignment = std::max(properties.limits.minUniformBufferOffsetAlignment, properties.limits.minStorageBufferOffsetAlignment);
+    this->capacity = AlignUp(capacity, alignment);
+
+    // Every descriptor reads its whole range from the dynamic offset, so the last allocation of the
+    // last frame needs the range past it to still be inside the buffer.
+    VkDeviceSize size = this->capacity * framesInFlight + std::max(UNIFORM_RANGE, STORAGE_RANGE);
+
+    if (size > UINT32_MAX)
+        throw std::runtime_error("frame allocator too large for 32 bit dynamic offsets.");
+
+    buffer = CreateBuffer(physicalDevice, device, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    uniformLayout = CreateLayout(device, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    storageLayout = CreateLayout(device, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+
+    VkDescriptorPoolSize poolSizes[] =
+    {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 2;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+
+    CheckVkResult(vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool));
+
+    VkDescriptorSetLayout setLayouts[] = { uniformLayout, storageLayout };
+    VkDescriptorSet sets[2];
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 2;
+    allocInfo.pSetLayouts = setLayouts;
+
+    CheckVkResult(vkAllocateDescriptorSets(device, &allocInfo, sets));
+    uniformSet = sets[0];
+    storageSet = sets[1];
+
+    VkDescriptorBufferInfo bufferInfos[] =
+    {
+        { buffer.buffer, 0, UNIFORM_RANGE },
+        { buffer.buffer, 0, STORAGE_RANGE },
+    };
+
+    VkWriteDescriptorSet writes[2]{};
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = sets[i];
+        writes[i].dstBinding = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = poolSizes[i].type;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+
+    beginFrame(0);
+}
+
+void FrameAllocator::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(device, uniformLayout, nullptr);
+    vkDestroyDescriptorSetLayout(device, storageLayout, nullptr);
+    DestroyBuffer(device, buffer);
+
+    device = VK_NULL_HANDLE;
+}
+
+void FrameAllocator::beginFrame(uint32_t frame)
+{
+    frameStart = (frame % framesInFlight) * capacity;
+    head.store(frameStart, std::memory_order_relaxed);
+}
+
+uint8_t* FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize range, uint32_t& offset)
+{
+    // Sizes are rounded up, so every offset handed out stays aligned.
+    VkDeviceSize start = head.fetch_add(AlignUp(size, alignment), std::memory_order_relaxed);
+
+    if (size > range || start + size > frameStart + capacity)
+        throw std::runtime_error("frame allocator out of space, raise its capacity.");
+
+    offset = uint32_t(start);
+    return static_cast<uint8_t*>(buffer.mapped) + start;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+
+#include "VulkanUtils.h"
+
+// Hands out per frame uniform and storage data from one persistently mapped buffer, split into a
+// region per frame in flight. Allocating is an atomic bump, safe from any thread recording draws.
+// Shaders see the data through two descriptor sets made once, a dynamic uniform buffer and a
+// dynamic storage buffer, bound with the offset allocate returned.
+class FrameAllocator
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_CAPACITY = 4ull * 1024 * 1024;
+
+    // How much of the buffer each descriptor covers from its offset, the most one allocation can be.
+    static constexpr VkDeviceSize UNIFORM_RANGE = 16 * 1024;
+    static constexpr VkDeviceSize STORAGE_RANGE = 1024 * 1024;
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight, VkDeviceSize capacity = DEFAULT_CAPACITY);
+    void destroy();
+
+    // Starts handing out the frame's region again. The GPU must be done with the frame that last used it.
+    void beginFrame(uint32_t frame);
+
+    // Returns where to write size bytes and their dynamic offset. Throws when the frame's region is full.
+    uint8_t* allocateUniform(VkDeviceSize size, uint32_t& offset) { return allocate(size, UNIFORM_RANGE, offset); }
+    uint8_t* allocateStorage(VkDeviceSize size, uint32_t& offset) { return allocate(size, STORAGE_RANGE, offset); }
+
+    template <typename T>
+    uint32_t pushUniform(const T& value)
+    {
+        uint32_t offset;
+        memcpy(allocateUniform(sizeof(T), offset), &value, sizeof(T));
+        return offset;
+    }
+
+    VkDescriptorSetLayout getUniformLayout() const { return uniformLayout; }
+    VkDescriptorSetLayout getStorageLayout() const { return storageLayout; }
+    VkDescriptorSet getUniformSet() const { return uniformSet; }
+    VkDescriptorSet getStorageSet() const { return storageSet; }
+
+    VkDeviceSize getUsed() const { return head.load(std::memory_order_relaxed) - frameStart; }
+    VkDeviceSize getCapacity() const { return capacity; }
+
+private:
+    uint8_t* allocate(VkDeviceSize size, VkDeviceSize range, uint32_t& offset);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+
+    GpuBuffer buffer;
+    VkDeviceSize capacity = 0;
+    VkDeviceSize alignment = 0;
+    uint32_t framesInFlight = 0;
+
+    VkDeviceSize frameStart = 0;
+    std::atomic<VkDeviceSize> head = 0;
+
+    VkDescriptorSetLayout uniformLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout storageLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet uniformSet = VK_NULL_HANDLE;
+    VkDescriptorSet storageSet = VK_NULL_HANDLE;
+};
@@ -0,0 +1,334 @@
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "Lz.h"
+
+static void Append(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+static bool Read(const uint8_t*& cursor, const uint8_t* end, void* dst, size_t size)
+{
+    if (size_t(end - cursor) < size)
+        return false;
+
+    // Empty vectors hand over a null dst, which memcpy isn't allowed even for zero bytes.
+    if (size > 0)
+        memcpy(dst, cursor, size);
+
+    cursor += size;
+    return true;
+}
+
+template<typename T>
+static bool ReadArray(const uint8_t*& cursor, const uint8_t* end, std::vector<T>& out, uint32_t count)
+{
+    if (size_t(end - cursor) / sizeof(T) < count)
+        return false;
+
+    out.resize(count);
+    return Read(cursor, end, out.data(), count * sizeof(T));
+}
+
+static size_t PaddedIndexBytes(uint32_t count)
+{
+    return (count * sizeof(ImDrawIdx) + 3) & ~size_t(3);
+}
+
+void CapturedFrame::clear()
+{
+    info = {};
+    lists.clear();
+    draws.clear();
+}
+
+void CapturedFrame::setDrawData(const ImDrawData* drawData)
+{
+    info.displayPos[0] = drawData->DisplayPos.x;
+    info.displayPos[1] = drawData->DisplayPos.y;
+    info.displaySize[0] = drawData->DisplaySize.x;
+    info.displaySize[1] = drawData->DisplaySize.y;
+    info.framebufferScale[0] = drawData->FramebufferScale.x;
+    info.framebufferScale[1] = drawData->FramebufferScale.y;
+    info.listCount = static_cast<uint32_t>(drawData->CmdListsCount);
+
+    lists.resize(info.listCount);
+
+    for (uint32_t i = 0; i < info.listCount; i++)
+    {
+        const ImDrawList* source = drawData->CmdLists[i];
+        CapturedDrawList& list = lists[i];
+
+        list.vertices.assign(source->VtxBuffer.begin(), source->VtxBuffer.end());
+        list.indices.assign(source->IdxBuffer.begin(), source->IdxBuffer.end());
+        list.commands.clear();
+
+        for (const ImDrawCmd& drawCommand : source->CmdBuffer)
+        {
+            CapturedDrawCommand command{};
+
+            if (drawCommand.UserCallback == ImDrawCallback_ResetRenderState)
+                command.flags = CAPTURED_COMMAND_RESET_RENDER_STATE;
+            else if (drawCommand.UserCallback != nullptr)
+                continue;
+
+            command.clipRect[0] = drawCommand.ClipRect.x;
+            command.clipRect[1] = drawCommand.ClipRect.y;
+            command.clipRect[2] = drawCommand.ClipRect.z;
+            command.clipRect[3] = drawCommand.ClipRect.w;
+            command.textureId = (uint64_t)(intptr_t)drawCommand.TextureId;
+            command.vertexOffset = drawCommand.VtxOffset;
+            command.indexOffset = drawCommand.IdxOffset;
+            command.elementCount = drawCommand.ElemCount;
+            list.commands.push_back(command);
+        }
+    }
+}
+
+bool FrameCaptureWriter::open(const char* path, bool compress)
+{
+    close();
+
+    handle = fopen(path, "wb");
+
+    if (!handle)
+        return false;
+
+    this->compress = compress;
+    failed = false;
+    frameCount = 0;
+
+    FrameCaptureHeader header{};
+    header.magic = FRAME_CAPTURE_MAGIC;
+    header.version = FRAME_CAPTURE_VERSION;
+    header.headerSize = sizeof(FrameCaptureHeader);
+    header.vertexSize = sizeof(ImDrawVert);
+    header.indexSize = sizeof(ImDrawIdx);
+
+    failed = fwrite(&header, sizeof(header), 1, handle) != 1;
+    return !failed;
+}
+
+bool FrameCaptureWriter::close()
+{
+    if (!handle)
+        return true;
+
+    bool written = !failed;
+
+    if (written)
+    {
+        written = fseek(handle, offsetof(FrameCaptureHeader, frameCount), SEEK_SET) == 0
+            && fwrite(&frameCount, sizeof(frameCount), 1, handle) == 1;
+    }
+
+    written = fclose(handle) == 0 && written;
+    handle = nullptr;
+
+    return written;
+}
+
+bool FrameCaptureWriter::writeFrame(const CapturedFrame& frame)
+{
+    if (!handle || failed)
+        return false;
+
+    CapturedFrameInfo info = frame.info;
+    info.listCount = static_cast<uint32_t>(frame.lists.size());
+    info.drawCount = static_cast<uint32_t>(frame.draws.size());
+
+    payload.clear();
+    Append(payload, &info, sizeof(info));
+
+    static const uint8_t zeros[4] = {};
+
+    for (const CapturedDrawList& list : frame.lists)
+    {
+        CapturedListInfo listInfo{};
+        listInfo.vertexCount = static_cast<uint32_t>(list.vertices.size());
+        listInfo.indexCount = static_cast<uint32_t>(list.indices.size());
+        listInfo.commandCount = static_cast<uint32_t>(list.commands.size());
+
+        size_t indexBytes = list.indices.size() * sizeof(ImDrawIdx);
+
+        Append(payload, &listInfo, sizeof(listInfo));
+        Append(payload, list.vertices.data(), list.vertices.size() * sizeof(ImDrawVert));
+        Append(payload, list.indices.data(), indexBytes);
+        Append(payload, zeros, PaddedIndexBytes(listInfo.indexCount) - indexBytes);
+        Append(payload, list.commands.data(), list.commands.size() * sizeof(CapturedDrawCommand));
+    }
+
+    Append(payload, frame.draws.data(), frame.draws.size() * sizeof(CapturedDraw));
+
+    if (payload.size() > UINT32_MAX)
+        return false;
+
+    FrameCaptureRecord record{};
+    record.dataSize = static_cast<uint32_t>(payload.size());
+
+    const std::vector<uint8_t>* stored = &payload;
+
+    // UI vertices repeat a lot frame to frame and within one, so this usually pays for itself.
+    if (compress && LzCompress(payload.data(), payload.size(), compressed) < payload.size())
+    {
+        record.flags = FRAME_CAPTURE_COMPRESSED;
+        stored = &compressed;
+    }
+
+    record.storedSize = static_cast<uint32_t>(stored->size());
+
+    failed = fwrite(&record, sizeof(record), 1, handle) != 1
+        || fwrite(stored->data(), 1, stored->size(), handle) != stored->size();
+
+    if (failed)
+        return false;
+
+    frameCount++;
+    return true;
+}
+
+bool FrameCaptureReader::open(const char* path)
+{
+    records.clear();
+
+    if (!file.open(path))
+    {
+        fprintf(stderr, "[capture] failed to open %s\n", path);
+        return false;
+    }
+
+    FrameCaptureHeader header;
+
+    if (file.size() < sizeof(header))
+    {
+        fprintf(stderr, "[capture] %s is too small to be a capture\n", path);
+        return false;
+    }
+
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.magic != FRAME_CAPTURE_MAGIC || header.version != FRAME_CAPTURE_VERSION
+        || header.headerSize < sizeof(header) || header.headerSize > file.size())
+    {
+        fprintf(stderr, "[capture] %s is not a version %u capture\n", path, FRAME_CAPTURE_VERSION);
+        return false;
+    }
+
+    if (header.vertexSize != sizeof(ImDrawVert) || header.indexSize != sizeof(ImDrawIdx))
+    {
+        fprintf(stderr, "[capture] %s was made with a different ImDrawVert or ImDrawIdx\n", path);
+        return false;
+    }
+
+    size_t offset = header.headerSize;
+
+    // An unclosed capture has a count of 0 and possibly a torn last frame, everything whole
+    // before it is still good.
+    while (file.size() - offset >= sizeof(FrameCaptureRecord))
+    {
+        FrameCaptureRecord record;
+        memcpy(&record, file.data() + offset, sizeof(record));
+
+        if (file.size() - offset - sizeof(record) < record.storedSize)
+            break;
+
+        records.push_back(offset);
+        offset += sizeof(record) + record.storedSize;
+    }
+
+    if (header.frameCount != 0 && header.frameCount != records.size())
+    {
+        fprintf(stderr, "[capture] %s holds %zu of its %u frames\n", path, records.size(), header.frameCount);
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameCaptureReader::readFrame(uint32_t index, CapturedFrame& frame)
+{
+    FrameCaptureRecord record;
+    memcpy(&record, file.data() + records[index], sizeof(record));
+
+    const uint8_t* stored = file.data() + records[index] + sizeof(record);
+    const uint8_t* data = stored;
+
+    if (record.flags & FRAME_CAPTURE_COMPRESSED)
+    {
+        payload.resize(record.dataSize);
+
+        if (!LzDecompress(stored, record.storedSize, payload.data(), payload.size()))
+        {
+            fprintf(stderr, "[capture] frame %u is corrupt\n", index);
+            return false;
+        }
+
+        data = payload.data();
+    }
+    else if (record.storedSize != record.dataSize)
+    {
+        fprintf(stderr, "[capture] frame %u is corrupt\n", index);
+        return false;
+    }
+
+    const uint8_t* cursor = data;
+    const uint8_t* end = data + record.dataSize;
+
+    bool valid = Read(cursor, end, &frame.info, sizeof(frame.info))
+        && frame.info.listCount <= record.dataSize / sizeof(CapturedListInfo);
+
+    if (valid)
+        frame.lists.resize(frame.info.listCount);
+
+    for (uint32_t i = 0; valid && i < frame.info.listCount; i++)
+    {
+        CapturedDrawList& list = frame.lists[i];
+        CapturedListInfo listInfo;
+
+        valid = Read(cursor, end, &listInfo, sizeof(listInfo))
+            && ReadArray(cursor, end, list.vertices, listInfo.vertexCount)
+            && ReadArray(cursor, end, list.indices, listInfo.indexCount);
+
+        if (!valid)
+            break;
+
+        size_t padding = PaddedIndexBytes(listInfo.indexCount) - listInfo.indexCount * sizeof(ImDrawIdx);
+        cursor += std::min(padding, size_t(end - cursor));
+
+        valid = ReadArray(cursor, end, list.commands, listInfo.commandCount);
+
+        for (const CapturedDrawCommand& command : list.commands)
+        {
+            if (!valid)
+                break;
+
+            valid = uint64_t(command.indexOffset) + command.elementCount <= list.indices.size()
+                && command.vertexOffset <= list.vertices.size();
+
+            // Every vertex the command draws has to be in the list, not just its first.
+            if (valid && command.elementCount > 0)
+            {
+                auto first = list.indices.begin() + command.indexOffset;
+                ImDrawIdx highest = *std::max_element(first, first + command.elementCount);
+
+                valid = uint64_t(command.vertexOffset) + highest < list.vertices.size();
+            }
+        }
+    }
+
+    valid = valid && ReadArray(cursor, end, frame.draws, frame.info.drawCount) && cursor == end;
+
+    if (!valid)
+    {
+        fprintf(stderr, "[capture] frame %u is corrupt\n", index);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <imgui.h>
+
+#include "DrawQueue.h"
+#include "MappedFile.h"
+
+// Recorded frames of UI draw data and engine draw submissions, for replaying identical workloads
+// against renderer changes without a live session.
+//
+// Layout: FrameCaptureHeader, then per frame a FrameCaptureRecord followed by its payload, LZ
+// compressed when flagged. A payload is CapturedFrameInfo, then per draw list CapturedListInfo
+// with its vertices, indices padded to 4 bytes and commands, then the engine draws.
+
+static constexpr uint32_t FRAME_CAPTURE_MAGIC = 0x50414356; // "VCAP"
+static constexpr uint32_t FRAME_CAPTURE_VERSION = 1;
+
+enum FrameCaptureFlags : uint32_t
+{
+    FRAME_CAPTURE_COMPRESSED = 1 << 0,
+};
+
+enum CapturedCommandFlags : uint32_t
+{
+    // ImDrawCallback_ResetRenderState. Other callbacks point into the capturing process and are
+    // left out.
+    CAPTURED_COMMAND_RESET_RENDER_STATE = 1 << 0,
+};
+
+struct FrameCaptureHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t frameCount; // written on close, 0 if the capture never closed
+
+    // ImGui can be built with other vertex and index types, replay needs the same.
+    uint32_t vertexSize;
+    uint32_t indexSize;
+    uint32_t reserved[2];
+};
+
+struct FrameCaptureRecord
+{
+    uint32_t flags;
+    uint32_t storedSize; // in the file
+    uint32_t dataSize;   // once decompressed
+    uint32_t reserved;
+};
+
+struct CapturedFrameInfo
+{
+    float displayPos[2];
+    float displaySize[2];
+    float framebufferScale[2];
+
+    uint32_t listCount;
+    uint32_t drawCount;
+};
+
+struct CapturedListInfo
+{
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t commandCount;
+    uint32_t reserved;
+};
+
+struct CapturedDrawCommand
+{
+    float clipRect[4];
+    uint64_t textureId;
+    uint32_t vertexOffset;
+    uint32_t indexOffset;
+    uint32_t elementCount;
+    uint32_t flags;
+};
+
+struct CapturedDraw
+{
+    DrawItem item;
+    float depth;
+};
+
+static_assert(sizeof(FrameCaptureHeader) == 32, "frame capture header layout changed");
+static_assert(sizeof(FrameCaptureRecord) == 16, "frame capture record layout changed");
+static_assert(sizeof(CapturedFrameInfo) == 32, "captured frame info layout changed");
+static_assert(sizeof(CapturedListInfo) == 16, "captured list info layout changed");
+static_assert(sizeof(CapturedDrawCommand) == 40, "captured draw command layout changed");
+static_assert(sizeof(CapturedDraw) == 40, "captured draw layout changed");
+
+struct CapturedDrawList
+{
+    std::vector<ImDrawVert> vertices;
+    std::vector<ImDrawIdx> indices;
+    std::vector<CapturedDrawCommand> commands;
+};
+
+// One frame. Lists and their vectors are kept between frames so a steady UI stops allocating.
+struct CapturedFrame
+{
+    CapturedFrameInfo info{};
+    std::vector<CapturedDrawList> lists;
+
+    // What went into the frame's DrawQueue, in the order it was added.
+    std::vector<CapturedDraw> draws;
+
+    void clear();
+
+    // Copies the UI part of the frame, leaving draws as they are.
+    void setDrawData(const ImDrawData* drawData);
+};
+
+class FrameCaptureWriter
+{
+public:
+    ~FrameCaptureWriter() { close(); }
+
+    bool open(const char* path, bool compress = true);
+
+    // Writes the frame count into the header. The file stays readable up to the last whole frame
+    // if the process dies before this.
+    bool close();
+
+    bool writeFrame(const CapturedFrame& frame);
+
+    bool isOpen() const { return handle != nullptr; }
+    uint32_t getFrameCount() const { return frameCount; }
+
+private:
+    FILE* handle = nullptr;
+    bool compress = true;
+    bool failed = false;
+    uint32_t frameCount = 0;
+
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> compressed;
+};
+
+// Validates the records up front, frames are decoded on demand straight from the mapping.
+class FrameCaptureReader
+{
+public:
+    bool open(const char* path);
+
+    uint32_t getFrameCount() const { return static_cast<uint32_t>(records.size()); }
+
+    bool readFrame(uint32_t index, CapturedFrame& frame);
+
+private:
+    MappedFile file;
+    std::vector<size_t> records; // offsets of each FrameCaptureRecord
+    std::vector<uint8_t> payload;
+};
@@ -0,0 +1,73 @@
+#include "FrameScheduler.h"
+
+void FrameScheduler::NextFrameAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    std::lock_guard<std::mutex> lock(scheduler.mutex);
+    scheduler.nextFrameWaiters.push_back(handle);
+}
+
+bool FrameScheduler::GpuAwaiter::await_ready() const
+{
+    return IsComplete(device, fence, semaphore, value);
+}
+
+void FrameScheduler::GpuAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    std::lock_guard<std::mutex> lock(scheduler.mutex);
+    scheduler.gpuWaits.push_back({ device, fence, semaphore, value, handle });
+}
+
+bool FrameScheduler::IsComplete(VkDevice device, VkFence fence, VkSemaphore semaphore, uint64_t value)
+{
+    if (fence != VK_NULL_HANDLE)
+    {
+        VkResult result = vkGetFenceStatus(device, fence);
+
+        if (result != VK_NOT_READY)
+            CheckVkResult(result);
+
+        return result == VK_SUCCESS;
+    }
+
+    uint64_t counter = 0;
+    CheckVkResult(vkGetSemaphoreCounterValue(device, semaphore, &counter));
+
+    return counter >= value;
+}
+
+void FrameScheduler::update()
+{
+    frameIndex++;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        resuming.swap(nextFrameWaiters);
+        polling.swap(gpuWaits);
+    }
+
+    // Polled outside the lock, still waiting ones go back after anything added meanwhile.
+    size_t waiting = 0;
+
+    for (const GpuWait& wait : polling)
+    {
+        if (IsComplete(wait.device, wait.fence, wait.semaphore, wait.value))
+            resuming.push_back(wait.handle);
+        else
+            polling[waiting++] = wait;
+    }
+
+    polling.resize(waiting);
+
+    if (!polling.empty())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        gpuWaits.insert(gpuWaits.end(), polling.begin(), polling.end());
+    }
+
+    polling.clear();
+
+    for (std::coroutine_handle<> handle : resuming)
+        handle.resume();
+
+    resuming.clear();
+}
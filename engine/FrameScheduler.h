@@ -0,0 +1,75 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "VulkanUtils.h"
+
+// Resumes coroutines on the main thread from update(), once a frame: those waiting for the next
+// frame, and those waiting on GPU work that has finished by then. Polling keeps the main thread
+// from ever blocking on the GPU. Awaiting is safe from any thread.
+class FrameScheduler
+{
+public:
+    struct NextFrameAwaiter
+    {
+        FrameScheduler& scheduler;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    struct GpuAwaiter
+    {
+        FrameScheduler& scheduler;
+        VkDevice device;
+        VkFence fence;
+        VkSemaphore semaphore;
+        uint64_t value;
+
+        bool await_ready() const;
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+    };
+
+    // Continues on the main thread at the start of the next update().
+    NextFrameAwaiter nextFrame() { return { *this }; }
+
+    // Continues on the main thread in the first update() after the fence is signalled. Don't reset
+    // the fence until then.
+    GpuAwaiter waitForFence(VkDevice device, VkFence fence) { return { *this, device, fence, VK_NULL_HANDLE, 0 }; }
+
+    // Continues on the main thread in the first update() after the timeline semaphore reaches value.
+    GpuAwaiter waitForTimeline(VkDevice device, VkSemaphore semaphore, uint64_t value) { return { *this, device, VK_NULL_HANDLE, semaphore, value }; }
+
+    // Call once a frame on the main thread.
+    void update();
+
+    uint64_t getFrameIndex() const { return frameIndex; }
+
+private:
+    struct GpuWait
+    {
+        VkDevice device;
+        VkFence fence;
+        VkSemaphore semaphore;
+        uint64_t value;
+        std::coroutine_handle<> handle;
+    };
+
+    static bool IsComplete(VkDevice device, VkFence fence, VkSemaphore semaphore, uint64_t value);
+
+private:
+    std::mutex mutex;
+    std::vector<std::coroutine_handle<>> nextFrameWaiters;
+    std::vector<GpuWait> gpuWaits;
+
+    // Swapped with the lists above each update, so resumed coroutines can wait again right away.
+    std::vector<std::coroutine_handle<>> resuming;
+    std::vector<GpuWait> polling;
+
+    uint64_t frameIndex = 0;
+};
@@ -0,0 +1,499 @@
+#include "FrustumCulling.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "JobSystem.h"
+#include "Simd.h"
+
+static constexpr uint32_t BATCH_PADDING = 16;
+
+static uint32_t PaddedSize(uint32_t count)
+{
+    return (count + BATCH_PADDING - 1) & ~(BATCH_PADDING - 1);
+}
+
+uint32_t SphereBoundsSoA::add(const BoundingSphere& sphere)
+{
+    uint32_t index = count++;
+    uint32_t padded = PaddedSize(count);
+
+    if (centerX.size() < padded)
+    {
+        centerX.resize(padded, 0.0f);
+        centerY.resize(padded, 0.0f);
+        centerZ.resize(padded, 0.0f);
+        radius.resize(padded, 0.0f);
+    }
+
+    set(index, sphere);
+    return index;
+}
+
+void SphereBoundsSoA::set(uint32_t index, const BoundingSphere& sphere)
+{
+    centerX[index] = sphere.center.x;
+    centerY[index] = sphere.center.y;
+    centerZ[index] = sphere.center.z;
+    radius[index] = sphere.radius;
+}
+
+BoundingSphere SphereBoundsSoA::get(uint32_t index) const
+{
+    return { glm::vec3(centerX[index], centerY[index], centerZ[index]), radius[index] };
+}
+
+void SphereBoundsSoA::reserve(uint32_t capacity)
+{
+    uint32_t padded = PaddedSize(capacity);
+
+    centerX.reserve(padded);
+    centerY.reserve(padded);
+    centerZ.reserve(padded);
+    radius.reserve(padded);
+}
+
+void SphereBoundsSoA::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    count = 0;
+}
+
+uint32_t BoxBoundsSoA::add(const AABB& box)
+{
+    uint32_t index = count++;
+    uint32_t padded = PaddedSize(count);
+
+    if (centerX.size() < padded)
+    {
+        centerX.resize(padded, 0.0f);
+        centerY.resize(padded, 0.0f);
+        centerZ.resize(padded, 0.0f);
+        extentX.resize(padded, 0.0f);
+        extentY.resize(padded, 0.0f);
+        extentZ.resize(padded, 0.0f);
+    }
+
+    set(index, box);
+    return index;
+}
+
+void BoxBoundsSoA::set(uint32_t index, const AABB& box)
+{
+    glm::vec3 center = box.getCenter();
+    glm::vec3 extents = box.getExtents();
+
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extents.x;
+    extentY[index] = extents.y;
+    extentZ[index] = extents.z;
+}
+
+AABB BoxBoundsSoA::get(uint32_t index) const
+{
+    glm::vec3 center(centerX[index], centerY[index], centerZ[index]);
+    glm::vec3 extents(extentX[index], extentY[index], extentZ[index]);
+
+    return { center - extents, center + extents };
+}
+
+void BoxBoundsSoA::reserve(uint32_t capacity)
+{
+    uint32_t padded = PaddedSize(capacity);
+
+    centerX.reserve(padded);
+    centerY.reserve(padded);
+    centerZ.reserve(padded);
+    extentX.reserve(padded);
+    extentY.reserve(padded);
+    extentZ.reserve(padded);
+}
+
+void BoxBoundsSoA::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+    count = 0;
+}
+
+// Kernels cull the objects in [begin, end) and write the visible indices to out, returning the count.
+// begin is always a multiple of the batch width.
+
+static uint32_t LaneMask(uint32_t remaining, uint32_t width)
+{
+    return remaining >= width ? (width == 32 ? ~0u : (1u << width) - 1) : (1u << remaining) - 1;
+}
+
+static uint32_t WriteVisible(uint32_t mask, uint32_t base, uint32_t* out, uint32_t written)
+{
+    while (mask)
+    {
+        out[written++] = base + CountTrailingZeros(mask);
+        mask &= mask - 1;
+    }
+
+    return written;
+}
+
+static uint32_t CullSpheresScalar(const Frustum& frustum, const SphereBoundsSoA& spheres, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+
+        for (const auto& plane : frustum.planes)
+        {
+            float distance = plane.normal.x * spheres.centerX[i] + plane.normal.y * spheres.centerY[i] + plane.normal.z * spheres.centerZ[i] + plane.distance;
+            inside &= distance >= -spheres.radius[i];
+        }
+
+        out[written] = i;
+        written += inside ? 1 : 0;
+    }
+
+    return written;
+}
+
+static uint32_t CullBoxesScalar(const Frustum& frustum, const BoxBoundsSoA& boxes, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+
+        for (const auto& plane : frustum.planes)
+        {
+            float distance = plane.normal.x * boxes.centerX[i] + plane.normal.y * boxes.centerY[i] + plane.normal.z * boxes.centerZ[i] + plane.distance;
+            float radius = std::fabs(plane.normal.x) * boxes.extentX[i] + std::fabs(plane.normal.y) * boxes.extentY[i] + std::fabs(plane.normal.z) * boxes.extentZ[i];
+            inside &= distance >= -radius;
+        }
+
+        out[written] = i;
+        written += inside ? 1 : 0;
+    }
+
+    return written;
+}
+
+#if defined(ENGINE_SIMD_X86)
+
+static uint32_t CullSpheresSSE2(const Frustum& frustum, const SphereBoundsSoA& spheres, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+        __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+        __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+        __m128 outside = _mm_setzero_ps();
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(y, _mm_set1_ps(plane.normal.y))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.distance)));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & LaneMask(end - i, 4);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+static uint32_t CullBoxesSSE2(const Frustum& frustum, const BoxBoundsSoA& boxes, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&boxes.centerX[i]);
+        __m128 y = _mm_loadu_ps(&boxes.centerY[i]);
+        __m128 z = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]);
+        __m128 ey = _mm_loadu_ps(&boxes.extentY[i]);
+        __m128 ez = _mm_loadu_ps(&boxes.extentZ[i]);
+        __m128 outside = _mm_setzero_ps();
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.normal.x)), _mm_mul_ps(y, _mm_set1_ps(plane.normal.y))),
+                _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.normal.z)), _mm_set1_ps(plane.distance)));
+
+            __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::fabs(plane.normal.x))), _mm_mul_ps(ey, _mm_set1_ps(std::fabs(plane.normal.y)))),
+                _mm_mul_ps(ez, _mm_set1_ps(std::fabs(plane.normal.z))));
+
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & LaneMask(end - i, 4);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+ENGINE_TARGET_AVX2
+static uint32_t CullSpheresAVX2(const Frustum& frustum, const SphereBoundsSoA& spheres, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+        __m256 outside = _mm256_setzero_ps();
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m256 distance = _mm256_fmadd_ps(x, _mm256_set1_ps(plane.normal.x),
+                _mm256_fmadd_ps(y, _mm256_set1_ps(plane.normal.y),
+                _mm256_fmadd_ps(z, _mm256_set1_ps(plane.normal.z), _mm256_set1_ps(plane.distance))));
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & LaneMask(end - i, 8);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+ENGINE_TARGET_AVX2
+static uint32_t CullBoxesAVX2(const Frustum& frustum, const BoxBoundsSoA& boxes, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&boxes.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&boxes.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&boxes.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]);
+        __m256 ey = _mm256_loadu_ps(&boxes.extentY[i]);
+        __m256 ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+        __m256 outside = _mm256_setzero_ps();
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m256 distance = _mm256_fmadd_ps(x, _mm256_set1_ps(plane.normal.x),
+                _mm256_fmadd_ps(y, _mm256_set1_ps(plane.normal.y),
+                _mm256_fmadd_ps(z, _mm256_set1_ps(plane.normal.z), _mm256_set1_ps(plane.distance))));
+
+            __m256 reach = _mm256_fmadd_ps(ex, _mm256_set1_ps(std::fabs(plane.normal.x)),
+                _mm256_fmadd_ps(ey, _mm256_set1_ps(std::fabs(plane.normal.y)),
+                _mm256_fmadd_ps(ez, _mm256_set1_ps(std::fabs(plane.normal.z)), distance)));
+
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(reach, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & LaneMask(end - i, 8);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+ENGINE_TARGET_AVX512
+static uint32_t CullSpheresAVX512(const Frustum& frustum, const SphereBoundsSoA& spheres, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(&spheres.centerX[i]);
+        __m512 y = _mm512_loadu_ps(&spheres.centerY[i]);
+        __m512 z = _mm512_loadu_ps(&spheres.centerZ[i]);
+        __m512 negRadius = _mm512_sub_ps(_mm512_setzero_ps(), _mm512_loadu_ps(&spheres.radius[i]));
+        __mmask16 outside = 0;
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m512 distance = _mm512_fmadd_ps(x, _mm512_set1_ps(plane.normal.x),
+                _mm512_fmadd_ps(y, _mm512_set1_ps(plane.normal.y),
+                _mm512_fmadd_ps(z, _mm512_set1_ps(plane.normal.z), _mm512_set1_ps(plane.distance))));
+
+            outside |= _mm512_cmp_ps_mask(distance, negRadius, _CMP_LT_OQ);
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(outside) & LaneMask(end - i, 16);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+ENGINE_TARGET_AVX512
+static uint32_t CullBoxesAVX512(const Frustum& frustum, const BoxBoundsSoA& boxes, uint32_t begin, uint32_t end, uint32_t* out)
+{
+    uint32_t written = 0;
+
+    for (uint32_t i = begin; i < end; i += 16)
+    {
+        __m512 x = _mm512_loadu_ps(&boxes.centerX[i]);
+        __m512 y = _mm512_loadu_ps(&boxes.centerY[i]);
+        __m512 z = _mm512_loadu_ps(&boxes.centerZ[i]);
+        __m512 ex = _mm512_loadu_ps(&boxes.extentX[i]);
+        __m512 ey = _mm512_loadu_ps(&boxes.extentY[i]);
+        __m512 ez = _mm512_loadu_ps(&boxes.extentZ[i]);
+        __mmask16 outside = 0;
+
+        for (const auto& plane : frustum.planes)
+        {
+            __m512 distance = _mm512_fmadd_ps(x, _mm512_set1_ps(plane.normal.x),
+                _mm512_fmadd_ps(y, _mm512_set1_ps(plane.normal.y),
+                _mm512_fmadd_ps(z, _mm512_set1_ps(plane.normal.z), _mm512_set1_ps(plane.distance))));
+
+            __m512 reach = _mm512_fmadd_ps(ex, _mm512_set1_ps(std::fabs(plane.normal.x)),
+                _mm512_fmadd_ps(ey, _mm512_set1_ps(std::fabs(plane.normal.y)),
+                _mm512_fmadd_ps(ez, _mm512_set1_ps(std::fabs(plane.normal.z)), distance)));
+
+            outside |= _mm512_cmp_ps_mask(reach, _mm512_setzero_ps(), _CMP_LT_OQ);
+        }
+
+        uint32_t mask = ~static_cast<uint32_t>(outside) & LaneMask(end - i, 16);
+        written = WriteVisible(mask, i, out, written);
+    }
+
+    return written;
+}
+
+#endif // ENGINE_SIMD_X86
+
+FrustumCuller::FrustumCuller(JobSystem* jobs)
+    : jobs(jobs), path(getBestPath())
+{
+}
+
+template<typename Kernel>
+uint32_t FrustumCuller::run(uint32_t count, std::vector<uint32_t>& visible, const Kernel& kernel) const
+{
+    if (visible.size() < count)
+        visible.resize(count);
+
+    uint32_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    if (jobs == nullptr || chunkCount <= 1)
+        return count > 0 ? kernel(0, count, visible.data()) : 0;
+
+    // Every chunk writes into its own slice of the output, which is then compacted in place.
+    // A chunk's destination never reaches past its own slice so the moves can't clobber later chunks.
+    std::vector<uint32_t> chunkCounts(chunkCount);
+
+    jobs->parallelFor(count, CHUNK_SIZE, [&](uint32_t begin, uint32_t end)
+    {
+        chunkCounts[begin / CHUNK_SIZE] = kernel(begin, end, visible.data() + begin);
+    });
+
+    uint32_t total = chunkCounts[0];
+
+    for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        memmove(visible.data() + total, visible.data() + chunk * CHUNK_SIZE, chunkCounts[chunk] * sizeof(uint32_t));
+        total += chunkCounts[chunk];
+    }
+
+    return total;
+}
+
+uint32_t FrustumCuller::cull(const Frustum& frustum, const SphereBoundsSoA& spheres, std::vector<uint32_t>& visible) const
+{
+    auto kernel = [&](uint32_t begin, uint32_t end, uint32_t* out) -> uint32_t
+    {
+        switch (path)
+        {
+#if defined(ENGINE_SIMD_X86)
+        case CullPath::SSE2: return CullSpheresSSE2(frustum, spheres, begin, end, out);
+        case CullPath::AVX2: return CullSpheresAVX2(frustum, spheres, begin, end, out);
+        case CullPath::AVX512: return CullSpheresAVX512(frustum, spheres, begin, end, out);
+#endif
+        default: return CullSpheresScalar(frustum, spheres, begin, end, out);
+        }
+    };
+
+    return run(spheres.size(), visible, kernel);
+}
+
+uint32_t FrustumCuller::cull(const Frustum& frustum, const BoxBoundsSoA& boxes, std::vector<uint32_t>& visible) const
+{
+    auto kernel = [&](uint32_t begin, uint32_t end, uint32_t* out) -> uint32_t
+    {
+        switch (path)
+        {
+#if defined(ENGINE_SIMD_X86)
+        case CullPath::SSE2: return CullBoxesSSE2(frustum, boxes, begin, end, out);
+        case CullPath::AVX2: return CullBoxesAVX2(frustum, boxes, begin, end, out);
+        case CullPath::AVX512: return CullBoxesAVX512(frustum, boxes, begin, end, out);
+#endif
+        default: return CullBoxesScalar(frustum, boxes, begin, end, out);
+        }
+    };
+
+    return run(boxes.size(), visible, kernel);
+}
+
+void FrustumCuller::setPath(CullPath path)
+{
+    this->path = isSupported(path) ? path : getBestPath();
+}
+
+CullPath FrustumCuller::getBestPath()
+{
+    const auto& features = CpuFeatures::get();
+
+    if (features.avx512)
+        return CullPath::AVX512;
+
+    if (features.avx2)
+        return CullPath::AVX2;
+
+    if (features.sse2)
+        return CullPath::SSE2;
+
+    return CullPath::Scalar;
+}
+
+bool FrustumCuller::isSupported(CullPath path)
+{
+    const auto& features = CpuFeatures::get();
+
+    switch (path)
+    {
+    case CullPath::SSE2: return features.sse2;
+    case CullPath::AVX2: return features.avx2;
+    case CullPath::AVX512: return features.avx512;
+    default: return true;
+    }
+}
+
+const char* FrustumCuller::getPathName(CullPath path)
+{
+    switch (path)
+    {
+    case CullPath::SSE2: return "SSE2";
+    case CullPath::AVX2: return "AVX2";
+    case CullPath::AVX512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+
+class JobSystem;
+
+// Structure of arrays storage, padded to a whole number of 16 wide batches so the kernels can
+// always issue full width loads. Padding lanes are masked off by the kernels.
+class SphereBoundsSoA
+{
+public:
+    uint32_t add(const BoundingSphere& sphere);
+    void set(uint32_t index, const BoundingSphere& sphere);
+    BoundingSphere get(uint32_t index) const;
+
+    void reserve(uint32_t capacity);
+    void clear();
+
+    uint32_t size() const { return count; }
+
+public:
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+private:
+    uint32_t count = 0;
+};
+
+class BoxBoundsSoA
+{
+public:
+    uint32_t add(const AABB& box);
+    void set(uint32_t index, const AABB& box);
+    AABB get(uint32_t index) const;
+
+    void reserve(uint32_t capacity);
+    void clear();
+
+    uint32_t size() const { return count; }
+
+public:
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+private:
+    uint32_t count = 0;
+};
+
+enum class CullPath
+{
+    Scalar,
+    SSE2,   // 4 objects per batch
+    AVX2,   // 8 objects per batch
+    AVX512, // 16 objects per batch
+};
+
+class FrustumCuller
+{
+public:
+    // Objects per parallel chunk, must be a multiple of the widest batch.
+    static constexpr uint32_t CHUNK_SIZE = 4096;
+
+    explicit FrustumCuller(JobSystem* jobs = nullptr);
+
+    // Writes the indices of every visible object to the front of visible, in ascending order, and
+    // returns how many there are. The vector is only ever grown so it can be reused between frames.
+    uint32_t cull(const Frustum& frustum, const SphereBoundsSoA& spheres, std::vector<uint32_t>& visible) const;
+    uint32_t cull(const Frustum& frustum, const BoxBoundsSoA& boxes, std::vector<uint32_t>& visible) const;
+
+    void setPath(CullPath path);
+    CullPath getPath() const { return path; }
+
+    static CullPath getBestPath();
+    static bool isSupported(CullPath path);
+    static const char* getPathName(CullPath path);
+
+private:
+    template<typename Kernel>
+    uint32_t run(uint32_t count, std::vector<uint32_t>& visible, const Kernel& kernel) const;
+
+private:
+    JobSystem* jobs;
+    CullPath path;
+};
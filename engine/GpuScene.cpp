@@ -0,0 +1,409 @@
+#include "GpuScene.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Bounds.h"
+#include "Mesh.h"
+#include "PipelineLayoutCache.h"
+#include "ShaderReflection.h"
+#include "StagingUploader.h"
+#include "VirtualFileSystem.h"
+
+static const char* CULL_SHADER_PATH = "shaders/cull.comp.spv";
+static const char* OCCLUSION_SHADER_PATH = "shaders/cull_occlusion.comp.spv";
+
+static constexpr uint32_t CULL_GROUP_SIZE = 64;
+
+static constexpr uint32_t MIN_OBJECT_CAPACITY = 1024;
+static constexpr uint32_t MIN_MESH_CAPACITY = 64;
+
+static VfsFile LoadShader(const VirtualFileSystem& vfs, const char* path)
+{
+    VfsFile file;
+
+    if (!vfs.open(path, file))
+        throw std::runtime_error(std::string("failed to load ") + path + ".");
+
+    return file;
+}
+
+static VkPipeline CreateCullPipeline(VkDevice device, VkPipelineLayout layout, const VfsFile& file)
+{
+    VkShaderModule module = CreateShaderModule(device, file.data(), file.size());
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = module;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = layout;
+
+    VkPipeline pipeline;
+    CheckVkResult(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline));
+
+    vkDestroyShaderModule(device, module, nullptr);
+
+    return pipeline;
+}
+
+// Recreates the buffer when it is smaller than size, at least doubling it. Returns whether it did.
+static bool Reserve(VkPhysicalDevice physicalDevice, VkDevice device, GpuBuffer& buffer, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+    if (buffer.buffer != VK_NULL_HANDLE && buffer.size >= size)
+        return false;
+
+    VkDeviceSize capacity = std::max(size, buffer.size * 2);
+
+    DestroyBuffer(device, buffer);
+    buffer = CreateBuffer(physicalDevice, device, capacity, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    return true;
+}
+
+void GpuScene::init(VkPhysicalDevice physicalDevice, VkDevice device, const VirtualFileSystem& vfs, PipelineLayoutCache& layouts, bool drawIndirectCount)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->drawIndirectCount = drawIndirectCount;
+
+    createPipelines(vfs, layouts);
+
+    VkDescriptorPoolSize poolSizes[] =
+    {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+        { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 2;
+    poolInfo.poolSizeCount = 3;
+    poolInfo.pPoolSizes = poolSizes;
+
+    CheckVkResult(vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool));
+
+    VkDescriptorSetLayout setLayouts[] = { bufferSetLayout, pyramidSetLayout };
+    VkDescriptorSet sets[2];
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 2;
+    allocInfo.pSetLayouts = setLayouts;
+
+    CheckVkResult(vkAllocateDescriptorSets(device, &allocInfo, sets));
+    bufferSet = sets[0];
+    pyramidSet = sets[1];
+
+    paramsBuffer = CreateBuffer(physicalDevice, device, sizeof(GpuCullParams),
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    ensureCapacity(MIN_OBJECT_CAPACITY, MIN_OBJECT_CAPACITY, MIN_MESH_CAPACITY);
+}
+
+void GpuScene::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    DestroyBuffer(device, paramsBuffer);
+    DestroyBuffer(device, objectBuffer);
+    DestroyBuffer(device, drawBuffer);
+    DestroyBuffer(device, countBuffer);
+    DestroyBuffer(device, instanceBuffer);
+
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyPipeline(device, cullPipeline, nullptr);
+    vkDestroyPipeline(device, occlusionPipeline, nullptr);
+
+    meshes.clear();
+    instances.clear();
+    objects.clear();
+    objectCount = 0;
+
+    device = VK_NULL_HANDLE;
+}
+
+void GpuScene::createPipelines(const VirtualFileSystem& vfs, PipelineLayoutCache& layouts)
+{
+    VfsFile cullFile = LoadShader(vfs, CULL_SHADER_PATH);
+    VfsFile occlusionFile = LoadShader(vfs, OCCLUSION_SHADER_PATH);
+
+    ShaderReflection reflections[2];
+
+    if (!ReflectShader(cullFile.data(), cullFile.size(), reflections[0]) || !ReflectShader(occlusionFile.data(), occlusionFile.size(), reflections[1]))
+        throw std::runtime_error("failed to reflect the cull shaders.");
+
+    // Both variants share the layout, the plain one never touches set 1 so it can stay unbound.
+    const PipelineLayout& layout = layouts.getLayout(reflections, 2);
+
+    if (layout.setLayouts.size() != 2)
+        throw std::runtime_error("cull shaders must use descriptor sets 0 and 1.");
+
+    bufferSetLayout = layout.setLayouts[0];
+    pyramidSetLayout = layout.setLayouts[1];
+    pipelineLayout = layout.layout;
+
+    cullPipeline = CreateCullPipeline(device, pipelineLayout, cullFile);
+    occlusionPipeline = CreateCullPipeline(device, pipelineLayout, occlusionFile);
+}
+
+void GpuScene::ensureCapacity(uint32_t objectCapacity, uint32_t instanceCapacity, uint32_t meshCapacity)
+{
+    bool grown = false;
+
+    grown |= Reserve(physicalDevice, device, objectBuffer, VkDeviceSize(objectCapacity) * sizeof(GpuCullObject),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    grown |= Reserve(physicalDevice, device, drawBuffer, VkDeviceSize(objectCapacity) * sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    grown |= Reserve(physicalDevice, device, countBuffer, VkDeviceSize(meshCapacity) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    grown |= Reserve(physicalDevice, device, instanceBuffer, VkDeviceSize(instanceCapacity) * sizeof(glm::mat4),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+    if (grown)
+        writeDescriptors();
+}
+
+void GpuScene::writeDescriptors()
+{
+    VkDescriptorBufferInfo bufferInfos[] =
+    {
+        { paramsBuffer.buffer, 0, VK_WHOLE_SIZE },
+        { objectBuffer.buffer, 0, VK_WHOLE_SIZE },
+        { drawBuffer.buffer, 0, VK_WHOLE_SIZE },
+        { countBuffer.buffer, 0, VK_WHOLE_SIZE },
+    };
+
+    VkWriteDescriptorSet writes[4]{};
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = bufferSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(device, 4, writes, 0, nullptr);
+}
+
+uint32_t GpuScene::addMesh(const Mesh& mesh)
+{
+    meshes.push_back({ &mesh, 0, 0, 0 });
+    layoutDirty = true;
+
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t GpuScene::addInstance(uint32_t mesh, const glm::mat4& transform)
+{
+    if (mesh >= meshes.size())
+        return INVALID;
+
+    instances.push_back({ mesh, transform });
+    meshes[mesh].instanceCount++;
+    layoutDirty = true;
+
+    return static_cast<uint32_t>(instances.size() - 1);
+}
+
+void GpuScene::setTransform(uint32_t instance, const glm::mat4& transform)
+{
+    instances[instance].transform = transform;
+    transformsDirty = true;
+}
+
+void GpuScene::clearInstances()
+{
+    instances.clear();
+
+    for (MeshBatch& batch : meshes)
+        batch.instanceCount = 0;
+
+    layoutDirty = true;
+}
+
+void GpuScene::upload(StagingUploader& uploader)
+{
+    if (!layoutDirty && !transformsDirty)
+        return;
+
+    if (layoutDirty)
+    {
+        // Each mesh owns a contiguous range of draws, one per submesh of each of its instances.
+        uint32_t base = 0;
+
+        for (MeshBatch& batch : meshes)
+        {
+            batch.commandBase = base;
+            batch.commandCount = batch.instanceCount * static_cast<uint32_t>(batch.mesh->submeshes.size());
+            base += batch.commandCount;
+        }
+
+        objectCount = base;
+        batchCount = static_cast<uint32_t>(meshes.size());
+        ensureCapacity(objectCount, static_cast<uint32_t>(instances.size()), static_cast<uint32_t>(meshes.size()));
+    }
+
+    layoutDirty = false;
+    transformsDirty = false;
+
+    if (instances.empty())
+        return;
+
+    // Object i always writes draw i, so the slot doubles as the object's position.
+    std::vector<uint32_t> cursors(meshes.size(), 0);
+    objects.resize(objectCount);
+
+    for (uint32_t i = 0; i < instances.size(); i++)
+    {
+        const Instance& instance = instances[i];
+        const MeshBatch& batch = meshes[instance.mesh];
+
+        float scale = std::max(glm::length(glm::vec3(instance.transform[0])),
+            std::max(glm::length(glm::vec3(instance.transform[1])), glm::length(glm::vec3(instance.transform[2]))));
+
+        for (const Submesh& submesh : batch.mesh->submeshes)
+        {
+            uint32_t slot = batch.commandBase + cursors[instance.mesh]++;
+            glm::vec3 center = glm::vec3(instance.transform * glm::vec4(submesh.bounds.getCenter(), 1.0f));
+
+            GpuCullObject& object = objects[slot];
+            object.sphere = glm::vec4(center, glm::length(submesh.bounds.getExtents()) * scale);
+            object.instanceIndex = i;
+            object.firstIndex = submesh.firstIndex;
+            object.indexCount = submesh.indexCount;
+            object.vertexOffset = submesh.vertexOffset;
+            object.meshIndex = instance.mesh;
+            object.commandBase = batch.commandBase;
+            object.slot = slot;
+            object.pad = 0;
+        }
+    }
+
+    VkCommandBuffer commandBuffer = uploader.getCommandBuffer();
+
+    // Earlier frames' culls and vertex shaders may still be reading the old contents.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    VkDeviceSize stagingOffset;
+    VkDeviceSize transformSize = instances.size() * sizeof(glm::mat4);
+    auto transforms = reinterpret_cast<glm::mat4*>(uploader.allocate(transformSize, alignof(glm::mat4), stagingOffset));
+
+    for (size_t i = 0; i < instances.size(); i++)
+        transforms[i] = instances[i].transform;
+
+    uploader.copyToBuffer(stagingOffset, instanceBuffer.buffer, 0, transformSize);
+
+    if (objectCount > 0)
+    {
+        VkDeviceSize objectSize = objects.size() * sizeof(GpuCullObject);
+        uint8_t* staging = uploader.allocate(objectSize, alignof(GpuCullObject), stagingOffset);
+
+        memcpy(staging, objects.data(), objectSize);
+        uploader.copyToBuffer(stagingOffset, objectBuffer.buffer, 0, objectSize);
+    }
+}
+
+void GpuScene::setDepthPyramid(VkImageView view, VkSampler sampler, VkImageLayout layout, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = layout;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = pyramidSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+    pyramidSize = glm::vec4(float(width), float(height), float(mipCount), 0.0f);
+}
+
+void GpuScene::recordCull(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, bool occlusion)
+{
+    if (objectCount == 0)
+        return;
+
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+
+    GpuCullParams params{};
+
+    for (int i = 0; i < Frustum::Count; i++)
+        params.planes[i] = glm::vec4(frustum.planes[i].normal, frustum.planes[i].distance);
+
+    params.viewProjection = viewProjection;
+    params.pyramidSize = pyramidSize;
+    params.objectCount = objectCount;
+    params.compact = drawIndirectCount ? 1 : 0;
+
+    // The last frame's cull and draws may still be reading what gets overwritten here.
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vkCmdUpdateBuffer(commandBuffer, paramsBuffer.buffer, 0, sizeof(params), &params);
+
+    if (drawIndirectCount)
+        vkCmdFillBuffer(commandBuffer, countBuffer.buffer, 0, VkDeviceSize(batchCount) * sizeof(uint32_t), 0);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkDescriptorSet sets[] = { bufferSet, pyramidSet };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, occlusion ? occlusionPipeline : cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, occlusion ? 2 : 1, sets, 0, nullptr);
+    vkCmdDispatch(commandBuffer, (objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuScene::recordDraws(VkCommandBuffer commandBuffer) const
+{
+    const VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+
+    // Meshes added since the last upload() have no draws or count slot yet.
+    for (uint32_t i = 0; i < batchCount; i++)
+    {
+        const MeshBatch& batch = meshes[i];
+
+        if (batch.commandCount == 0)
+            continue;
+
+        const Mesh& mesh = *batch.mesh;
+
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.buffer.buffer, &mesh.vertexOffset);
+        vkCmdBindIndexBuffer(commandBuffer, mesh.buffer.buffer, mesh.indexOffset, mesh.indexType);
+
+        VkDeviceSize offset = batch.commandBase * stride;
+
+        if (drawIndirectCount)
+            vkCmdDrawIndexedIndirectCount(commandBuffer, drawBuffer.buffer, offset, countBuffer.buffer, i * sizeof(uint32_t), batch.commandCount, stride);
+        else
+            vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer.buffer, offset, batch.commandCount, stride);
+    }
+}
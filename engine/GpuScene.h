@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "VulkanUtils.h"
+
+struct Mesh;
+class PipelineLayoutCache;
+class StagingUploader;
+class VirtualFileSystem;
+
+// Mirrors CullParams in shaders/cull.comp, std140.
+struct GpuCullParams
+{
+    glm::vec4 planes[6];
+    glm::mat4 viewProjection;
+    glm::vec4 pyramidSize; // width, height, mip count
+    uint32_t objectCount;
+    uint32_t compact;
+    uint32_t pad[2];
+};
+
+static_assert(sizeof(GpuCullParams) == 192, "GpuCullParams must match the shader");
+
+// Mirrors CullObject in shaders/cull.comp, std430.
+struct GpuCullObject
+{
+    glm::vec4 sphere;
+    uint32_t instanceIndex;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    uint32_t meshIndex;
+    uint32_t commandBase;
+    uint32_t slot;
+    uint32_t pad;
+};
+
+static_assert(sizeof(GpuCullObject) == 48, "GpuCullObject must match the shader");
+
+// Instances of meshes culled and drawn entirely on the GPU. Every submesh of every instance is
+// one cull object, and a compute pass tests them against the frustum, and optionally a depth
+// pyramid, and writes the indirect draws. Recording a frame costs one dispatch and one indirect
+// draw per mesh however many instances there are.
+//
+// Draws are grouped by mesh since each mesh has its own vertex and index buffer. The firstInstance
+// of every draw is its instance index, for the vertex shader to look up the transform in
+// getInstanceBuffer(). Pipelines and their descriptor sets are the caller's to bind.
+class GpuScene
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+
+    // Uses vkCmdDrawIndexedIndirectCount when drawIndirectCount is enabled on the device, which
+    // lets hidden objects cost nothing at draw time. Needs multiDrawIndirect and
+    // drawIndirectFirstInstance either way. The cull layout comes from layouts, which has to
+    // outlive the scene.
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, const VirtualFileSystem& vfs, PipelineLayoutCache& layouts, bool drawIndirectCount);
+    void destroy();
+
+    // The mesh has to outlive the scene, or at least every frame drawing it.
+    uint32_t addMesh(const Mesh& mesh);
+    uint32_t addInstance(uint32_t mesh, const glm::mat4& transform);
+    void setTransform(uint32_t instance, const glm::mat4& transform);
+    void clearInstances();
+
+    // Records copies of whatever changed since the last call into the uploader's batch. Buffers
+    // grow here, so only call it while no submitted frame is still using the scene.
+    void upload(StagingUploader& uploader);
+
+    // The texture has to hold the farthest depth under each texel in every mip, be in layout and
+    // stay alive for as long as culls with occlusion use it. Level 0 covers the whole viewport.
+    void setDepthPyramid(VkImageView view, VkSampler sampler, VkImageLayout layout, uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // Culls with the camera and writes this frame's draws. Occlusion tests against the depth
+    // pyramid, normally last frame's, so it must have been set. Record outside a render pass.
+    void recordCull(VkCommandBuffer commandBuffer, const glm::mat4& viewProjection, bool occlusion = false);
+
+    // Draws what the last recordCull() wrote, with the caller's pipeline bound.
+    void recordDraws(VkCommandBuffer commandBuffer) const;
+
+    // One mat4 per instance, in instance order.
+    VkBuffer getInstanceBuffer() const { return instanceBuffer.buffer; }
+
+    uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+    uint32_t getObjectCount() const { return objectCount; }
+
+    // What the cull reads and writes, for checking its results. Objects are as of the last
+    // upload(), draws are VkDrawIndexedIndirectCommand and counts one uint32_t per mesh, only
+    // written when the draws are compacted.
+    const std::vector<GpuCullObject>& getObjects() const { return objects; }
+    VkBuffer getDrawBuffer() const { return drawBuffer.buffer; }
+    VkBuffer getCountBuffer() const { return countBuffer.buffer; }
+    bool compactsDraws() const { return drawIndirectCount; }
+
+private:
+    struct MeshBatch
+    {
+        const Mesh* mesh;
+        uint32_t instanceCount;
+        uint32_t commandBase;
+        uint32_t commandCount;
+    };
+
+    struct Instance
+    {
+        uint32_t mesh;
+        glm::mat4 transform;
+    };
+
+    void createPipelines(const VirtualFileSystem& vfs, PipelineLayoutCache& layouts);
+    void ensureCapacity(uint32_t objects, uint32_t instanceCapacity, uint32_t meshCapacity);
+    void writeDescriptors();
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    bool drawIndirectCount = false;
+
+    // Owned by the layout cache.
+    VkDescriptorSetLayout bufferSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout pyramidSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+    VkPipeline occlusionPipeline = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet bufferSet = VK_NULL_HANDLE;
+    VkDescriptorSet pyramidSet = VK_NULL_HANDLE;
+    glm::vec4 pyramidSize{ 0.0f };
+
+    GpuBuffer paramsBuffer;
+    GpuBuffer objectBuffer;
+    GpuBuffer drawBuffer;
+    GpuBuffer countBuffer;
+    GpuBuffer instanceBuffer;
+
+    std::vector<MeshBatch> meshes;
+    std::vector<Instance> instances;
+    std::vector<GpuCullObject> objects;
+    uint32_t objectCount = 0;
+    uint32_t batchCount = 0; // meshes laid out by the last upload(), what the count buffer holds
+
+    bool layoutDirty = false;
+    bool transformsDirty = false;
+};
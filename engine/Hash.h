@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 64 bit non cryptographic hash (MurmurHash64A). Stable across platforms and runs, so it can be
+// written to disk as a content key.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+    const uint64_t m = 0xC6A4A7935BD1E995ull;
+    const int r = 47;
+
+    uint64_t h = seed ^ (size * m);
+
+    auto bytes = static_cast<const uint8_t*>(data);
+    const uint8_t* end = bytes + (size & ~size_t(7));
+
+    for (; bytes != end; bytes += 8)
+    {
+        uint64_t k;
+        memcpy(&k, bytes, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    size_t remaining = size & 7;
+
+    if (remaining > 0)
+    {
+        for (size_t i = remaining; i > 0; i--)
+            h ^= uint64_t(bytes[i - 1]) << (8 * (i - 1));
+
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 12) + (seed >> 4));
+}
@@ -0,0 +1,160 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <memory>
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+
+    for (uint32_t i = 0; i < threadCount; i++)
+        workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wakeCondition.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void JobSystem::submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+
+    wakeCondition.notify_one();
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t chunkSize, const RangeJob& job)
+{
+    if (count == 0)
+        return;
+
+    chunkSize = std::max(chunkSize, 1u);
+    uint32_t chunkCount = getChunkCount(count, chunkSize);
+
+    if (chunkCount == 1)
+    {
+        job(0, count);
+        return;
+    }
+
+    struct Batch
+    {
+        std::atomic<uint32_t> nextChunk{ 0 };
+        std::atomic<uint32_t> finishedChunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    // Helpers that start after the caller has drained every chunk just return, so the batch
+    // has to outlive this call.
+    auto batch = std::make_shared<Batch>();
+
+    auto runChunks = [batch, count, chunkSize, chunkCount, &job]()
+    {
+        uint32_t chunk;
+
+        while ((chunk = batch->nextChunk.fetch_add(1)) < chunkCount)
+        {
+            uint32_t begin = chunk * chunkSize;
+            job(begin, std::min(begin + chunkSize, count));
+
+            if (batch->finishedChunks.fetch_add(1) + 1 == chunkCount)
+            {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->done.notify_all();
+            }
+        }
+    };
+
+    uint32_t helpers = std::min(chunkCount - 1, getThreadCount());
+
+    for (uint32_t i = 0; i < helpers; i++)
+        submit(runChunks);
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&]() { return batch->finishedChunks.load() == chunkCount; });
+}
+
+void JobSystem::waitIdle()
+{
+    // Help out rather than block while there is still queued work.
+    while (runPendingJob())
+        ;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this]() { return queue.empty() && activeJobs == 0; });
+}
+
+bool JobSystem::runPendingJob()
+{
+    Job job;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (queue.empty())
+            return false;
+
+        job = std::move(queue.front());
+        queue.pop_front();
+        activeJobs++;
+    }
+
+    job();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        activeJobs--;
+    }
+
+    idleCondition.notify_all();
+    return true;
+}
+
+void JobSystem::workerLoop()
+{
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            if (stopping && queue.empty())
+                return;
+
+            job = std::move(queue.front());
+            queue.pop_front();
+            activeJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeJobs--;
+        }
+
+        idleCondition.notify_all();
+    }
+}
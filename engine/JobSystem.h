@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(uint32_t begin, uint32_t end)>;
+
+    // A thread count of zero uses one worker per hardware thread, minus the calling thread.
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void submit(Job job);
+
+    // Splits [0, count) into chunks and runs them across the workers. The calling thread
+    // takes chunks too and only returns once every chunk has finished.
+    void parallelFor(uint32_t count, uint32_t chunkSize, const RangeJob& job);
+
+    void waitIdle();
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+    uint32_t getChunkCount(uint32_t count, uint32_t chunkSize) const { return (count + chunkSize - 1) / chunkSize; }
+
+private:
+    void workerLoop();
+    bool runPendingJob();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Job> queue;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+
+    uint32_t activeJobs = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,219 @@
+#include "Lz.h"
+
+#include <cstring>
+
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t MAX_OFFSET = 65535;
+
+// The format requires the last match to end this far before the end of the block, and the last
+// bytes to always be literals, so a decoder can copy in whole words without overrunning.
+static constexpr size_t LAST_LITERALS = 5;
+static constexpr size_t MATCH_LIMIT = 12;
+
+static constexpr uint32_t HASH_BITS = 14;
+
+static uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static uint8_t* WriteLength(uint8_t* out, size_t length)
+{
+    while (length >= 255)
+    {
+        *out++ = 255;
+        length -= 255;
+    }
+
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+static uint8_t* WriteSequence(uint8_t* out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+    uint8_t* token = out++;
+
+    *token = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+
+    if (literalCount >= 15)
+        out = WriteLength(out, literalCount - 15);
+
+    if (literalCount > 0)
+        memcpy(out, literals, literalCount);
+
+    out += literalCount;
+
+    // A sequence without a match only ever ends the block.
+    if (matchLength == 0)
+        return out;
+
+    *out++ = static_cast<uint8_t>(offset);
+    *out++ = static_cast<uint8_t>(offset >> 8);
+
+    size_t extra = matchLength - MIN_MATCH;
+    *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+
+    if (extra >= 15)
+        out = WriteLength(out, extra - 15);
+
+    return out;
+}
+
+size_t LzCompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+uint64_t LzDecompressBound(uint64_t srcSize)
+{
+    return srcSize > UINT64_MAX / 255 ? UINT64_MAX : srcSize * 255;
+}
+
+size_t LzCompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+{
+    out.resize(LzCompressBound(size));
+
+    uint8_t* dst = out.data();
+    const uint8_t* anchor = src;
+
+    if (size > MATCH_LIMIT)
+    {
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+        const uint8_t* ip = src + 1;
+        const uint8_t* matchEnd = src + size - LAST_LITERALS;
+        const uint8_t* searchEnd = src + size - MATCH_LIMIT;
+
+        while (ip < searchEnd)
+        {
+            uint32_t sequence = Read32(ip);
+            uint32_t& slot = table[Hash(sequence)];
+
+            const uint8_t* candidate = src + slot;
+            slot = static_cast<uint32_t>(ip - src);
+
+            if (candidate >= ip || static_cast<size_t>(ip - candidate) > MAX_OFFSET || Read32(candidate) != sequence)
+            {
+                ip++;
+                continue;
+            }
+
+            // Extend backwards over literals that also match.
+            while (ip > anchor && candidate > src && ip[-1] == candidate[-1])
+            {
+                ip--;
+                candidate--;
+            }
+
+            const uint8_t* end = ip + MIN_MATCH;
+
+            while (end < matchEnd && *end == candidate[end - ip])
+                end++;
+
+            dst = WriteSequence(dst, anchor, ip - anchor, ip - candidate, end - ip);
+
+            // Seed the table inside the match so the next search has a nearby candidate.
+            table[Hash(Read32(end - 2))] = static_cast<uint32_t>(end - 2 - src);
+
+            ip = end;
+            anchor = end;
+        }
+    }
+
+    dst = WriteSequence(dst, anchor, src + size - anchor, 0, 0);
+
+    size_t written = dst - out.data();
+    out.resize(written);
+
+    return written;
+}
+
+static bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+{
+    uint8_t byte;
+
+    do
+    {
+        if (ip >= end)
+            return false;
+
+        byte = *ip++;
+        length += byte;
+    }
+    while (byte == 255);
+
+    return true;
+}
+
+bool LzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    const uint8_t* ip = src;
+    const uint8_t* ipEnd = src + srcSize;
+
+    uint8_t* op = dst;
+    uint8_t* opEnd = dst + dstSize;
+
+    while (ip < ipEnd)
+    {
+        uint8_t token = *ip++;
+
+        size_t literalCount = token >> 4;
+
+        if (literalCount == 15 && !ReadLength(ip, ipEnd, literalCount))
+            return false;
+
+        if (literalCount > static_cast<size_t>(ipEnd - ip) || literalCount > static_cast<size_t>(opEnd - op))
+            return false;
+
+        if (literalCount > 0)
+            memcpy(op, ip, literalCount);
+
+        ip += literalCount;
+        op += literalCount;
+
+        if (ip == ipEnd)
+            break;
+
+        if (ipEnd - ip < 2)
+            return false;
+
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - dst))
+            return false;
+
+        size_t matchLength = token & 15;
+
+        if (matchLength == 15 && !ReadLength(ip, ipEnd, matchLength))
+            return false;
+
+        matchLength += MIN_MATCH;
+
+        if (matchLength > static_cast<size_t>(opEnd - op))
+            return false;
+
+        const uint8_t* match = op - offset;
+
+        if (offset >= matchLength)
+        {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        }
+        else
+        {
+            // Overlapping copies repeat the last offset bytes, so they have to go forwards one at a time.
+            for (size_t i = 0; i < matchLength; i++)
+                *op++ = *match++;
+        }
+    }
+
+    return op == opEnd;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Byte oriented LZ77 using the LZ4 block layout: no entropy stage, so decompression runs at
+// memory bandwidth and stays cheaper than the I/O it saves.
+
+// Worst case size of the compressed output for size bytes of input.
+size_t LzCompressBound(size_t size);
+
+// Largest size srcSize compressed bytes can decompress to, each length byte adds at most 255.
+// Lets readers reject a corrupt decompressed size before allocating for it.
+uint64_t LzDecompressBound(uint64_t srcSize);
+
+// Replaces the contents of out with the compressed block and returns its size.
+size_t LzCompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out);
+
+// Decompresses a whole block. Fails on malformed input or if it doesn't produce exactly dstSize bytes.
+bool LzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
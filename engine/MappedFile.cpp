@@ -0,0 +1,167 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+
+        std::swap(mapping, other.mapping);
+        std::swap(length, other.length);
+
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (view == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    mapping = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+
+    if (mapping == nullptr)
+    {
+        CloseHandle(view);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = view;
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapping)
+        UnmapViewOfFile(mapping);
+
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+
+    if (fileHandle)
+        CloseHandle(fileHandle);
+
+    mapping = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+}
+
+void MappedFile::prefetch() const
+{
+    if (!mapping)
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = mapping;
+    range.NumberOfBytes = length;
+
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const char* path)
+{
+    close();
+
+    int file = ::open(path, O_RDONLY);
+
+    if (file < 0)
+        return false;
+
+    struct stat info;
+
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file.
+    ::close(file);
+
+    if (view == MAP_FAILED)
+        return false;
+
+    mapping = view;
+    length = static_cast<size_t>(info.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapping)
+        munmap(mapping, length);
+
+    mapping = nullptr;
+    length = 0;
+}
+
+void MappedFile::prefetch() const
+{
+    if (!mapping)
+        return;
+
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    madvise(mapping, length, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Read only view of a whole file through the OS page cache. Nothing is read until a page is
+// touched, so handing the pointer straight to memcpy or a decompressor costs one copy total.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const char* path);
+    void close();
+
+    // Tells the OS the whole file is about to be read front to back.
+    void prefetch() const;
+
+    bool isOpen() const { return mapping != nullptr; }
+
+    const uint8_t* data() const { return static_cast<const uint8_t*>(mapping); }
+    size_t size() const { return length; }
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,60 @@
+#include "MaterialFile.h"
+
+#include <cstdio>
+
+bool MaterialFileView::open(const uint8_t* data, size_t size)
+{
+    header = nullptr;
+
+    if (size < sizeof(MaterialFileHeader))
+        return false;
+
+    auto candidate = reinterpret_cast<const MaterialFileHeader*>(data);
+
+    if (candidate->magic != MATERIAL_FILE_MAGIC || candidate->version != MATERIAL_FILE_VERSION || candidate->headerSize != sizeof(MaterialFileHeader))
+        return false;
+
+    if (sizeof(MaterialFileHeader) + uint64_t(candidate->materialCount) * sizeof(MaterialFileEntry) > size)
+        return false;
+
+    auto entries = reinterpret_cast<const MaterialFileEntry*>(data + sizeof(MaterialFileHeader));
+
+    // Strings are fixed size, make sure they are all terminated before anyone reads them.
+    for (uint32_t i = 0; i < candidate->materialCount; i++)
+    {
+        if (entries[i].name[MATERIAL_NAME_SIZE - 1] != '\0')
+            return false;
+
+        for (uint32_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; slot++)
+        {
+            if (entries[i].textures[slot][MATERIAL_TEXTURE_PATH_SIZE - 1] != '\0')
+                return false;
+        }
+    }
+
+    header = candidate;
+    materials = entries;
+
+    return true;
+}
+
+bool WriteMaterialFile(const char* path, const std::vector<MaterialFileEntry>& materials)
+{
+    MaterialFileHeader header{};
+    header.magic = MATERIAL_FILE_MAGIC;
+    header.version = MATERIAL_FILE_VERSION;
+    header.headerSize = sizeof(MaterialFileHeader);
+    header.materialCount = static_cast<uint32_t>(materials.size());
+
+    FILE* handle = fopen(path, "wb");
+
+    if (!handle)
+        return false;
+
+    bool written = fwrite(&header, sizeof(header), 1, handle) == 1;
+
+    if (!materials.empty())
+        written = written && fwrite(materials.data(), sizeof(MaterialFileEntry), materials.size(), handle) == materials.size();
+
+    return fclose(handle) == 0 && written;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Engine native material table, one per cooked source. Submeshes refer to materials by index and
+// materials refer to cooked textures by their path relative to the content root.
+
+static constexpr uint32_t MATERIAL_FILE_MAGIC = 0x4C544D56; // "VMTL"
+static constexpr uint32_t MATERIAL_FILE_VERSION = 1;
+static constexpr uint32_t MATERIAL_NAME_SIZE = 64;
+static constexpr uint32_t MATERIAL_TEXTURE_PATH_SIZE = 128;
+
+enum class AlphaMode : uint32_t
+{
+    Opaque,
+    Mask,
+    Blend,
+};
+
+enum MaterialTextureSlot : uint32_t
+{
+    MATERIAL_BASE_COLOR,
+    MATERIAL_NORMAL, // BC5 when block compressed, z has to be rebuilt from x and y
+    MATERIAL_METALLIC_ROUGHNESS,
+    MATERIAL_OCCLUSION,
+    MATERIAL_EMISSIVE,
+    MATERIAL_TEXTURE_COUNT,
+};
+
+struct MaterialFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t materialCount;
+};
+
+struct MaterialFileEntry
+{
+    char name[MATERIAL_NAME_SIZE];
+
+    float baseColor[4];
+    float emissive[3];
+    float metallic;
+    float roughness;
+    float alphaCutoff;
+    AlphaMode alphaMode;
+    uint32_t doubleSided;
+
+    // Empty string when the slot is unused.
+    char textures[MATERIAL_TEXTURE_COUNT][MATERIAL_TEXTURE_PATH_SIZE];
+};
+
+static_assert(sizeof(MaterialFileHeader) == 16, "material file header layout changed");
+static_assert(sizeof(MaterialFileEntry) == 752, "material file entry layout changed");
+
+class MaterialFileView
+{
+public:
+    bool open(const uint8_t* data, size_t size);
+
+    uint32_t getMaterialCount() const { return header->materialCount; }
+    const MaterialFileEntry& getMaterial(uint32_t index) const { return materials[index]; }
+
+private:
+    const MaterialFileHeader* header = nullptr;
+    const MaterialFileEntry* materials = nullptr;
+};
+
+bool WriteMaterialFile(const char* path, const std::vector<MaterialFileEntry>& materials);
@@ -0,0 +1,149 @@
+#include "Mesh.h"
+
+#include <cstdio>
+
+#include "AsyncIO.h"
+#include "FrameScheduler.h"
+#include "StagingUploader.h"
+#include "VirtualFileSystem.h"
+
+VkFormat GetVkFormat(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Float2: return VK_FORMAT_R32G32_SFLOAT;
+    case VertexFormat::Float3: return VK_FORMAT_R32G32B32_SFLOAT;
+    case VertexFormat::Float4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+    case VertexFormat::Half2: return VK_FORMAT_R16G16_SFLOAT;
+    case VertexFormat::Half4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case VertexFormat::Snorm16x2: return VK_FORMAT_R16G16_SNORM;
+    case VertexFormat::Snorm16x4: return VK_FORMAT_R16G16B16A16_SNORM;
+    case VertexFormat::Unorm16x2: return VK_FORMAT_R16G16_UNORM;
+    case VertexFormat::Unorm8x4: return VK_FORMAT_R8G8B8A8_UNORM;
+    case VertexFormat::Snorm8x4: return VK_FORMAT_R8G8B8A8_SNORM;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+static AABB ToAABB(const float min[3], const float max[3])
+{
+    return { glm::vec3(min[0], min[1], min[2]), glm::vec3(max[0], max[1], max[2]) };
+}
+
+static bool UploadMesh(StagingUploader& uploader, const VfsFile& file, const char* path, Mesh& mesh)
+{
+    MeshFileView view;
+
+    if (!view.open(file.data(), file.size()))
+    {
+        fprintf(stderr, "[mesh] %s is not a valid version %d mesh file\n", path, MESH_FILE_VERSION);
+        return false;
+    }
+
+    const MeshFileHeader& header = view.getHeader();
+
+    // The only pass over the payload: mapped file to staging memory, decompressing on the way if needed.
+    VkDeviceSize stagingOffset;
+    uint8_t* staging = uploader.allocate(header.dataSize, MESH_FILE_ALIGNMENT, stagingOffset);
+
+    if (!view.readData(staging))
+    {
+        fprintf(stderr, "[mesh] %s has a corrupt data section\n", path);
+        return false;
+    }
+
+    mesh.buffer = CreateBuffer(uploader.getPhysicalDevice(), uploader.getDevice(), header.dataSize,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uploader.copyToBuffer(stagingOffset, mesh.buffer.buffer, 0, header.dataSize);
+
+    mesh.vertexOffset = header.vertexOffset;
+    mesh.indexOffset = header.indexOffset;
+    mesh.indexType = header.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    mesh.vertexCount = header.vertexCount;
+    mesh.indexCount = header.indexCount;
+
+    mesh.binding.binding = 0;
+    mesh.binding.stride = header.vertexStride;
+    mesh.binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    mesh.attributes.clear();
+
+    for (uint32_t i = 0; i < header.attributeCount; i++)
+    {
+        const MeshFileAttribute& attribute = view.getAttributes()[i];
+
+        VkVertexInputAttributeDescription description{};
+        description.location = static_cast<uint32_t>(attribute.semantic);
+        description.binding = 0;
+        description.format = GetVkFormat(attribute.format);
+        description.offset = attribute.offset;
+
+        mesh.attributes.push_back(description);
+    }
+
+    mesh.submeshes.clear();
+
+    for (uint32_t i = 0; i < header.submeshCount; i++)
+    {
+        const MeshFileSubmesh& source = view.getSubmeshes()[i];
+
+        Submesh submesh;
+        submesh.firstIndex = source.firstIndex;
+        submesh.indexCount = source.indexCount;
+        submesh.vertexOffset = source.vertexOffset;
+        submesh.materialIndex = source.materialIndex;
+        submesh.bounds = ToAABB(source.boundsMin, source.boundsMax);
+
+        mesh.submeshes.push_back(submesh);
+    }
+
+    mesh.bounds = ToAABB(header.boundsMin, header.boundsMax);
+
+    return true;
+}
+
+bool LoadMesh(StagingUploader& uploader, const VirtualFileSystem& vfs, const char* path, Mesh& mesh)
+{
+    VfsFile file;
+
+    if (!vfs.open(path, file))
+    {
+        fprintf(stderr, "[mesh] Failed to open %s\n", path);
+        return false;
+    }
+
+    file.prefetch();
+
+    return UploadMesh(uploader, file, path, mesh);
+}
+
+Task<bool> LoadMeshAsync(StagingUploader& uploader, AsyncIO& io, const VirtualFileSystem& vfs, FrameScheduler& scheduler, std::string path, Mesh& mesh)
+{
+    VfsFile file = co_await io.readAsync(vfs, path.c_str(), IoPriority::Normal);
+
+    if (!file.isOpen())
+    {
+        fprintf(stderr, "[mesh] Failed to read %s\n", path.c_str());
+        co_return false;
+    }
+
+    // The uploader belongs to the main thread.
+    co_await scheduler.nextFrame();
+
+    if (!UploadMesh(uploader, file, path.c_str(), mesh))
+        co_return false;
+
+    uint64_t value = uploader.submit();
+    co_await scheduler.waitForTimeline(uploader.getDevice(), uploader.getTimeline(), value);
+
+    co_return true;
+}
+
+void DestroyMesh(VkDevice device, Mesh& mesh)
+{
+    DestroyBuffer(device, mesh.buffer);
+    mesh = {};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Bounds.h"
+#include "MeshFile.h"
+#include "Task.h"
+#include "VulkanUtils.h"
+
+class AsyncIO;
+class FrameScheduler;
+class StagingUploader;
+class VirtualFileSystem;
+
+struct Submesh
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    uint32_t materialIndex = 0;
+    AABB bounds;
+};
+
+// Vertices and indices share one device local buffer, laid out exactly as in the mesh file.
+struct Mesh
+{
+    GpuBuffer buffer;
+
+    VkDeviceSize vertexOffset = 0;
+    VkDeviceSize indexOffset = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    VkVertexInputBindingDescription binding{};
+    std::vector<VkVertexInputAttributeDescription> attributes;
+
+    std::vector<Submesh> submeshes;
+    AABB bounds;
+};
+
+VkFormat GetVkFormat(VertexFormat format);
+
+// Opens the file through the VFS and records its upload into the uploader's current batch, so many
+// meshes can be loaded with a single submit. The mesh can be drawn once the uploader has been flushed.
+bool LoadMesh(StagingUploader& uploader, const VirtualFileSystem& vfs, const char* path, Mesh& mesh);
+
+// Reads the file in the background, records the upload on the main thread at the start of the next
+// frame and submits it, and finishes on the main thread once the GPU is done with it, when the mesh
+// can be drawn. The mesh has to outlive the task.
+Task<bool> LoadMeshAsync(StagingUploader& uploader, AsyncIO& io, const VirtualFileSystem& vfs, FrameScheduler& scheduler, std::string path, Mesh& mesh);
+void DestroyMesh(VkDevice device, Mesh& mesh);
@@ -0,0 +1,217 @@
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "Lz.h"
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t GetVertexFormatSize(VertexFormat format)
+{
+    switch (format)
+    {
+    case VertexFormat::Float2: return 8;
+    case VertexFormat::Float3: return 12;
+    case VertexFormat::Float4: return 16;
+    case VertexFormat::Half2: return 4;
+    case VertexFormat::Half4: return 8;
+    case VertexFormat::Snorm16x2: return 4;
+    case VertexFormat::Snorm16x4: return 8;
+    case VertexFormat::Unorm16x2: return 4;
+    case VertexFormat::Unorm8x4: return 4;
+    case VertexFormat::Snorm8x4: return 4;
+    }
+
+    return 0;
+}
+
+bool MeshFileView::open(const uint8_t* data, size_t size)
+{
+    header = nullptr;
+
+    if (size < sizeof(MeshFileHeader))
+        return false;
+
+    auto candidate = reinterpret_cast<const MeshFileHeader*>(data);
+
+    if (candidate->magic != MESH_FILE_MAGIC || candidate->version != MESH_FILE_VERSION || candidate->headerSize != sizeof(MeshFileHeader))
+        return false;
+
+    if (candidate->indexSize != 2 && candidate->indexSize != 4)
+        return false;
+
+    uint64_t tablesEnd = sizeof(MeshFileHeader)
+        + uint64_t(candidate->attributeCount) * sizeof(MeshFileAttribute)
+        + uint64_t(candidate->submeshCount) * sizeof(MeshFileSubmesh);
+
+    if (candidate->dataOffset < tablesEnd || candidate->dataOffset % MESH_FILE_ALIGNMENT != 0)
+        return false;
+
+    if (candidate->dataOffset > size || candidate->storedSize > size - candidate->dataOffset)
+        return false;
+
+    if (!(candidate->flags & MESH_FILE_COMPRESSED) && candidate->storedSize != candidate->dataSize)
+        return false;
+
+    // The data size decides the staging allocation, so a corrupt one mustn't get past here.
+    if (candidate->dataSize > LzDecompressBound(candidate->storedSize))
+        return false;
+
+    uint64_t dataSize = candidate->dataSize;
+    uint64_t vertexBytes = uint64_t(candidate->vertexCount) * candidate->vertexStride;
+    uint64_t indexBytes = uint64_t(candidate->indexCount) * candidate->indexSize;
+
+    // Written so a crafted offset can't wrap around.
+    if (vertexBytes > dataSize || candidate->vertexOffset > dataSize - vertexBytes)
+        return false;
+
+    if (indexBytes > dataSize || candidate->indexOffset > dataSize - indexBytes)
+        return false;
+
+    auto attributeTable = reinterpret_cast<const MeshFileAttribute*>(data + sizeof(MeshFileHeader));
+    auto submeshTable = reinterpret_cast<const MeshFileSubmesh*>(attributeTable + candidate->attributeCount);
+
+    for (uint32_t i = 0; i < candidate->attributeCount; i++)
+    {
+        uint32_t formatSize = GetVertexFormatSize(attributeTable[i].format);
+
+        if (formatSize == 0 || attributeTable[i].offset + formatSize > candidate->vertexStride)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < candidate->submeshCount; i++)
+    {
+        const MeshFileSubmesh& submesh = submeshTable[i];
+
+        if (uint64_t(submesh.firstIndex) + submesh.indexCount > candidate->indexCount)
+            return false;
+
+        // The offset is added to every index, so its vertices have to lie in the mesh's.
+        if (submesh.vertexOffset < 0 || uint64_t(submesh.vertexOffset) + submesh.vertexCount > candidate->vertexCount)
+            return false;
+    }
+
+    header = candidate;
+    attributes = attributeTable;
+    submeshes = submeshTable;
+    storedData = data + candidate->dataOffset;
+
+    return true;
+}
+
+bool MeshFileView::readData(uint8_t* dst) const
+{
+    if (!isCompressed())
+    {
+        memcpy(dst, storedData, header->dataSize);
+        return true;
+    }
+
+    return LzDecompress(storedData, header->storedSize, dst, header->dataSize);
+}
+
+std::vector<uint8_t> SerializeMeshFile(const MeshFileData& mesh, bool compress)
+{
+    uint32_t maxIndex = 0;
+
+    for (uint32_t index : mesh.indices)
+        maxIndex = std::max(maxIndex, index);
+
+    uint32_t indexSize = maxIndex <= 0xFFFF ? 2 : 4;
+
+    MeshFileHeader header{};
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.headerSize = sizeof(MeshFileHeader);
+    header.attributeCount = static_cast<uint32_t>(mesh.attributes.size());
+    header.submeshCount = static_cast<uint32_t>(mesh.submeshes.size());
+    header.vertexStride = mesh.vertexStride;
+    header.indexSize = indexSize;
+    header.vertexCount = mesh.vertexCount;
+    header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+
+    // Data section: vertices then indices, each aligned so one GPU buffer can hold both as is.
+    header.vertexOffset = 0;
+    header.indexOffset = AlignUp(mesh.vertices.size(), MESH_FILE_ALIGNMENT);
+    header.dataSize = header.indexOffset + uint64_t(header.indexCount) * indexSize;
+
+    std::vector<uint8_t> data(header.dataSize, 0);
+    memcpy(data.data(), mesh.vertices.data(), mesh.vertices.size());
+
+    if (indexSize == 2)
+    {
+        auto indices = reinterpret_cast<uint16_t*>(data.data() + header.indexOffset);
+
+        for (size_t i = 0; i < mesh.indices.size(); i++)
+            indices[i] = static_cast<uint16_t>(mesh.indices[i]);
+    }
+    else
+    {
+        memcpy(data.data() + header.indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        header.boundsMin[axis] = mesh.submeshes.empty() ? 0.0f : 3.402823466e+38f;
+        header.boundsMax[axis] = mesh.submeshes.empty() ? 0.0f : -3.402823466e+38f;
+    }
+
+    for (const auto& submesh : mesh.submeshes)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], submesh.boundsMin[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], submesh.boundsMax[axis]);
+        }
+    }
+
+    std::vector<uint8_t> compressed;
+
+    if (compress && LzCompress(data.data(), data.size(), compressed) < data.size())
+    {
+        header.flags |= MESH_FILE_COMPRESSED;
+        data.swap(compressed);
+    }
+
+    header.storedSize = data.size();
+
+    uint64_t tablesEnd = sizeof(MeshFileHeader)
+        + mesh.attributes.size() * sizeof(MeshFileAttribute)
+        + mesh.submeshes.size() * sizeof(MeshFileSubmesh);
+
+    header.dataOffset = AlignUp(tablesEnd, MESH_FILE_ALIGNMENT);
+
+    std::vector<uint8_t> file(header.dataOffset + header.storedSize, 0);
+    uint8_t* out = file.data();
+
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+
+    memcpy(out, mesh.attributes.data(), mesh.attributes.size() * sizeof(MeshFileAttribute));
+    out += mesh.attributes.size() * sizeof(MeshFileAttribute);
+
+    memcpy(out, mesh.submeshes.data(), mesh.submeshes.size() * sizeof(MeshFileSubmesh));
+
+    memcpy(file.data() + header.dataOffset, data.data(), data.size());
+
+    return file;
+}
+
+bool WriteMeshFile(const char* path, const MeshFileData& mesh, bool compress)
+{
+    std::vector<uint8_t> file = SerializeMeshFile(mesh, compress);
+
+    FILE* handle = fopen(path, "wb");
+
+    if (!handle)
+        return false;
+
+    bool written = fwrite(file.data(), 1, file.size(), handle) == file.size();
+
+    return fclose(handle) == 0 && written;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Engine native mesh container. The data section holds the vertex and index streams exactly as
+// they sit in the GPU buffer, so loading is a copy (or decompression) from the file mapping into
+// staging memory and nothing else.
+//
+// Layout: MeshFileHeader, attributeCount MeshFileAttribute, submeshCount MeshFileSubmesh,
+// padding up to dataOffset, then the data section (LZ compressed as a whole when flagged).
+
+static constexpr uint32_t MESH_FILE_MAGIC = 0x48534D56; // "VMSH"
+static constexpr uint32_t MESH_FILE_VERSION = 1;
+
+// Alignment of the data section in the file and of each stream inside it. Covers every buffer
+// offset alignment Vulkan can ask for and keeps the section page friendly.
+static constexpr uint32_t MESH_FILE_ALIGNMENT = 256;
+
+enum MeshFileFlags : uint32_t
+{
+    MESH_FILE_COMPRESSED = 1 << 0,
+};
+
+// Doubles as the vertex shader input location.
+enum class VertexSemantic : uint32_t
+{
+    Position,
+    Normal,
+    Tangent,
+    TexCoord0,
+    TexCoord1,
+    Color,
+};
+
+enum class VertexFormat : uint32_t
+{
+    Float2,
+    Float3,
+    Float4,
+    Half2,
+    Half4,
+    Snorm16x2,
+    Snorm16x4,
+    Unorm16x2,
+    Unorm8x4,
+    Snorm8x4,
+};
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t headerSize;
+
+    uint32_t attributeCount;
+    uint32_t submeshCount;
+    uint32_t vertexStride;
+    uint32_t indexSize; // 2 or 4
+
+    uint32_t vertexCount;
+    uint32_t indexCount;
+
+    uint64_t dataOffset;   // from the start of the file
+    uint64_t dataSize;     // once decompressed
+    uint64_t storedSize;   // in the file
+    uint64_t vertexOffset; // from the start of the data section
+    uint64_t indexOffset;
+
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshFileAttribute
+{
+    VertexSemantic semantic;
+    VertexFormat format;
+    uint32_t offset;
+    uint32_t reserved;
+};
+
+struct MeshFileSubmesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t materialIndex;
+    uint32_t reserved;
+
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+static_assert(sizeof(MeshFileHeader) == 104, "mesh file header layout changed");
+static_assert(sizeof(MeshFileAttribute) == 16, "mesh file attribute layout changed");
+static_assert(sizeof(MeshFileSubmesh) == 48, "mesh file submesh layout changed");
+
+uint32_t GetVertexFormatSize(VertexFormat format);
+
+// Validates a mesh file in place. Nothing is copied, every accessor points into the given memory.
+class MeshFileView
+{
+public:
+    bool open(const uint8_t* data, size_t size);
+
+    const MeshFileHeader& getHeader() const { return *header; }
+    const MeshFileAttribute* getAttributes() const { return attributes; }
+    const MeshFileSubmesh* getSubmeshes() const { return submeshes; }
+
+    bool isCompressed() const { return (header->flags & MESH_FILE_COMPRESSED) != 0; }
+
+    // The data section as stored, possibly compressed.
+    const uint8_t* getStoredData() const { return storedData; }
+
+    // Writes getHeader().dataSize bytes of vertex and index data to dst.
+    bool readData(uint8_t* dst) const;
+
+private:
+    const MeshFileHeader* header = nullptr;
+    const MeshFileAttribute* attributes = nullptr;
+    const MeshFileSubmesh* submeshes = nullptr;
+    const uint8_t* storedData = nullptr;
+};
+
+// Source data for WriteMeshFile, vertices already interleaved in their final format.
+struct MeshFileData
+{
+    std::vector<MeshFileAttribute> attributes;
+    std::vector<MeshFileSubmesh> submeshes;
+
+    uint32_t vertexStride = 0;
+    uint32_t vertexCount = 0;
+    std::vector<uint8_t> vertices;
+
+    std::vector<uint32_t> indices;
+};
+
+// Serializes the mesh, picking 16 bit indices when they fit. The data section is only stored
+// compressed when that actually makes it smaller.
+std::vector<uint8_t> SerializeMeshFile(const MeshFileData& mesh, bool compress);
+bool WriteMeshFile(const char* path, const MeshFileData& mesh, bool compress);
@@ -0,0 +1,270 @@
+#include "MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "JobSystem.h"
+#include "Simd.h"
+
+struct SrgbTables
+{
+    // sRGB to linear for the first 256 entries, then the value itself for alpha, so one
+    // lookup with the alpha index offset by 256 converts a whole texel.
+    float toLinear[512];
+
+    // Linear in steps of 1/65535 to sRGB.
+    uint8_t toSrgb[65536];
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            float c = i / 255.0f;
+            toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            toLinear[256 + i] = static_cast<float>(i);
+        }
+
+        for (int i = 0; i < 65536; i++)
+        {
+            float c = i / 65535.0f;
+            c = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+        }
+    }
+};
+
+static const SrgbTables& GetSrgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+// Every path sums the four texels as (top left + bottom left) + (top right + bottom right) and
+// rounds the same way, so their output matches to the byte.
+static void DownsampleScalar(const uint8_t* row0, const uint8_t* row1, uint32_t width, bool srgb, uint8_t* out, uint32_t begin, uint32_t end)
+{
+    const SrgbTables& tables = GetSrgbTables();
+
+    for (uint32_t x = begin; x < end; x++)
+    {
+        uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+
+        const uint8_t* t0 = row0 + x0 * 4;
+        const uint8_t* t1 = row0 + x1 * 4;
+        const uint8_t* t2 = row1 + x0 * 4;
+        const uint8_t* t3 = row1 + x1 * 4;
+
+        for (int c = 0; c < 4; c++)
+        {
+            if (srgb && c < 3)
+            {
+                const float* linear = tables.toLinear;
+                float sum = (linear[t0[c]] + linear[t2[c]]) + (linear[t1[c]] + linear[t3[c]]);
+                out[x * 4 + c] = tables.toSrgb[lrintf(sum * 0.25f * 65535.0f)];
+            }
+            else
+            {
+                out[x * 4 + c] = static_cast<uint8_t>((t0[c] + t1[c] + t2[c] + t3[c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+#if defined(ENGINE_SIMD_X86)
+
+static uint32_t DownsampleSSE2(const uint8_t* row0, const uint8_t* row1, uint32_t width, bool srgb, uint8_t* out, uint32_t end)
+{
+    uint32_t x = 0;
+
+    if (srgb)
+    {
+        const SrgbTables& tables = GetSrgbTables();
+        const float* linear = tables.toLinear;
+
+        for (; x < end && x * 2 + 2 <= width; x++)
+        {
+            const uint8_t* t0 = row0 + x * 8;
+            const uint8_t* t1 = t0 + 4;
+            const uint8_t* t2 = row1 + x * 8;
+            const uint8_t* t3 = t2 + 4;
+
+            __m128 f0 = _mm_setr_ps(linear[t0[0]], linear[t0[1]], linear[t0[2]], linear[256 + t0[3]]);
+            __m128 f1 = _mm_setr_ps(linear[t1[0]], linear[t1[1]], linear[t1[2]], linear[256 + t1[3]]);
+            __m128 f2 = _mm_setr_ps(linear[t2[0]], linear[t2[1]], linear[t2[2]], linear[256 + t2[3]]);
+            __m128 f3 = _mm_setr_ps(linear[t3[0]], linear[t3[1]], linear[t3[2]], linear[256 + t3[3]]);
+
+            __m128 average = _mm_mul_ps(_mm_add_ps(_mm_add_ps(f0, f2), _mm_add_ps(f1, f3)), _mm_set1_ps(0.25f));
+
+            alignas(16) int32_t color[4], alpha[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(color), _mm_cvtps_epi32(_mm_mul_ps(average, _mm_set1_ps(65535.0f))));
+            _mm_store_si128(reinterpret_cast<__m128i*>(alpha), _mm_cvttps_epi32(_mm_add_ps(average, _mm_set1_ps(0.5f))));
+
+            out[x * 4 + 0] = tables.toSrgb[color[0]];
+            out[x * 4 + 1] = tables.toSrgb[color[1]];
+            out[x * 4 + 2] = tables.toSrgb[color[2]];
+            out[x * 4 + 3] = static_cast<uint8_t>(alpha[3]);
+        }
+
+        return x;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+
+    for (; x + 2 <= end && x * 2 + 4 <= width; x += 2)
+    {
+        __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+        __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+        // Texels 0 and 1 in the low half, 2 and 3 in the high half.
+        __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, sum));
+    }
+
+    return x;
+}
+
+ENGINE_TARGET_AVX2
+static uint32_t DownsampleAVX2(const uint8_t* row0, const uint8_t* row1, uint32_t width, bool srgb, uint8_t* out, uint32_t end)
+{
+    // sRGB is bound by the table lookups either side of the filter, which wider registers do not help.
+    if (srgb)
+        return DownsampleSSE2(row0, row1, width, srgb, out, end);
+
+    uint32_t x = 0;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i two = _mm256_set1_epi16(2);
+
+    for (; x + 4 <= end && x * 2 + 8 <= width; x += 4)
+    {
+        __m256i top = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8));
+        __m256i bottom = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8));
+
+        // Same as SSE2 within each 128 bit lane, which hold texels 0 to 3 and 4 to 7.
+        __m256i left = _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+        __m256i right = _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+
+        __m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(left, right), _mm256_unpackhi_epi64(left, right));
+        sum = _mm256_srli_epi16(_mm256_add_epi16(sum, two), 2);
+
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm256_castsi256_si128(packed));
+    }
+
+    return x;
+}
+
+#endif // ENGINE_SIMD_X86
+
+MipGenerator::MipGenerator(JobSystem* jobs)
+    : jobs(jobs), path(getBestPath())
+{
+}
+
+void MipGenerator::downsample(const uint8_t* source, uint32_t width, uint32_t height, bool srgb, uint8_t* out) const
+{
+    uint32_t mipWidth = std::max(width >> 1, 1u);
+    uint32_t mipHeight = std::max(height >> 1, 1u);
+
+    // Loads the tables before any worker races to.
+    if (srgb)
+        GetSrgbTables();
+
+    auto downsampleRows = [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t y = begin; y < end; y++)
+        {
+            const uint8_t* row0 = source + size_t(std::min(y * 2, height - 1)) * width * 4;
+            const uint8_t* row1 = source + size_t(std::min(y * 2 + 1, height - 1)) * width * 4;
+            uint8_t* row = out + size_t(y) * mipWidth * 4;
+
+            uint32_t done = 0;
+
+            switch (path)
+            {
+#if defined(ENGINE_SIMD_X86)
+            case MipPath::SSE2:
+                done = DownsampleSSE2(row0, row1, width, srgb, row, mipWidth);
+                break;
+            case MipPath::AVX2:
+                done = DownsampleAVX2(row0, row1, width, srgb, row, mipWidth);
+                break;
+#endif
+            default:
+                break;
+            }
+
+            DownsampleScalar(row0, row1, width, srgb, row, done, mipWidth);
+        }
+    };
+
+    if (jobs)
+        jobs->parallelFor(mipHeight, CHUNK_ROWS, downsampleRows);
+    else
+        downsampleRows(0, mipHeight);
+}
+
+void MipGenerator::generate(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, bool srgb, uint32_t mipCount) const
+{
+    for (uint32_t level = 1; level < mips.size(); level++)
+    {
+        width = std::max(width >> 1, 1u);
+        height = std::max(height >> 1, 1u);
+    }
+
+    while (mips.size() < mipCount)
+    {
+        std::vector<uint8_t> mip(size_t(std::max(width >> 1, 1u)) * std::max(height >> 1, 1u) * 4);
+        downsample(mips.back().data(), width, height, srgb, mip.data());
+        mips.push_back(std::move(mip));
+
+        width = std::max(width >> 1, 1u);
+        height = std::max(height >> 1, 1u);
+    }
+}
+
+void MipGenerator::setPath(MipPath path)
+{
+    this->path = isSupported(path) ? path : getBestPath();
+}
+
+MipPath MipGenerator::getBestPath()
+{
+    const auto& features = CpuFeatures::get();
+
+    if (features.avx2)
+        return MipPath::AVX2;
+
+    if (features.sse2)
+        return MipPath::SSE2;
+
+    return MipPath::Scalar;
+}
+
+bool MipGenerator::isSupported(MipPath path)
+{
+    const auto& features = CpuFeatures::get();
+
+    switch (path)
+    {
+    case MipPath::SSE2: return features.sse2;
+    case MipPath::AVX2: return features.avx2;
+    default: return true;
+    }
+}
+
+const char* MipGenerator::getPathName(MipPath path)
+{
+    switch (path)
+    {
+    case MipPath::SSE2: return "SSE2";
+    case MipPath::AVX2: return "AVX2";
+    default: return "Scalar";
+    }
+}
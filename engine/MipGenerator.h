@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+enum class MipPath
+{
+    Scalar,
+    SSE2, // 1 texel per batch for sRGB, 2 for linear
+    AVX2, // 4 texels per batch for linear, sRGB as SSE2
+};
+
+// Builds mip chains for RGBA8 images on the CPU with a 2x2 box filter. Odd edges reuse the last
+// row or column. Color channels of sRGB images are averaged in linear space, alpha is always
+// linear. Every path gives the same bytes.
+class MipGenerator
+{
+public:
+    // Destination rows per parallel chunk.
+    static constexpr uint32_t CHUNK_ROWS = 16;
+
+    explicit MipGenerator(JobSystem* jobs = nullptr);
+
+    // Writes the next level down, max(width >> 1, 1) by max(height >> 1, 1) tightly packed texels.
+    void downsample(const uint8_t* source, uint32_t width, uint32_t height, bool srgb, uint8_t* out) const;
+
+    // Appends levels to mips, which holds at least the top level, until it has mipCount of them.
+    void generate(std::vector<std::vector<uint8_t>>& mips, uint32_t width, uint32_t height, bool srgb, uint32_t mipCount) const;
+
+    void setPath(MipPath path);
+    MipPath getPath() const { return path; }
+
+    static MipPath getBestPath();
+    static bool isSupported(MipPath path);
+    static const char* getPathName(MipPath path);
+
+private:
+    JobSystem* jobs;
+    MipPath path;
+};
@@ -0,0 +1,278 @@
+#include "PackFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "Hash.h"
+#include "Lz.h"
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Only keep a compressed entry when it saves at least an eighth, below that the in place view
+// of a stored entry is worth more than the bytes.
+static bool IsWorthCompressing(size_t size, size_t compressedSize)
+{
+    return compressedSize < size - size / 8;
+}
+
+std::string NormalizePackPath(const char* path)
+{
+    std::string normalized;
+    normalized.reserve(strlen(path));
+
+    const char* component = path;
+
+    while (true)
+    {
+        const char* end = component;
+
+        while (*end != '\0' && *end != '/' && *end != '\\')
+            end++;
+
+        size_t length = end - component;
+
+        if (length > 0 && !(length == 1 && component[0] == '.'))
+        {
+            if (!normalized.empty())
+                normalized += '/';
+
+            normalized.append(component, length);
+        }
+
+        if (*end == '\0')
+            break;
+
+        component = end + 1;
+    }
+
+    return normalized;
+}
+
+uint64_t HashPackPath(const std::string& normalizedPath)
+{
+    return HashBytes(normalizedPath.data(), normalizedPath.size(), PACK_FILE_HASH_SEED);
+}
+
+bool PackFileView::open(const uint8_t* data, size_t size)
+{
+    header = nullptr;
+
+    if (size < sizeof(PackFileHeader))
+        return false;
+
+    auto candidate = reinterpret_cast<const PackFileHeader*>(data);
+
+    if (candidate->magic != PACK_FILE_MAGIC || candidate->version != PACK_FILE_VERSION || candidate->headerSize != sizeof(PackFileHeader))
+        return false;
+
+    uint64_t tableEnd = sizeof(PackFileHeader) + uint64_t(candidate->entryCount) * sizeof(PackFileEntry);
+
+    if (candidate->namesOffset < tableEnd || candidate->namesOffset > size || candidate->namesSize > size - candidate->namesOffset)
+        return false;
+
+    if (candidate->dataOffset < candidate->namesOffset + candidate->namesSize || candidate->dataOffset > size)
+        return false;
+
+    auto entryTable = reinterpret_cast<const PackFileEntry*>(data + sizeof(PackFileHeader));
+
+    for (uint32_t i = 0; i < candidate->entryCount; i++)
+    {
+        const PackFileEntry& entry = entryTable[i];
+
+        if (i > 0 && entry.pathHash < entryTable[i - 1].pathHash)
+            return false;
+
+        if (uint64_t(entry.nameOffset) + entry.nameSize > candidate->namesSize)
+            return false;
+
+        if (entry.offset < candidate->dataOffset || entry.offset % PACK_FILE_ALIGNMENT != 0)
+            return false;
+
+        if (entry.offset > size || entry.storedSize > size - entry.offset)
+            return false;
+
+        if (!(entry.flags & PACK_ENTRY_COMPRESSED) && entry.storedSize != entry.size)
+            return false;
+
+        // Readers allocate the decompressed size up front, so it has to be one the stored bytes
+        // could actually expand to.
+        if (entry.size > LzDecompressBound(entry.storedSize))
+            return false;
+    }
+
+    this->data = data;
+    header = candidate;
+    entries = entryTable;
+    names = reinterpret_cast<const char*>(data + candidate->namesOffset);
+
+    return true;
+}
+
+std::string PackFileView::getEntryName(const PackFileEntry& entry) const
+{
+    return std::string(names + entry.nameOffset, entry.nameSize);
+}
+
+const PackFileEntry* PackFileView::find(const std::string& normalizedPath, uint64_t pathHash) const
+{
+    const PackFileEntry* end = entries + header->entryCount;
+
+    const PackFileEntry* entry = std::lower_bound(entries, end, pathHash,
+        [](const PackFileEntry& entry, uint64_t hash) { return entry.pathHash < hash; });
+
+    // Different paths with the same hash sit next to each other, the name settles it.
+    for (; entry != end && entry->pathHash == pathHash; entry++)
+    {
+        if (entry->nameSize == normalizedPath.size() && memcmp(names + entry->nameOffset, normalizedPath.data(), entry->nameSize) == 0)
+            return entry;
+    }
+
+    return nullptr;
+}
+
+bool PackFileView::readEntry(const PackFileEntry& entry, uint8_t* dst) const
+{
+    if (!isCompressed(entry))
+    {
+        memcpy(dst, getStoredData(entry), entry.size);
+        return true;
+    }
+
+    return LzDecompress(getStoredData(entry), entry.storedSize, dst, entry.size);
+}
+
+bool SerializePackFile(const std::vector<PackFileSource>& sources, std::vector<uint8_t>& file, std::string& error)
+{
+    struct Pending
+    {
+        std::string name;
+        uint64_t hash;
+        const PackFileSource* source;
+    };
+
+    std::vector<Pending> pending;
+    pending.reserve(sources.size());
+
+    for (const PackFileSource& source : sources)
+    {
+        std::string name = NormalizePackPath(source.path.c_str());
+
+        if (name.empty())
+        {
+            error = "empty path";
+            return false;
+        }
+
+        uint64_t hash = HashPackPath(name);
+        pending.push_back({ std::move(name), hash, &source });
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b)
+    {
+        return a.hash != b.hash ? a.hash < b.hash : a.name < b.name;
+    });
+
+    for (size_t i = 1; i < pending.size(); i++)
+    {
+        if (pending[i].name == pending[i - 1].name)
+        {
+            error = "duplicate path " + pending[i].name;
+            return false;
+        }
+    }
+
+    PackFileHeader header{};
+    header.magic = PACK_FILE_MAGIC;
+    header.version = PACK_FILE_VERSION;
+    header.headerSize = sizeof(PackFileHeader);
+    header.entryCount = static_cast<uint32_t>(pending.size());
+    header.namesOffset = sizeof(PackFileHeader) + pending.size() * sizeof(PackFileEntry);
+
+    std::vector<PackFileEntry> entries(pending.size());
+    std::string names;
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        entries[i].pathHash = pending[i].hash;
+        entries[i].nameOffset = static_cast<uint32_t>(names.size());
+        entries[i].nameSize = static_cast<uint32_t>(pending[i].name.size());
+        names += pending[i].name;
+    }
+
+    header.namesSize = names.size();
+    header.dataOffset = AlignUp(header.namesOffset + header.namesSize, PACK_FILE_ALIGNMENT);
+
+    // Compress up front so the offsets are known before anything is written.
+    std::vector<std::vector<uint8_t>> compressed(pending.size());
+    uint64_t offset = header.dataOffset;
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        const PackFileSource& source = *pending[i].source;
+        PackFileEntry& entry = entries[i];
+
+        entry.size = source.data.size();
+        entry.storedSize = entry.size;
+
+        if (source.compress && !source.data.empty() && IsWorthCompressing(source.data.size(), LzCompress(source.data.data(), source.data.size(), compressed[i])))
+        {
+            entry.flags |= PACK_ENTRY_COMPRESSED;
+            entry.storedSize = compressed[i].size();
+        }
+        else
+        {
+            compressed[i].clear();
+            compressed[i].shrink_to_fit();
+        }
+
+        offset = AlignUp(offset, entry.storedSize >= PACK_FILE_PAGE_ALIGN_THRESHOLD ? PACK_FILE_PAGE_SIZE : PACK_FILE_ALIGNMENT);
+        entry.offset = offset;
+        offset += entry.storedSize;
+    }
+
+    file.assign(offset, 0);
+
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), entries.data(), entries.size() * sizeof(PackFileEntry));
+    memcpy(file.data() + header.namesOffset, names.data(), names.size());
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        const std::vector<uint8_t>& stored = (entries[i].flags & PACK_ENTRY_COMPRESSED) ? compressed[i] : pending[i].source->data;
+
+        if (!stored.empty())
+            memcpy(file.data() + entries[i].offset, stored.data(), stored.size());
+    }
+
+    return true;
+}
+
+bool WritePackFile(const char* path, const std::vector<PackFileSource>& sources, std::string& error)
+{
+    std::vector<uint8_t> file;
+
+    if (!SerializePackFile(sources, file, error))
+        return false;
+
+    FILE* handle = fopen(path, "wb");
+
+    if (!handle)
+    {
+        error = std::string("failed to open ") + path;
+        return false;
+    }
+
+    bool written = fwrite(file.data(), 1, file.size(), handle) == file.size();
+
+    if (fclose(handle) != 0 || !written)
+    {
+        error = std::string("failed to write ") + path;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Engine archive holding many files behind one mapping. The entry table is sorted by path hash,
+// so finding a file is a binary search over memory that is already mapped instead of an open
+// call, and stored entries are aligned so they can be used in place.
+//
+// Layout: PackFileHeader, entryCount PackFileEntry sorted by pathHash, the name table, padding,
+// then each entry's data at its own aligned offset.
+
+static constexpr uint32_t PACK_FILE_MAGIC = 0x4B415056; // "VPAK"
+static constexpr uint32_t PACK_FILE_VERSION = 1;
+
+// Alignment of every entry's data. Lets any engine file format inside be read in place.
+static constexpr uint32_t PACK_FILE_ALIGNMENT = 256;
+
+// Entries at least this large start on their own page, so touching one never faults in the
+// tail of another.
+static constexpr uint32_t PACK_FILE_PAGE_SIZE = 4096;
+static constexpr uint64_t PACK_FILE_PAGE_ALIGN_THRESHOLD = 64 * 1024;
+
+// Seed of the path hash, so a pack can't be mistaken for one keyed some other way.
+static constexpr uint64_t PACK_FILE_HASH_SEED = PACK_FILE_MAGIC;
+
+enum PackFileEntryFlags : uint32_t
+{
+    PACK_ENTRY_COMPRESSED = 1 << 0,
+};
+
+struct PackFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t headerSize;
+
+    uint32_t entryCount;
+    uint32_t reserved;
+
+    uint64_t namesOffset; // from the start of the file
+    uint64_t namesSize;
+    uint64_t dataOffset;  // first byte of entry data
+};
+
+struct PackFileEntry
+{
+    uint64_t pathHash;   // HashBytes of the normalized path with PACK_FILE_HASH_SEED
+    uint64_t offset;     // from the start of the file
+    uint64_t size;       // once decompressed
+    uint64_t storedSize; // in the file
+
+    uint32_t nameOffset; // into the name table, not null terminated
+    uint32_t nameSize;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackFileHeader) == 48, "pack file header layout changed");
+static_assert(sizeof(PackFileEntry) == 48, "pack file entry layout changed");
+
+// Forward slashes, no leading "./" or "/", no empty or "." components. Case is kept.
+std::string NormalizePackPath(const char* path);
+
+uint64_t HashPackPath(const std::string& normalizedPath);
+
+// Validates a pack file in place. Nothing is copied, every accessor points into the given memory.
+class PackFileView
+{
+public:
+    bool open(const uint8_t* data, size_t size);
+
+    const PackFileHeader& getHeader() const { return *header; }
+
+    uint32_t getEntryCount() const { return header->entryCount; }
+    const PackFileEntry& getEntry(uint32_t index) const { return entries[index]; }
+
+    std::string getEntryName(const PackFileEntry& entry) const;
+
+    // Looks up a path already run through NormalizePackPath, nullptr when it isn't in the pack.
+    const PackFileEntry* find(const std::string& normalizedPath, uint64_t pathHash) const;
+
+    bool isCompressed(const PackFileEntry& entry) const { return (entry.flags & PACK_ENTRY_COMPRESSED) != 0; }
+
+    // The entry as stored, possibly compressed.
+    const uint8_t* getStoredData(const PackFileEntry& entry) const { return data + entry.offset; }
+
+    // Writes entry.size bytes to dst.
+    bool readEntry(const PackFileEntry& entry, uint8_t* dst) const;
+
+private:
+    const uint8_t* data = nullptr;
+    const PackFileHeader* header = nullptr;
+    const PackFileEntry* entries = nullptr;
+    const char* names = nullptr;
+};
+
+// Source data for WritePackFile.
+struct PackFileSource
+{
+    std::string path;
+    std::vector<uint8_t> data;
+
+    // LZ compress the entry when it saves enough to be worth losing the in place view. Leave off
+    // for formats that compress their own payload and are read straight from the mapping.
+    bool compress = true;
+};
+
+// Fails on duplicate paths. Paths are normalized on the way in.
+bool SerializePackFile(const std::vector<PackFileSource>& sources, std::vector<uint8_t>& file, std::string& error);
+bool WritePackFile(const char* path, const std::vector<PackFileSource>& sources, std::string& error);
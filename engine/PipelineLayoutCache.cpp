@@ -0,0 +1,196 @@
+#include "PipelineLayoutCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include "Hash.h"
+#include "ShaderReflection.h"
+
+// Non dispatchable handles are pointers on 64 bit and integers on 32 bit.
+static uint64_t HandleBits(VkDescriptorSetLayout layout)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &layout, sizeof(layout));
+    return bits;
+}
+
+size_t PipelineLayoutCache::KeyHash::operator()(const Key& key) const
+{
+    return static_cast<size_t>(HashBytes(key.words.data(), key.words.size() * sizeof(uint64_t)));
+}
+
+void PipelineLayoutCache::init(VkDevice device)
+{
+    this->device = device;
+}
+
+void PipelineLayoutCache::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    for (auto& [key, layout] : layouts)
+        vkDestroyPipelineLayout(device, layout.layout, nullptr);
+
+    for (auto& [key, layout] : setLayouts)
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+
+    layouts.clear();
+    setLayouts.clear();
+
+    device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSetLayout PipelineLayoutCache::getSetLayout(const VkDescriptorSetLayoutBinding* bindings, uint32_t count)
+{
+    std::vector<VkDescriptorSetLayoutBinding> sorted(bindings, bindings + count);
+
+    std::sort(sorted.begin(), sorted.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+    {
+        return a.binding < b.binding;
+    });
+
+    Key key;
+    key.words.reserve(count * 2);
+
+    for (const VkDescriptorSetLayoutBinding& binding : sorted)
+    {
+        if (binding.pImmutableSamplers != nullptr)
+            throw std::runtime_error("cached set layouts can't have immutable samplers.");
+
+        key.words.push_back(uint64_t(binding.binding) << 32 | uint32_t(binding.descriptorType));
+        key.words.push_back(uint64_t(binding.descriptorCount) << 32 | binding.stageFlags);
+    }
+
+    auto found = setLayouts.find(key);
+
+    if (found != setLayouts.end())
+        return found->second;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = count;
+    layoutInfo.pBindings = sorted.data();
+
+    VkDescriptorSetLayout layout;
+    CheckVkResult(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout));
+
+    setLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+const PipelineLayout& PipelineLayoutCache::getLayout(const ShaderReflection* stages, uint32_t stageCount, const std::vector<FixedSetLayout>& fixedSets)
+{
+    auto isFixed = [&](uint32_t set)
+    {
+        return std::any_of(fixedSets.begin(), fixedSets.end(), [set](const FixedSetLayout& fixed) { return fixed.set == set; });
+    };
+
+    std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> sets;
+
+    uint32_t pushStart = UINT32_MAX;
+    uint32_t pushEnd = 0;
+    VkShaderStageFlags pushStages = 0;
+
+    for (uint32_t i = 0; i < stageCount; i++)
+    {
+        const ShaderReflection& stage = stages[i];
+
+        for (const ReflectedBinding& reflected : stage.bindings)
+        {
+            if (isFixed(reflected.set))
+                continue;
+
+            if (reflected.count == 0)
+                throw std::runtime_error("unsized descriptor arrays need a fixed set layout.");
+
+            std::vector<VkDescriptorSetLayoutBinding>& bindings = sets[reflected.set];
+
+            auto existing = std::find_if(bindings.begin(), bindings.end(), [&](const VkDescriptorSetLayoutBinding& binding)
+            {
+                return binding.binding == reflected.binding;
+            });
+
+            if (existing == bindings.end())
+            {
+                VkDescriptorSetLayoutBinding binding{};
+                binding.binding = reflected.binding;
+                binding.descriptorType = reflected.type;
+                binding.descriptorCount = reflected.count;
+                binding.stageFlags = stage.stage;
+                bindings.push_back(binding);
+            }
+            else if (existing->descriptorType != reflected.type || existing->descriptorCount != reflected.count)
+            {
+                throw std::runtime_error("shader stages disagree on a descriptor binding.");
+            }
+            else
+            {
+                existing->stageFlags |= stage.stage;
+            }
+        }
+
+        if (stage.pushConstantSize > 0)
+        {
+            pushStart = std::min(pushStart, stage.pushConstantOffset);
+            pushEnd = std::max(pushEnd, stage.pushConstantOffset + stage.pushConstantSize);
+            pushStages |= stage.stage;
+        }
+    }
+
+    uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+
+    for (const FixedSetLayout& fixed : fixedSets)
+        setCount = std::max(setCount, fixed.set + 1);
+
+    PipelineLayout result;
+    result.setLayouts.resize(setCount);
+
+    for (uint32_t set = 0; set < setCount; set++)
+    {
+        auto fixed = std::find_if(fixedSets.begin(), fixedSets.end(), [set](const FixedSetLayout& fixed) { return fixed.set == set; });
+
+        if (fixed != fixedSets.end())
+        {
+            result.setLayouts[set] = fixed->layout;
+            continue;
+        }
+
+        const std::vector<VkDescriptorSetLayoutBinding>& bindings = sets[set];
+        result.setLayouts[set] = getSetLayout(bindings.data(), static_cast<uint32_t>(bindings.size()));
+    }
+
+    if (pushStages != 0)
+    {
+        result.pushConstants.stageFlags = pushStages;
+        result.pushConstants.offset = pushStart;
+        result.pushConstants.size = pushEnd - pushStart;
+    }
+
+    Key key;
+    key.words.reserve(setCount + 2);
+
+    for (VkDescriptorSetLayout layout : result.setLayouts)
+        key.words.push_back(HandleBits(layout));
+
+    key.words.push_back(result.pushConstants.stageFlags);
+    key.words.push_back(uint64_t(result.pushConstants.offset) << 32 | result.pushConstants.size);
+
+    auto found = layouts.find(key);
+
+    if (found != layouts.end())
+        return found->second;
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = setCount;
+    layoutInfo.pSetLayouts = result.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = pushStages != 0 ? 1 : 0;
+    layoutInfo.pPushConstantRanges = &result.pushConstants;
+
+    CheckVkResult(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &result.layout));
+
+    return layouts.emplace(std::move(key), std::move(result)).first->second;
+}
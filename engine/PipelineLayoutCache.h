@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "VulkanUtils.h"
+
+struct ShaderReflection;
+
+struct PipelineLayout
+{
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> setLayouts; // by set number, empty layouts fill gaps
+
+    // One range for every stage using push constants, so pushes pass its stageFlags whatever
+    // part of it they write. stageFlags is 0 when no stage has any.
+    VkPushConstantRange pushConstants{};
+};
+
+// A set the reflection can't describe, like a dynamic buffer or a variable sized array, and the
+// layout to use for it instead.
+struct FixedSetLayout
+{
+    uint32_t set;
+    VkDescriptorSetLayout layout;
+};
+
+// Builds descriptor set and pipeline layouts from reflected shaders and hands out the same handle
+// for the same contents. Pipelines made from shaders declaring the same resources end up sharing
+// a layout, so switching between them keeps descriptor sets bound. Layouts live until destroy().
+class PipelineLayoutCache
+{
+public:
+    void init(VkDevice device);
+    void destroy();
+
+    // Bindings are matched regardless of order.
+    VkDescriptorSetLayout getSetLayout(const VkDescriptorSetLayoutBinding* bindings, uint32_t count);
+
+    // Merges the resources of every stage, a binding used by several stages is visible to all of
+    // them. Throws if the stages disagree on a binding or leave an unsized array in a set that
+    // isn't fixed. The reference stays valid until destroy().
+    const PipelineLayout& getLayout(const ShaderReflection* stages, uint32_t stageCount, const std::vector<FixedSetLayout>& fixedSets = {});
+
+    uint32_t getSetLayoutCount() const { return static_cast<uint32_t>(setLayouts.size()); }
+    uint32_t getLayoutCount() const { return static_cast<uint32_t>(layouts.size()); }
+
+private:
+    struct Key
+    {
+        std::vector<uint64_t> words;
+
+        bool operator==(const Key& other) const { return words == other.words; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+
+    std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> setLayouts;
+    std::unordered_map<Key, PipelineLayout, KeyHash> layouts;
+};
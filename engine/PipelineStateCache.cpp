@@ -0,0 +1,246 @@
+#include "PipelineStateCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "Hash.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+void PipelineStateCache::init(VkDevice device, JobSystem* jobs, const char* path)
+{
+    this->device = device;
+    this->jobs = jobs;
+
+    MappedFile file;
+
+    // Data from another driver or device is ignored by the driver, leaving the cache empty.
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    if (path && file.open(path))
+    {
+        cacheInfo.initialDataSize = file.size();
+        cacheInfo.pInitialData = file.data();
+    }
+
+    CheckVkResult(vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache));
+}
+
+void PipelineStateCache::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, [this]() { return pending.load() == 0; });
+    }
+
+    for (Entry& entry : entries)
+        vkDestroyPipeline(device, entry.pipeline.load(), nullptr);
+
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+
+    entries.clear();
+    lookup.clear();
+
+    device = VK_NULL_HANDLE;
+}
+
+bool PipelineStateCache::save(const char* path) const
+{
+    size_t size = 0;
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, nullptr) != VK_SUCCESS)
+        return false;
+
+    std::vector<uint8_t> data(size);
+
+    if (vkGetPipelineCacheData(device, pipelineCache, &size, data.data()) != VK_SUCCESS)
+        return false;
+
+    FILE* handle = fopen(path, "wb");
+
+    if (!handle)
+        return false;
+
+    bool written = fwrite(data.data(), 1, size, handle) == size;
+
+    return fclose(handle) == 0 && written;
+}
+
+uint32_t PipelineStateCache::request(const GraphicsPipelineDesc& desc)
+{
+    std::vector<uint32_t>& bucket = lookup[HashBytes(&desc, sizeof(desc))];
+
+    for (uint32_t id : bucket)
+    {
+        if (memcmp(&entries[id].desc, &desc, sizeof(desc)) == 0)
+            return id;
+    }
+
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    bucket.push_back(id);
+
+    Entry& entry = entries.emplace_back();
+    entry.desc = desc;
+
+    pending.fetch_add(1);
+
+    if (jobs)
+        jobs->submit([this, &entry]() { compile(entry); });
+    else
+        compile(entry);
+
+    return id;
+}
+
+VkPipeline PipelineStateCache::get(uint32_t id, VkPipeline fallback) const
+{
+    VkPipeline pipeline = get(id);
+    return pipeline != VK_NULL_HANDLE ? pipeline : fallback;
+}
+
+VkPipeline PipelineStateCache::wait(uint32_t id)
+{
+    Entry& entry = entries[id];
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&entry]() { return entry.done.load(); });
+
+    return entry.pipeline.load();
+}
+
+void PipelineStateCache::compile(Entry& entry)
+{
+    const GraphicsPipelineDesc& desc = entry.desc;
+
+    VkPipelineShaderStageCreateInfo stages[2]{};
+    uint32_t stageCount = 0;
+
+    const std::pair<VkShaderModule, VkShaderStageFlagBits> modules[] =
+    {
+        { desc.vertexShader, VK_SHADER_STAGE_VERTEX_BIT },
+        { desc.fragmentShader, VK_SHADER_STAGE_FRAGMENT_BIT },
+    };
+
+    for (const auto& [module, stageBit] : modules)
+    {
+        if (module == VK_NULL_HANDLE)
+            continue;
+
+        VkPipelineShaderStageCreateInfo& stage = stages[stageCount];
+        stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage.stage = stageBit;
+        stage.module = module;
+        stage.pName = "main";
+        stageCount++;
+    }
+
+    VkVertexInputBindingDescription binding{};
+    binding.binding = 0;
+    binding.stride = desc.vertexStride;
+    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount = desc.attributeCount > 0 ? 1 : 0;
+    vertexInput.pVertexBindingDescriptions = &binding;
+    vertexInput.vertexAttributeDescriptionCount = desc.attributeCount;
+    vertexInput.pVertexAttributeDescriptions = desc.attributes;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = desc.topology;
+
+    VkPipelineViewportStateCreateInfo viewport{};
+    viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport.viewportCount = 1;
+    viewport.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterization{};
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = desc.polygonMode;
+    rasterization.cullMode = desc.cullMode;
+    rasterization.frontFace = desc.frontFace;
+    rasterization.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample{};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = desc.samples;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = desc.depthTest;
+    depthStencil.depthWriteEnable = desc.depthWrite;
+    depthStencil.depthCompareOp = desc.depthCompare;
+
+    VkPipelineColorBlendAttachmentState blendAttachments[GraphicsPipelineDesc::MAX_COLOR_ATTACHMENTS]{};
+
+    for (VkPipelineColorBlendAttachmentState& attachment : blendAttachments)
+    {
+        attachment.blendEnable = desc.blend;
+        attachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        attachment.colorBlendOp = VK_BLEND_OP_ADD;
+        attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    }
+
+    VkPipelineColorBlendStateCreateInfo colorBlend{};
+    colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount = desc.colorCount;
+    colorBlend.pAttachments = blendAttachments;
+
+    VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkPipelineRenderingCreateInfo rendering{};
+    rendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    rendering.colorAttachmentCount = desc.colorCount;
+    rendering.pColorAttachmentFormats = desc.colorFormats;
+    rendering.depthAttachmentFormat = desc.depthFormat;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = desc.renderPass == VK_NULL_HANDLE ? &rendering : nullptr;
+    pipelineInfo.stageCount = stageCount;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewport;
+    pipelineInfo.pRasterizationState = &rasterization;
+    pipelineInfo.pMultisampleState = &multisample;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlend;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+
+    // The driver cache is internally synchronized, workers can compile into it at once.
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "[pipeline] failed to compile a variant (%d), its draws keep falling back.\n", result);
+        pipeline = VK_NULL_HANDLE;
+    }
+
+    entry.pipeline.store(pipeline, std::memory_order_release);
+
+    // Notified under the lock, destroy() may free the condition as soon as pending reaches zero.
+    std::lock_guard<std::mutex> lock(doneMutex);
+    entry.done.store(true);
+    pending.fetch_sub(1);
+    doneCondition.notify_all();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "VulkanUtils.h"
+
+class JobSystem;
+
+// Everything a graphics pipeline is made from. Compared and hashed as bytes, so start from {} and
+// leave unused array entries zeroed. Viewport and scissor are always dynamic.
+struct GraphicsPipelineDesc
+{
+    static constexpr uint32_t MAX_ATTRIBUTES = 8;
+    static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 4;
+
+    // Have to outlive the compile, which may still be running on a worker.
+    VkShaderModule vertexShader = VK_NULL_HANDLE;
+    VkShaderModule fragmentShader = VK_NULL_HANDLE; // null for depth only passes
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+
+    // Null to target dynamic rendering with the formats below instead.
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+
+    // One interleaved binding, 0.
+    uint32_t vertexStride = 0;
+    uint32_t attributeCount = 0;
+    VkVertexInputAttributeDescription attributes[MAX_ATTRIBUTES]{};
+
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkBool32 depthTest = VK_TRUE;
+    VkBool32 depthWrite = VK_TRUE;
+    VkCompareOp depthCompare = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    // Premultiplied alpha blending on every color attachment.
+    VkBool32 blend = VK_FALSE;
+
+    uint32_t colorCount = 1;
+    VkFormat colorFormats[MAX_COLOR_ATTACHMENTS]{};
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+};
+
+static_assert(std::has_unique_object_representations_v<GraphicsPipelineDesc>, "GraphicsPipelineDesc must have no padding to hash as bytes");
+
+// Pipeline variants by description, compiled once each through a VkPipelineCache that persists
+// between runs. A variant asked for the first time compiles on a worker while frames go on, its
+// draws falling back to another pipeline or skipped until then, so a new material never stalls
+// a frame on the driver's compiler.
+//
+// request(), get() and wait() are for one thread, the one building the frame's draw tables.
+class PipelineStateCache
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+
+    // Seeds the driver cache from path if it exists and matches the device. Without jobs,
+    // variants compile inside request().
+    void init(VkDevice device, JobSystem* jobs = nullptr, const char* path = nullptr);
+
+    // Waits for compiles still running first.
+    void destroy();
+
+    // Writes the driver cache for the next run's init.
+    bool save(const char* path) const;
+
+    // The variant's id, the same for the same description. Queues its compile the first time.
+    uint32_t request(const GraphicsPipelineDesc& desc);
+
+    // Null until the variant has compiled, or for good if it failed to.
+    VkPipeline get(uint32_t id) const { return entries[id].pipeline.load(std::memory_order_acquire); }
+
+    // The fallback instead of null, for draws that can use a generic pipeline meanwhile.
+    VkPipeline get(uint32_t id, VkPipeline fallback) const;
+
+    // Blocks until the variant is done, for the fallbacks themselves. Null if it failed.
+    VkPipeline wait(uint32_t id);
+
+    uint32_t getVariantCount() const { return static_cast<uint32_t>(entries.size()); }
+    uint32_t getPendingCount() const { return pending.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry
+    {
+        GraphicsPipelineDesc desc;
+        std::atomic<VkPipeline> pipeline = VK_NULL_HANDLE;
+        std::atomic<bool> done = false;
+    };
+
+    void compile(Entry& entry);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    JobSystem* jobs = nullptr;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
+    // A deque so workers can hold on to entries while more are added.
+    std::deque<Entry> entries;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> lookup;
+
+    std::atomic<uint32_t> pending = 0;
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+};
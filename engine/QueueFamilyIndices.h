@@ -10,6 +10,9 @@ struct QueueFamilyIndices
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
 
+	// A family without graphics for streaming uploads, the graphics family when there is none.
+	std::optional<uint32_t> transferFamily;
+
 	bool isComplete()
 	{
 		return graphicsFamily.has_value() && presentFamily.has_value();
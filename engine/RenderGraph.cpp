@@ -0,0 +1,994 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+struct AccessInfo
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    VkImageLayout layout;
+    VkImageUsageFlags usage;
+    bool writes;
+};
+
+static const AccessInfo ACCESS_INFOS[] =
+{
+    // ColorAttachment
+    {
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true
+    },
+    // DepthAttachment
+    {
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true
+    },
+    // DepthRead
+    {
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false
+    },
+    // FragmentSampled
+    {
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false
+    },
+    // ComputeSampled
+    {
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false
+    },
+    // ComputeStorageRead
+    {
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false
+    },
+    // ComputeStorageWrite
+    {
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true
+    },
+    // TransferSource
+    {
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false
+    },
+    // TransferDestination
+    {
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true
+    },
+    // IndirectBuffer
+    {
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, 0, false
+    },
+    // VertexBuffer
+    {
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED, 0, false
+    },
+    // UniformBuffer
+    {
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_ACCESS_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false
+    },
+};
+
+static_assert(sizeof(ACCESS_INFOS) / sizeof(ACCESS_INFOS[0]) == size_t(RenderGraphAccess::Count), "every access needs its info");
+
+static constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+static const AccessInfo& GetAccessInfo(RenderGraphAccess access)
+{
+    return ACCESS_INFOS[size_t(access)];
+}
+
+static VkImageAspectFlags GetAspect(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static bool IsAttachment(RenderGraphAccess access)
+{
+    return access == RenderGraphAccess::ColorAttachment || access == RenderGraphAccess::DepthAttachment || access == RenderGraphAccess::DepthRead;
+}
+
+static bool LifetimesOverlap(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB)
+{
+    return firstA <= lastB && firstB <= lastA;
+}
+
+static bool RangesOverlap(VkDeviceSize offsetA, VkDeviceSize sizeA, VkDeviceSize offsetB, VkDeviceSize sizeB)
+{
+    return offsetA < offsetB + sizeB && offsetB < offsetA + sizeA;
+}
+
+void RenderGraph::init(VkPhysicalDevice physicalDevice, VkDevice device, bool vulkan13)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->vulkan13 = vulkan13;
+}
+
+void RenderGraph::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    reset();
+
+    for (const RenderPassEntry& entry : renderPasses)
+        vkDestroyRenderPass(device, entry.renderPass, nullptr);
+
+    renderPasses.clear();
+    device = VK_NULL_HANDLE;
+}
+
+void RenderGraph::reset()
+{
+    releaseTransients();
+    releaseFramebuffers();
+
+    passes.clear();
+    resources.clear();
+    batches.clear();
+    finalBatch = {};
+    stats = {};
+}
+
+uint32_t RenderGraph::createImage(const char* name, const RenderGraphImageDesc& desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+
+    resources.push_back(resource);
+    return uint32_t(resources.size() - 1);
+}
+
+uint32_t RenderGraph::importImage(const char* name, VkImage image, VkImageView view, const RenderGraphImageDesc& desc, VkImageLayout initialLayout,
+    VkImageLayout finalLayout, VkPipelineStageFlags initialStages)
+{
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.desc = desc;
+    resource.initialLayout = initialLayout;
+    resource.finalLayout = finalLayout;
+    resource.initialStages = initialStages;
+    resource.image = image;
+    resource.view = view;
+
+    resources.push_back(resource);
+    return uint32_t(resources.size() - 1);
+}
+
+uint32_t RenderGraph::importBuffer(const char* name, VkBuffer buffer)
+{
+    Resource resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.isBuffer = true;
+    resource.buffer = buffer;
+
+    resources.push_back(resource);
+    return uint32_t(resources.size() - 1);
+}
+
+void RenderGraph::setImportedImage(uint32_t resource, VkImage image, VkImageView view)
+{
+    resources[resource].image = image;
+    resources[resource].view = view;
+}
+
+uint32_t RenderGraph::addPass(const char* name, PassFunction execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    passes.push_back(std::move(pass));
+    return uint32_t(passes.size() - 1);
+}
+
+void RenderGraph::use(uint32_t pass, uint32_t resource, RenderGraphAccess access)
+{
+    if (resources[resource].isBuffer != (GetAccessInfo(access).layout == VK_IMAGE_LAYOUT_UNDEFINED))
+        throw std::runtime_error("render graph pass " + passes[pass].name + " uses " + resources[resource].name + " the wrong way.");
+
+    passes[pass].accesses.push_back({ resource, access });
+}
+
+void RenderGraph::setSideEffects(uint32_t pass)
+{
+    passes[pass].sideEffects = true;
+}
+
+void RenderGraph::setClear(uint32_t pass, uint32_t resource, const VkClearValue& value)
+{
+    passes[pass].clears.push_back({ resource, value });
+}
+
+void RenderGraph::compile()
+{
+    stats = {};
+    stats.passCount = uint32_t(passes.size());
+
+    releaseFramebuffers();
+
+    cullPasses();
+    allocateTransients();
+    buildBarriers();
+
+    if (!vulkan13)
+        createRenderPasses();
+}
+
+void RenderGraph::cullPasses()
+{
+    // Whoever writes something a kept pass uses is kept too. Passes only depend on earlier ones, so
+    // one walk from the back settles it. A write that is fully overwritten later still counts, the
+    // graph can't tell a full overwrite from a load.
+    std::vector<std::vector<uint32_t>> writers(resources.size());
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        Pass& pass = passes[i];
+        pass.live = pass.sideEffects;
+
+        for (const Access& access : pass.accesses)
+        {
+            if (!GetAccessInfo(access.access).writes)
+                continue;
+
+            writers[access.resource].push_back(i);
+
+            if (resources[access.resource].imported)
+                pass.live = true;
+        }
+    }
+
+    for (uint32_t i = uint32_t(passes.size()); i-- > 0;)
+    {
+        if (!passes[i].live)
+        {
+            stats.culledPassCount++;
+            continue;
+        }
+
+        for (const Access& access : passes[i].accesses)
+        {
+            for (uint32_t writer : writers[access.resource])
+            {
+                if (writer < i)
+                    passes[writer].live = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::allocateTransients()
+{
+    releaseTransients();
+
+    for (Resource& resource : resources)
+    {
+        resource.firstPass = INVALID;
+        resource.lastPass = INVALID;
+        resource.usage = 0;
+    }
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        if (!passes[i].live)
+            continue;
+
+        for (const Access& access : passes[i].accesses)
+        {
+            Resource& resource = resources[access.resource];
+
+            if (resource.firstPass == INVALID)
+                resource.firstPass = i;
+
+            resource.lastPass = i;
+            resource.usage |= GetAccessInfo(access.access).usage;
+        }
+    }
+
+    struct Block
+    {
+        uint32_t memoryType;
+        VkDeviceSize size;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<uint32_t> transients;
+    std::vector<VkDeviceSize> alignments(resources.size());
+
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        Resource& resource = resources[i];
+
+        if (resource.imported || resource.firstPass == INVALID)
+            continue;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.desc.format;
+        imageInfo.extent = { resource.desc.width, resource.desc.height, 1 };
+        imageInfo.mipLevels = resource.desc.mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = resource.desc.samples;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        CheckVkResult(vkCreateImage(device, &imageInfo, nullptr, &resource.image));
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, resource.image, &requirements);
+
+        uint32_t memoryType = FindMemoryType(physicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        auto block = std::find_if(blocks.begin(), blocks.end(), [&](const Block& b) { return b.memoryType == memoryType; });
+
+        if (block == blocks.end())
+        {
+            blocks.push_back({ memoryType, 0 });
+            block = blocks.end() - 1;
+        }
+
+        resource.memoryBlock = uint32_t(block - blocks.begin());
+        resource.size = requirements.size;
+        alignments[i] = requirements.alignment;
+
+        transients.push_back(i);
+
+        stats.transientImages++;
+        stats.transientBytes += requirements.size;
+    }
+
+    // Largest first, each at the lowest offset clear of everything placed that is alive at the same
+    // time. Images that never overlap end up sharing memory.
+    std::sort(transients.begin(), transients.end(), [&](uint32_t a, uint32_t b)
+    {
+        return resources[a].size != resources[b].size ? resources[a].size > resources[b].size : a < b;
+    });
+
+    for (size_t i = 0; i < transients.size(); i++)
+    {
+        Resource& resource = resources[transients[i]];
+        VkDeviceSize alignment = alignments[transients[i]];
+        VkDeviceSize offset = 0;
+
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+
+            for (size_t j = 0; j < i; j++)
+            {
+                const Resource& placed = resources[transients[j]];
+
+                if (placed.memoryBlock != resource.memoryBlock ||
+                    !LifetimesOverlap(resource.firstPass, resource.lastPass, placed.firstPass, placed.lastPass) ||
+                    !RangesOverlap(offset, resource.size, placed.offset, placed.size))
+                {
+                    continue;
+                }
+
+                offset = (placed.offset + placed.size + alignment - 1) / alignment * alignment;
+                moved = true;
+            }
+        }
+
+        resource.offset = offset;
+
+        Block& block = blocks[resource.memoryBlock];
+        block.size = std::max(block.size, offset + resource.size);
+    }
+
+    for (const Block& block : blocks)
+    {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        allocInfo.memoryTypeIndex = block.memoryType;
+
+        VkDeviceMemory memory;
+        CheckVkResult(vkAllocateMemory(device, &allocInfo, nullptr, &memory));
+
+        memoryBlocks.push_back(memory);
+        stats.allocatedBytes += block.size;
+    }
+
+    for (uint32_t i : transients)
+    {
+        Resource& resource = resources[i];
+
+        CheckVkResult(vkBindImageMemory(device, resource.image, memoryBlocks[resource.memoryBlock], resource.offset));
+
+        // Views of depth stencil images can only be sampled for one aspect, depth is the useful one.
+        VkImageAspectFlags aspect = GetAspect(resource.desc.format);
+
+        if ((resource.usage & VK_IMAGE_USAGE_SAMPLED_BIT) && (aspect & VK_IMAGE_ASPECT_DEPTH_BIT))
+            aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = resource.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.desc.format;
+        viewInfo.subresourceRange.aspectMask = aspect;
+        viewInfo.subresourceRange.levelCount = resource.desc.mipLevels;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        CheckVkResult(vkCreateImageView(device, &viewInfo, nullptr, &resource.view));
+    }
+}
+
+void RenderGraph::releaseTransients()
+{
+    for (Resource& resource : resources)
+    {
+        if (resource.imported)
+            continue;
+
+        if (resource.view != VK_NULL_HANDLE)
+            vkDestroyImageView(device, resource.view, nullptr);
+
+        if (resource.image != VK_NULL_HANDLE)
+            vkDestroyImage(device, resource.image, nullptr);
+
+        resource.view = VK_NULL_HANDLE;
+        resource.image = VK_NULL_HANDLE;
+        resource.memoryBlock = INVALID;
+    }
+
+    for (VkDeviceMemory memory : memoryBlocks)
+        vkFreeMemory(device, memory, nullptr);
+
+    memoryBlocks.clear();
+}
+
+void RenderGraph::releaseFramebuffers()
+{
+    for (const FramebufferEntry& entry : framebuffers)
+        vkDestroyFramebuffer(device, entry.framebuffer, nullptr);
+
+    framebuffers.clear();
+}
+
+void RenderGraph::buildBarriers()
+{
+    std::vector<State> states(resources.size());
+
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        if (resources[i].imported)
+        {
+            states[i].writeStages = resources[i].initialStages;
+            states[i].writeAccess = VK_ACCESS_MEMORY_WRITE_BIT;
+            states[i].layout = resources[i].initialLayout;
+        }
+    }
+
+    // A dry run finds where each resource ends the frame.
+    std::vector<State> initialStates = states;
+    simulate(states, false);
+
+    for (uint32_t i = 0; i < resources.size(); i++)
+        resources[i].endState = states[i];
+
+    // A transient image's first use waits on the last use of everything sharing its memory, earlier
+    // in this frame or later in the previous one. Barriers cover all earlier work on the queue.
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        const Resource& resource = resources[i];
+
+        if (resource.imported || resource.memoryBlock == INVALID)
+            continue;
+
+        for (const Resource& other : resources)
+        {
+            if (other.imported || other.memoryBlock != resource.memoryBlock ||
+                !RangesOverlap(resource.offset, resource.size, other.offset, other.size))
+            {
+                continue;
+            }
+
+            initialStates[i].writeStages |= other.endState.writeStages | other.endState.readStages;
+            initialStates[i].writeAccess |= other.endState.writeAccess;
+        }
+    }
+
+    simulate(initialStates, true);
+
+    // Imported images leave in the layout their owner expects.
+    finalBatch.clear();
+
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        const Resource& resource = resources[i];
+        const State& state = initialStates[i];
+
+        if (!resource.imported || resource.isBuffer || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.finalLayout == state.layout)
+        {
+            continue;
+        }
+
+        finalBatch.push_back({ i, state.writeStages | state.readStages, state.writeAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            state.layout, resource.finalLayout });
+    }
+
+    if (!finalBatch.empty())
+        countBatch(finalBatch);
+}
+
+void RenderGraph::simulate(std::vector<State>& states, bool record)
+{
+    batches.clear();
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        Pass& pass = passes[i];
+        pass.barrierBatch = INVALID;
+        pass.attachments.clear();
+        pass.hasDepth = false;
+
+        if (!pass.live)
+            continue;
+
+        BarrierBatch batch;
+
+        for (const Access& access : pass.accesses)
+        {
+            VkImageLayout previousLayout = states[access.resource].layout;
+            addBarrier(batch, access.resource, states[access.resource], access.access);
+
+            if (record && IsAttachment(access.access))
+                addAttachment(pass, i, access.resource, previousLayout, access.access);
+        }
+
+        if (!record || batch.empty())
+            continue;
+
+        countBatch(batch);
+
+        pass.barrierBatch = uint32_t(batches.size());
+        batches.push_back(std::move(batch));
+    }
+}
+
+void RenderGraph::countBatch(const BarrierBatch& batch)
+{
+    stats.barrierBatches++;
+
+    uint32_t memoryBarriers = 0;
+
+    for (const Barrier& barrier : batch)
+    {
+        if (barrier.oldLayout != barrier.newLayout)
+            stats.imageBarriers++;
+        else
+            memoryBarriers++;
+    }
+
+    // Without synchronization2 they fold into one.
+    stats.memoryBarriers += vulkan13 ? memoryBarriers : std::min(memoryBarriers, 1u);
+}
+
+void RenderGraph::addBarrier(BarrierBatch& batch, uint32_t resource, State& state, RenderGraphAccess access)
+{
+    const AccessInfo& info = GetAccessInfo(access);
+    VkImageLayout layout = resources[resource].isBuffer ? VK_IMAGE_LAYOUT_UNDEFINED : info.layout;
+
+    VkPipelineStageFlags srcStages = state.writeStages | state.readStages;
+    VkAccessFlags srcAccess = state.writeAccess;
+
+    if (!info.writes && layout == state.layout)
+    {
+        // Reading what is already visible to this stage and access needs nothing, nor does reading
+        // what nothing wrote.
+        bool visible = (info.stages & ~state.readStages) == 0 && (info.access & ~state.readAccess) == 0;
+
+        state.readStages |= info.stages;
+        state.readAccess |= info.access;
+
+        if (visible || srcStages == 0)
+            return;
+    }
+    else if (info.writes)
+    {
+        state.writeStages = info.stages;
+        state.writeAccess = info.access & WRITE_ACCESS;
+        state.readStages = 0;
+        state.readAccess = 0;
+    }
+    else
+    {
+        // A read in a new layout, the transition is what later accesses wait on through the readers.
+        state.readStages = info.stages;
+        state.readAccess = info.access;
+    }
+
+    // Without a layout change a global barrier does the same job as one for the resource.
+    batch.push_back({ resource, srcStages, srcAccess, info.stages, info.access, state.layout, layout });
+    state.layout = layout;
+}
+
+void RenderGraph::addAttachment(Pass& pass, uint32_t passIndex, uint32_t resource, VkImageLayout previousLayout, RenderGraphAccess access)
+{
+    const Resource& image = resources[resource];
+
+    Attachment attachment{};
+    attachment.resource = resource;
+    attachment.layout = GetAccessInfo(access).layout;
+
+    // Nothing wrote it this frame, so there is nothing to load.
+    attachment.loadOp = previousLayout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD;
+
+    for (const Clear& clear : pass.clears)
+    {
+        if (clear.resource == resource)
+        {
+            attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            attachment.clear = clear.value;
+        }
+    }
+
+    // Nothing reads it later, so there is nothing to keep.
+    bool kept = image.imported || image.lastPass > passIndex;
+    attachment.storeOp = kept ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+    if (access == RenderGraphAccess::ColorAttachment)
+    {
+        pass.attachments.insert(pass.attachments.end() - (pass.hasDepth ? 1 : 0), attachment);
+    }
+    else
+    {
+        pass.attachments.push_back(attachment);
+        pass.hasDepth = true;
+    }
+}
+
+void RenderGraph::createRenderPasses()
+{
+    for (Pass& pass : passes)
+    {
+        pass.renderPass = VK_NULL_HANDLE;
+
+        if (!pass.live || pass.attachments.empty())
+            continue;
+
+        // The graph's barriers do the transitions, so attachments start and end in the pass's layout.
+        std::vector<VkAttachmentDescription> descriptions;
+
+        for (const Attachment& attachment : pass.attachments)
+        {
+            const RenderGraphImageDesc& desc = resources[attachment.resource].desc;
+
+            VkAttachmentDescription description{};
+            description.format = desc.format;
+            description.samples = desc.samples;
+            description.loadOp = attachment.loadOp;
+            description.storeOp = attachment.storeOp;
+            description.stencilLoadOp = attachment.loadOp;
+            description.stencilStoreOp = attachment.storeOp;
+            description.initialLayout = attachment.layout;
+            description.finalLayout = attachment.layout;
+
+            descriptions.push_back(description);
+        }
+
+        auto same = [&](const RenderPassEntry& entry)
+        {
+            if (entry.hasDepth != pass.hasDepth || entry.attachments.size() != descriptions.size())
+                return false;
+
+            for (size_t i = 0; i < descriptions.size(); i++)
+            {
+                const VkAttachmentDescription& a = entry.attachments[i];
+                const VkAttachmentDescription& b = descriptions[i];
+
+                if (a.format != b.format || a.samples != b.samples || a.loadOp != b.loadOp || a.storeOp != b.storeOp ||
+                    a.initialLayout != b.initialLayout)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        auto entry = std::find_if(renderPasses.begin(), renderPasses.end(), same);
+
+        if (entry != renderPasses.end())
+        {
+            pass.renderPass = entry->renderPass;
+            continue;
+        }
+
+        uint32_t colorCount = uint32_t(descriptions.size()) - (pass.hasDepth ? 1 : 0);
+        std::vector<VkAttachmentReference> colorReferences(colorCount);
+
+        for (uint32_t i = 0; i < colorCount; i++)
+            colorReferences[i] = { i, descriptions[i].initialLayout };
+
+        VkAttachmentReference depthReference = { colorCount, pass.hasDepth ? descriptions.back().initialLayout : VK_IMAGE_LAYOUT_UNDEFINED };
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = colorCount;
+        subpass.pColorAttachments = colorReferences.data();
+        subpass.pDepthStencilAttachment = pass.hasDepth ? &depthReference : nullptr;
+
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = uint32_t(descriptions.size());
+        renderPassInfo.pAttachments = descriptions.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+
+        CheckVkResult(vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass));
+
+        renderPasses.push_back({ std::move(descriptions), pass.hasDepth, pass.renderPass });
+    }
+}
+
+void RenderGraph::recordBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch)
+{
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+    imageBarriers.clear();
+
+    for (const Barrier& barrier : batch)
+    {
+        srcStages |= barrier.srcStages;
+        dstStages |= barrier.dstStages;
+
+        if (barrier.oldLayout == barrier.newLayout)
+        {
+            memoryBarrier.srcAccessMask |= barrier.srcAccess;
+            memoryBarrier.dstAccessMask |= barrier.dstAccess;
+            continue;
+        }
+
+        const Resource& resource = resources[barrier.resource];
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrier.srcAccess;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resource.image;
+        imageBarrier.subresourceRange.aspectMask = GetAspect(resource.desc.format);
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    if (srcStages == 0)
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+    bool hasMemoryBarrier = imageBarriers.size() < batch.size();
+
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0,
+        hasMemoryBarrier ? 1 : 0, &memoryBarrier, 0, nullptr,
+        uint32_t(imageBarriers.size()), imageBarriers.data());
+}
+
+void RenderGraph::recordBatch2(VkCommandBuffer commandBuffer, const BarrierBatch& batch)
+{
+    // Stage and access bits below 32 mean the same in both versions.
+    imageBarriers2.clear();
+    memoryBarriers2.clear();
+
+    for (const Barrier& barrier : batch)
+    {
+        if (barrier.oldLayout == barrier.newLayout)
+        {
+            VkMemoryBarrier2 memoryBarrier{};
+            memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+            memoryBarrier.srcStageMask = barrier.srcStages;
+            memoryBarrier.srcAccessMask = barrier.srcAccess;
+            memoryBarrier.dstStageMask = barrier.dstStages;
+            memoryBarrier.dstAccessMask = barrier.dstAccess;
+
+            memoryBarriers2.push_back(memoryBarrier);
+            continue;
+        }
+
+        const Resource& resource = resources[barrier.resource];
+
+        VkImageMemoryBarrier2 imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        imageBarrier.srcStageMask = barrier.srcStages;
+        imageBarrier.srcAccessMask = barrier.srcAccess;
+        imageBarrier.dstStageMask = barrier.dstStages;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resource.image;
+        imageBarrier.subresourceRange.aspectMask = GetAspect(resource.desc.format);
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+        imageBarriers2.push_back(imageBarrier);
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.memoryBarrierCount = uint32_t(memoryBarriers2.size());
+    dependencyInfo.pMemoryBarriers = memoryBarriers2.data();
+    dependencyInfo.imageMemoryBarrierCount = uint32_t(imageBarriers2.size());
+    dependencyInfo.pImageMemoryBarriers = imageBarriers2.data();
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void RenderGraph::beginRendering(VkCommandBuffer commandBuffer, uint32_t passIndex)
+{
+    const Pass& pass = passes[passIndex];
+    const RenderGraphImageDesc& desc = resources[pass.attachments[0].resource].desc;
+
+    VkRect2D renderArea = { { 0, 0 }, { desc.width, desc.height } };
+
+    if (!vulkan13)
+    {
+        clearValues.clear();
+
+        for (const Attachment& attachment : pass.attachments)
+            clearValues.push_back(attachment.clear);
+
+        VkRenderPassBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        beginInfo.renderPass = pass.renderPass;
+        beginInfo.framebuffer = getFramebuffer(passIndex);
+        beginInfo.renderArea = renderArea;
+        beginInfo.clearValueCount = uint32_t(clearValues.size());
+        beginInfo.pClearValues = clearValues.data();
+
+        vkCmdBeginRenderPass(commandBuffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
+
+    renderingAttachments.clear();
+
+    for (const Attachment& attachment : pass.attachments)
+    {
+        VkRenderingAttachmentInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        info.imageView = resources[attachment.resource].view;
+        info.imageLayout = attachment.layout;
+        info.loadOp = attachment.loadOp;
+        info.storeOp = attachment.storeOp;
+        info.clearValue = attachment.clear;
+
+        renderingAttachments.push_back(info);
+    }
+
+    uint32_t colorCount = uint32_t(renderingAttachments.size()) - (pass.hasDepth ? 1 : 0);
+    const VkRenderingAttachmentInfo* depth = pass.hasDepth ? &renderingAttachments.back() : nullptr;
+
+    VkRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.renderArea = renderArea;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = colorCount;
+    renderingInfo.pColorAttachments = renderingAttachments.data();
+    renderingInfo.pDepthAttachment = depth;
+
+    if (depth && (GetAspect(resources[pass.attachments.back().resource].desc.format) & VK_IMAGE_ASPECT_STENCIL_BIT))
+        renderingInfo.pStencilAttachment = depth;
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void RenderGraph::endRendering(VkCommandBuffer commandBuffer)
+{
+    if (vulkan13)
+        vkCmdEndRendering(commandBuffer);
+    else
+        vkCmdEndRenderPass(commandBuffer);
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(uint32_t passIndex)
+{
+    const Pass& pass = passes[passIndex];
+
+    std::vector<VkImageView> views;
+
+    for (const Attachment& attachment : pass.attachments)
+        views.push_back(resources[attachment.resource].view);
+
+    for (const FramebufferEntry& entry : framebuffers)
+    {
+        if (entry.pass == passIndex && entry.views == views)
+            return entry.framebuffer;
+    }
+
+    const RenderGraphImageDesc& desc = resources[pass.attachments[0].resource].desc;
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = pass.renderPass;
+    framebufferInfo.attachmentCount = uint32_t(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = desc.width;
+    framebufferInfo.height = desc.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer;
+    CheckVkResult(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer));
+
+    framebuffers.push_back({ passIndex, std::move(views), framebuffer });
+    return framebuffer;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    auto record = [&](const BarrierBatch& batch)
+    {
+        if (vulkan13)
+            recordBatch2(commandBuffer, batch);
+        else
+            recordBatch(commandBuffer, batch);
+    };
+
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        Pass& pass = passes[i];
+
+        if (!pass.live)
+            continue;
+
+        if (pass.barrierBatch != INVALID)
+            record(batches[pass.barrierBatch]);
+
+        if (!pass.attachments.empty())
+            beginRendering(commandBuffer, i);
+
+        if (pass.execute)
+            pass.execute(commandBuffer, *this);
+
+        if (!pass.attachments.empty())
+            endRendering(commandBuffer);
+    }
+
+    if (!finalBatch.empty())
+        record(finalBatch);
+}
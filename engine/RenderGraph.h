@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "VulkanUtils.h"
+
+// How a pass uses a resource. Decides the stages, access, layout and usage flags of the barriers
+// around it, and whether the pass counts as writing the resource.
+enum class RenderGraphAccess
+{
+    ColorAttachment,
+    DepthAttachment,
+    DepthRead,          // depth testing without writes
+    FragmentSampled,
+    ComputeSampled,
+    ComputeStorageRead,
+    ComputeStorageWrite,
+    TransferSource,
+    TransferDestination,
+
+    // Buffers only.
+    IndirectBuffer,
+    VertexBuffer,
+    UniformBuffer,
+
+    Count,
+};
+
+struct RenderGraphImageDesc
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+struct RenderGraphStats
+{
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+
+    // Per execute().
+    uint32_t barrierBatches = 0;
+    uint32_t imageBarriers = 0;
+    uint32_t memoryBarriers = 0;
+
+    uint32_t transientImages = 0;
+    VkDeviceSize transientBytes = 0; // what the transient images would take on their own
+    VkDeviceSize allocatedBytes = 0; // what they take sharing memory
+};
+
+// A frame described as passes and the images and buffers they use. compile() drops passes nothing
+// needs, works out every barrier from the declared accesses and places transient images whose
+// lifetimes don't overlap in the same memory. execute() then records the passes in the order they
+// were added with one batched barrier in front of each that needs one. Passes with attachments
+// are recorded inside a render pass instance the graph begins and ends for them.
+//
+// On Vulkan 1.3 barriers go through vkCmdPipelineBarrier2 with each barrier's own stages, and
+// passes render with vkCmdBeginRendering. Otherwise barriers share one stage mask per batch and
+// the graph keeps a VkRenderPass per attachment setup and a framebuffer per set of views.
+//
+// Build and compile once, and again when something like the swapchain size changes; execute()
+// every frame. Imported images may change between executes, such as the acquired swapchain image.
+class RenderGraph
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+
+    using PassFunction = std::function<void(VkCommandBuffer commandBuffer, const RenderGraph& graph)>;
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, bool vulkan13);
+    void destroy();
+
+    // Drops every pass and resource and frees the transient memory and framebuffers, which the GPU
+    // must be done with. The same goes for compile() after the graph has been executed.
+    void reset();
+
+    // Transient: created and aliased by compile(), contents undefined at the start of each frame.
+    uint32_t createImage(const char* name, const RenderGraphImageDesc& desc);
+
+    // Owned elsewhere. The image enters each frame in initialLayout and is left in finalLayout. Its
+    // first use waits on earlier work in initialStages, for a swapchain image the stage the acquire
+    // semaphore is waited at.
+    uint32_t importImage(const char* name, VkImage image, VkImageView view, const RenderGraphImageDesc& desc, VkImageLayout initialLayout,
+        VkImageLayout finalLayout, VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    uint32_t importBuffer(const char* name, VkBuffer buffer);
+    void setImportedImage(uint32_t resource, VkImage image, VkImageView view);
+
+    // Passes run in the order they were added. A pass uses each resource once.
+    uint32_t addPass(const char* name, PassFunction execute);
+    void use(uint32_t pass, uint32_t resource, RenderGraphAccess access);
+
+    // Keeps a pass that writes outside the graph, which culling can't see.
+    void setSideEffects(uint32_t pass);
+
+    // Clears an attachment when the pass begins. Otherwise it is loaded, unless nothing before the
+    // pass wrote it this frame.
+    void setClear(uint32_t pass, uint32_t resource, const VkClearValue& value);
+
+    void compile();
+    void execute(VkCommandBuffer commandBuffer);
+
+    VkImage getImage(uint32_t resource) const { return resources[resource].image; }
+    VkImageView getImageView(uint32_t resource) const { return resources[resource].view; }
+    VkBuffer getBuffer(uint32_t resource) const { return resources[resource].buffer; }
+    const RenderGraphImageDesc& getImageDesc(uint32_t resource) const { return resources[resource].desc; }
+
+    // What pipelines drawing in the pass are compatible with once compiled. VK_NULL_HANDLE with
+    // dynamic rendering, where they take a VkPipelineRenderingCreateInfo with the attachment formats.
+    VkRenderPass getRenderPass(uint32_t pass) const { return passes[pass].renderPass; }
+
+    bool isCulled(uint32_t pass) const { return !passes[pass].live; }
+    const RenderGraphStats& getStats() const { return stats; }
+
+private:
+    struct Access
+    {
+        uint32_t resource;
+        RenderGraphAccess access;
+    };
+
+    struct Clear
+    {
+        uint32_t resource;
+        VkClearValue value;
+    };
+
+    struct Attachment
+    {
+        uint32_t resource;
+        VkImageLayout layout;
+        VkAttachmentLoadOp loadOp;
+        VkAttachmentStoreOp storeOp;
+        VkClearValue clear;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        PassFunction execute;
+        std::vector<Access> accesses;
+        std::vector<Clear> clears;
+        bool sideEffects = false;
+        bool live = false;
+        uint32_t barrierBatch = INVALID;
+
+        // Colour attachments in the order they were used, then depth.
+        std::vector<Attachment> attachments;
+        bool hasDepth = false;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+    };
+
+    // Where a resource stands between two passes.
+    struct State
+    {
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags writeAccess = 0;
+        VkPipelineStageFlags readStages = 0; // read since the last write, visible to them
+        VkAccessFlags readAccess = 0;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        bool imported = false;
+        bool isBuffer = false;
+
+        RenderGraphImageDesc desc;
+        VkImageUsageFlags usage = 0;
+        VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+
+        // Transient placement.
+        uint32_t firstPass = INVALID;
+        uint32_t lastPass = INVALID;
+        uint32_t memoryBlock = INVALID;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+
+        State endState;
+    };
+
+    // An image barrier when the layout changes, otherwise a global memory barrier.
+    struct Barrier
+    {
+        uint32_t resource;
+        VkPipelineStageFlags srcStages;
+        VkAccessFlags srcAccess;
+        VkPipelineStageFlags dstStages;
+        VkAccessFlags dstAccess;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+    };
+
+    using BarrierBatch = std::vector<Barrier>;
+
+    struct RenderPassEntry
+    {
+        std::vector<VkAttachmentDescription> attachments;
+        bool hasDepth;
+        VkRenderPass renderPass;
+    };
+
+    struct FramebufferEntry
+    {
+        uint32_t pass;
+        std::vector<VkImageView> views;
+        VkFramebuffer framebuffer;
+    };
+
+    void cullPasses();
+    void allocateTransients();
+    void releaseTransients();
+    void releaseFramebuffers();
+    void buildBarriers();
+    void simulate(std::vector<State>& states, bool record);
+    void addBarrier(BarrierBatch& batch, uint32_t resource, State& state, RenderGraphAccess access);
+    void addAttachment(Pass& pass, uint32_t passIndex, uint32_t resource, VkImageLayout previousLayout, RenderGraphAccess access);
+    void countBatch(const BarrierBatch& batch);
+    void createRenderPasses();
+
+    void recordBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+    void recordBatch2(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+    void beginRendering(VkCommandBuffer commandBuffer, uint32_t passIndex);
+    void endRendering(VkCommandBuffer commandBuffer);
+    VkFramebuffer getFramebuffer(uint32_t passIndex);
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    bool vulkan13 = false;
+
+    std::vector<Pass> passes;
+    std::vector<Resource> resources;
+    std::vector<VkDeviceMemory> memoryBlocks;
+
+    std::vector<BarrierBatch> batches;
+    BarrierBatch finalBatch; // imported images into their final layouts
+
+    // Kept across compiles, a resize doesn't change them.
+    std::vector<RenderPassEntry> renderPasses;
+
+    // Made as execute() meets new views, such as each swapchain image.
+    std::vector<FramebufferEntry> framebuffers;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    std::vector<VkImageMemoryBarrier2> imageBarriers2;
+    std::vector<VkMemoryBarrier2> memoryBarriers2;
+    std::vector<VkRenderingAttachmentInfo> renderingAttachments;
+    std::vector<VkClearValue> clearValues;
+
+    RenderGraphStats stats;
+};
@@ -0,0 +1,448 @@
+#include "ShaderReflection.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+static constexpr uint32_t HEADER_WORDS = 5;
+
+enum SpirvOp : uint32_t
+{
+    OP_ENTRY_POINT = 15,
+    OP_TYPE_INT = 21,
+    OP_TYPE_FLOAT = 22,
+    OP_TYPE_VECTOR = 23,
+    OP_TYPE_MATRIX = 24,
+    OP_TYPE_IMAGE = 25,
+    OP_TYPE_SAMPLER = 26,
+    OP_TYPE_SAMPLED_IMAGE = 27,
+    OP_TYPE_ARRAY = 28,
+    OP_TYPE_RUNTIME_ARRAY = 29,
+    OP_TYPE_STRUCT = 30,
+    OP_TYPE_POINTER = 32,
+    OP_CONSTANT = 43,
+    OP_VARIABLE = 59,
+    OP_DECORATE = 71,
+    OP_MEMBER_DECORATE = 72,
+};
+
+enum SpirvDecoration : uint32_t
+{
+    DECORATION_BLOCK = 2,
+    DECORATION_BUFFER_BLOCK = 3,
+    DECORATION_ARRAY_STRIDE = 6,
+    DECORATION_MATRIX_STRIDE = 7,
+    DECORATION_BUILT_IN = 11,
+    DECORATION_LOCATION = 30,
+    DECORATION_BINDING = 33,
+    DECORATION_DESCRIPTOR_SET = 34,
+    DECORATION_OFFSET = 35,
+};
+
+enum SpirvStorageClass : uint32_t
+{
+    STORAGE_UNIFORM_CONSTANT = 0,
+    STORAGE_INPUT = 1,
+    STORAGE_UNIFORM = 2,
+    STORAGE_PUSH_CONSTANT = 9,
+    STORAGE_STORAGE_BUFFER = 12,
+};
+
+static constexpr uint32_t DIM_BUFFER = 5;
+static constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+static constexpr uint32_t NONE = ~0u;
+
+// What the module says about one id. Types keep the word their instruction starts at.
+struct SpirvId
+{
+    uint32_t opcode = 0;
+    uint32_t instruction = 0;
+
+    uint32_t set = NONE;
+    uint32_t binding = NONE;
+    uint32_t location = NONE;
+    uint32_t arrayStride = 0;
+    bool block = false;
+    bool bufferBlock = false;
+    bool builtIn = false;
+};
+
+struct SpirvModule
+{
+    const uint32_t* words;
+    std::vector<SpirvId> ids;
+
+    // Keyed by struct id and member index.
+    std::unordered_map<uint64_t, uint32_t> memberOffsets;
+    std::unordered_map<uint64_t, uint32_t> memberMatrixStrides;
+
+    const uint32_t* operands(uint32_t id) const { return words + ids[id].instruction + 1; }
+    uint32_t wordCount(uint32_t id) const { return words[ids[id].instruction] >> 16; }
+};
+
+static uint64_t MemberKey(uint32_t structId, uint32_t member)
+{
+    return (uint64_t(structId) << 32) | member;
+}
+
+static VkShaderStageFlagBits GetStage(uint32_t executionModel)
+{
+    switch (executionModel)
+    {
+    case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+    case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+    case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+    default: return VK_SHADER_STAGE_ALL;
+    }
+}
+
+static uint32_t GetConstant(const SpirvModule& module, uint32_t id)
+{
+    return module.ids[id].opcode == OP_CONSTANT ? module.operands(id)[2] : 0;
+}
+
+static uint32_t GetTypeSize(const SpirvModule& module, uint32_t type, uint32_t matrixStride = 0)
+{
+    const uint32_t* operands = module.operands(type);
+
+    switch (module.ids[type].opcode)
+    {
+    case OP_TYPE_INT:
+    case OP_TYPE_FLOAT:
+        return operands[1] / 8;
+    case OP_TYPE_VECTOR:
+        return operands[2] * GetTypeSize(module, operands[1]);
+    case OP_TYPE_MATRIX:
+        return operands[2] * (matrixStride ? matrixStride : GetTypeSize(module, operands[1]));
+    case OP_TYPE_ARRAY:
+    {
+        uint32_t stride = module.ids[type].arrayStride ? module.ids[type].arrayStride : GetTypeSize(module, operands[1]);
+        return GetConstant(module, operands[2]) * stride;
+    }
+    case OP_TYPE_STRUCT:
+    {
+        uint32_t size = 0;
+        uint32_t memberCount = module.wordCount(type) - 2;
+
+        for (uint32_t i = 0; i < memberCount; i++)
+        {
+            auto offset = module.memberOffsets.find(MemberKey(type, i));
+            auto stride = module.memberMatrixStrides.find(MemberKey(type, i));
+
+            uint32_t memberOffset = offset != module.memberOffsets.end() ? offset->second : size;
+            uint32_t memberStride = stride != module.memberMatrixStrides.end() ? stride->second : 0;
+
+            size = std::max(size, memberOffset + GetTypeSize(module, operands[1 + i], memberStride));
+        }
+
+        return size;
+    }
+    default:
+        return 0;
+    }
+}
+
+static VkFormat GetVertexFormat(const SpirvModule& module, uint32_t type)
+{
+    static const VkFormat FORMATS[3][4] =
+    {
+        { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT },
+        { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT },
+        { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT },
+    };
+
+    uint32_t components = 1;
+
+    if (module.ids[type].opcode == OP_TYPE_VECTOR)
+    {
+        components = module.operands(type)[2];
+        type = module.operands(type)[1];
+    }
+
+    const uint32_t* operands = module.operands(type);
+    uint32_t opcode = module.ids[type].opcode;
+
+    // Only 32 bit components, which is all the engine's vertex formats need.
+    if (components > 4 || (opcode != OP_TYPE_FLOAT && opcode != OP_TYPE_INT) || operands[1] != 32)
+        return VK_FORMAT_UNDEFINED;
+
+    uint32_t kind = opcode == OP_TYPE_FLOAT ? 0 : (operands[2] ? 1 : 2);
+    return FORMATS[kind][components - 1];
+}
+
+static VkDescriptorType GetDescriptorType(const SpirvModule& module, uint32_t type, uint32_t storageClass)
+{
+    const SpirvId& id = module.ids[type];
+
+    if (storageClass == STORAGE_STORAGE_BUFFER)
+        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+    if (storageClass == STORAGE_UNIFORM)
+    {
+        if (id.bufferBlock)
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        return id.block ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    }
+
+    if (storageClass != STORAGE_UNIFORM_CONSTANT)
+        return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+
+    switch (id.opcode)
+    {
+    case OP_TYPE_SAMPLER:
+        return VK_DESCRIPTOR_TYPE_SAMPLER;
+    case OP_TYPE_SAMPLED_IMAGE:
+        return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    case OP_TYPE_IMAGE:
+    {
+        const uint32_t* operands = module.operands(type);
+        uint32_t dim = operands[2];
+        bool storage = operands[6] == 2;
+
+        if (dim == DIM_SUBPASS_DATA)
+            return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+
+        if (dim == DIM_BUFFER)
+            return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+        return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    }
+    default:
+        return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    }
+}
+
+bool ReflectShader(const void* code, size_t size, ShaderReflection& reflection)
+{
+    reflection = {};
+
+    if (size < HEADER_WORDS * 4 || size % 4 != 0)
+    {
+        fprintf(stderr, "[reflect] Shader is not SPIR-V, size %zu\n", size);
+        return false;
+    }
+
+    SpirvModule module;
+    module.words = static_cast<const uint32_t*>(code);
+
+    uint32_t wordCount = uint32_t(size / 4);
+
+    if (module.words[0] != SPIRV_MAGIC)
+    {
+        fprintf(stderr, "[reflect] Shader is not SPIR-V, bad magic\n");
+        return false;
+    }
+
+    uint32_t bound = module.words[3];
+    module.ids.resize(bound);
+
+    std::vector<uint32_t> variables;
+    bool entryPoint = false;
+
+    for (uint32_t offset = HEADER_WORDS; offset < wordCount;)
+    {
+        uint32_t opcode = module.words[offset] & 0xFFFF;
+        uint32_t length = module.words[offset] >> 16;
+
+        if (length == 0 || offset + length > wordCount)
+        {
+            fprintf(stderr, "[reflect] Shader has a truncated instruction at word %u\n", offset);
+            return false;
+        }
+
+        const uint32_t* operands = module.words + offset + 1;
+
+        // Result ids come first for types and second after a result type for constants and variables.
+        uint32_t result = NONE;
+
+        switch (opcode)
+        {
+        case OP_ENTRY_POINT:
+            if (!entryPoint)
+                reflection.stage = GetStage(operands[0]);
+
+            entryPoint = true;
+            break;
+        case OP_TYPE_INT:
+        case OP_TYPE_FLOAT:
+        case OP_TYPE_VECTOR:
+        case OP_TYPE_MATRIX:
+        case OP_TYPE_IMAGE:
+        case OP_TYPE_SAMPLER:
+        case OP_TYPE_SAMPLED_IMAGE:
+        case OP_TYPE_ARRAY:
+        case OP_TYPE_RUNTIME_ARRAY:
+        case OP_TYPE_STRUCT:
+        case OP_TYPE_POINTER:
+            result = operands[0];
+            break;
+        case OP_CONSTANT:
+            result = operands[1];
+            break;
+        case OP_VARIABLE:
+            result = operands[1];
+            variables.push_back(result);
+            break;
+        case OP_DECORATE:
+        {
+            if (operands[0] >= bound || length < 3)
+                break;
+
+            SpirvId& target = module.ids[operands[0]];
+            uint32_t value = length > 3 ? operands[2] : 0;
+
+            switch (operands[1])
+            {
+            case DECORATION_BLOCK: target.block = true; break;
+            case DECORATION_BUFFER_BLOCK: target.bufferBlock = true; break;
+            case DECORATION_ARRAY_STRIDE: target.arrayStride = value; break;
+            case DECORATION_BUILT_IN: target.builtIn = true; break;
+            case DECORATION_LOCATION: target.location = value; break;
+            case DECORATION_BINDING: target.binding = value; break;
+            case DECORATION_DESCRIPTOR_SET: target.set = value; break;
+            }
+            break;
+        }
+        case OP_MEMBER_DECORATE:
+            if (length > 4 && operands[2] == DECORATION_OFFSET)
+                module.memberOffsets[MemberKey(operands[0], operands[1])] = operands[3];
+            else if (length > 4 && operands[2] == DECORATION_MATRIX_STRIDE)
+                module.memberMatrixStrides[MemberKey(operands[0], operands[1])] = operands[3];
+            else if (length > 3 && operands[2] == DECORATION_BUILT_IN && operands[0] < bound)
+                module.ids[operands[0]].builtIn = true;
+            break;
+        }
+
+        if (result != NONE)
+        {
+            if (result >= bound)
+            {
+                fprintf(stderr, "[reflect] Shader uses id %u past its bound %u\n", result, bound);
+                return false;
+            }
+
+            module.ids[result].opcode = opcode;
+            module.ids[result].instruction = offset;
+        }
+
+        offset += length;
+    }
+
+    for (uint32_t variable : variables)
+    {
+        const SpirvId& id = module.ids[variable];
+        const uint32_t* operands = module.operands(variable);
+
+        if (operands[0] >= bound || module.ids[operands[0]].opcode != OP_TYPE_POINTER)
+        {
+            fprintf(stderr, "[reflect] Shader variable %u isn't a pointer\n", variable);
+            return false;
+        }
+
+        uint32_t storageClass = operands[2];
+        uint32_t type = module.operands(operands[0])[2]; // through the pointer
+
+        if (storageClass == STORAGE_PUSH_CONSTANT)
+        {
+            uint32_t memberCount = module.wordCount(type) - 2;
+            uint32_t begin = NONE;
+
+            for (uint32_t i = 0; i < memberCount; i++)
+            {
+                auto offset = module.memberOffsets.find(MemberKey(type, i));
+
+                if (offset != module.memberOffsets.end())
+                    begin = std::min(begin, offset->second);
+            }
+
+            reflection.pushConstantOffset = begin != NONE ? begin : 0;
+            reflection.pushConstantSize = GetTypeSize(module, type) - reflection.pushConstantOffset;
+            continue;
+        }
+
+        if (storageClass == STORAGE_INPUT)
+        {
+            if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || id.builtIn || module.ids[type].builtIn || id.location == NONE)
+                continue;
+
+            reflection.vertexInputs.push_back({ id.location, GetVertexFormat(module, type) });
+            continue;
+        }
+
+        if (id.set == NONE || id.binding == NONE)
+            continue;
+
+        ReflectedBinding binding;
+        binding.set = id.set;
+        binding.binding = id.binding;
+
+        while (module.ids[type].opcode == OP_TYPE_ARRAY || module.ids[type].opcode == OP_TYPE_RUNTIME_ARRAY)
+        {
+            const uint32_t* arrayOperands = module.operands(type);
+            binding.count *= module.ids[type].opcode == OP_TYPE_ARRAY ? GetConstant(module, arrayOperands[2]) : 0;
+            type = arrayOperands[1];
+        }
+
+        binding.type = GetDescriptorType(module, type, storageClass);
+
+        if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+        {
+            fprintf(stderr, "[reflect] Shader binding %u.%u has a type that isn't a descriptor\n", binding.set, binding.binding);
+            return false;
+        }
+
+        reflection.bindings.push_back(binding);
+    }
+
+    if (!entryPoint)
+    {
+        fprintf(stderr, "[reflect] Shader has no entry point\n");
+        return false;
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b)
+    {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b)
+    {
+        return a.location < b.location;
+    });
+
+    return true;
+}
+
+uint32_t GetPackedVertexAttributes(const ShaderReflection& reflection, uint32_t binding, std::vector<VkVertexInputAttributeDescription>& attributes)
+{
+    uint32_t stride = 0;
+
+    for (const ReflectedVertexInput& input : reflection.vertexInputs)
+    {
+        VkVertexInputAttributeDescription attribute{};
+        attribute.location = input.location;
+        attribute.binding = binding;
+        attribute.format = input.format;
+        attribute.offset = stride;
+
+        attributes.push_back(attribute);
+
+        // Every reflected format is made of 4 byte components.
+        switch (input.format)
+        {
+        case VK_FORMAT_R32_SFLOAT: case VK_FORMAT_R32_SINT: case VK_FORMAT_R32_UINT: stride += 4; break;
+        case VK_FORMAT_R32G32_SFLOAT: case VK_FORMAT_R32G32_SINT: case VK_FORMAT_R32G32_UINT: stride += 8; break;
+        case VK_FORMAT_R32G32B32_SFLOAT: case VK_FORMAT_R32G32B32_SINT: case VK_FORMAT_R32G32B32_UINT: stride += 12; break;
+        default: stride += 16; break;
+        }
+    }
+
+    return stride;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "VulkanUtils.h"
+
+struct ReflectedBinding
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    uint32_t count = 1; // 0 for an unsized array
+};
+
+struct ReflectedVertexInput
+{
+    uint32_t location = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
+// What a SPIR-V module expects bound, read from its decorations and types.
+struct ShaderReflection
+{
+    VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+
+    std::vector<ReflectedBinding> bindings; // by set, then binding
+
+    uint32_t pushConstantOffset = 0;
+    uint32_t pushConstantSize = 0; // 0 when the module has no push constants
+
+    std::vector<ReflectedVertexInput> vertexInputs; // vertex shaders only, by location
+};
+
+// Reads the first entry point's stage and every resource the module declares, used or not. Prints
+// the reason and returns false for anything that isn't valid SPIR-V.
+bool ReflectShader(const void* code, size_t size, ShaderReflection& reflection);
+
+// Attributes for the vertex inputs interleaved in location order in one binding. Returns the stride.
+uint32_t GetPackedVertexAttributes(const ShaderReflection& reflection, uint32_t binding, std::vector<VkVertexInputAttributeDescription>& attributes);
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ENGINE_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define ENGINE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and Clang need the target spelled out per function.
+#if defined(ENGINE_SIMD_X86) && !defined(_MSC_VER)
+#define ENGINE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2,fma,bmi")))
+#define ENGINE_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma,bmi")))
+#else
+#define ENGINE_TARGET_SSE42
+#define ENGINE_TARGET_AVX2
+#define ENGINE_TARGET_AVX512
+#endif
+
+struct CpuFeatures
+{
+    bool sse2 = false;
+    bool sse42 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+    bool neon = false;
+
+    static const CpuFeatures& get()
+    {
+        static const CpuFeatures features = detect();
+        return features;
+    }
+
+private:
+    static CpuFeatures detect()
+    {
+        CpuFeatures features;
+
+#if defined(ENGINE_SIMD_X86)
+        uint32_t leaf1[4] = {};
+        uint32_t leaf7[4] = {};
+
+        cpuid(1, 0, leaf1);
+        cpuid(7, 0, leaf7);
+
+        features.sse2 = (leaf1[3] & (1u << 26)) != 0;
+        features.sse42 = (leaf1[2] & (1u << 20)) != 0;
+
+        // AVX state has to be enabled by the OS as well as supported by the CPU.
+        bool osxsave = (leaf1[2] & (1u << 27)) != 0;
+        uint64_t xcr0 = osxsave ? xgetbv() : 0;
+
+        bool avxState = (xcr0 & 0x6) == 0x6;
+        bool avx512State = (xcr0 & 0xE6) == 0xE6;
+
+        // The AVX2 kernels are compiled with FMA and BMI1 enabled too, so all three are required.
+        bool fma = (leaf1[2] & (1u << 12)) != 0;
+
+        features.avx2 = avxState && fma && (leaf7[1] & (1u << 5)) != 0 && (leaf7[1] & (1u << 3)) != 0;
+        features.avx512 = avx512State && features.avx2 && (leaf7[1] & (1u << 16)) != 0;
+#elif defined(ENGINE_SIMD_NEON)
+        features.neon = true;
+#endif
+
+        return features;
+    }
+
+#if defined(ENGINE_SIMD_X86)
+    static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t out[4])
+    {
+#if defined(_MSC_VER)
+        int regs[4];
+        __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+
+        for (int i = 0; i < 4; i++)
+            out[i] = static_cast<uint32_t>(regs[i]);
+#else
+        __cpuid_count(leaf, subleaf, out[0], out[1], out[2], out[3]);
+#endif
+    }
+
+    static uint64_t xgetbv()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+    }
+#endif
+};
+
+inline uint32_t CountTrailingZeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+inline uint32_t CountTrailingZeros64(uint64_t value)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#elif defined(_MSC_VER)
+    uint32_t lo = static_cast<uint32_t>(value);
+    return lo ? CountTrailingZeros(lo) : 32 + CountTrailingZeros(static_cast<uint32_t>(value >> 32));
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
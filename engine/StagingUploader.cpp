@@ -0,0 +1,198 @@
+#include "StagingUploader.h"
+
+#include <stdexcept>
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void StagingUploader::init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, VkDeviceSize capacity)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->queue = queue;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    CheckVkResult(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool));
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    CheckVkResult(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer));
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    CheckVkResult(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline));
+
+    createStaging(capacity);
+}
+
+void StagingUploader::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    flush();
+
+    DestroyBuffer(device, staging);
+    vkDestroySemaphore(device, timeline, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+
+    device = VK_NULL_HANDLE;
+}
+
+void StagingUploader::createStaging(VkDeviceSize capacity)
+{
+    staging = CreateBuffer(physicalDevice, device, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+uint8_t* StagingUploader::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+    offset = AlignUp(head, alignment);
+
+    if (offset + size > staging.size)
+    {
+        flush();
+        offset = 0;
+
+        if (size > staging.size)
+        {
+            DestroyBuffer(device, staging);
+            createStaging(AlignUp(size, DEFAULT_CAPACITY));
+        }
+    }
+
+    head = offset + size;
+
+    return static_cast<uint8_t*>(staging.mapped) + offset;
+}
+
+VkCommandBuffer StagingUploader::getCommandBuffer()
+{
+    if (!recording)
+    {
+        // The one command buffer may still be executing the last submit.
+        wait(submitted);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        CheckVkResult(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+        recording = true;
+    }
+
+    return commandBuffer;
+}
+
+void StagingUploader::copyToBuffer(VkDeviceSize stagingOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size)
+{
+    VkBufferCopy region{};
+    region.srcOffset = stagingOffset;
+    region.dstOffset = dstOffset;
+    region.size = size;
+
+    vkCmdCopyBuffer(getCommandBuffer(), staging.buffer, dst, 1, &region);
+}
+
+void StagingUploader::copyToImage(VkDeviceSize stagingOffset, VkImage dst, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    if (mipCount == 0)
+        throw std::runtime_error("images need at least one mip level.");
+
+    VkCommandBuffer commandBuffer = getCommandBuffer();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = dst;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipCount, 0, 1 };
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = stagingOffset;
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { width, height, 1 };
+
+    vkCmdCopyBufferToImage(commandBuffer, staging.buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    RecordMipBlits(commandBuffer, dst, width, height, mipCount);
+}
+
+uint64_t StagingUploader::submit()
+{
+    if (!recording)
+        return submitted;
+
+    // Make the copies visible to anything that reads them later on this queue.
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    CheckVkResult(vkEndCommandBuffer(commandBuffer));
+    recording = false;
+
+    submitted++;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &submitted;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timeline;
+
+    CheckVkResult(vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    return submitted;
+}
+
+void StagingUploader::wait(uint64_t value)
+{
+    if (value == 0)
+        return;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline;
+    waitInfo.pValues = &value;
+
+    CheckVkResult(vkWaitSemaphores(device, &waitInfo, UINT64_MAX));
+}
+
+void StagingUploader::flush()
+{
+    wait(submit());
+    head = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "VulkanUtils.h"
+
+// Batches host to device copies through one persistently mapped staging buffer. Callers write
+// straight into the memory returned by allocate() and record copies out of it; flush() submits
+// everything recorded so far and waits for it. submit() doesn't wait, it returns the value the
+// uploader's timeline semaphore reaches once the batch is done, for waiting on it later.
+class StagingUploader
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_CAPACITY = 64ull * 1024 * 1024;
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, VkDeviceSize capacity = DEFAULT_CAPACITY);
+    void destroy();
+
+    // Reserves size bytes of staging memory. Flushes pending copies when the buffer is full and
+    // grows it when a single allocation is larger than the whole buffer.
+    uint8_t* allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+
+    void copyToBuffer(VkDeviceSize stagingOffset, VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size);
+
+    // Copies tightly packed texels into level 0 of an image in UNDEFINED layout, blits the rest of
+    // its mipCount levels from it and leaves them all in SHADER_READ_ONLY_OPTIMAL. The format has
+    // to pass SupportsMipBlits when mipCount is above one.
+    void copyToImage(VkDeviceSize stagingOffset, VkImage dst, uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // Records into the pending batch, for copies that need more than copyToBuffer offers.
+    VkCommandBuffer getCommandBuffer();
+    VkBuffer getStagingBuffer() const { return staging.buffer; }
+
+    // Submits the pending batch without waiting for it. Staging memory it uses stays reserved until
+    // the next flush(). Returns the last submitted value when nothing was pending.
+    uint64_t submit();
+    void wait(uint64_t value);
+    void flush();
+
+    VkSemaphore getTimeline() const { return timeline; }
+
+    VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
+    VkDevice getDevice() const { return device; }
+
+private:
+    void createStaging(VkDeviceSize capacity);
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    uint64_t submitted = 0;
+
+    GpuBuffer staging;
+    VkDeviceSize head = 0;
+    bool recording = false;
+};
@@ -0,0 +1,194 @@
+#include "Task.h"
+
+static constexpr size_t FRAME_CLASS_COUNT = CoroutineFramePool::MAX_POOLED_SIZE / CoroutineFramePool::GRANULARITY;
+
+// Frames a thread keeps per size class before half of them go back to the shared lists.
+static constexpr uint32_t LOCAL_FRAME_LIMIT = 64;
+
+static constexpr size_t FRAME_SLAB_SIZE = 64 * 1024;
+
+struct FreeFrame
+{
+    FreeFrame* next;
+};
+
+struct SharedFrameLists
+{
+    std::mutex mutex;
+    FreeFrame* heads[FRAME_CLASS_COUNT] = {};
+
+    // Slabs are never freed, frames from them may sit on any thread's list.
+    std::vector<void*> slabs;
+};
+
+static SharedFrameLists& GetSharedFrameLists()
+{
+    static SharedFrameLists lists;
+    return lists;
+}
+
+struct LocalFrameLists
+{
+    FreeFrame* heads[FRAME_CLASS_COUNT] = {};
+    uint32_t counts[FRAME_CLASS_COUNT] = {};
+
+    // Hands this thread's frames to the others when it exits.
+    ~LocalFrameLists()
+    {
+        SharedFrameLists& shared = GetSharedFrameLists();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        for (size_t i = 0; i < FRAME_CLASS_COUNT; i++)
+        {
+            while (FreeFrame* frame = heads[i])
+            {
+                heads[i] = frame->next;
+                frame->next = shared.heads[i];
+                shared.heads[i] = frame;
+            }
+        }
+    }
+};
+
+static thread_local LocalFrameLists localFrames;
+
+void* CoroutineFramePool::allocate(size_t size)
+{
+    if (size > MAX_POOLED_SIZE)
+        return ::operator new(size);
+
+    size_t sizeClass = (size + GRANULARITY - 1) / GRANULARITY - 1;
+    LocalFrameLists& local = localFrames;
+
+    if (!local.heads[sizeClass])
+    {
+        SharedFrameLists& shared = GetSharedFrameLists();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        for (uint32_t i = 0; i < LOCAL_FRAME_LIMIT / 2 && shared.heads[sizeClass]; i++)
+        {
+            FreeFrame* frame = shared.heads[sizeClass];
+            shared.heads[sizeClass] = frame->next;
+            frame->next = local.heads[sizeClass];
+            local.heads[sizeClass] = frame;
+            local.counts[sizeClass]++;
+        }
+
+        if (!local.heads[sizeClass])
+        {
+            auto slab = static_cast<uint8_t*>(::operator new(FRAME_SLAB_SIZE));
+            shared.slabs.push_back(slab);
+
+            size_t frameSize = (sizeClass + 1) * GRANULARITY;
+
+            for (size_t offset = 0; offset + frameSize <= FRAME_SLAB_SIZE; offset += frameSize)
+            {
+                auto frame = reinterpret_cast<FreeFrame*>(slab + offset);
+                frame->next = local.heads[sizeClass];
+                local.heads[sizeClass] = frame;
+                local.counts[sizeClass]++;
+            }
+        }
+    }
+
+    FreeFrame* frame = local.heads[sizeClass];
+    local.heads[sizeClass] = frame->next;
+    local.counts[sizeClass]--;
+
+    return frame;
+}
+
+void CoroutineFramePool::deallocate(void* frame, size_t size)
+{
+    if (size > MAX_POOLED_SIZE)
+    {
+        ::operator delete(frame);
+        return;
+    }
+
+    size_t sizeClass = (size + GRANULARITY - 1) / GRANULARITY - 1;
+    LocalFrameLists& local = localFrames;
+
+    auto freed = static_cast<FreeFrame*>(frame);
+    freed->next = local.heads[sizeClass];
+    local.heads[sizeClass] = freed;
+
+    if (++local.counts[sizeClass] <= LOCAL_FRAME_LIMIT)
+        return;
+
+    SharedFrameLists& shared = GetSharedFrameLists();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+
+    for (uint32_t i = 0; i < LOCAL_FRAME_LIMIT / 2; i++)
+    {
+        FreeFrame* moved = local.heads[sizeClass];
+        local.heads[sizeClass] = moved->next;
+        moved->next = shared.heads[sizeClass];
+        shared.heads[sizeClass] = moved;
+    }
+
+    local.counts[sizeClass] -= LOCAL_FRAME_LIMIT / 2;
+}
+
+struct WhenAllState
+{
+    // One per task plus one for the launching await_suspend, so the last task can't resume the
+    // awaiter while it is still launching the others.
+    std::atomic<uint32_t> remaining{ 0 };
+    std::coroutine_handle<> continuation;
+
+    std::mutex mutex;
+    std::exception_ptr exception;
+};
+
+static DetachedTask RunWhenAllTask(JobSystem& jobs, Task<void>& task, WhenAllState& state)
+{
+    co_await ScheduleOn(jobs);
+
+    try
+    {
+        co_await std::move(task);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        if (!state.exception)
+            state.exception = std::current_exception();
+    }
+
+    if (state.remaining.fetch_sub(1) == 1)
+        state.continuation.resume();
+}
+
+Task<void> WhenAll(JobSystem& jobs, std::vector<Task<void>> tasks)
+{
+    struct Awaiter
+    {
+        JobSystem& jobs;
+        std::vector<Task<void>>& tasks;
+        WhenAllState& state;
+
+        bool await_ready() const noexcept { return tasks.empty(); }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            state.continuation = handle;
+            state.remaining = static_cast<uint32_t>(tasks.size()) + 1;
+
+            for (Task<void>& task : tasks)
+                RunWhenAllTask(jobs, task, state);
+
+            // Everything finished already, carry on without suspending.
+            return state.remaining.fetch_sub(1) != 1;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    WhenAllState state;
+    co_await Awaiter{ jobs, tasks, state };
+
+    if (state.exception)
+        std::rethrow_exception(state.exception);
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Coroutine frames come from here instead of the heap. Freed frames go on a free list of the
+// freeing thread and only move to the shared lists in batches, so a frame allocated on one thread
+// and finished on another costs a lock only once in a while. Memory is kept for reuse, never
+// returned.
+class CoroutineFramePool
+{
+public:
+    static constexpr size_t GRANULARITY = 64;
+    static constexpr size_t MAX_POOLED_SIZE = 2048; // larger frames go to the heap
+
+    static void* allocate(size_t size);
+    static void deallocate(void* frame, size_t size);
+};
+
+template<typename T>
+class Task;
+
+struct TaskPromiseBase
+{
+    // Resumed when the task finishes, the coroutine awaiting it.
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    static void* operator new(size_t size) { return CoroutineFramePool::allocate(size); }
+    static void operator delete(void* frame, size_t size) { CoroutineFramePool::deallocate(frame, size); }
+
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+
+        // Symmetric transfer, a long chain of tasks finishing doesn't grow the stack.
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    // Tasks are lazy, nothing runs until the task is awaited.
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase
+{
+    alignas(T) unsigned char storage[sizeof(T)];
+    bool hasValue = false;
+
+    ~TaskPromise()
+    {
+        if (hasValue)
+            reinterpret_cast<T*>(storage)->~T();
+    }
+
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U&& value)
+    {
+        new (storage) T(std::forward<U>(value));
+        hasValue = true;
+    }
+
+    T takeResult()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+
+        return std::move(*reinterpret_cast<T*>(storage));
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase
+{
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void takeResult()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+};
+
+// A coroutine that produces a T. Awaiting it starts it and resumes the awaiter once it finishes,
+// on whatever thread it finished on. Exceptions are rethrown in the awaiter. Owns its frame.
+template<typename T = void>
+class Task
+{
+public:
+    using promise_type = TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    ~Task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+
+            handle = std::exchange(other.handle, nullptr);
+        }
+
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool isValid() const { return handle != nullptr; }
+    bool isDone() const { return handle && handle.done(); }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+
+        return Awaiter{ handle };
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Starts right away and destroys itself when done, the top of a chain of tasks.
+struct DetachedTask
+{
+    struct promise_type
+    {
+        static void* operator new(size_t size) { return CoroutineFramePool::allocate(size); }
+        static void operator delete(void* frame, size_t size) { CoroutineFramePool::deallocate(frame, size); }
+
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+
+        // Nothing is left to hand the exception to, same as an exception escaping a thread.
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Runs the task to completion without anyone awaiting it. It runs on this thread until its first
+// suspension.
+inline DetachedTask Spawn(Task<void> task)
+{
+    co_await std::move(task);
+}
+
+// Blocks the calling thread until the task has finished, for tools and shutdown paths. Never
+// call it from a thread the task needs to make progress.
+template<typename T>
+T SyncWait(Task<T> task)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::exception_ptr exception;
+
+    std::conditional_t<std::is_void_v<T>, char, std::optional<T>> result{};
+
+    auto run = [&]() -> DetachedTask
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+                co_await std::move(task);
+            else
+                result.emplace(co_await std::move(task));
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        condition.notify_all();
+    };
+
+    run();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return done; });
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    if constexpr (!std::is_void_v<T>)
+        return std::move(*result);
+}
+
+// co_await ScheduleOn(jobs) continues the coroutine on a job system worker.
+inline auto ScheduleOn(JobSystem& jobs)
+{
+    struct Awaiter
+    {
+        JobSystem& jobs;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { jobs.submit([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    return Awaiter{ jobs };
+}
+
+// Non blocking parallelFor: the chunks run on the workers and the coroutine continues on the
+// worker that finishes the last one, no thread waits in between.
+inline auto ParallelForAsync(JobSystem& jobs, uint32_t count, uint32_t chunkSize, JobSystem::RangeJob job)
+{
+    struct Awaiter
+    {
+        JobSystem& jobs;
+        uint32_t count;
+        uint32_t chunkSize;
+        JobSystem::RangeJob job;
+        std::atomic<uint32_t> remaining{ 0 };
+
+        bool await_ready() const noexcept { return count == 0; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            chunkSize = chunkSize > 0 ? chunkSize : 1;
+            uint32_t chunkCount = jobs.getChunkCount(count, chunkSize);
+            remaining = chunkCount;
+
+            // The awaiter lives in the suspended frame, so it outlives every chunk.
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                jobs.submit([this, handle, chunk]()
+                {
+                    uint32_t begin = chunk * chunkSize;
+                    job(begin, count - begin < chunkSize ? count : begin + chunkSize);
+
+                    if (remaining.fetch_sub(1) == 1)
+                        handle.resume();
+                });
+            }
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    return Awaiter{ jobs, count, chunkSize, std::move(job) };
+}
+
+// Runs every task on the job system at once and continues once all of them have finished, on
+// the worker that finished last. Rethrows the first exception after all have finished.
+Task<void> WhenAll(JobSystem& jobs, std::vector<Task<void>> tasks);
@@ -0,0 +1,152 @@
+#include "TextureFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t GetTextureMipSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8Unorm:
+    case TextureFormat::RGBA8Srgb:
+        return uint64_t(width) * height * 4;
+    case TextureFormat::BC1Unorm:
+    case TextureFormat::BC1Srgb:
+    case TextureFormat::BC4Unorm:
+        return uint64_t((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case TextureFormat::BC3Unorm:
+    case TextureFormat::BC3Srgb:
+    case TextureFormat::BC5Unorm:
+    case TextureFormat::BC7Unorm:
+    case TextureFormat::BC7Srgb:
+        return uint64_t((width + 3) / 4) * ((height + 3) / 4) * 16;
+    }
+
+    return 0;
+}
+
+uint32_t GetTextureBlockHeight(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8Unorm:
+    case TextureFormat::RGBA8Srgb:
+        return 1;
+    default:
+        return 4;
+    }
+
+    return 1;
+}
+
+uint32_t GetMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+
+    while ((width | height) > 1)
+    {
+        width = std::max(width >> 1, 1u);
+        height = std::max(height >> 1, 1u);
+        count++;
+    }
+
+    return count;
+}
+
+bool TextureFileView::open(const uint8_t* data, size_t size)
+{
+    header = nullptr;
+
+    if (size < sizeof(TextureFileHeader))
+        return false;
+
+    auto candidate = reinterpret_cast<const TextureFileHeader*>(data);
+
+    if (candidate->magic != TEXTURE_FILE_MAGIC || candidate->version != TEXTURE_FILE_VERSION || candidate->headerSize != sizeof(TextureFileHeader))
+        return false;
+
+    if (candidate->mipCount == 0 || candidate->mipCount > TEXTURE_FILE_MAX_MIPS)
+        return false;
+
+    if (sizeof(TextureFileHeader) + candidate->mipCount * sizeof(TextureFileMip) > size)
+        return false;
+
+    auto mipTable = reinterpret_cast<const TextureFileMip*>(data + sizeof(TextureFileHeader));
+
+    for (uint32_t i = 0; i < candidate->mipCount; i++)
+    {
+        const TextureFileMip& mip = mipTable[i];
+
+        if (mip.size != GetTextureMipSize(candidate->format, mip.width, mip.height) || mip.size == 0)
+            return false;
+
+        if (mip.offset > size || mip.size > size - mip.offset)
+            return false;
+    }
+
+    base = data;
+    header = candidate;
+    mips = mipTable;
+
+    return true;
+}
+
+std::vector<uint8_t> SerializeTextureFile(const TextureFileData& texture)
+{
+    TextureFileHeader header{};
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.headerSize = sizeof(TextureFileHeader);
+    header.format = texture.format;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.mipCount = static_cast<uint32_t>(texture.mips.size());
+
+    std::vector<TextureFileMip> mips(texture.mips.size());
+
+    uint64_t offset = AlignUp(sizeof(TextureFileHeader) + mips.size() * sizeof(TextureFileMip), TEXTURE_FILE_ALIGNMENT);
+    uint32_t width = texture.width;
+    uint32_t height = texture.height;
+
+    for (size_t i = 0; i < mips.size(); i++)
+    {
+        mips[i].width = width;
+        mips[i].height = height;
+        mips[i].offset = offset;
+        mips[i].size = texture.mips[i].size();
+
+        offset = AlignUp(offset + mips[i].size, TEXTURE_FILE_ALIGNMENT);
+        width = std::max(width >> 1, 1u);
+        height = std::max(height >> 1, 1u);
+    }
+
+    std::vector<uint8_t> file(offset, 0);
+
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), mips.data(), mips.size() * sizeof(TextureFileMip));
+
+    for (size_t i = 0; i < mips.size(); i++)
+        memcpy(file.data() + mips[i].offset, texture.mips[i].data(), texture.mips[i].size());
+
+    return file;
+}
+
+bool WriteTextureFile(const char* path, const TextureFileData& texture)
+{
+    std::vector<uint8_t> file = SerializeTextureFile(texture);
+
+    FILE* handle = fopen(path, "wb");
+
+    if (!handle)
+        return false;
+
+    bool written = fwrite(file.data(), 1, file.size(), handle) == file.size();
+
+    return fclose(handle) == 0 && written;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Engine native texture container. Every mip is stored in its final GPU layout at an aligned
+// offset, so any subset of mips can be copied straight from the file mapping into staging.
+//
+// Layout: TextureFileHeader, mipCount TextureFileMip (largest first), then the mip data.
+
+static constexpr uint32_t TEXTURE_FILE_MAGIC = 0x58455456; // "VTEX"
+static constexpr uint32_t TEXTURE_FILE_VERSION = 1;
+static constexpr uint32_t TEXTURE_FILE_ALIGNMENT = 256;
+static constexpr uint32_t TEXTURE_FILE_MAX_MIPS = 16;
+
+enum class TextureFormat : uint32_t
+{
+    RGBA8Unorm,
+    RGBA8Srgb,
+
+    // 4x4 blocks, see BlockCompression.h
+    BC1Unorm,
+    BC1Srgb,
+    BC3Unorm,
+    BC3Srgb,
+    BC4Unorm,
+    BC5Unorm,
+    BC7Unorm,
+    BC7Srgb,
+};
+
+struct TextureFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t headerSize;
+    TextureFormat format;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t flags;
+};
+
+struct TextureFileMip
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+};
+
+static_assert(sizeof(TextureFileHeader) == 32, "texture file header layout changed");
+static_assert(sizeof(TextureFileMip) == 24, "texture file mip layout changed");
+
+uint64_t GetTextureMipSize(TextureFormat format, uint32_t width, uint32_t height);
+
+// Texel rows stored together in one row of the mip data, so partial uploads split on multiples of it.
+uint32_t GetTextureBlockHeight(TextureFormat format);
+uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+// Validates a texture file in place, every accessor points into the given memory.
+class TextureFileView
+{
+public:
+    bool open(const uint8_t* data, size_t size);
+
+    const TextureFileHeader& getHeader() const { return *header; }
+    const TextureFileMip& getMip(uint32_t level) const { return mips[level]; }
+    const uint8_t* getMipData(uint32_t level) const { return base + mips[level].offset; }
+
+private:
+    const uint8_t* base = nullptr;
+    const TextureFileHeader* header = nullptr;
+    const TextureFileMip* mips = nullptr;
+};
+
+struct TextureFileData
+{
+    TextureFormat format = TextureFormat::RGBA8Unorm;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // One entry per mip, largest first, each GetTextureMipSize bytes.
+    std::vector<std::vector<uint8_t>> mips;
+};
+
+std::vector<uint8_t> SerializeTextureFile(const TextureFileData& texture);
+bool WriteTextureFile(const char* path, const TextureFileData& texture);
@@ -0,0 +1,754 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static constexpr VkDeviceSize STAGING_ALIGNMENT = 256;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+VkFormat GetVkFormat(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::RGBA8Unorm: return VK_FORMAT_R8G8B8A8_UNORM;
+    case TextureFormat::RGBA8Srgb: return VK_FORMAT_R8G8B8A8_SRGB;
+    case TextureFormat::BC1Unorm: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case TextureFormat::BC1Srgb: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+    case TextureFormat::BC3Unorm: return VK_FORMAT_BC3_UNORM_BLOCK;
+    case TextureFormat::BC3Srgb: return VK_FORMAT_BC3_SRGB_BLOCK;
+    case TextureFormat::BC4Unorm: return VK_FORMAT_BC4_UNORM_BLOCK;
+    case TextureFormat::BC5Unorm: return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureFormat::BC7Unorm: return VK_FORMAT_BC7_UNORM_BLOCK;
+    case TextureFormat::BC7Srgb: return VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+void TextureStreamer::init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue transferQueue, uint32_t transferFamily,
+    uint32_t graphicsFamily, const TextureStreamerSettings& settings)
+{
+    this->physicalDevice = physicalDevice;
+    this->device = device;
+    this->queue = transferQueue;
+    this->transferFamily = transferFamily;
+    this->graphicsFamily = graphicsFamily;
+    this->settings = settings;
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+    // Transfer only families may only copy whole mips, reported as a granularity of zero.
+    VkExtent3D granularity = families[transferFamily].minImageTransferGranularity;
+    rowGranularity = granularity.width == 0 ? 0 : granularity.height;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = transferFamily;
+
+    CheckVkResult(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool));
+
+    for (auto& batch : batches)
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        CheckVkResult(vkAllocateCommandBuffers(device, &allocInfo, &batch.commandBuffer));
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        CheckVkResult(vkCreateFence(device, &fenceInfo, nullptr, &batch.fence));
+    }
+
+    reserveStaging(settings.uploadBudget);
+
+    stats = {};
+    stats.memoryBudget = settings.memoryBudget;
+}
+
+void TextureStreamer::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    CheckVkResult(vkQueueWaitIdle(queue));
+
+    for (auto& texture : textures)
+    {
+        destroyImage(texture.current);
+
+        if (texture.load)
+            destroyImage(texture.load->image);
+    }
+
+    destroyRetired(true);
+
+    for (auto& batch : batches)
+    {
+        vkDestroyFence(device, batch.fence, nullptr);
+        batch = {};
+    }
+
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    DestroyBuffer(device, staging);
+
+    textures.clear();
+    freeTextures.clear();
+    finished.clear();
+
+    device = VK_NULL_HANDLE;
+}
+
+void TextureStreamer::reserveStaging(VkDeviceSize size)
+{
+    size = AlignUp(size, STAGING_ALIGNMENT);
+
+    if (size <= batchSize)
+        return;
+
+    if (staging.buffer != VK_NULL_HANDLE)
+    {
+        CheckVkResult(vkQueueWaitIdle(queue));
+        retireBatches();
+        DestroyBuffer(device, staging);
+    }
+
+    staging = CreateBuffer(physicalDevice, device, size * BATCH_COUNT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    batchSize = size;
+
+    for (uint32_t i = 0; i < BATCH_COUNT; i++)
+        batches[i].stagingOffset = i * size;
+}
+
+uint32_t TextureStreamer::addTexture(const VirtualFileSystem& vfs, const char* path)
+{
+    Texture texture;
+
+    if (!vfs.open(path, texture.file) || !texture.view.open(texture.file.data(), texture.file.size()))
+    {
+        fprintf(stderr, "[texture] Failed to load %s\n", path);
+        return INVALID;
+    }
+
+    const TextureFileHeader& header = texture.view.getHeader();
+
+    texture.mipCount = header.mipCount;
+    texture.tailMip = header.mipCount - 1;
+
+    for (uint32_t i = 0; i < header.mipCount; i++)
+    {
+        const TextureFileMip& mip = texture.view.getMip(i);
+
+        if (std::max(mip.width, mip.height) <= settings.residentTailSize)
+        {
+            texture.tailMip = i;
+            break;
+        }
+    }
+
+    texture.residentMip = texture.mipCount;
+    texture.wantedMip = texture.tailMip;
+    texture.alive = true;
+
+    // Every copy has to fit in one batch, which for whole mip copies means the largest mip.
+    const TextureFileMip& top = texture.view.getMip(0);
+    uint32_t blockRows = (top.height + GetTextureBlockHeight(header.format) - 1) / GetTextureBlockHeight(header.format);
+
+    if (rowGranularity == 0)
+        reserveStaging(top.size);
+    else
+        reserveStaging(top.size / blockRows * rowGranularity);
+
+    uint32_t index;
+
+    if (!freeTextures.empty())
+    {
+        index = freeTextures.back();
+        freeTextures.pop_back();
+        textures[index] = std::move(texture);
+    }
+    else
+    {
+        index = static_cast<uint32_t>(textures.size());
+        textures.push_back(std::move(texture));
+    }
+
+    return index;
+}
+
+void TextureStreamer::removeTexture(uint32_t index)
+{
+    Texture& texture = textures[index];
+
+    if (!texture.alive)
+        return;
+
+    texture.alive = false;
+    retire(texture.current);
+    finished.erase(std::remove(finished.begin(), finished.end(), index), finished.end());
+
+    // A load still referenced by a batch is released once that batch completes.
+    if (!texture.load || texture.load->batchesInFlight == 0)
+        releaseTexture(index);
+}
+
+void TextureStreamer::releaseTexture(uint32_t index)
+{
+    Texture& texture = textures[index];
+
+    if (texture.load)
+        retire(texture.load->image);
+
+    texture.load.reset();
+    texture.file.close();
+
+    freeTextures.push_back(index);
+}
+
+void TextureStreamer::request(uint32_t index, float screenSize, float distance)
+{
+    Texture& texture = textures[index];
+    const TextureFileHeader& header = texture.view.getHeader();
+
+    // One texel per pixel: every halving of the on screen size drops a mip.
+    float ratio = static_cast<float>(std::max(header.width, header.height)) / std::max(screenSize, 1.0f);
+    uint32_t mip = ratio > 1.0f ? static_cast<uint32_t>(std::log2(ratio)) : 0;
+    mip = std::min(mip, texture.tailMip);
+
+    float priority = screenSize / std::max(distance, 1.0f);
+
+    if (texture.lastUsedFrame != frame)
+    {
+        texture.lastUsedFrame = frame;
+        texture.wantedMip = mip;
+        texture.priority = priority;
+    }
+    else
+    {
+        texture.wantedMip = std::min(texture.wantedMip, mip);
+        texture.priority = std::max(texture.priority, priority);
+    }
+}
+
+float TextureStreamer::ComputeScreenSize(const BoundingSphere& sphere, const glm::vec3& cameraPosition, float fovY, float viewportHeight)
+{
+    float distance = glm::length(sphere.center - cameraPosition);
+
+    if (distance <= sphere.radius)
+        return viewportHeight;
+
+    float projected = sphere.radius / (std::tan(fovY * 0.5f) * std::sqrt(distance * distance - sphere.radius * sphere.radius));
+
+    return projected * viewportHeight;
+}
+
+void TextureStreamer::update()
+{
+    retireBatches();
+    destroyRetired(false);
+
+    stats.uploadedBytes = 0;
+
+    Batch& batch = batches[nextBatch];
+
+    // Every batch is still in flight, the transfer queue is behind so skip a frame.
+    if (batch.submitted)
+    {
+        updateStats();
+        frame++;
+        return;
+    }
+
+    VkDeviceSize head = batch.stagingOffset;
+    VkDeviceSize end = batch.stagingOffset + batchSize;
+
+    // Loads already under way go first so their memory is not held longer than needed.
+    for (uint32_t i = 0; i < textures.size(); i++)
+    {
+        const Texture& texture = textures[i];
+
+        if (texture.alive && texture.load && !texture.load->uploaded)
+            uploadLoad(i, batch, head, end);
+    }
+
+    // Textures with nothing resident load their tail before anything else, then the rest go
+    // a mip at a time, most visible and furthest from their wanted mip first.
+    candidates.clear();
+
+    for (uint32_t i = 0; i < textures.size(); i++)
+    {
+        const Texture& texture = textures[i];
+
+        if (!texture.alive || texture.load)
+            continue;
+
+        if (texture.residentMip == texture.mipCount)
+            candidates.push_back({ i, FLT_MAX });
+        else if (texture.lastUsedFrame == frame && texture.wantedMip < texture.residentMip)
+            candidates.push_back({ i, texture.priority * static_cast<float>(texture.residentMip - texture.wantedMip) });
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+    VkDeviceSize committed = getCommittedBytes();
+    bool evicted = false;
+
+    for (const auto& candidate : candidates)
+    {
+        if (AlignUp(head, STAGING_ALIGNMENT) >= end)
+            break;
+
+        Texture& texture = textures[candidate.texture];
+        bool tail = texture.residentMip == texture.mipCount;
+        uint32_t firstMip = tail ? texture.tailMip : texture.residentMip - 1;
+
+        // The tails are small and must always load, everything else waits for room.
+        if (!tail && committed + getImageSize(texture, firstMip) > settings.memoryBudget)
+        {
+            if (!evicted)
+                evict(committed + getImageSize(texture, firstMip) - settings.memoryBudget);
+
+            evicted = true;
+            continue;
+        }
+
+        if (!startLoad(candidate.texture, firstMip))
+        {
+            if (!evicted)
+                evict(getImageSize(texture, firstMip));
+
+            evicted = true;
+            continue;
+        }
+
+        committed += texture.load->image.size;
+        uploadLoad(candidate.texture, batch, head, end);
+    }
+
+    if (batch.recording)
+    {
+        submitBatch(batch);
+        nextBatch = (nextBatch + 1) % BATCH_COUNT;
+    }
+
+    updateStats();
+    frame++;
+}
+
+void TextureStreamer::evict(VkDeviceSize needed)
+{
+    // Least recently requested first. Textures requested this frame only give up the mips they
+    // no longer want.
+    evictions.clear();
+
+    for (uint32_t i = 0; i < textures.size(); i++)
+    {
+        const Texture& texture = textures[i];
+
+        if (!texture.alive || texture.load || texture.residentMip >= texture.tailMip)
+            continue;
+
+        if (texture.lastUsedFrame != frame || texture.wantedMip > texture.residentMip)
+            evictions.push_back({ i, static_cast<float>(texture.lastUsedFrame) });
+    }
+
+    std::sort(evictions.begin(), evictions.end(), [](const Candidate& a, const Candidate& b) { return a.score < b.score; });
+
+    VkDeviceSize released = 0;
+
+    for (const auto& candidate : evictions)
+    {
+        if (released >= needed)
+            break;
+
+        Texture& texture = textures[candidate.texture];
+        uint32_t firstMip = texture.lastUsedFrame != frame ? texture.residentMip + 1 : std::min(texture.wantedMip, texture.tailMip);
+
+        if (!startLoad(candidate.texture, firstMip))
+            continue;
+
+        released += texture.current.size - std::min(texture.current.size, texture.load->image.size);
+        stats.evictedMips += firstMip - texture.residentMip;
+    }
+}
+
+bool TextureStreamer::startLoad(uint32_t index, uint32_t firstMip)
+{
+    Texture& texture = textures[index];
+    StreamedImage image = createImage(texture, firstMip);
+
+    if (image.image == VK_NULL_HANDLE)
+        return false;
+
+    texture.load = std::make_unique<Load>();
+    texture.load->image = image;
+    texture.load->firstMip = firstMip;
+    texture.load->nextMip = firstMip;
+
+    return true;
+}
+
+void TextureStreamer::uploadLoad(uint32_t index, Batch& batch, VkDeviceSize& head, VkDeviceSize end)
+{
+    Texture& texture = textures[index];
+    Load& load = *texture.load;
+
+    TextureFormat format = texture.view.getHeader().format;
+    uint32_t blockHeight = GetTextureBlockHeight(format);
+    bool recorded = false;
+
+    while (load.nextMip < texture.mipCount)
+    {
+        const TextureFileMip& mip = texture.view.getMip(load.nextMip);
+
+        uint32_t rows = (mip.height + blockHeight - 1) / blockHeight;
+        VkDeviceSize rowPitch = mip.size / rows;
+
+        head = AlignUp(head, STAGING_ALIGNMENT);
+
+        uint32_t remaining = rows - load.nextRow;
+        uint32_t count = static_cast<uint32_t>(std::min<VkDeviceSize>(remaining, head < end ? (end - head) / rowPitch : 0));
+
+        // A partial copy has to stop on the queue's granularity, the end of the mip always counts.
+        if (count < remaining)
+            count = rowGranularity == 0 ? 0 : count - count % rowGranularity;
+
+        if (count == 0)
+            break;
+
+        VkCommandBuffer commandBuffer = beginBatch(batch);
+
+        if (!load.started)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = load.image.image;
+            barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 };
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            load.started = true;
+        }
+
+        VkDeviceSize bytes = count * rowPitch;
+        memcpy(static_cast<uint8_t*>(staging.mapped) + head, texture.view.getMipData(load.nextMip) + load.nextRow * rowPitch, bytes);
+
+        uint32_t y = load.nextRow * blockHeight;
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = head;
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, load.nextMip - load.firstMip, 0, 1 };
+        region.imageOffset = { 0, static_cast<int32_t>(y), 0 };
+        region.imageExtent = { mip.width, std::min(count * blockHeight, mip.height - y), 1 };
+
+        vkCmdCopyBufferToImage(commandBuffer, staging.buffer, load.image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        head += bytes;
+        stats.uploadedBytes += bytes;
+        stats.totalUploadedBytes += bytes;
+        recorded = true;
+
+        load.nextRow += count;
+
+        if (load.nextRow == rows)
+        {
+            load.nextMip++;
+            load.nextRow = 0;
+        }
+    }
+
+    if (!recorded)
+        return;
+
+    batch.textures.push_back(index);
+    load.batchesInFlight++;
+
+    if (load.nextMip < texture.mipCount)
+        return;
+
+    load.uploaded = true;
+
+    // Release half of the queue family ownership transfer, recordAcquires() records the other.
+    if (transferFamily != graphicsFamily)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = transferFamily;
+        barrier.dstQueueFamilyIndex = graphicsFamily;
+        barrier.image = load.image.image;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 };
+
+        vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+VkCommandBuffer TextureStreamer::beginBatch(Batch& batch)
+{
+    if (!batch.recording)
+    {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        CheckVkResult(vkBeginCommandBuffer(batch.commandBuffer, &beginInfo));
+        batch.recording = true;
+    }
+
+    return batch.commandBuffer;
+}
+
+void TextureStreamer::submitBatch(Batch& batch)
+{
+    CheckVkResult(vkEndCommandBuffer(batch.commandBuffer));
+    batch.recording = false;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+    CheckVkResult(vkQueueSubmit(queue, 1, &submitInfo, batch.fence));
+    batch.submitted = true;
+}
+
+void TextureStreamer::retireBatches()
+{
+    for (auto& batch : batches)
+    {
+        if (!batch.submitted || vkGetFenceStatus(device, batch.fence) != VK_SUCCESS)
+            continue;
+
+        CheckVkResult(vkResetFences(device, 1, &batch.fence));
+        CheckVkResult(vkResetCommandBuffer(batch.commandBuffer, 0));
+        batch.submitted = false;
+
+        for (uint32_t index : batch.textures)
+        {
+            Texture& texture = textures[index];
+            Load& load = *texture.load;
+
+            if (--load.batchesInFlight > 0)
+                continue;
+
+            if (!texture.alive)
+                releaseTexture(index);
+            else if (load.uploaded)
+                finished.push_back(index);
+        }
+
+        batch.textures.clear();
+    }
+}
+
+void TextureStreamer::recordAcquires(VkCommandBuffer commandBuffer)
+{
+    if (finished.empty())
+        return;
+
+    bool transfer = transferFamily != graphicsFamily;
+    std::vector<VkImageMemoryBarrier> barriers(finished.size());
+
+    for (size_t i = 0; i < finished.size(); i++)
+    {
+        VkImageMemoryBarrier& barrier = barriers[i];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = transfer ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = transfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = transfer ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = textures[finished[i]].load->image.image;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1 };
+    }
+
+    VkPipelineStageFlags srcStage = transfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+    VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    for (uint32_t index : finished)
+    {
+        Texture& texture = textures[index];
+
+        retire(texture.current);
+        texture.current = texture.load->image;
+        texture.residentMip = texture.load->firstMip;
+        texture.load.reset();
+    }
+
+    finished.clear();
+}
+
+TextureStreamer::StreamedImage TextureStreamer::createImage(const Texture& texture, uint32_t firstMip)
+{
+    const TextureFileMip& mip = texture.view.getMip(firstMip);
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = GetVkFormat(texture.view.getHeader().format);
+    imageInfo.extent = { mip.width, mip.height, 1 };
+    imageInfo.mipLevels = texture.mipCount - firstMip;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    StreamedImage image;
+    CheckVkResult(vkCreateImage(device, &imageInfo, nullptr, &image.image));
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, image.image, &requirements);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Running out of device memory is expected here, the caller evicts and tries again later.
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &image.memory);
+
+    if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY)
+    {
+        vkDestroyImage(device, image.image, nullptr);
+        return {};
+    }
+
+    CheckVkResult(result);
+    CheckVkResult(vkBindImageMemory(device, image.image, image.memory, 0));
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = imageInfo.format;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, imageInfo.mipLevels, 0, 1 };
+
+    CheckVkResult(vkCreateImageView(device, &viewInfo, nullptr, &image.view));
+
+    image.size = requirements.size;
+    stats.allocatedBytes += image.size;
+
+    return image;
+}
+
+void TextureStreamer::retire(StreamedImage& image)
+{
+    if (image.image == VK_NULL_HANDLE)
+        return;
+
+    retired.push_back({ image, frame });
+    retiredBytes += image.size;
+    image = {};
+}
+
+void TextureStreamer::destroyRetired(bool all)
+{
+    size_t kept = 0;
+
+    for (auto& entry : retired)
+    {
+        if (all || entry.frame + settings.framesInFlight <= frame)
+        {
+            retiredBytes -= entry.image.size;
+            destroyImage(entry.image);
+        }
+        else
+        {
+            retired[kept++] = entry;
+        }
+    }
+
+    retired.resize(kept);
+}
+
+void TextureStreamer::destroyImage(StreamedImage& image)
+{
+    if (image.image == VK_NULL_HANDLE)
+        return;
+
+    vkDestroyImageView(device, image.view, nullptr);
+    vkDestroyImage(device, image.image, nullptr);
+    vkFreeMemory(device, image.memory, nullptr);
+
+    stats.allocatedBytes -= image.size;
+    image = {};
+}
+
+VkDeviceSize TextureStreamer::getImageSize(const Texture& texture, uint32_t firstMip) const
+{
+    VkDeviceSize size = 0;
+
+    for (uint32_t i = firstMip; i < texture.mipCount; i++)
+        size += texture.view.getMip(i).size;
+
+    return size;
+}
+
+VkDeviceSize TextureStreamer::getCommittedBytes() const
+{
+    // Images on their way out, and the part of a shrinking texture its new image will give back,
+    // are as good as free already.
+    VkDeviceSize releasing = retiredBytes;
+
+    for (const auto& texture : textures)
+    {
+        if (texture.alive && texture.load && texture.load->image.size < texture.current.size)
+            releasing += texture.current.size - texture.load->image.size;
+    }
+
+    return stats.allocatedBytes - std::min(stats.allocatedBytes, releasing);
+}
+
+void TextureStreamer::updateStats()
+{
+    stats.textureCount = 0;
+    stats.fullyResidentCount = 0;
+    stats.loadingCount = 0;
+    stats.residentMips = 0;
+    stats.requestedMips = 0;
+
+    for (const auto& texture : textures)
+    {
+        if (!texture.alive)
+            continue;
+
+        stats.textureCount++;
+        stats.residentMips += texture.mipCount - texture.residentMip;
+        stats.requestedMips += texture.mipCount - texture.wantedMip;
+
+        if (texture.residentMip <= texture.wantedMip)
+            stats.fullyResidentCount++;
+
+        if (texture.load)
+            stats.loadingCount++;
+    }
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Bounds.h"
+#include "TextureFile.h"
+#include "VirtualFileSystem.h"
+#include "VulkanUtils.h"
+
+struct TextureStreamerSettings
+{
+    // Bytes copied into staging and submitted per update().
+    VkDeviceSize uploadBudget = 16ull * 1024 * 1024;
+
+    // Device memory the streamed images may use before the least recently used ones give up mips.
+    // Replaced images waiting out the frames in flight are not counted.
+    VkDeviceSize memoryBudget = 512ull * 1024 * 1024;
+
+    // Mips whose largest side is at most this many texels are loaded on add and never evicted.
+    uint32_t residentTailSize = 64;
+
+    // Frames the renderer may still be using an image for after it has been replaced.
+    uint32_t framesInFlight = 2;
+};
+
+struct TextureStreamerStats
+{
+    uint32_t textureCount = 0;
+    uint32_t fullyResidentCount = 0; // every requested mip is resident
+    uint32_t loadingCount = 0;
+    uint32_t residentMips = 0;
+    uint32_t requestedMips = 0;
+
+    VkDeviceSize allocatedBytes = 0;
+    VkDeviceSize memoryBudget = 0;
+    VkDeviceSize uploadedBytes = 0; // during the last update()
+    uint64_t totalUploadedBytes = 0;
+    uint64_t evictedMips = 0;
+};
+
+VkFormat GetVkFormat(TextureFormat format);
+
+// Streams texture files from their mappings into device memory a mip at a time. Textures start
+// with only their small tail mips resident, and request() raises the wanted mip from how big the
+// texture is on screen. update() spends the per frame upload budget on the highest priority
+// requests through the transfer queue, and under memory pressure drops mips from the textures
+// that have gone longest without a request.
+//
+// Residency changes recreate the image with the new mip range and upload every mip it holds from
+// the mapping, so growing by one level costs a third more than the new level on its own. Finished
+// images are handed over to the graphics queue by recordAcquires().
+class TextureStreamer
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+    static constexpr uint32_t BATCH_COUNT = 3;
+
+    void init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue transferQueue, uint32_t transferFamily,
+        uint32_t graphicsFamily, const TextureStreamerSettings& settings = {});
+    void destroy();
+
+    // Opens the file through the VFS and queues its tail mips. Returns INVALID if the file is not a
+    // valid texture. Keep the texture stored, not compressed, in packs so it streams from the mapping.
+    uint32_t addTexture(const VirtualFileSystem& vfs, const char* path);
+    void removeTexture(uint32_t texture);
+
+    // Call for every use of the texture this frame with its projected size in pixels and its
+    // distance from the camera. The largest, closest use decides the mip and the priority.
+    void request(uint32_t texture, float screenSize, float distance);
+
+    // Retires finished batches, evicts if over budget and submits the next batch of uploads.
+    void update();
+
+    // Records the barriers that hand finished images to the graphics queue and makes them current.
+    // Call at the start of a graphics command buffer, before anything samples the textures.
+    void recordAcquires(VkCommandBuffer commandBuffer);
+
+    // VK_NULL_HANDLE until the first load has been acquired.
+    VkImageView getImageView(uint32_t texture) const { return textures[texture].current.view; }
+    uint32_t getResidentMip(uint32_t texture) const { return textures[texture].residentMip; }
+
+    const TextureStreamerStats& getStats() const { return stats; }
+
+    // Diameter of the sphere in pixels for a perspective camera, for use with request().
+    static float ComputeScreenSize(const BoundingSphere& sphere, const glm::vec3& cameraPosition, float fovY, float viewportHeight);
+
+private:
+    struct StreamedImage
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+    };
+
+    struct Load
+    {
+        StreamedImage image;
+        uint32_t firstMip = 0;
+        uint32_t nextMip = 0;
+        uint32_t nextRow = 0;     // in block rows of nextMip
+        uint32_t batchesInFlight = 0;
+        bool started = false;     // the transition to TRANSFER_DST has been recorded
+        bool uploaded = false;    // every copy has been recorded
+    };
+
+    struct Texture
+    {
+        VfsFile file;
+        TextureFileView view;
+
+        StreamedImage current;
+        std::unique_ptr<Load> load;
+
+        uint32_t mipCount = 0;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0; // mipCount while nothing is resident
+
+        uint32_t wantedMip = 0;
+        float priority = 0.0f;
+        uint64_t lastUsedFrame = 0; // the frame of the last request()
+
+        bool alive = false;
+    };
+
+    struct Batch
+    {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        VkDeviceSize stagingOffset = 0;
+        std::vector<uint32_t> textures; // loads with copies in this batch
+        bool recording = false;
+        bool submitted = false;
+    };
+
+    struct Candidate
+    {
+        uint32_t texture;
+        float score;
+    };
+
+    struct Retired
+    {
+        StreamedImage image;
+        uint64_t frame = 0;
+    };
+
+    void retireBatches();
+    void destroyRetired(bool all);
+    void evict(VkDeviceSize needed);
+    bool startLoad(uint32_t texture, uint32_t firstMip);
+    void uploadLoad(uint32_t texture, Batch& batch, VkDeviceSize& head, VkDeviceSize end);
+    void releaseTexture(uint32_t texture);
+    void reserveStaging(VkDeviceSize batchSize);
+    void updateStats();
+
+    VkCommandBuffer beginBatch(Batch& batch);
+    void submitBatch(Batch& batch);
+
+    StreamedImage createImage(const Texture& texture, uint32_t firstMip);
+    void retire(StreamedImage& image);
+    void destroyImage(StreamedImage& image);
+
+    VkDeviceSize getImageSize(const Texture& texture, uint32_t firstMip) const;
+    VkDeviceSize getCommittedBytes() const;
+
+private:
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t transferFamily = 0;
+    uint32_t graphicsFamily = 0;
+    TextureStreamerSettings settings;
+
+    // Copies must cover whole multiples of this many block rows, or whole mips when zero.
+    uint32_t rowGranularity = 1;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    Batch batches[BATCH_COUNT];
+    uint32_t nextBatch = 0;
+
+    GpuBuffer staging;
+    VkDeviceSize batchSize = 0;
+
+    std::vector<Texture> textures;
+    std::vector<uint32_t> freeTextures;
+    std::vector<uint32_t> finished;   // loads waiting for recordAcquires()
+    std::vector<Retired> retired;
+    VkDeviceSize retiredBytes = 0;
+
+    std::vector<Candidate> candidates;
+    std::vector<Candidate> evictions;
+    uint64_t frame = 1;
+
+    TextureStreamerStats stats;
+};
@@ -0,0 +1,146 @@
+#include "VirtualFileSystem.h"
+
+#include <cstdio>
+#include <filesystem>
+
+bool VirtualFileSystem::mountPack(const char* path)
+{
+    Mount mount;
+
+    if (!mount.file.open(path))
+    {
+        fprintf(stderr, "[vfs] Failed to open %s\n", path);
+        return false;
+    }
+
+    if (!mount.view.open(mount.file.data(), mount.file.size()))
+    {
+        fprintf(stderr, "[vfs] %s is not a valid version %d pack file\n", path, PACK_FILE_VERSION);
+        return false;
+    }
+
+    mount.path = path;
+    mounts.push_back(std::move(mount));
+    return true;
+}
+
+void VirtualFileSystem::mountDirectory(const char* path)
+{
+    Mount mount;
+    mount.path = NormalizePackPath(path);
+
+    // Normalizing drops a leading slash, put it back for absolute paths.
+    if (path[0] == '/' || path[0] == '\\')
+        mount.path.insert(0, 1, '/');
+
+    if (!mount.path.empty() && mount.path.back() != '/')
+        mount.path += '/';
+
+    mounts.push_back(std::move(mount));
+}
+
+bool VirtualFileSystem::open(const char* path, VfsFile& file) const
+{
+    file = VfsFile();
+
+    std::string normalized = NormalizePackPath(path);
+    uint64_t hash = HashPackPath(normalized);
+
+    for (auto mount = mounts.rbegin(); mount != mounts.rend(); ++mount)
+    {
+        if (!mount->file.isOpen())
+        {
+            if (!file.loose.open((mount->path + normalized).c_str()))
+                continue;
+
+            file.bytes = file.loose.data();
+            file.length = file.loose.size();
+            return true;
+        }
+
+        const PackFileEntry* entry = mount->view.find(normalized, hash);
+
+        if (!entry)
+            continue;
+
+        if (!mount->view.isCompressed(*entry))
+        {
+            // Empty entries still need a non null pointer to count as open.
+            static const uint8_t empty = 0;
+
+            file.bytes = entry->size > 0 ? mount->view.getStoredData(*entry) : &empty;
+            file.length = entry->size;
+            return true;
+        }
+
+        file.storage.resize(entry->size);
+
+        if (!mount->view.readEntry(*entry, file.storage.data()))
+        {
+            fprintf(stderr, "[vfs] %s has a corrupt entry in a mounted pack\n", normalized.c_str());
+            file = VfsFile();
+            return false;
+        }
+
+        file.bytes = file.storage.data();
+        file.length = file.storage.size();
+        return true;
+    }
+
+    return false;
+}
+
+bool VirtualFileSystem::exists(const char* path) const
+{
+    std::string normalized = NormalizePackPath(path);
+    uint64_t hash = HashPackPath(normalized);
+
+    for (auto mount = mounts.rbegin(); mount != mounts.rend(); ++mount)
+    {
+        if (mount->file.isOpen() ? mount->view.find(normalized, hash) != nullptr : std::filesystem::is_regular_file(mount->path + normalized))
+            return true;
+    }
+
+    return false;
+}
+
+bool VirtualFileSystem::locate(const char* path, VfsLocation& location) const
+{
+    std::string normalized = NormalizePackPath(path);
+    uint64_t hash = HashPackPath(normalized);
+
+    for (auto mount = mounts.rbegin(); mount != mounts.rend(); ++mount)
+    {
+        if (!mount->file.isOpen())
+        {
+            std::string loosePath = mount->path + normalized;
+
+            std::error_code error;
+            uint64_t size = std::filesystem::file_size(loosePath, error);
+
+            if (error)
+                continue;
+
+            location = VfsLocation();
+            location.filePath = std::move(loosePath);
+            location.size = size;
+            location.storedSize = size;
+            return true;
+        }
+
+        const PackFileEntry* entry = mount->view.find(normalized, hash);
+
+        if (!entry)
+            continue;
+
+        location.filePath = mount->path;
+        location.offset = entry->offset;
+        location.size = entry->size;
+        location.storedSize = entry->storedSize;
+        location.compressed = mount->view.isCompressed(*entry);
+        location.packed = true;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PackFile.h"
+
+// A file opened through the VirtualFileSystem. Stored pack entries point straight into the
+// pack's mapping and stay valid for as long as the file system, loose files are mapped on their
+// own, and compressed entries own their decompressed bytes.
+class VfsFile
+{
+public:
+    void close() { *this = VfsFile(); }
+
+    bool isOpen() const { return bytes != nullptr; }
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // True when data() is a view of a mapping rather than a copy.
+    bool isMapped() const { return storage.empty(); }
+
+    // Tells the OS a loose file is about to be read front to back. Pack entries are left to the
+    // page cache, their neighbours are likely wanted soon anyway.
+    void prefetch() const { if (loose.isOpen()) loose.prefetch(); }
+
+private:
+    friend class VirtualFileSystem;
+    friend class AsyncIO;
+
+    const uint8_t* bytes = nullptr;
+    size_t length = 0;
+
+    std::vector<uint8_t> storage;
+    MappedFile loose;
+};
+
+// Where a file lives on disk, for callers that do their own reads.
+struct VfsLocation
+{
+    std::string filePath; // the pack, or the loose file itself
+    uint64_t offset = 0;
+    uint64_t size = 0;       // once decompressed
+    uint64_t storedSize = 0; // on disk
+    bool compressed = false;
+    bool packed = false;
+};
+
+// Resolves engine paths against mounted pack files and directories. Later mounts win, so a patch
+// pack or a loose override directory mounted last shadows what came before. Mount everything up
+// front, open() is safe to call from any thread once mounting is done.
+class VirtualFileSystem
+{
+public:
+    bool mountPack(const char* path);
+    void mountDirectory(const char* path);
+
+    bool open(const char* path, VfsFile& file) const;
+    bool exists(const char* path) const;
+
+    // Resolves a path without reading it. Costs a stat for every directory mount it passes.
+    bool locate(const char* path, VfsLocation& location) const;
+
+private:
+    struct Mount
+    {
+        // Pack mounts, the view points into the mapping, which stays put when the mount moves.
+        MappedFile file;
+        PackFileView view;
+
+        // The pack file for pack mounts, the directory with a trailing slash for the rest.
+        std::string path;
+    };
+
+    std::vector<Mount> mounts;
+};
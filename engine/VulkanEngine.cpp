@@ -1,6 +1,8 @@
 #include "VulkanEngine.h"
+#include "VulkanUtils.h"
 
 #include <cstdio>
+#include <filesystem>
 #include <stdlib.h>
 #include <vector>
 #include <stdexcept>
@@ -12,22 +14,14 @@
 
 #define VERSION VK_MAKE_API_VERSION(0, 1, 0, 0)
 
+static const char* ASSET_PACK_PATH = "assets.vpak";
+static const char* PIPELINE_CACHE_PATH = "pipelines.cache";
+
 static void GlfwErrorCallback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
-static void CheckVkResult(VkResult err)
-{
-    if (err == 0)
-        return;
-
-    fprintf(stderr, "[vulkan] Error: VkResult = %d\n", err);
-
-    if (err < 0)
-        abort();
-}
-
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT severity,
     VkDebugUtilsMessageTypeFlagsEXT type,
@@ -59,12 +53,22 @@ static void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMesse
 
 void VulkanEngine::run() 
 {
+    initFileSystem();
     initWindow();
     initVulkan();
     mainLoop();
     cleanup();
 }
 
+void VulkanEngine::initFileSystem()
+{
+    // Loose files next to the executable are the fallback, the cooked pack shadows them.
+    vfs.mountDirectory(".");
+
+    if (std::filesystem::exists(ASSET_PACK_PATH))
+        vfs.mountPack(ASSET_PACK_PATH);
+}
+
 void VulkanEngine::initWindow()
 {
     glfwSetErrorCallback(GlfwErrorCallback);
@@ -94,6 +98,16 @@ void VulkanEngine::initVulkan()
     createSurface();
     initPhysicalDevice();
     createLogicalDevice();
+
+    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+
+    uploader.init(physicalDevice, device, graphicsQueue, indices.graphicsFamily.value());
+    textureStreamer.init(physicalDevice, device, transferQueue, indices.transferFamily.value(), indices.graphicsFamily.value());
+    layouts.init(device);
+    pipelines.init(device, &jobs, PIPELINE_CACHE_PATH);
+    scene.init(physicalDevice, device, vfs, layouts, drawIndirectCount);
+    graph.init(physicalDevice, device, vulkan13);
+    frameAllocator.init(physicalDevice, device, FRAMES_IN_FLIGHT);
 }
 
 int VulkanEngine::getDeviceScore(VkPhysicalDevice device)
@@ -106,8 +120,16 @@ int VulkanEngine::getDeviceScore(VkPhysicalDevice device)
 
     auto indicies = findQueueFamilies(device);
 
-    // Doesn't support geometry or our required queue families.
-    if (!features.geometryShader || !indicies.isComplete())
+    // Doesn't support geometry, cooked BC textures or our required queue families.
+    if (!features.geometryShader || !features.textureCompressionBC || !indicies.isComplete())
+        return 0;
+
+    // The GPU driven scene draws every mesh with one indirect call, firstInstance picking the instance.
+    if (!features.multiDrawIndirect || !features.drawIndirectFirstInstance)
+        return 0;
+
+    // Timeline semaphores are core from 1.2, uploads and async loads wait on them.
+    if (properties.apiVersion < VK_API_VERSION_1_2)
         return 0;
 
     int score = 0;
@@ -154,6 +176,9 @@ void VulkanEngine::mainLoop()
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+
+        scheduler.update();
+        textureStreamer.update();
     }
 }
 
@@ -169,6 +194,15 @@ void VulkanEngine::cleanup()
     //ImGui_ImplGlfw_Shutdown();
     //ImGui::DestroyContext();
 
+    frameAllocator.destroy();
+    graph.destroy();
+    scene.destroy();
+    pipelines.save(PIPELINE_CACHE_PATH);
+    pipelines.destroy();
+    layouts.destroy();
+    textureStreamer.destroy();
+    uploader.destroy();
+
     vkDestroyDevice(device, nullptr);
     vkDestroySurfaceKHR(instance, surface, nullptr);
     vkDestroyInstance(instance, nullptr);
@@ -190,7 +224,12 @@ void VulkanEngine::createInstance()
     appInfo.applicationVersion = VERSION;
     appInfo.engineVersion = VERSION;
     appInfo.pEngineName = "NA";
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 1.3 when the loader has it, for dynamic rendering and synchronization2 on devices that do too.
+    uint32_t loaderVersion = VK_API_VERSION_1_0;
+    vkEnumerateInstanceVersion(&loaderVersion);
+
+    apiVersion = loaderVersion >= VK_API_VERSION_1_3 ? VK_API_VERSION_1_3 : VK_API_VERSION_1_2;
+    appInfo.apiVersion = apiVersion;
     
     VkInstanceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -289,7 +328,7 @@ void VulkanEngine::createLogicalDevice()
     QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+    std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value(), indices.transferFamily.value() };
 
     float queuePriority = 1.0f;
 
@@ -312,8 +351,52 @@ void VulkanEngine::createLogicalDevice()
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.textureCompressionBC = VK_TRUE;
+    deviceFeatures.multiDrawIndirect = VK_TRUE;
+    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
     createInfo.pEnabledFeatures = &deviceFeatures;
 
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported12;
+
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+    // Optional, without it culled objects still cost an empty draw.
+    drawIndirectCount = supported12.drawIndirectCount == VK_TRUE;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // Optional, without them the render graph falls back to render pass objects and 1.0 barriers.
+    if (apiVersion >= VK_API_VERSION_1_3 && properties.apiVersion >= VK_API_VERSION_1_3)
+    {
+        VkPhysicalDeviceVulkan13Features supported13{};
+        supported13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        supported.pNext = &supported13;
+
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+        vulkan13 = supported13.dynamicRendering == VK_TRUE && supported13.synchronization2 == VK_TRUE;
+    }
+
+    fprintf(stdout, "[vulkan] Dynamic rendering and synchronization2: %s\n", vulkan13 ? "yes" : "no");
+
+    VkPhysicalDeviceVulkan13Features vulkan13Features{};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13Features.dynamicRendering = VK_TRUE;
+    vulkan13Features.synchronization2 = VK_TRUE;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.pNext = vulkan13 ? &vulkan13Features : nullptr;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.drawIndirectCount = drawIndirectCount ? VK_TRUE : VK_FALSE;
+    createInfo.pNext = &vulkan12Features;
+
     createInfo.enabledExtensionCount = 0;
 
     if (enableValidationLayers) 
@@ -331,6 +414,7 @@ void VulkanEngine::createLogicalDevice()
 
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+    vkGetDeviceQueue(device, indices.transferFamily.value(), 0, &transferQueue);
 }
 
 void VulkanEngine::createDebugMessenger()
@@ -382,5 +466,20 @@ QueueFamilyIndices VulkanEngine::findQueueFamilies(VkPhysicalDevice device)
         i++;
     }
 
+    // Prefer a pure copy engine, then anything without graphics, so uploads run alongside rendering.
+    for (uint32_t j = 0; j < queueFamilyCount; j++)
+    {
+        VkQueueFlags flags = families[j].queueFlags;
+
+        if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+            continue;
+
+        if (!indices.transferFamily.has_value() || !(flags & VK_QUEUE_COMPUTE_BIT))
+            indices.transferFamily = j;
+    }
+
+    if (!indices.transferFamily.has_value())
+        indices.transferFamily = indices.graphicsFamily;
+
     return indices;
 }
\ No newline at end of file
@@ -4,7 +4,17 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 
+#include "FrameAllocator.h"
+#include "FrameScheduler.h"
+#include "GpuScene.h"
+#include "JobSystem.h"
+#include "PipelineLayoutCache.h"
+#include "PipelineStateCache.h"
 #include "QueueFamilyIndices.h"
+#include "RenderGraph.h"
+#include "StagingUploader.h"
+#include "TextureStreamer.h"
+#include "VirtualFileSystem.h"
 
 class VulkanEngine
 {
@@ -12,6 +22,7 @@ public:
     void run();
 
 private:
+    void initFileSystem();
     void initWindow();
     void initVulkan();
     void initPhysicalDevice();
@@ -34,6 +45,7 @@ private:
 private:
     const uint32_t WIDTH = 800;
     const uint32_t HEIGHT = 600;
+    const uint32_t FRAMES_IN_FLIGHT = 2;
 
     const std::vector<const char*> validationLayers =
     {
@@ -53,7 +65,27 @@ private:
     VkDevice device;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue transferQueue;
     VkSurfaceKHR surface;
+    bool drawIndirectCount = false;
+
+    // Instance version, and whether the device has 1.3 with dynamic rendering and synchronization2.
+    uint32_t apiVersion = VK_API_VERSION_1_2;
+    bool vulkan13 = false;
+
+    // Before anything holding files opened through it.
+    VirtualFileSystem vfs;
+
+    JobSystem jobs;
+
+    StagingUploader uploader;
+    PipelineLayoutCache layouts;
+    PipelineStateCache pipelines;
+    TextureStreamer textureStreamer;
+    GpuScene scene;
+    RenderGraph graph;
+    FrameAllocator frameAllocator;
+    FrameScheduler scheduler;
 
     VkDebugUtilsMessengerEXT debugMessenger;
 };
\ No newline at end of file
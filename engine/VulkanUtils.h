@@ -0,0 +1,35 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN // Get GLFW to handle vulkan
+#include <GLFW/glfw3.h>
+#include <cstdint>
+
+void CheckVkResult(VkResult err);
+
+uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties);
+
+struct GpuBuffer
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+
+    // Only set for host visible buffers, which stay mapped for their whole lifetime.
+    void* mapped = nullptr;
+};
+
+GpuBuffer CreateBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+void DestroyBuffer(VkDevice device, GpuBuffer& buffer);
+
+// Wraps SPIR-V code, which has to be 4 byte aligned.
+VkShaderModule CreateShaderModule(VkDevice device, const void* code, size_t size);
+
+// Whether the format can be the source and destination of linear filtered blits.
+bool SupportsMipBlits(VkPhysicalDevice physicalDevice, VkFormat format);
+
+// Fills levels 1 to mipCount - 1 of the image by blitting each level from the one above, which
+// the GPU filters in linear space for sRGB formats. Expects every level in TRANSFER_DST_OPTIMAL
+// with level 0 written, and leaves them all in SHADER_READ_ONLY_OPTIMAL. mipCount can't be zero.
+// Meant for images made at runtime, cooked textures carry their own chains. Nothing uses it yet:
+// the ImGui font atlas stays single level, its 1 pixel glyph padding would bleed from mip 1 on.
+void RecordMipBlits(VkCommandBuffer commandBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipCount);
@@ -19,6 +19,8 @@
 #include <stdio.h>          // printf, fprintf
 #include <stdlib.h>         // abort
 #include <EASTL/vector.h>
+#include "engine/FrameCapture.h"
+#include "engine/JobSystem.h"
 #define GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -56,6 +58,10 @@ static ImGui_ImplVulkanH_Window g_MainWindowData;
 static int                      g_MinImageCount = 2;
 static bool                     g_SwapChainRebuild = false;
 
+// Every frame's draw data goes here when started with --capture FILE, for tools/FrameReplay.
+static FrameCaptureWriter       g_Capture;
+static CapturedFrame            g_CapturedFrame;
+
 static void glfw_error_callback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
@@ -391,8 +397,14 @@ static void FramePresent(ImGui_ImplVulkanH_Window* wd)
 }
 
 // Main code
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc && !g_Capture.open(argv[++i]))
+            fprintf(stderr, "[capture] failed to create %s\n", argv[i]);
+    }
+
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit())
         return 1;
@@ -482,6 +494,26 @@ int main(int, char**)
     //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, nullptr, io.Fonts->GetGlyphRangesJapanese());
     //IM_ASSERT(font != nullptr);
 
+    // Build the atlas now rather than on the first frame, with glyphs rasterized across the job system.
+    {
+        JobSystem jobs;
+        io.Fonts->ParallelFor = [](void* user_data, int count, void (*job)(void* job_data, int index), void* job_data)
+        {
+            static_cast<JobSystem*>(user_data)->parallelFor((uint32_t)count, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; i++)
+                    job(job_data, (int)i);
+            });
+        };
+        io.Fonts->ParallelForUserData = &jobs;
+        io.Fonts->Build();
+        io.Fonts->ParallelFor = nullptr;
+        io.Fonts->ParallelForUserData = nullptr;
+
+        for (const ImFontConfig& cfg : io.Fonts->ConfigData)
+            printf("[fonts] %s: %.2f ms\n", cfg.Name, cfg.BuildTimeMs);
+    }
+
     // Our state
     bool show_demo_window = true;
     bool show_another_window = false;
@@ -566,6 +598,12 @@ int main(int, char**)
         if (!main_is_minimized)
             FrameRender(wd, main_draw_data);
 
+        if (g_Capture.isOpen() && !main_is_minimized)
+        {
+            g_CapturedFrame.setDrawData(main_draw_data);
+            g_Capture.writeFrame(g_CapturedFrame);
+        }
+
         // Update and Render additional Platform Windows
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
         {
@@ -578,6 +616,12 @@ int main(int, char**)
             FramePresent(wd);
     }
 
+    if (g_Capture.isOpen())
+    {
+        uint32_t frames = g_Capture.getFrameCount();
+        printf("[capture] %u frames written%s\n", frames, g_Capture.close() ? "" : ", but the file is incomplete");
+    }
+
     // Cleanup
     err = vkDeviceWaitIdle(g_Device);
     check_vk_result(err);
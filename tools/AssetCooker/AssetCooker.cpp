@@ -0,0 +1,483 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CookCache.h"
+#include "GltfImporter.h"
+#include "Hash.h"
+#include "JobSystem.h"
+#include "MaterialFile.h"
+#include "MeshCooker.h"
+#include "ObjImporter.h"
+#include "PackFile.h"
+#include "TextureCooker.h"
+
+namespace fs = std::filesystem;
+
+// Bump whenever the cooked output for the same input changes, invalidates every cache entry.
+static constexpr uint64_t COOKER_VERSION = 3;
+
+static const char* CACHE_FILE_NAME = "cook.cache";
+
+struct CookSettings
+{
+    fs::path inputRoot;
+    fs::path outputRoot;
+    fs::path packPath; // empty to leave the output loose
+    uint32_t threadCount = 0;
+    bool force = false;
+    bool compress = true;
+    bool blockCompress = true;
+    bool fastBlockCompress = false;
+};
+
+struct TextureJob
+{
+    ImportedTexture texture;
+    std::string key; // output path relative to the output root
+};
+
+class AssetCooker
+{
+public:
+    explicit AssetCooker(const CookSettings& settings) : settings(settings), jobs(settings.threadCount) {}
+
+    int run()
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<fs::path> sources;
+
+        std::unordered_map<std::string, fs::path> outputs;
+
+        for (const auto& entry : fs::recursive_directory_iterator(settings.inputRoot))
+        {
+            if (!entry.is_regular_file() || !IsSource(entry.path()))
+                continue;
+
+            // model.obj and model.gltf side by side would both cook to model.vmesh.
+            std::string output = fs::relative(entry.path(), settings.inputRoot).replace_extension().generic_string();
+            auto inserted = outputs.emplace(output, entry.path());
+
+            if (!inserted.second)
+            {
+                reportFailure(entry.path(), "cooks to the same output as " + inserted.first->second.string());
+                continue;
+            }
+
+            sources.push_back(entry.path());
+        }
+
+        fs::path cachePath = settings.outputRoot / CACHE_FILE_NAME;
+
+        if (!settings.force)
+            cache.load(cachePath);
+
+        printf("Cooking %d sources on %u threads\n", static_cast<int>(sources.size()), jobs.getThreadCount() + 1);
+
+        // Meshes first, they discover the textures.
+        jobs.parallelFor(static_cast<uint32_t>(sources.size()), 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; i++)
+                cookSource(sources[i]);
+        });
+
+        jobs.parallelFor(static_cast<uint32_t>(textureJobs.size()), 1, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; i++)
+                cookTexture(textureJobs[i]);
+        });
+
+        if (!cache.save(cachePath))
+            fprintf(stderr, "warning: failed to write %s\n", cachePath.string().c_str());
+
+        if (!settings.packPath.empty() && failed == 0)
+            pack();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("Done in %.2fs: %d cooked, %d up to date, %d failed\n", seconds, cooked.load(), skipped.load(), failed.load());
+
+        return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+private:
+    static std::string GetExtension(const fs::path& path)
+    {
+        std::string extension = path.extension().string();
+
+        for (char& c : extension)
+            c = static_cast<char>(tolower(c));
+
+        return extension;
+    }
+
+    static bool IsSource(const fs::path& path)
+    {
+        std::string extension = GetExtension(path);
+        return extension == ".gltf" || extension == ".glb" || extension == ".obj";
+    }
+
+    std::string getKey(const fs::path& output) const
+    {
+        return fs::relative(output, settings.outputRoot).generic_string();
+    }
+
+    // Content hash of the inputs plus everything else that changes the output.
+    uint64_t getSeed() const
+    {
+        return HashCombine(COOKER_VERSION, settings.compress ? 1 : 0);
+    }
+
+    uint64_t getTextureSeed() const
+    {
+        return HashCombine(getSeed(), settings.blockCompress ? (settings.fastBlockCompress ? 2 : 1) : 0);
+    }
+
+    // Sources that reference textures are hashed with the texture settings too, so changing them
+    // imports the source again and its textures get queued.
+    uint64_t getSourceSeed(const CookCache::Entry& entry) const
+    {
+        return entry.outputs.empty() ? getSeed() : getTextureSeed();
+    }
+
+    bool isUpToDate(const std::string& key, const std::vector<fs::path>& outputs)
+    {
+        CookCache::Entry entry;
+
+        if (settings.force || !cache.find(key, entry))
+            return false;
+
+        for (const fs::path& output : outputs)
+        {
+            if (!fs::exists(output))
+                return false;
+        }
+
+        // A texture that failed to cook or was deleted since needs the source imported again.
+        for (const std::string& output : entry.outputs)
+        {
+            CookCache::Entry texture;
+
+            if (!cache.find(output, texture) || !fs::exists(settings.outputRoot / output))
+                return false;
+        }
+
+        return HashFiles(entry.inputs, getSourceSeed(entry)) == entry.hash;
+    }
+
+    // Meshes and textures compress their own payload and are read straight from the mapping,
+    // so only the rest is worth compressing per entry.
+    static bool IsCompressedInPack(const fs::path& path)
+    {
+        std::string extension = GetExtension(path);
+        return extension != ".vmesh" && extension != ".vtex";
+    }
+
+    static bool ReadFile(const fs::path& path, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+        if (!file)
+            return false;
+
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+
+        return data.empty() || file.read(reinterpret_cast<char*>(data.data()), data.size()).good();
+    }
+
+    // Packs everything under the output root, keyed by its path relative to it.
+    void pack()
+    {
+        std::vector<PackFileSource> sources;
+        fs::path packPath = fs::weakly_canonical(settings.packPath);
+
+        for (const auto& entry : fs::recursive_directory_iterator(settings.outputRoot))
+        {
+            if (!entry.is_regular_file() || entry.path().filename() == CACHE_FILE_NAME || fs::weakly_canonical(entry.path()) == packPath)
+                continue;
+
+            PackFileSource source;
+            source.path = getKey(entry.path());
+            source.compress = settings.compress && IsCompressedInPack(entry.path());
+
+            if (!ReadFile(entry.path(), source.data))
+                return reportFailure(entry.path(), "failed to read for packing");
+
+            sources.push_back(std::move(source));
+        }
+
+        std::string error;
+
+        if (!WritePackFile(settings.packPath.string().c_str(), sources, error))
+            return reportFailure(settings.packPath, error);
+
+        printf("Packed %d files into %s\n", static_cast<int>(sources.size()), settings.packPath.string().c_str());
+    }
+
+    void reportFailure(const fs::path& path, const std::string& error)
+    {
+        fprintf(stderr, "error: %s: %s\n", path.string().c_str(), error.c_str());
+        failed++;
+    }
+
+    // Where a texture ends up: mirrored under the output root when it lives in the input tree,
+    // next to its mesh when embedded, otherwise in a shared folder for outside files.
+    fs::path getTextureOutput(const fs::path& source, const ImportedTexture& texture, size_t index) const
+    {
+        fs::path meshOutput = settings.outputRoot / fs::relative(source, settings.inputRoot);
+
+        if (texture.sourcePath.empty())
+            return meshOutput.parent_path() / (meshOutput.stem().string() + "_texture" + std::to_string(index) + ".vtex");
+
+        fs::path relative = fs::relative(fs::weakly_canonical(texture.sourcePath), fs::weakly_canonical(settings.inputRoot));
+
+        if (relative.empty() || *relative.begin() == "..")
+            return settings.outputRoot / "external" / fs::path(texture.sourcePath).filename().replace_extension(".vtex");
+
+        return (settings.outputRoot / relative).replace_extension(".vtex");
+    }
+
+    void addTextureJob(TextureJob&& job)
+    {
+        std::lock_guard<std::mutex> lock(textureMutex);
+
+        for (const TextureJob& existing : textureJobs)
+        {
+            if (existing.key == job.key)
+                return;
+        }
+
+        textureJobs.push_back(std::move(job));
+    }
+
+    void cookSource(const fs::path& source)
+    {
+        fs::path relative = fs::relative(source, settings.inputRoot);
+        fs::path meshPath = (settings.outputRoot / relative).replace_extension(".vmesh");
+        fs::path materialPath = (settings.outputRoot / relative).replace_extension(".vmtl");
+        std::string key = relative.generic_string();
+
+        if (isUpToDate(key, { meshPath, materialPath }))
+        {
+            skipped++;
+            return;
+        }
+
+        ImportedScene scene;
+        std::string error;
+        bool imported = GetExtension(source) == ".obj"
+            ? ImportObj(source, scene, error)
+            : ImportGltf(source, scene, error);
+
+        if (!imported)
+            return reportFailure(source, error);
+
+        std::vector<MaterialFileEntry> materials(scene.materials.size());
+        std::vector<std::string> textureOutputs;
+
+        for (size_t i = 0; i < scene.textures.size(); i++)
+        {
+            TextureJob job;
+            job.texture = scene.textures[i];
+            job.texture.outputPath = getKey(getTextureOutput(source, job.texture, i));
+            job.key = job.texture.outputPath;
+
+            scene.textures[i].outputPath = job.texture.outputPath;
+            textureOutputs.push_back(job.texture.outputPath);
+
+            // External images are inputs of the mesh too, a changed image has to be found again.
+            if (!job.texture.sourcePath.empty())
+                scene.dependencies.push_back(job.texture.sourcePath);
+
+            addTextureJob(std::move(job));
+        }
+
+        for (size_t i = 0; i < scene.materials.size(); i++)
+            fillMaterial(scene, scene.materials[i], materials[i]);
+
+        MeshFileData mesh;
+        MeshCookStats stats;
+        CookMesh(scene, mesh, stats);
+
+        fs::create_directories(meshPath.parent_path());
+
+        if (!WriteMeshFile(meshPath.string().c_str(), mesh, settings.compress) || !WriteMaterialFile(materialPath.string().c_str(), materials))
+            return reportFailure(source, "failed to write output");
+
+        CookCache::Entry entry;
+        entry.inputs.push_back(source.string());
+        entry.inputs.insert(entry.inputs.end(), scene.dependencies.begin(), scene.dependencies.end());
+        entry.outputs = std::move(textureOutputs);
+        entry.hash = HashFiles(entry.inputs, getSourceSeed(entry));
+
+        cache.update(key, entry);
+        cooked++;
+
+        printf("%s: %u vertices, %u triangles, ACMR %.2f -> %.2f\n", key.c_str(), stats.vertexCount, stats.triangleCount, stats.acmrBefore, stats.acmrAfter);
+    }
+
+    void fillMaterial(const ImportedScene& scene, const ImportedMaterial& source, MaterialFileEntry& material)
+    {
+        material = {};
+
+        snprintf(material.name, sizeof(material.name), "%s", source.name.c_str());
+
+        for (int c = 0; c < 4; c++)
+            material.baseColor[c] = source.baseColor[c];
+
+        for (int c = 0; c < 3; c++)
+            material.emissive[c] = source.emissive[c];
+
+        material.metallic = source.metallic;
+        material.roughness = source.roughness;
+        material.alphaCutoff = source.alphaCutoff;
+        material.alphaMode = source.alphaMode;
+        material.doubleSided = source.doubleSided ? 1 : 0;
+
+        for (uint32_t slot = 0; slot < MATERIAL_TEXTURE_COUNT; slot++)
+        {
+            int texture = source.textures[slot];
+
+            if (texture < 0)
+                continue;
+
+            const std::string& path = scene.textures[texture].outputPath;
+
+            if (path.size() >= MATERIAL_TEXTURE_PATH_SIZE)
+            {
+                fprintf(stderr, "warning: texture path %s is too long, slot left empty\n", path.c_str());
+                continue;
+            }
+
+            memcpy(material.textures[slot], path.c_str(), path.size() + 1);
+        }
+    }
+
+    void cookTexture(const TextureJob& job)
+    {
+        fs::path output = settings.outputRoot / job.key;
+
+        CookCache::Entry entry;
+        uint64_t seed = HashCombine(getTextureSeed(), job.texture.srgb ? 1 : 0);
+        seed = HashCombine(seed, job.texture.normalMap ? 1 : 0);
+
+        if (job.texture.sourcePath.empty())
+        {
+            entry.hash = HashBytes(job.texture.embedded.data(), job.texture.embedded.size(), seed);
+        }
+        else
+        {
+            entry.inputs.push_back(job.texture.sourcePath);
+            entry.hash = HashFiles(entry.inputs, seed);
+        }
+
+        CookCache::Entry previous;
+
+        if (!settings.force && cache.find(job.key, previous) && previous.hash == entry.hash && fs::exists(output))
+        {
+            skipped++;
+            return;
+        }
+
+        fs::create_directories(output.parent_path());
+
+        std::string error;
+
+        TextureCookSettings textureSettings;
+        textureSettings.blockCompress = settings.blockCompress;
+        textureSettings.quality = settings.fastBlockCompress ? BlockQuality::Fast : BlockQuality::Quality;
+        textureSettings.jobs = &jobs;
+
+        if (!CookTexture(job.texture, textureSettings, output, error))
+        {
+            // Leaves nothing behind that would let the mesh referencing it look up to date.
+            std::error_code ignored;
+            fs::remove(output, ignored);
+
+            return reportFailure(job.texture.sourcePath.empty() ? fs::path(job.key) : fs::path(job.texture.sourcePath), error);
+        }
+
+        cache.update(job.key, entry);
+        cooked++;
+
+        printf("%s\n", job.key.c_str());
+    }
+
+private:
+    CookSettings settings;
+    JobSystem jobs;
+    CookCache cache;
+
+    std::mutex textureMutex;
+    std::vector<TextureJob> textureJobs;
+
+    std::atomic<int> cooked{ 0 };
+    std::atomic<int> skipped{ 0 };
+    std::atomic<int> failed{ 0 };
+};
+
+static void PrintUsage()
+{
+    printf("Usage: AssetCooker <input dir> <output dir> [--threads N] [--force] [--no-compress] [--no-bc] [--fast-bc] [--pack FILE]\n");
+    printf("Cooks every .gltf, .glb and .obj under the input dir into engine mesh, material and texture files.\n");
+    printf("  --threads N    worker threads besides the main one, defaults to one per core\n");
+    printf("  --force        ignore the cache and cook everything\n");
+    printf("  --no-compress  store mesh data uncompressed\n");
+    printf("  --no-bc        store textures as RGBA8 instead of BC5 and BC7\n");
+    printf("  --fast-bc      skip endpoint refinement and the BC7 mode search\n");
+    printf("  --pack FILE    also pack the whole output dir into one archive for the engine's file system\n");
+}
+
+int main(int argc, char** argv)
+{
+    CookSettings settings;
+    std::vector<const char*> positional;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            settings.threadCount = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--force") == 0)
+            settings.force = true;
+        else if (strcmp(argv[i], "--no-compress") == 0)
+            settings.compress = false;
+        else if (strcmp(argv[i], "--no-bc") == 0)
+            settings.blockCompress = false;
+        else if (strcmp(argv[i], "--fast-bc") == 0)
+            settings.fastBlockCompress = true;
+        else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+            settings.packPath = argv[++i];
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 2)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    settings.inputRoot = positional[0];
+    settings.outputRoot = positional[1];
+
+    if (!fs::is_directory(settings.inputRoot))
+    {
+        fprintf(stderr, "error: %s is not a directory\n", positional[0]);
+        return EXIT_FAILURE;
+    }
+
+    fs::create_directories(settings.outputRoot);
+
+    AssetCooker cooker(settings);
+    return cooker.run();
+}
@@ -0,0 +1,127 @@
+#include "CookCache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#include "Hash.h"
+#include "MappedFile.h"
+
+// One line per entry: hash, key, then every input, separated by tabs. Outputs follow the inputs
+// after a lone '>' field.
+bool CookCache::load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+
+    if (!file)
+        return false;
+
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> fields;
+        size_t start = 0;
+
+        while (start <= line.size())
+        {
+            size_t end = line.find('\t', start);
+
+            if (end == std::string::npos)
+                end = line.size();
+
+            fields.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+
+        if (fields.size() < 2)
+            continue;
+
+        Entry entry;
+        entry.hash = strtoull(fields[0].c_str(), nullptr, 16);
+
+        auto separator = std::find(fields.begin() + 2, fields.end(), ">");
+        entry.inputs.assign(fields.begin() + 2, separator);
+
+        if (separator != fields.end())
+            entry.outputs.assign(separator + 1, fields.end());
+
+        entries[fields[1]] = std::move(entry);
+    }
+
+    return true;
+}
+
+bool CookCache::save(const std::filesystem::path& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Sorted so the file diffs cleanly between runs.
+    std::map<std::string, const Entry*> sorted;
+
+    for (const auto& [key, entry] : entries)
+        sorted[key] = &entry;
+
+    FILE* file = fopen(path.string().c_str(), "w");
+
+    if (!file)
+        return false;
+
+    for (const auto& [key, entry] : sorted)
+    {
+        fprintf(file, "%016" PRIx64 "\t%s", entry->hash, key.c_str());
+
+        for (const std::string& input : entry->inputs)
+            fprintf(file, "\t%s", input.c_str());
+
+        if (!entry->outputs.empty())
+        {
+            fprintf(file, "\t>");
+
+            for (const std::string& output : entry->outputs)
+                fprintf(file, "\t%s", output.c_str());
+        }
+
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+bool CookCache::find(const std::string& key, Entry& entry) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = entries.find(key);
+
+    if (found == entries.end())
+        return false;
+
+    entry = found->second;
+    return true;
+}
+
+void CookCache::update(const std::string& key, const Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries[key] = entry;
+}
+
+uint64_t HashFiles(const std::vector<std::string>& paths, uint64_t seed)
+{
+    uint64_t hash = seed;
+
+    for (const std::string& path : paths)
+    {
+        MappedFile file;
+
+        if (!file.open(path.c_str()))
+            return 0;
+
+        hash = HashCombine(hash, HashBytes(file.data(), file.size(), hash));
+    }
+
+    return hash;
+}
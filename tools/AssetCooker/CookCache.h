@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remembers the content hash every output was last cooked from, along with the inputs that went
+// into it, so unchanged sources can be skipped without importing them again.
+class CookCache
+{
+public:
+    struct Entry
+    {
+        uint64_t hash = 0;
+        std::vector<std::string> inputs;
+
+        // Other cooks this output relies on, such as the textures a mesh references.
+        std::vector<std::string> outputs;
+    };
+
+    bool load(const std::filesystem::path& path);
+    bool save(const std::filesystem::path& path) const;
+
+    // Safe to call from any thread.
+    bool find(const std::string& key, Entry& entry) const;
+    void update(const std::string& key, const Entry& entry);
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+// Hash of the contents of every file, in order. Zero if any of them can't be read.
+uint64_t HashFiles(const std::vector<std::string>& paths, uint64_t seed);
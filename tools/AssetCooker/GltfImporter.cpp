@@ -0,0 +1,765 @@
+#include "GltfImporter.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "Json.h"
+#include "MappedFile.h"
+
+namespace
+{
+    constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+    constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+    constexpr int COMPONENT_BYTE = 5120;
+    constexpr int COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr int COMPONENT_SHORT = 5122;
+    constexpr int COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr int COMPONENT_UNSIGNED_INT = 5125;
+    constexpr int COMPONENT_FLOAT = 5126;
+
+    constexpr int MODE_TRIANGLES = 4;
+    constexpr int MAX_NODE_DEPTH = 64;
+
+    // Column major 4x4, as glTF stores it.
+    struct Matrix
+    {
+        float m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+        Matrix operator*(const Matrix& other) const
+        {
+            Matrix result;
+
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 4; row++)
+                {
+                    float sum = 0.0f;
+
+                    for (int k = 0; k < 4; k++)
+                        sum += m[k * 4 + row] * other.m[column * 4 + k];
+
+                    result.m[column * 4 + row] = sum;
+                }
+            }
+
+            return result;
+        }
+
+        glm::vec3 transformPoint(const glm::vec3& p) const
+        {
+            return glm::vec3(
+                m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+        }
+
+        glm::vec3 transformVector(const glm::vec3& v) const
+        {
+            return glm::vec3(
+                m[0] * v.x + m[4] * v.y + m[8] * v.z,
+                m[1] * v.x + m[5] * v.y + m[9] * v.z,
+                m[2] * v.x + m[6] * v.y + m[10] * v.z);
+        }
+
+        float determinant3() const
+        {
+            return m[0] * (m[5] * m[10] - m[9] * m[6])
+                - m[4] * (m[1] * m[10] - m[9] * m[2])
+                + m[8] * (m[1] * m[6] - m[5] * m[2]);
+        }
+
+        // Cofactors of the upper 3x3, the inverse transpose up to a scale. Normals are
+        // renormalized after, so only the sign of the determinant matters.
+        Matrix normalMatrix() const
+        {
+            Matrix result;
+            float sign = determinant3() < 0.0f ? -1.0f : 1.0f;
+
+            result.m[0] = sign * (m[5] * m[10] - m[6] * m[9]);
+            result.m[1] = sign * (m[6] * m[8] - m[4] * m[10]);
+            result.m[2] = sign * (m[4] * m[9] - m[5] * m[8]);
+            result.m[4] = sign * (m[2] * m[9] - m[1] * m[10]);
+            result.m[5] = sign * (m[0] * m[10] - m[2] * m[8]);
+            result.m[6] = sign * (m[1] * m[8] - m[0] * m[9]);
+            result.m[8] = sign * (m[1] * m[6] - m[2] * m[5]);
+            result.m[9] = sign * (m[2] * m[4] - m[0] * m[6]);
+            result.m[10] = sign * (m[0] * m[5] - m[1] * m[4]);
+
+            return result;
+        }
+    };
+
+    glm::vec3 Normalize(const glm::vec3& v)
+    {
+        float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        return length > 0.0f ? v / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+
+    Matrix ReadNodeTransform(const JsonValue& node)
+    {
+        Matrix result;
+        const JsonValue& matrix = node["matrix"];
+
+        if (matrix.size() == 16)
+        {
+            for (int i = 0; i < 16; i++)
+                result.m[i] = static_cast<float>(matrix[i].asNumber());
+
+            return result;
+        }
+
+        const JsonValue& t = node["translation"];
+        const JsonValue& r = node["rotation"];
+        const JsonValue& s = node["scale"];
+
+        float x = static_cast<float>(r[0].asNumber(0.0)), y = static_cast<float>(r[1].asNumber(0.0));
+        float z = static_cast<float>(r[2].asNumber(0.0)), w = static_cast<float>(r[3].asNumber(1.0));
+        float sx = static_cast<float>(s[0].asNumber(1.0)), sy = static_cast<float>(s[1].asNumber(1.0)), sz = static_cast<float>(s[2].asNumber(1.0));
+
+        // T * R * S
+        result.m[0] = (1 - 2 * (y * y + z * z)) * sx;
+        result.m[1] = (2 * (x * y + z * w)) * sx;
+        result.m[2] = (2 * (x * z - y * w)) * sx;
+        result.m[4] = (2 * (x * y - z * w)) * sy;
+        result.m[5] = (1 - 2 * (x * x + z * z)) * sy;
+        result.m[6] = (2 * (y * z + x * w)) * sy;
+        result.m[8] = (2 * (x * z + y * w)) * sz;
+        result.m[9] = (2 * (y * z - x * w)) * sz;
+        result.m[10] = (1 - 2 * (x * x + y * y)) * sz;
+        result.m[12] = static_cast<float>(t[0].asNumber(0.0));
+        result.m[13] = static_cast<float>(t[1].asNumber(0.0));
+        result.m[14] = static_cast<float>(t[2].asNumber(0.0));
+
+        return result;
+    }
+
+    int Base64Value(char c)
+    {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    }
+
+    bool DecodeBase64(const char* text, size_t length, std::vector<uint8_t>& out)
+    {
+        out.clear();
+        out.reserve(length / 4 * 3);
+
+        uint32_t accumulator = 0;
+        int bits = 0;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            if (text[i] == '=')
+                break;
+
+            int value = Base64Value(text[i]);
+
+            if (value < 0)
+                return false;
+
+            accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+
+            if (bits >= 8)
+            {
+                bits -= 8;
+                out.push_back(static_cast<uint8_t>(accumulator >> bits));
+            }
+        }
+
+        return true;
+    }
+
+    bool DecodeDataUri(const std::string& uri, std::vector<uint8_t>& out)
+    {
+        size_t comma = uri.find(',');
+
+        if (comma == std::string::npos || uri.compare(comma - 7, 7, ";base64") != 0)
+            return false;
+
+        return DecodeBase64(uri.c_str() + comma + 1, uri.size() - comma - 1, out);
+    }
+
+    std::string DecodeUri(const std::string& uri)
+    {
+        std::string result;
+
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size())
+            {
+                result += static_cast<char>(strtol(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                result += uri[i];
+            }
+        }
+
+        return result;
+    }
+
+    int GetComponentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_BYTE:
+        case COMPONENT_UNSIGNED_BYTE: return 1;
+        case COMPONENT_SHORT:
+        case COMPONENT_UNSIGNED_SHORT: return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT: return 4;
+        }
+
+        return 0;
+    }
+
+    int GetComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+
+    float ReadComponent(const uint8_t* data, int componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_BYTE:
+        {
+            int8_t value;
+            memcpy(&value, data, 1);
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case COMPONENT_UNSIGNED_BYTE:
+            return normalized ? data[0] / 255.0f : data[0];
+        case COMPONENT_SHORT:
+        {
+            int16_t value;
+            memcpy(&value, data, 2);
+            return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            uint16_t value;
+            memcpy(&value, data, 2);
+            return normalized ? value / 65535.0f : value;
+        }
+        case COMPONENT_UNSIGNED_INT:
+        {
+            uint32_t value;
+            memcpy(&value, data, 4);
+            return static_cast<float>(value);
+        }
+        case COMPONENT_FLOAT:
+        {
+            float value;
+            memcpy(&value, data, 4);
+            return value;
+        }
+        }
+
+        return 0.0f;
+    }
+
+    struct BufferData
+    {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    class GltfImporter
+    {
+    public:
+        GltfImporter(const std::filesystem::path& path, ImportedScene& scene) : path(path), scene(scene) {}
+
+        bool import(std::string& error)
+        {
+            if (!file.open(path.string().c_str()))
+                return fail(error, "failed to open file");
+
+            const char* jsonText = reinterpret_cast<const char*>(file.data());
+            size_t jsonLength = file.size();
+            BufferData binaryChunk;
+
+            if (file.size() >= 12 && ReadU32(file.data()) == GLB_MAGIC)
+            {
+                if (!parseGlb(jsonText, jsonLength, binaryChunk))
+                    return fail(error, "malformed binary glTF container");
+            }
+
+            std::string jsonError;
+
+            if (!JsonValue::parse(jsonText, jsonLength, document, jsonError))
+                return fail(error, "invalid JSON: " + jsonError);
+
+            if (!loadBuffers(binaryChunk, error))
+                return false;
+
+            loadMaterials();
+
+            const JsonValue& scenes = document["scenes"];
+            const JsonValue& sceneNodes = scenes[document["scene"].asInt(0)]["nodes"];
+
+            if (sceneNodes.isArray())
+            {
+                for (const JsonValue& node : sceneNodes.getArray())
+                {
+                    if (!importNode(node.asInt(), Matrix(), 0, error))
+                        return false;
+                }
+            }
+            else
+            {
+                // No scene graph, take every mesh as is.
+                for (size_t i = 0; i < document["meshes"].size(); i++)
+                {
+                    if (!importMesh(static_cast<int>(i), Matrix(), error))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        static uint32_t ReadU32(const uint8_t* data)
+        {
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        static bool fail(std::string& error, const std::string& message)
+        {
+            error = message;
+            return false;
+        }
+
+        bool parseGlb(const char*& jsonText, size_t& jsonLength, BufferData& binaryChunk)
+        {
+            const uint8_t* data = file.data();
+            size_t size = std::min<size_t>(file.size(), ReadU32(data + 8));
+            size_t offset = 12;
+            bool foundJson = false;
+
+            while (offset + 8 <= size)
+            {
+                uint32_t chunkLength = ReadU32(data + offset);
+                uint32_t chunkType = ReadU32(data + offset + 4);
+                offset += 8;
+
+                if (chunkLength > size - offset)
+                    return false;
+
+                if (chunkType == GLB_CHUNK_JSON && !foundJson)
+                {
+                    jsonText = reinterpret_cast<const char*>(data + offset);
+                    jsonLength = chunkLength;
+                    foundJson = true;
+                }
+                else if (chunkType == GLB_CHUNK_BIN && binaryChunk.data == nullptr)
+                {
+                    binaryChunk.data = data + offset;
+                    binaryChunk.size = chunkLength;
+                }
+
+                offset += (chunkLength + 3) & ~3u;
+            }
+
+            return foundJson;
+        }
+
+        bool loadBuffers(const BufferData& binaryChunk, std::string& error)
+        {
+            const JsonValue& buffers = document["buffers"];
+
+            decodedBuffers.resize(buffers.size());
+            externalBuffers.resize(buffers.size());
+
+            for (size_t i = 0; i < buffers.size(); i++)
+            {
+                const JsonValue& buffer = buffers[i];
+                BufferData data;
+
+                if (!buffer.has("uri"))
+                {
+                    data = binaryChunk;
+                }
+                else if (buffer["uri"].asString().rfind("data:", 0) == 0)
+                {
+                    if (!DecodeDataUri(buffer["uri"].asString(), decodedBuffers[i]))
+                        return fail(error, "buffer " + std::to_string(i) + " has an invalid data URI");
+
+                    data.data = decodedBuffers[i].data();
+                    data.size = decodedBuffers[i].size();
+                }
+                else
+                {
+                    std::filesystem::path bufferPath = path.parent_path() / DecodeUri(buffer["uri"].asString());
+
+                    if (!externalBuffers[i].open(bufferPath.string().c_str()))
+                        return fail(error, "failed to open buffer " + bufferPath.string());
+
+                    scene.dependencies.push_back(bufferPath.string());
+                    data.data = externalBuffers[i].data();
+                    data.size = externalBuffers[i].size();
+                }
+
+                if (data.size < static_cast<size_t>(buffer["byteLength"].asNumber()))
+                    return fail(error, "buffer " + std::to_string(i) + " is shorter than its byteLength");
+
+                bufferData.push_back(data);
+            }
+
+            return true;
+        }
+
+        // Points at the bytes of a buffer view after bounds checking it.
+        bool getBufferView(int index, BufferData& view, size_t& stride)
+        {
+            const JsonValue& bufferView = document["bufferViews"][index];
+            int buffer = bufferView["buffer"].asInt();
+
+            if (buffer < 0 || buffer >= static_cast<int>(bufferData.size()))
+                return false;
+
+            size_t offset = static_cast<size_t>(bufferView["byteOffset"].asNumber(0));
+            size_t length = static_cast<size_t>(bufferView["byteLength"].asNumber(0));
+
+            if (offset > bufferData[buffer].size || length > bufferData[buffer].size - offset)
+                return false;
+
+            view.data = bufferData[buffer].data + offset;
+            view.size = length;
+            stride = static_cast<size_t>(bufferView["byteStride"].asNumber(0));
+
+            return true;
+        }
+
+        // Converts an accessor to floats, padding or truncating to components per element.
+        // Missing components are filled from fill, so a VEC3 colour reads back with alpha 1.
+        bool readAccessor(int index, int components, std::vector<float>& out, float fill = 0.0f)
+        {
+            const JsonValue& accessor = document["accessors"][index];
+
+            if (!accessor.isObject() || accessor.has("sparse"))
+                return false;
+
+            size_t count = static_cast<size_t>(accessor["count"].asNumber(0));
+            int componentType = accessor["componentType"].asInt();
+            int sourceComponents = GetComponentCount(accessor["type"].asString());
+            int componentSize = GetComponentSize(componentType);
+            bool normalized = accessor["normalized"].asBool();
+
+            if (sourceComponents == 0 || componentSize == 0)
+                return false;
+
+            out.assign(count * components, fill);
+
+            // No buffer view means all zeros.
+            if (!accessor.has("bufferView"))
+            {
+                std::fill(out.begin(), out.end(), 0.0f);
+                return true;
+            }
+
+            BufferData view;
+            size_t stride;
+
+            if (!getBufferView(accessor["bufferView"].asInt(), view, stride))
+                return false;
+
+            size_t elementSize = size_t(sourceComponents) * componentSize;
+            size_t offset = static_cast<size_t>(accessor["byteOffset"].asNumber(0));
+
+            if (stride == 0)
+                stride = elementSize;
+
+            if (count > 0 && (offset > view.size || (count - 1) * stride + elementSize > view.size - offset))
+                return false;
+
+            int copied = std::min(components, sourceComponents);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t* element = view.data + offset + i * stride;
+
+                for (int c = 0; c < copied; c++)
+                    out[i * components + c] = ReadComponent(element + c * componentSize, componentType, normalized);
+            }
+
+            return true;
+        }
+
+        bool readIndices(int index, std::vector<uint32_t>& out)
+        {
+            std::vector<float> values;
+
+            // Indices go through floats, exact for every index below 2^24.
+            if (!readAccessor(index, 1, values))
+                return false;
+
+            out.resize(values.size());
+
+            for (size_t i = 0; i < values.size(); i++)
+                out[i] = static_cast<uint32_t>(values[i]);
+
+            return true;
+        }
+
+        int getTexture(const JsonValue& textureInfo, bool srgb, bool normalMap = false)
+        {
+            if (!textureInfo.isObject())
+                return -1;
+
+            const JsonValue& texture = document["textures"][textureInfo["index"].asInt()];
+            int image = texture["source"].asInt();
+
+            if (image < 0 || image >= static_cast<int>(document["images"].size()))
+                return -1;
+
+            for (size_t i = 0; i < imageTextures.size(); i++)
+            {
+                if (imageTextures[i] == image)
+                    return static_cast<int>(i);
+            }
+
+            const JsonValue& imageInfo = document["images"][image];
+            ImportedTexture imported;
+            imported.srgb = srgb;
+            imported.normalMap = normalMap;
+
+            if (imageInfo.has("bufferView"))
+            {
+                BufferData view;
+                size_t stride;
+
+                if (!getBufferView(imageInfo["bufferView"].asInt(), view, stride))
+                    return -1;
+
+                imported.embedded.assign(view.data, view.data + view.size);
+            }
+            else if (imageInfo["uri"].asString().rfind("data:", 0) == 0)
+            {
+                if (!DecodeDataUri(imageInfo["uri"].asString(), imported.embedded))
+                    return -1;
+            }
+            else
+            {
+                imported.sourcePath = (path.parent_path() / DecodeUri(imageInfo["uri"].asString())).string();
+            }
+
+            scene.textures.push_back(std::move(imported));
+            imageTextures.push_back(image);
+
+            return static_cast<int>(scene.textures.size() - 1);
+        }
+
+        void loadMaterials()
+        {
+            const JsonValue& materials = document["materials"];
+
+            for (size_t i = 0; i < materials.size(); i++)
+            {
+                const JsonValue& source = materials[i];
+                const JsonValue& pbr = source["pbrMetallicRoughness"];
+                ImportedMaterial material;
+
+                material.name = source["name"].isString() ? source["name"].asString() : "material" + std::to_string(i);
+
+                for (int c = 0; c < 4; c++)
+                    material.baseColor[c] = static_cast<float>(pbr["baseColorFactor"][c].asNumber(1.0));
+
+                for (int c = 0; c < 3; c++)
+                    material.emissive[c] = static_cast<float>(source["emissiveFactor"][c].asNumber(0.0));
+
+                material.metallic = static_cast<float>(pbr["metallicFactor"].asNumber(1.0));
+                material.roughness = static_cast<float>(pbr["roughnessFactor"].asNumber(1.0));
+                material.alphaCutoff = static_cast<float>(source["alphaCutoff"].asNumber(0.5));
+                material.doubleSided = source["doubleSided"].asBool();
+
+                const std::string& alphaMode = source["alphaMode"].asString();
+
+                if (alphaMode == "MASK")
+                    material.alphaMode = AlphaMode::Mask;
+                else if (alphaMode == "BLEND")
+                    material.alphaMode = AlphaMode::Blend;
+
+                material.textures[MATERIAL_BASE_COLOR] = getTexture(pbr["baseColorTexture"], true);
+                material.textures[MATERIAL_METALLIC_ROUGHNESS] = getTexture(pbr["metallicRoughnessTexture"], false);
+                material.textures[MATERIAL_NORMAL] = getTexture(source["normalTexture"], false, true);
+                material.textures[MATERIAL_OCCLUSION] = getTexture(source["occlusionTexture"], false);
+                material.textures[MATERIAL_EMISSIVE] = getTexture(source["emissiveTexture"], true);
+
+                scene.materials.push_back(material);
+            }
+        }
+
+        uint32_t getDefaultMaterial()
+        {
+            if (defaultMaterial < 0)
+            {
+                ImportedMaterial material;
+                material.name = "default";
+                material.metallic = 0.0f;
+
+                scene.materials.push_back(material);
+                defaultMaterial = static_cast<int>(scene.materials.size() - 1);
+            }
+
+            return static_cast<uint32_t>(defaultMaterial);
+        }
+
+        bool importNode(int index, const Matrix& parent, int depth, std::string& error)
+        {
+            const JsonValue& node = document["nodes"][index];
+
+            if (!node.isObject())
+                return fail(error, "invalid node " + std::to_string(index));
+
+            if (depth > MAX_NODE_DEPTH)
+                return fail(error, "node hierarchy too deep or cyclic");
+
+            Matrix world = parent * ReadNodeTransform(node);
+
+            if (node.has("mesh") && !importMesh(node["mesh"].asInt(), world, error))
+                return false;
+
+            for (const JsonValue& child : node["children"].getArray())
+            {
+                if (!importNode(child.asInt(), world, depth + 1, error))
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool importMesh(int index, const Matrix& transform, std::string& error)
+        {
+            const JsonValue& mesh = document["meshes"][index];
+
+            if (!mesh.isObject())
+                return fail(error, "invalid mesh " + std::to_string(index));
+
+            Matrix normalTransform = transform.normalMatrix();
+            bool mirrored = transform.determinant3() < 0.0f;
+
+            for (const JsonValue& primitive : mesh["primitives"].getArray())
+            {
+                if (primitive["mode"].asInt(MODE_TRIANGLES) != MODE_TRIANGLES)
+                    continue;
+
+                const JsonValue& attributes = primitive["attributes"];
+                ImportedSubmesh submesh;
+                std::vector<float> values;
+
+                if (!readAccessor(attributes["POSITION"].asInt(), 3, values))
+                    return fail(error, "mesh " + std::to_string(index) + " has an unreadable POSITION accessor");
+
+                size_t vertexCount = values.size() / 3;
+
+                for (size_t v = 0; v < vertexCount; v++)
+                    submesh.positions.push_back(transform.transformPoint(glm::vec3(values[v * 3], values[v * 3 + 1], values[v * 3 + 2])));
+
+                if (attributes.has("NORMAL") && readAccessor(attributes["NORMAL"].asInt(), 3, values) && values.size() == vertexCount * 3)
+                {
+                    for (size_t v = 0; v < vertexCount; v++)
+                        submesh.normals.push_back(Normalize(normalTransform.transformVector(glm::vec3(values[v * 3], values[v * 3 + 1], values[v * 3 + 2]))));
+                }
+
+                if (attributes.has("TANGENT") && readAccessor(attributes["TANGENT"].asInt(), 4, values) && values.size() == vertexCount * 4)
+                {
+                    for (size_t v = 0; v < vertexCount; v++)
+                    {
+                        glm::vec3 tangent = Normalize(transform.transformVector(glm::vec3(values[v * 4], values[v * 4 + 1], values[v * 4 + 2])));
+                        submesh.tangents.emplace_back(tangent, mirrored ? -values[v * 4 + 3] : values[v * 4 + 3]);
+                    }
+                }
+
+                if (attributes.has("TEXCOORD_0") && readAccessor(attributes["TEXCOORD_0"].asInt(), 2, values) && values.size() == vertexCount * 2)
+                {
+                    for (size_t v = 0; v < vertexCount; v++)
+                        submesh.texCoords0.emplace_back(values[v * 2], values[v * 2 + 1]);
+                }
+
+                if (attributes.has("TEXCOORD_1") && readAccessor(attributes["TEXCOORD_1"].asInt(), 2, values) && values.size() == vertexCount * 2)
+                {
+                    for (size_t v = 0; v < vertexCount; v++)
+                        submesh.texCoords1.emplace_back(values[v * 2], values[v * 2 + 1]);
+                }
+
+                if (attributes.has("COLOR_0") && readAccessor(attributes["COLOR_0"].asInt(), 4, values, 1.0f) && values.size() == vertexCount * 4)
+                {
+                    for (size_t v = 0; v < vertexCount; v++)
+                        submesh.colors.emplace_back(values[v * 4], values[v * 4 + 1], values[v * 4 + 2], values[v * 4 + 3]);
+                }
+
+                if (primitive.has("indices"))
+                {
+                    if (!readIndices(primitive["indices"].asInt(), submesh.indices))
+                        return fail(error, "mesh " + std::to_string(index) + " has an unreadable index accessor");
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < vertexCount; i++)
+                        submesh.indices.push_back(i);
+                }
+
+                submesh.indices.resize(submesh.indices.size() / 3 * 3);
+
+                for (size_t i = 0; i < submesh.indices.size(); i += 3)
+                {
+                    if (submesh.indices[i] >= vertexCount || submesh.indices[i + 1] >= vertexCount || submesh.indices[i + 2] >= vertexCount)
+                        return fail(error, "mesh " + std::to_string(index) + " has an out of range index");
+
+                    // A mirroring transform flips the winding, swap it back.
+                    if (mirrored)
+                        std::swap(submesh.indices[i + 1], submesh.indices[i + 2]);
+                }
+
+                int material = primitive["material"].asInt();
+
+                if (material >= 0 && material < static_cast<int>(document["materials"].size()))
+                    submesh.material = static_cast<uint32_t>(material);
+                else
+                    submesh.material = getDefaultMaterial();
+
+                scene.submeshes.push_back(std::move(submesh));
+            }
+
+            return true;
+        }
+
+    private:
+        std::filesystem::path path;
+        ImportedScene& scene;
+
+        MappedFile file;
+        JsonValue document;
+
+        std::vector<BufferData> bufferData;
+        std::vector<std::vector<uint8_t>> decodedBuffers;
+        std::vector<MappedFile> externalBuffers;
+
+        // glTF image index of each texture added to the scene.
+        std::vector<int> imageTextures;
+        int defaultMaterial = -1;
+    };
+}
+
+bool ImportGltf(const std::filesystem::path& path, ImportedScene& scene, std::string& error)
+{
+    GltfImporter importer(path, scene);
+    return importer.import(error);
+}
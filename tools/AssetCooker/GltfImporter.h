@@ -0,0 +1,11 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "ImportedScene.h"
+
+// glTF 2.0, both .gltf (external or data URI buffers) and binary .glb. The default scene is
+// flattened: every mesh instance becomes submeshes with its node transform baked in.
+// Only triangle list primitives are imported, sparse accessors are rejected.
+bool ImportGltf(const std::filesystem::path& path, ImportedScene& scene, std::string& error);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MaterialFile.h"
+
+// Format independent result of importing one source file, before optimization and quantization.
+// Optional streams are either empty or have one entry per position.
+struct ImportedSubmesh
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec4> tangents;
+    std::vector<glm::vec2> texCoords0;
+    std::vector<glm::vec2> texCoords1;
+    std::vector<glm::vec4> colors;
+
+    std::vector<uint32_t> indices;
+    uint32_t material = 0;
+};
+
+// An image referenced by a material, either a file on disk or bytes embedded in the source.
+struct ImportedTexture
+{
+    std::string sourcePath;
+    std::vector<uint8_t> embedded;
+    bool srgb = false;
+    bool normalMap = false;
+
+    // Where the cooked texture goes, relative to the output root.
+    std::string outputPath;
+};
+
+struct ImportedMaterial
+{
+    std::string name;
+
+    glm::vec4 baseColor{ 1.0f };
+    glm::vec3 emissive{ 0.0f };
+    float metallic = 1.0f;
+    float roughness = 1.0f;
+    float alphaCutoff = 0.5f;
+    AlphaMode alphaMode = AlphaMode::Opaque;
+    bool doubleSided = false;
+
+    // Index into ImportedScene::textures, -1 when the slot is unused.
+    int textures[MATERIAL_TEXTURE_COUNT] = { -1, -1, -1, -1, -1 };
+};
+
+struct ImportedScene
+{
+    std::vector<ImportedSubmesh> submeshes;
+    std::vector<ImportedMaterial> materials;
+    std::vector<ImportedTexture> textures;
+
+    // Every other file the import read, so the content hash covers them too.
+    std::vector<std::string> dependencies;
+};
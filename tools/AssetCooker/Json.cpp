@@ -0,0 +1,327 @@
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+
+class JsonParser
+{
+public:
+    JsonParser(const char* text, size_t length) : current(text), end(text + length) {}
+
+    bool parseDocument(JsonValue& value)
+    {
+        if (!parseValue(value, 0))
+            return false;
+
+        skipWhitespace();
+
+        return current == end || fail("trailing characters after document");
+    }
+
+    std::string error;
+
+private:
+    static constexpr int MAX_DEPTH = 256;
+
+    bool fail(const char* message)
+    {
+        if (error.empty())
+            error = message;
+
+        return false;
+    }
+
+    void skipWhitespace()
+    {
+        while (current < end && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r'))
+            current++;
+    }
+
+    bool consume(char c)
+    {
+        skipWhitespace();
+
+        if (current < end && *current == c)
+        {
+            current++;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool matchLiteral(const char* literal)
+    {
+        size_t length = strlen(literal);
+
+        if (static_cast<size_t>(end - current) < length || memcmp(current, literal, length) != 0)
+            return false;
+
+        current += length;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value, int depth)
+    {
+        if (depth > MAX_DEPTH)
+            return fail("document nested too deeply");
+
+        skipWhitespace();
+
+        if (current == end)
+            return fail("unexpected end of document");
+
+        switch (*current)
+        {
+        case '{': return parseObject(value, depth);
+        case '[': return parseArray(value, depth);
+        case '"':
+            value.type = JsonValue::Type::String;
+            return parseString(value.string);
+        case 't':
+        case 'f':
+            value.type = JsonValue::Type::Bool;
+            value.boolean = *current == 't';
+            return matchLiteral(value.boolean ? "true" : "false") || fail("invalid literal");
+        case 'n':
+            value.type = JsonValue::Type::Null;
+            return matchLiteral("null") || fail("invalid literal");
+        default:
+            return parseNumber(value);
+        }
+    }
+
+    bool parseNumber(JsonValue& value)
+    {
+        // strtod needs a terminator, numbers are short so copy them out.
+        char buffer[64];
+        size_t length = 0;
+
+        while (current < end && length < sizeof(buffer) - 1 && strchr("+-0123456789.eE", *current))
+            buffer[length++] = *current++;
+
+        buffer[length] = '\0';
+
+        char* parsedEnd = nullptr;
+        value.number = strtod(buffer, &parsedEnd);
+        value.type = JsonValue::Type::Number;
+
+        return (length > 0 && parsedEnd == buffer + length) || fail("invalid number");
+    }
+
+    static void AppendUtf8(std::string& out, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+        {
+            out += static_cast<char>(codepoint);
+        }
+        else if (codepoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parseHex4(uint32_t& result)
+    {
+        if (end - current < 4)
+            return false;
+
+        result = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            char c = *current++;
+            result <<= 4;
+
+            if (c >= '0' && c <= '9')
+                result |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                result |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                result |= c - 'A' + 10;
+            else
+                return false;
+        }
+
+        return true;
+    }
+
+    bool parseString(std::string& out)
+    {
+        current++; // opening quote
+
+        while (current < end && *current != '"')
+        {
+            char c = *current++;
+
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+
+            if (current == end)
+                break;
+
+            char escape = *current++;
+
+            switch (escape)
+            {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                uint32_t codepoint;
+
+                if (!parseHex4(codepoint))
+                    return fail("invalid unicode escape");
+
+                // Surrogate pair.
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && end - current >= 6 && current[0] == '\\' && current[1] == 'u')
+                {
+                    current += 2;
+                    uint32_t low;
+
+                    if (!parseHex4(low) || low < 0xDC00 || low >= 0xE000)
+                        return fail("invalid surrogate pair");
+
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                AppendUtf8(out, codepoint);
+                break;
+            }
+            default:
+                return fail("invalid escape sequence");
+            }
+        }
+
+        if (current == end)
+            return fail("unterminated string");
+
+        current++; // closing quote
+        return true;
+    }
+
+    bool parseArray(JsonValue& value, int depth)
+    {
+        current++;
+        value.type = JsonValue::Type::Array;
+
+        if (consume(']'))
+            return true;
+
+        do
+        {
+            value.array.emplace_back();
+
+            if (!parseValue(value.array.back(), depth + 1))
+                return false;
+        }
+        while (consume(','));
+
+        return consume(']') || fail("expected ',' or ']'");
+    }
+
+    bool parseObject(JsonValue& value, int depth)
+    {
+        current++;
+        value.type = JsonValue::Type::Object;
+
+        if (consume('}'))
+            return true;
+
+        do
+        {
+            skipWhitespace();
+
+            if (current == end || *current != '"')
+                return fail("expected object key");
+
+            value.members.emplace_back();
+
+            if (!parseString(value.members.back().first))
+                return false;
+
+            if (!consume(':'))
+                return fail("expected ':'");
+
+            if (!parseValue(value.members.back().second, depth + 1))
+                return false;
+        }
+        while (consume(','));
+
+        return consume('}') || fail("expected ',' or '}'");
+    }
+
+private:
+    const char* current;
+    const char* end;
+};
+
+const JsonValue& JsonValue::Null()
+{
+    static const JsonValue null;
+    return null;
+}
+
+size_t JsonValue::size() const
+{
+    if (type == Type::Array)
+        return array.size();
+
+    if (type == Type::Object)
+        return members.size();
+
+    return 0;
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const
+{
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return member.second;
+    }
+
+    return Null();
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+    return index < array.size() ? array[index] : Null();
+}
+
+bool JsonValue::parse(const char* text, size_t length, JsonValue& result, std::string& error)
+{
+    JsonParser parser(text, length);
+    result = JsonValue();
+
+    if (!parser.parseDocument(result))
+    {
+        error = parser.error;
+        return false;
+    }
+
+    return true;
+}
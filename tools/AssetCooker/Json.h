@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Small read only JSON DOM, enough for glTF. Missing keys and out of range indices return a
+// shared null value so lookups can be chained without checks.
+class JsonValue
+{
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type getType() const { return type; }
+
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    bool asBool(bool fallback = false) const { return type == Type::Bool ? boolean : fallback; }
+    double asNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    int asInt(int fallback = -1) const { return type == Type::Number ? static_cast<int>(number) : fallback; }
+    const std::string& asString() const { return string; }
+
+    size_t size() const;
+    bool has(const char* key) const { return &(*this)[key] != &Null(); }
+
+    const JsonValue& operator[](const char* key) const;
+    const JsonValue& operator[](size_t index) const;
+
+    // Negative indices (such as a missing index read with asInt) return null.
+    const JsonValue& operator[](int index) const { return index < 0 ? Null() : (*this)[static_cast<size_t>(index)]; }
+
+    const std::vector<JsonValue>& getArray() const { return array; }
+
+    static bool parse(const char* text, size_t length, JsonValue& result, std::string& error);
+
+private:
+    static const JsonValue& Null();
+
+    friend class JsonParser;
+
+private:
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
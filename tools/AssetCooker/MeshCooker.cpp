@@ -0,0 +1,232 @@
+#include "MeshCooker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "MeshOptimizer.h"
+
+namespace
+{
+    int16_t PackSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint16_t PackUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    uint8_t PackUnorm8(float value)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    // Area weighted smooth normals, the cross product length is twice the triangle area.
+    void GenerateNormals(ImportedSubmesh& submesh)
+    {
+        submesh.normals.assign(submesh.positions.size(), glm::vec3(0.0f));
+
+        for (size_t i = 0; i + 2 < submesh.indices.size(); i += 3)
+        {
+            uint32_t a = submesh.indices[i], b = submesh.indices[i + 1], c = submesh.indices[i + 2];
+            glm::vec3 normal = glm::cross(submesh.positions[b] - submesh.positions[a], submesh.positions[c] - submesh.positions[a]);
+
+            submesh.normals[a] += normal;
+            submesh.normals[b] += normal;
+            submesh.normals[c] += normal;
+        }
+
+        for (glm::vec3& normal : submesh.normals)
+        {
+            float length = glm::length(normal);
+            normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+    }
+
+    bool InUnitRange(const std::vector<glm::vec2>& values)
+    {
+        for (const glm::vec2& value : values)
+        {
+            if (value.x < 0.0f || value.x > 1.0f || value.y < 0.0f || value.y > 1.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    void Remap(std::vector<T>& stream, const std::vector<uint32_t>& remap, uint32_t newCount)
+    {
+        if (stream.empty())
+            return;
+
+        std::vector<T> result(newCount);
+
+        for (size_t i = 0; i < remap.size(); i++)
+        {
+            if (remap[i] != ~0u)
+                result[remap[i]] = stream[i];
+        }
+
+        stream.swap(result);
+    }
+
+    void Write(uint8_t* vertex, uint32_t offset, const void* data, size_t size)
+    {
+        memcpy(vertex + offset, data, size);
+    }
+}
+
+void CookMesh(ImportedScene& scene, MeshFileData& mesh, MeshCookStats& stats)
+{
+    mesh = MeshFileData();
+    stats = MeshCookStats();
+
+    bool hasTangents = false, hasTexCoords0 = false, hasTexCoords1 = false, hasColors = false;
+    bool texCoords0Unit = true, texCoords1Unit = true;
+    double missesBefore = 0.0, missesAfter = 0.0;
+
+    for (ImportedSubmesh& submesh : scene.submeshes)
+    {
+        if (submesh.normals.size() != submesh.positions.size())
+            GenerateNormals(submesh);
+
+        uint32_t vertexCount = static_cast<uint32_t>(submesh.positions.size());
+        float triangles = float(submesh.indices.size() / 3);
+
+        missesBefore += ComputeACMR(submesh.indices, vertexCount) * triangles;
+        OptimizeVertexCache(submesh.indices, vertexCount);
+        missesAfter += ComputeACMR(submesh.indices, vertexCount) * triangles;
+
+        std::vector<uint32_t> remap;
+        uint32_t usedCount = OptimizeVertexFetch(submesh.indices, vertexCount, remap);
+
+        Remap(submesh.positions, remap, usedCount);
+        Remap(submesh.normals, remap, usedCount);
+        Remap(submesh.tangents, remap, usedCount);
+        Remap(submesh.texCoords0, remap, usedCount);
+        Remap(submesh.texCoords1, remap, usedCount);
+        Remap(submesh.colors, remap, usedCount);
+
+        hasTangents |= !submesh.tangents.empty();
+        hasTexCoords0 |= !submesh.texCoords0.empty();
+        hasTexCoords1 |= !submesh.texCoords1.empty();
+        hasColors |= !submesh.colors.empty();
+        texCoords0Unit &= InUnitRange(submesh.texCoords0);
+        texCoords1Unit &= InUnitRange(submesh.texCoords1);
+
+        stats.vertexCount += usedCount;
+        stats.triangleCount += static_cast<uint32_t>(submesh.indices.size() / 3);
+    }
+
+    if (stats.triangleCount > 0)
+    {
+        stats.acmrBefore = float(missesBefore / stats.triangleCount);
+        stats.acmrAfter = float(missesAfter / stats.triangleCount);
+    }
+
+    // Vertex layout.
+    uint32_t stride = 0;
+
+    auto addAttribute = [&](VertexSemantic semantic, VertexFormat format)
+    {
+        MeshFileAttribute attribute{ semantic, format, stride, 0 };
+        mesh.attributes.push_back(attribute);
+        stride += GetVertexFormatSize(format);
+        return attribute.offset;
+    };
+
+    VertexFormat texCoords0Format = texCoords0Unit ? VertexFormat::Unorm16x2 : VertexFormat::Float2;
+    VertexFormat texCoords1Format = texCoords1Unit ? VertexFormat::Unorm16x2 : VertexFormat::Float2;
+
+    uint32_t positionOffset = addAttribute(VertexSemantic::Position, VertexFormat::Float3);
+    uint32_t normalOffset = addAttribute(VertexSemantic::Normal, VertexFormat::Snorm16x4);
+    uint32_t tangentOffset = hasTangents ? addAttribute(VertexSemantic::Tangent, VertexFormat::Snorm16x4) : 0;
+    uint32_t texCoords0Offset = hasTexCoords0 ? addAttribute(VertexSemantic::TexCoord0, texCoords0Format) : 0;
+    uint32_t texCoords1Offset = hasTexCoords1 ? addAttribute(VertexSemantic::TexCoord1, texCoords1Format) : 0;
+    uint32_t colorOffset = hasColors ? addAttribute(VertexSemantic::Color, VertexFormat::Unorm8x4) : 0;
+
+    mesh.vertexStride = stride;
+    mesh.vertexCount = stats.vertexCount;
+    mesh.vertices.assign(size_t(stride) * stats.vertexCount, 0);
+
+    auto writeTexCoord = [&](uint8_t* vertex, uint32_t offset, VertexFormat format, const glm::vec2& value)
+    {
+        if (format == VertexFormat::Unorm16x2)
+        {
+            uint16_t packed[2] = { PackUnorm16(value.x), PackUnorm16(value.y) };
+            Write(vertex, offset, packed, sizeof(packed));
+        }
+        else
+        {
+            float packed[2] = { value.x, value.y };
+            Write(vertex, offset, packed, sizeof(packed));
+        }
+    };
+
+    uint32_t baseVertex = 0;
+
+    for (const ImportedSubmesh& submesh : scene.submeshes)
+    {
+        MeshFileSubmesh entry{};
+        entry.firstIndex = static_cast<uint32_t>(mesh.indices.size());
+        entry.indexCount = static_cast<uint32_t>(submesh.indices.size());
+        entry.vertexOffset = static_cast<int32_t>(baseVertex);
+        entry.vertexCount = static_cast<uint32_t>(submesh.positions.size());
+        entry.materialIndex = submesh.material;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            entry.boundsMin[axis] = submesh.positions.empty() ? 0.0f : 3.402823466e+38f;
+            entry.boundsMax[axis] = submesh.positions.empty() ? 0.0f : -3.402823466e+38f;
+        }
+
+        for (uint32_t v = 0; v < entry.vertexCount; v++)
+        {
+            uint8_t* vertex = mesh.vertices.data() + size_t(baseVertex + v) * stride;
+            const glm::vec3& position = submesh.positions[v];
+
+            float packedPosition[3] = { position.x, position.y, position.z };
+            Write(vertex, positionOffset, packedPosition, sizeof(packedPosition));
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                entry.boundsMin[axis] = std::min(entry.boundsMin[axis], position[axis]);
+                entry.boundsMax[axis] = std::max(entry.boundsMax[axis], position[axis]);
+            }
+
+            const glm::vec3& normal = submesh.normals[v];
+            int16_t packedNormal[4] = { PackSnorm16(normal.x), PackSnorm16(normal.y), PackSnorm16(normal.z), 0 };
+            Write(vertex, normalOffset, packedNormal, sizeof(packedNormal));
+
+            if (hasTangents)
+            {
+                glm::vec4 tangent = submesh.tangents.empty() ? glm::vec4(1.0f, 0.0f, 0.0f, 1.0f) : submesh.tangents[v];
+                int16_t packedTangent[4] = { PackSnorm16(tangent.x), PackSnorm16(tangent.y), PackSnorm16(tangent.z), PackSnorm16(tangent.w < 0.0f ? -1.0f : 1.0f) };
+                Write(vertex, tangentOffset, packedTangent, sizeof(packedTangent));
+            }
+
+            if (hasTexCoords0)
+                writeTexCoord(vertex, texCoords0Offset, texCoords0Format, submesh.texCoords0.empty() ? glm::vec2(0.0f) : submesh.texCoords0[v]);
+
+            if (hasTexCoords1)
+                writeTexCoord(vertex, texCoords1Offset, texCoords1Format, submesh.texCoords1.empty() ? glm::vec2(0.0f) : submesh.texCoords1[v]);
+
+            if (hasColors)
+            {
+                glm::vec4 color = submesh.colors.empty() ? glm::vec4(1.0f) : submesh.colors[v];
+                uint8_t packedColor[4] = { PackUnorm8(color.x), PackUnorm8(color.y), PackUnorm8(color.z), PackUnorm8(color.w) };
+                Write(vertex, colorOffset, packedColor, sizeof(packedColor));
+            }
+        }
+
+        // Indices stay relative to the submesh's base vertex, which keeps them 16 bit whenever
+        // every submesh is under 64k vertices.
+        mesh.indices.insert(mesh.indices.end(), submesh.indices.begin(), submesh.indices.end());
+        mesh.submeshes.push_back(entry);
+
+        baseVertex += entry.vertexCount;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ImportedScene.h"
+#include "MeshFile.h"
+
+struct MeshCookStats
+{
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+};
+
+// Optimizes every submesh for the vertex cache and fetch order, quantizes the vertex streams and
+// packs everything into one interleaved vertex buffer:
+//   position  Float3
+//   normal    Snorm16x4
+//   tangent   Snorm16x4, w is the bitangent sign
+//   texcoords Unorm16x2 when inside [0, 1], otherwise Float2
+//   color     Unorm8x4
+// Streams no submesh has are left out, missing normals are generated.
+void CookMesh(ImportedScene& scene, MeshFileData& mesh, MeshCookStats& stats);
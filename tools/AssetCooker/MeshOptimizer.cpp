@@ -0,0 +1,219 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr int CACHE_SIZE = 32;
+static constexpr int MAX_VALENCE = 64;
+
+static constexpr float CACHE_DECAY_POWER = 1.5f;
+static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+namespace
+{
+    struct ScoreTables
+    {
+        float cache[CACHE_SIZE];
+        float valence[MAX_VALENCE + 1];
+
+        ScoreTables()
+        {
+            for (int i = 0; i < CACHE_SIZE; i++)
+            {
+                // The last triangle's vertices get a fixed score so it isn't immediately reused,
+                // which would just repeat the same edge.
+                if (i < 3)
+                    cache[i] = LAST_TRIANGLE_SCORE;
+                else
+                    cache[i] = powf(1.0f - float(i - 3) / float(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+            }
+
+            valence[0] = 0.0f;
+
+            for (int i = 1; i <= MAX_VALENCE; i++)
+                valence[i] = VALENCE_BOOST_SCALE * powf(float(i), -VALENCE_BOOST_POWER);
+        }
+
+        float score(int cachePosition, uint32_t remaining) const
+        {
+            // Fully used vertices must never pull triangles towards them.
+            if (remaining == 0)
+                return -1.0f;
+
+            float result = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+            return result + valence[std::min<uint32_t>(remaining, MAX_VALENCE)];
+        }
+    };
+}
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+{
+    static const ScoreTables tables;
+
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    if (triangleCount == 0)
+        return;
+
+    // Triangles adjacent to each vertex, the first remaining[v] entries are the ones not yet emitted.
+    std::vector<uint32_t> remaining(vertexCount, 0);
+
+    for (uint32_t index : indices)
+        remaining[index]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+
+    for (uint32_t v = 0; v < vertexCount; v++)
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+
+    for (uint32_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = tables.score(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+
+    for (uint32_t t = 0; t < triangleCount; t++)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    // Room for the whole cache plus the three vertices pushed in by the latest triangle.
+    uint32_t cache[CACHE_SIZE + 3];
+    uint32_t newCache[CACHE_SIZE + 3];
+    int cacheCount = 0;
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t best = 0;
+    uint32_t cursor = 0;
+
+    for (uint32_t step = 0; step < triangleCount; step++)
+    {
+        // No candidate near the cache, fall back to the next triangle in input order.
+        if (best == ~0u)
+        {
+            while (emitted[cursor])
+                cursor++;
+
+            best = cursor;
+        }
+
+        emitted[best] = 1;
+
+        const uint32_t* triangle = &indices[best * 3];
+        int newCount = 0;
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = triangle[k];
+            result.push_back(v);
+            newCache[newCount++] = v;
+
+            // Drop the triangle from the vertex's remaining list.
+            uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+            uint32_t* end = begin + remaining[v];
+            uint32_t* found = std::find(begin, end, best);
+
+            *found = *(end - 1);
+            remaining[v]--;
+        }
+
+        for (int i = 0; i < cacheCount; i++)
+        {
+            uint32_t v = cache[i];
+
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                newCache[newCount++] = v;
+        }
+
+        // Vertices that fell out of the cache.
+        for (int i = CACHE_SIZE; i < newCount; i++)
+            cachePosition[newCache[i]] = -1;
+
+        cacheCount = std::min(newCount, CACHE_SIZE);
+
+        for (int i = 0; i < cacheCount; i++)
+        {
+            cache[i] = newCache[i];
+            cachePosition[cache[i]] = i;
+        }
+
+        // Rescore everything whose cache position changed and every triangle touching it.
+        float bestScore = -1.0f;
+        best = ~0u;
+
+        for (int i = 0; i < newCount; i++)
+        {
+            uint32_t v = newCache[i];
+            float score = tables.score(cachePosition[v], remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+
+            const uint32_t* begin = &adjacency[adjacencyOffsets[v]];
+
+            for (uint32_t j = 0; j < remaining[v]; j++)
+            {
+                uint32_t t = begin[j];
+                triangleScore[t] += delta;
+
+                if (i < cacheCount && triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices.swap(result);
+}
+
+uint32_t OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& remap)
+{
+    remap.assign(vertexCount, ~0u);
+    uint32_t next = 0;
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == ~0u)
+            remap[index] = next++;
+
+        index = remap[index];
+    }
+
+    return next;
+}
+
+float ComputeACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // Vertex v is in the FIFO while timestamps[v] is within cacheSize misses of now.
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t misses = 0;
+
+    for (uint32_t index : indices)
+    {
+        if (timestamps[index] == 0 || misses + 1 - timestamps[index] > cacheSize)
+        {
+            misses++;
+            timestamps[index] = misses;
+        }
+    }
+
+    return float(misses) / float(indices.size() / 3);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Reorders triangles for the post transform vertex cache (Forsyth, "Linear-Speed Vertex Cache
+// Optimisation"). Works on an indexed triangle list in place.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+// Renumbers vertices in order of first use so fetches walk memory forwards. Fills remap with
+// the new index of every old vertex (~0u for unused ones) and returns the new vertex count.
+uint32_t OptimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount, std::vector<uint32_t>& remap);
+
+// Average transformed vertices per triangle with a FIFO cache, lower is better (0.5 is ideal).
+float ComputeACMR(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 16);
@@ -0,0 +1,490 @@
+#include "ObjImporter.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include "MappedFile.h"
+
+namespace
+{
+    // Walks a mapped text file one line at a time. Lines are copied out so the usual
+    // terminator based C parsing functions can be used on them.
+    class LineReader
+    {
+    public:
+        LineReader(const MappedFile& file)
+            : current(reinterpret_cast<const char*>(file.data())), end(current + file.size()) {}
+
+        bool next(std::string& line)
+        {
+            if (current >= end)
+                return false;
+
+            const char* start = current;
+
+            while (current < end && *current != '\n')
+                current++;
+
+            const char* lineEnd = current;
+
+            if (lineEnd > start && lineEnd[-1] == '\r')
+                lineEnd--;
+
+            line.assign(start, lineEnd);
+            current++;
+
+            return true;
+        }
+
+    private:
+        const char* current;
+        const char* end;
+    };
+
+    const char* SkipSpace(const char* text)
+    {
+        while (*text == ' ' || *text == '\t')
+            text++;
+
+        return text;
+    }
+
+    // Returns the keyword and points rest at what follows it.
+    std::string SplitKeyword(const std::string& line, const char*& rest)
+    {
+        const char* text = SkipSpace(line.c_str());
+        const char* start = text;
+
+        while (*text && *text != ' ' && *text != '\t')
+            text++;
+
+        rest = SkipSpace(text);
+        return std::string(start, text);
+    }
+
+    int ParseFloats(const char* text, float* values, int maxCount)
+    {
+        int count = 0;
+
+        while (count < maxCount)
+        {
+            char* end;
+            float value = strtof(text, &end);
+
+            if (end == text)
+                break;
+
+            values[count++] = value;
+            text = end;
+        }
+
+        return count;
+    }
+
+    // Texture map statements can carry options ("-bm 1.0 file.png"), the file name is last.
+    std::string ParseMapPath(const char* text)
+    {
+        std::string path = text;
+
+        while (!path.empty() && (path.back() == ' ' || path.back() == '\t'))
+            path.pop_back();
+
+        size_t option = path.rfind(" -");
+
+        if (path.rfind('-', 0) == 0 || option != std::string::npos)
+        {
+            size_t lastSpace = path.find_last_of(" \t");
+
+            if (lastSpace != std::string::npos)
+                path = path.substr(lastSpace + 1);
+        }
+
+        return path;
+    }
+
+    struct VertexKey
+    {
+        int position;
+        int texCoord;
+        int normal;
+
+        bool operator==(const VertexKey& other) const
+        {
+            return position == other.position && texCoord == other.texCoord && normal == other.normal;
+        }
+    };
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            uint64_t hash = uint64_t(uint32_t(key.position)) * 0x9E3779B97F4A7C15ull;
+            hash ^= (uint64_t(uint32_t(key.texCoord)) + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+            hash ^= (uint64_t(uint32_t(key.normal)) + 0x165667B19E3779F9ull) * 0x85EBCA77C2B2AE63ull;
+            return static_cast<size_t>(hash ^ (hash >> 29));
+        }
+    };
+
+    int ResolveIndex(int index, size_t count)
+    {
+        if (index > 0)
+            return index - 1;
+
+        if (index < 0)
+            return static_cast<int>(count) + index;
+
+        return -1;
+    }
+
+    class ObjImporter
+    {
+    public:
+        ObjImporter(const std::filesystem::path& path, ImportedScene& scene) : path(path), scene(scene) {}
+
+        bool import(std::string& error)
+        {
+            MappedFile file;
+
+            if (!file.open(path.string().c_str()))
+            {
+                error = "failed to open file";
+                return false;
+            }
+
+            LineReader reader(file);
+            std::string line;
+            int lineNumber = 0;
+
+            while (reader.next(line))
+            {
+                lineNumber++;
+
+                const char* rest;
+                std::string keyword = SplitKeyword(line, rest);
+
+                if (keyword == "v")
+                {
+                    float values[7] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+                    int count = ParseFloats(rest, values, 6);
+
+                    positions.emplace_back(values[0], values[1], values[2]);
+
+                    // Common extension: "v x y z r g b".
+                    if (count == 6)
+                    {
+                        hasColors = true;
+                        colors.emplace_back(values[3], values[4], values[5], 1.0f);
+                    }
+                    else
+                    {
+                        colors.emplace_back(1.0f);
+                    }
+                }
+                else if (keyword == "vt")
+                {
+                    float values[2] = { 0.0f, 0.0f };
+                    ParseFloats(rest, values, 2);
+                    texCoords.emplace_back(values[0], 1.0f - values[1]);
+                }
+                else if (keyword == "vn")
+                {
+                    float values[3] = { 0.0f, 0.0f, 0.0f };
+                    ParseFloats(rest, values, 3);
+                    normals.emplace_back(values[0], values[1], values[2]);
+                }
+                else if (keyword == "f")
+                {
+                    if (!parseFace(rest))
+                    {
+                        error = "invalid face on line " + std::to_string(lineNumber);
+                        return false;
+                    }
+                }
+                else if (keyword == "usemtl")
+                {
+                    useMaterial(rest);
+                }
+                else if (keyword == "mtllib")
+                {
+                    loadMaterialLibrary(path.parent_path() / rest);
+                }
+            }
+
+            finish();
+            return true;
+        }
+
+    private:
+        struct Group
+        {
+            ImportedSubmesh submesh;
+            std::unordered_map<VertexKey, uint32_t, VertexKeyHash> vertices;
+            bool hasTexCoords = false;
+            bool hasNormals = false;
+        };
+
+        Group& currentGroup()
+        {
+            if (current < 0)
+                useMaterial("");
+
+            return groups[current];
+        }
+
+        void useMaterial(const std::string& name)
+        {
+            uint32_t material = findMaterial(name);
+
+            for (size_t i = 0; i < groups.size(); i++)
+            {
+                if (groups[i].submesh.material == material)
+                {
+                    current = static_cast<int>(i);
+                    return;
+                }
+            }
+
+            groups.emplace_back();
+            groups.back().submesh.material = material;
+            current = static_cast<int>(groups.size() - 1);
+        }
+
+        uint32_t findMaterial(const std::string& name)
+        {
+            for (size_t i = 0; i < scene.materials.size(); i++)
+            {
+                if (scene.materials[i].name == name)
+                    return static_cast<uint32_t>(i);
+            }
+
+            // Referenced but never defined, or geometry before any usemtl.
+            ImportedMaterial material;
+            material.name = name.empty() ? "default" : name;
+            material.metallic = 0.0f;
+            scene.materials.push_back(material);
+
+            return static_cast<uint32_t>(scene.materials.size() - 1);
+        }
+
+        bool parseFace(const char* text)
+        {
+            Group& group = currentGroup();
+            uint32_t corners[64];
+            int cornerCount = 0;
+
+            while (*text)
+            {
+                VertexKey key{ -1, -1, -1 };
+                char* end;
+
+                key.position = ResolveIndex(strtol(text, &end, 10), positions.size());
+
+                if (end == text)
+                    return false;
+
+                text = end;
+
+                if (*text == '/')
+                {
+                    text++;
+
+                    if (*text != '/')
+                    {
+                        key.texCoord = ResolveIndex(strtol(text, &end, 10), texCoords.size());
+                        text = end;
+                    }
+
+                    if (*text == '/')
+                    {
+                        text++;
+                        key.normal = ResolveIndex(strtol(text, &end, 10), normals.size());
+                        text = end;
+                    }
+                }
+
+                if (key.position < 0 || key.position >= static_cast<int>(positions.size())
+                    || key.texCoord >= static_cast<int>(texCoords.size()) || key.normal >= static_cast<int>(normals.size()))
+                {
+                    return false;
+                }
+
+                if (cornerCount < 64)
+                    corners[cornerCount++] = addVertex(group, key);
+
+                text = SkipSpace(text);
+            }
+
+            if (cornerCount < 3)
+                return false;
+
+            for (int i = 2; i < cornerCount; i++)
+            {
+                group.submesh.indices.push_back(corners[0]);
+                group.submesh.indices.push_back(corners[i - 1]);
+                group.submesh.indices.push_back(corners[i]);
+            }
+
+            return true;
+        }
+
+        uint32_t addVertex(Group& group, const VertexKey& key)
+        {
+            auto found = group.vertices.find(key);
+
+            if (found != group.vertices.end())
+                return found->second;
+
+            ImportedSubmesh& submesh = group.submesh;
+            uint32_t index = static_cast<uint32_t>(submesh.positions.size());
+
+            submesh.positions.push_back(positions[key.position]);
+            submesh.colors.push_back(colors[key.position]);
+            submesh.texCoords0.push_back(key.texCoord >= 0 ? texCoords[key.texCoord] : glm::vec2(0.0f));
+            submesh.normals.push_back(key.normal >= 0 ? normals[key.normal] : glm::vec3(0.0f));
+
+            group.hasTexCoords |= key.texCoord >= 0;
+            group.hasNormals |= key.normal >= 0;
+            group.vertices.emplace(key, index);
+
+            return index;
+        }
+
+        int addTexture(const std::string& relativePath, bool srgb, bool normalMap = false)
+        {
+            std::filesystem::path texturePath = path.parent_path() / relativePath;
+
+            for (size_t i = 0; i < scene.textures.size(); i++)
+            {
+                if (scene.textures[i].sourcePath == texturePath.string())
+                    return static_cast<int>(i);
+            }
+
+            ImportedTexture texture;
+            texture.sourcePath = texturePath.string();
+            texture.srgb = srgb;
+            texture.normalMap = normalMap;
+            scene.textures.push_back(texture);
+
+            return static_cast<int>(scene.textures.size() - 1);
+        }
+
+        void loadMaterialLibrary(const std::filesystem::path& libraryPath)
+        {
+            MappedFile file;
+
+            if (!file.open(libraryPath.string().c_str()))
+                return;
+
+            scene.dependencies.push_back(libraryPath.string());
+
+            LineReader reader(file);
+            std::string line;
+            ImportedMaterial* material = nullptr;
+            bool hasRoughness = false;
+
+            while (reader.next(line))
+            {
+                const char* rest;
+                std::string keyword = SplitKeyword(line, rest);
+                float values[3] = { 0.0f, 0.0f, 0.0f };
+
+                if (keyword == "newmtl")
+                {
+                    material = &scene.materials[findMaterial(rest)];
+                    hasRoughness = false;
+                }
+                else if (!material)
+                {
+                    continue;
+                }
+                else if (keyword == "Kd" && ParseFloats(rest, values, 3) == 3)
+                {
+                    material->baseColor = glm::vec4(values[0], values[1], values[2], material->baseColor.w);
+                }
+                else if (keyword == "Ke" && ParseFloats(rest, values, 3) == 3)
+                {
+                    material->emissive = glm::vec3(values[0], values[1], values[2]);
+                }
+                else if (keyword == "d" && ParseFloats(rest, values, 1) == 1)
+                {
+                    material->baseColor.w = values[0];
+                }
+                else if (keyword == "Tr" && ParseFloats(rest, values, 1) == 1)
+                {
+                    material->baseColor.w = 1.0f - values[0];
+                }
+                else if (keyword == "Ns" && ParseFloats(rest, values, 1) == 1 && !hasRoughness)
+                {
+                    // Blinn-Phong exponent to roughness, the usual sqrt(2 / (n + 2)) approximation.
+                    material->roughness = sqrtf(2.0f / (values[0] + 2.0f));
+                }
+                else if (keyword == "Pr" && ParseFloats(rest, values, 1) == 1)
+                {
+                    material->roughness = values[0];
+                    hasRoughness = true;
+                }
+                else if (keyword == "Pm" && ParseFloats(rest, values, 1) == 1)
+                {
+                    material->metallic = values[0];
+                }
+                else if (keyword == "map_Kd")
+                {
+                    material->textures[MATERIAL_BASE_COLOR] = addTexture(ParseMapPath(rest), true);
+                }
+                else if (keyword == "map_Ke")
+                {
+                    material->textures[MATERIAL_EMISSIVE] = addTexture(ParseMapPath(rest), true);
+                }
+                else if (keyword == "map_Bump" || keyword == "map_bump" || keyword == "bump" || keyword == "norm")
+                {
+                    material->textures[MATERIAL_NORMAL] = addTexture(ParseMapPath(rest), false, true);
+                }
+
+                if (material && material->baseColor.w < 1.0f)
+                    material->alphaMode = AlphaMode::Blend;
+            }
+        }
+
+        void finish()
+        {
+            for (Group& group : groups)
+            {
+                if (group.submesh.indices.empty())
+                    continue;
+
+                // Leave streams the source never provided empty so the cooker generates them.
+                if (!group.hasTexCoords)
+                    group.submesh.texCoords0.clear();
+
+                if (!group.hasNormals)
+                    group.submesh.normals.clear();
+
+                if (!hasColors)
+                    group.submesh.colors.clear();
+
+                scene.submeshes.push_back(std::move(group.submesh));
+            }
+        }
+
+    private:
+        std::filesystem::path path;
+        ImportedScene& scene;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec4> colors;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        bool hasColors = false;
+
+        std::vector<Group> groups;
+        int current = -1;
+    };
+}
+
+bool ImportObj(const std::filesystem::path& path, ImportedScene& scene, std::string& error)
+{
+    ObjImporter importer(path, scene);
+    return importer.import(error);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "ImportedScene.h"
+
+// Wavefront OBJ with its MTL library. Faces are fan triangulated, one submesh per material and
+// texture coordinates are flipped to the top left origin Vulkan samples with.
+bool ImportObj(const std::filesystem::path& path, ImportedScene& scene, std::string& error);
@@ -0,0 +1,87 @@
+#include "TextureCooker.h"
+
+#include <algorithm>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_FAILURE_USERMSG
+#include <stb_image.h>
+
+#include "MappedFile.h"
+#include "MipGenerator.h"
+#include "TextureFile.h"
+
+namespace
+{
+    void BlockCompress(TextureFileData& data, BlockFormat format, const TextureCookSettings& settings)
+    {
+        BlockCompressor compressor(settings.jobs);
+        uint32_t width = data.width, height = data.height;
+
+        for (auto& mip : data.mips)
+        {
+            std::vector<uint8_t> blocks(GetBlockCompressedSize(format, width, height));
+            compressor.compress(mip.data(), width, height, size_t(width) * 4, format, settings.quality, blocks.data());
+            mip = std::move(blocks);
+
+            width = std::max(width >> 1, 1u);
+            height = std::max(height >> 1, 1u);
+        }
+
+        bool srgb = data.format == TextureFormat::RGBA8Srgb;
+
+        if (format == BlockFormat::BC5)
+            data.format = TextureFormat::BC5Unorm;
+        else
+            data.format = srgb ? TextureFormat::BC7Srgb : TextureFormat::BC7Unorm;
+    }
+}
+
+bool CookTexture(const ImportedTexture& texture, const TextureCookSettings& settings, const std::filesystem::path& outputPath, std::string& error)
+{
+    MappedFile file;
+    const uint8_t* encoded = texture.embedded.data();
+    size_t encodedSize = texture.embedded.size();
+
+    if (!texture.sourcePath.empty())
+    {
+        if (!file.open(texture.sourcePath.c_str()))
+        {
+            error = "failed to open " + texture.sourcePath;
+            return false;
+        }
+
+        encoded = file.data();
+        encodedSize = file.size();
+    }
+
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load_from_memory(encoded, static_cast<int>(encodedSize), &width, &height, &channels, 4);
+
+    if (!pixels)
+    {
+        error = std::string("failed to decode image: ") + stbi_failure_reason();
+        return false;
+    }
+
+    TextureFileData data;
+    data.format = texture.srgb ? TextureFormat::RGBA8Srgb : TextureFormat::RGBA8Unorm;
+    data.width = static_cast<uint32_t>(width);
+    data.height = static_cast<uint32_t>(height);
+    data.mips.emplace_back(pixels, pixels + size_t(width) * height * 4);
+
+    stbi_image_free(pixels);
+
+    MipGenerator mipGenerator(settings.jobs);
+    mipGenerator.generate(data.mips, data.width, data.height, texture.srgb, std::min(GetMipCount(data.width, data.height), TEXTURE_FILE_MAX_MIPS));
+
+    if (settings.blockCompress)
+        BlockCompress(data, texture.normalMap ? BlockFormat::BC5 : BlockFormat::BC7, settings);
+
+    if (!WriteTextureFile(outputPath.string().c_str(), data))
+    {
+        error = "failed to write " + outputPath.string();
+        return false;
+    }
+
+    return true;
+}
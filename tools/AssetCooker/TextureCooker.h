@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "BlockCompression.h"
+#include "ImportedScene.h"
+
+class JobSystem;
+
+struct TextureCookSettings
+{
+    // BC5 for normal maps and BC7 for everything else, RGBA8 otherwise.
+    bool blockCompress = true;
+    BlockQuality quality = BlockQuality::Quality;
+
+    // Splits mip generation and block compression across the workers when set.
+    JobSystem* jobs = nullptr;
+};
+
+// Decodes any image stb_image understands, builds the full mip chain (averaged in linear space
+// for sRGB textures) and writes an engine texture file.
+bool CookTexture(const ImportedTexture& texture, const TextureCookSettings& settings, const std::filesystem::path& outputPath, std::string& error);
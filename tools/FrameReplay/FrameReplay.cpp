@@ -0,0 +1,318 @@
+// Replays a frame capture without a window: the UI draw data goes through the ImGui Vulkan backend
+// into an offscreen target, the engine draws through DrawQueue's sort and record. Reports CPU
+// record time and GPU time per frame so renderer changes can be compared on identical workloads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <imgui.h>
+
+#include "DrawQueue.h"
+#include "FrameCapture.h"
+#include "HeadlessRenderer.h"
+#include "JobSystem.h"
+
+struct ReplaySettings
+{
+    const char* capturePath = nullptr;
+    const char* deviceFilter = nullptr;
+    const char* csvPath = nullptr;
+    uint32_t loops = 1;
+    bool validation = false;
+};
+
+struct FrameTimes
+{
+    double recordMs = 0.0; // UI command recording
+    double gpuMs = 0.0;    // UI rendering, from timestamps
+    double sortMs = 0.0;   // engine draws, sort and record
+};
+
+// Stands in for DrawRecorder, the captured indices refer to the capturing run's tables.
+struct CountingRecorder
+{
+    uint32_t pipelines = 0;
+    uint32_t materials = 0;
+    uint32_t meshes = 0;
+    uint32_t draws = 0;
+
+    void bindPipeline(uint32_t) { pipelines++; }
+    void bindMaterial(uint32_t) { materials++; }
+    void bindMesh(uint32_t) { meshes++; }
+    void draw(const DrawItem&) { draws++; }
+};
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class FrameReplay
+{
+public:
+    explicit FrameReplay(const ReplaySettings& settings) : settings(settings) {}
+
+    int run();
+
+private:
+    void cleanup();
+
+    void buildDrawData(const CapturedFrame& frame);
+    FrameTimes replayFrame(const CapturedFrame& frame);
+
+private:
+    ReplaySettings settings;
+
+    FrameCaptureReader reader;
+    CapturedFrame frame;
+
+    JobSystem jobs;
+    DrawQueue queue{ &jobs };
+
+    HeadlessRenderer renderer;
+
+    // Rebuilt in place every frame, their buffers keep their capacity.
+    std::vector<ImDrawList*> drawLists;
+    ImDrawData drawData;
+};
+
+int FrameReplay::run()
+{
+    if (!reader.open(settings.capturePath))
+        return EXIT_FAILURE;
+
+    if (reader.getFrameCount() == 0)
+    {
+        fprintf(stderr, "error: %s holds no frames\n", settings.capturePath);
+        return EXIT_FAILURE;
+    }
+
+    if (!reader.readFrame(0, frame))
+        return EXIT_FAILURE;
+
+    uint32_t width = std::max(1u, static_cast<uint32_t>(frame.info.displaySize[0] * frame.info.framebufferScale[0]));
+    uint32_t height = std::max(1u, static_cast<uint32_t>(frame.info.displaySize[1] * frame.info.framebufferScale[1]));
+
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+
+    HeadlessRendererSettings rendererSettings;
+    rendererSettings.deviceFilter = settings.deviceFilter;
+    rendererSettings.validation = settings.validation;
+    rendererSettings.width = width;
+    rendererSettings.height = height;
+
+    renderer.init(rendererSettings);
+    printf("device: %s\n", renderer.getDeviceName().c_str());
+
+    FILE* csv = settings.csvPath ? fopen(settings.csvPath, "w") : nullptr;
+
+    if (csv)
+        fprintf(csv, "loop,frame,record_ms,gpu_ms,sort_ms\n");
+
+    std::vector<FrameTimes> times;
+    times.reserve(size_t(reader.getFrameCount()) * settings.loops);
+
+    bool failed = false;
+
+    for (uint32_t loop = 0; loop < settings.loops && !failed; loop++)
+    {
+        for (uint32_t i = 0; i < reader.getFrameCount(); i++)
+        {
+            if (!reader.readFrame(i, frame))
+            {
+                failed = true;
+                break;
+            }
+
+            FrameTimes frameTimes = replayFrame(frame);
+            times.push_back(frameTimes);
+
+            if (csv)
+                fprintf(csv, "%u,%u,%.4f,%.4f,%.4f\n", loop, i, frameTimes.recordMs, frameTimes.gpuMs, frameTimes.sortMs);
+        }
+    }
+
+    if (csv)
+        fclose(csv);
+
+    cleanup();
+
+    if (failed || times.empty())
+        return EXIT_FAILURE;
+
+    auto report = [&](const char* name, double FrameTimes::* field)
+    {
+        std::vector<double> values;
+        values.reserve(times.size());
+
+        for (const FrameTimes& frameTimes : times)
+            values.push_back(frameTimes.*field);
+
+        std::sort(values.begin(), values.end());
+
+        double total = 0.0;
+
+        for (double value : values)
+            total += value;
+
+        printf("%-8s mean %8.4f ms  median %8.4f ms  p99 %8.4f ms  max %8.4f ms\n", name,
+            total / values.size(), values[values.size() / 2], values[values.size() * 99 / 100], values.back());
+    };
+
+    printf("%s: %u frames x %u loops at %ux%u\n", settings.capturePath, reader.getFrameCount(), settings.loops, width, height);
+    report("record", &FrameTimes::recordMs);
+
+    if (renderer.hasTimestamps())
+        report("gpu", &FrameTimes::gpuMs);
+
+    report("sort", &FrameTimes::sortMs);
+
+    return EXIT_SUCCESS;
+}
+
+void FrameReplay::cleanup()
+{
+    renderer.destroy();
+
+    for (ImDrawList* list : drawLists)
+        IM_DELETE(list);
+
+    drawLists.clear();
+
+    ImGui::DestroyContext();
+}
+
+void FrameReplay::buildDrawData(const CapturedFrame& frame)
+{
+    ImTextureID fontTexture = ImGui::GetIO().Fonts->TexID;
+
+    while (drawLists.size() < frame.lists.size())
+        drawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+    drawData.Clear();
+    drawData.Valid = true;
+    drawData.DisplayPos = ImVec2(frame.info.displayPos[0], frame.info.displayPos[1]);
+    drawData.DisplaySize = ImVec2(frame.info.displaySize[0], frame.info.displaySize[1]);
+    drawData.FramebufferScale = ImVec2(frame.info.framebufferScale[0], frame.info.framebufferScale[1]);
+    drawData.OwnerViewport = ImGui::GetMainViewport();
+
+    for (size_t i = 0; i < frame.lists.size(); i++)
+    {
+        const CapturedDrawList& source = frame.lists[i];
+        ImDrawList* list = drawLists[i];
+
+        list->VtxBuffer.resize(static_cast<int>(source.vertices.size()));
+        list->IdxBuffer.resize(static_cast<int>(source.indices.size()));
+        list->CmdBuffer.resize(static_cast<int>(source.commands.size()));
+
+        memcpy(list->VtxBuffer.Data, source.vertices.data(), source.vertices.size() * sizeof(ImDrawVert));
+        memcpy(list->IdxBuffer.Data, source.indices.data(), source.indices.size() * sizeof(ImDrawIdx));
+
+        for (size_t c = 0; c < source.commands.size(); c++)
+        {
+            const CapturedDrawCommand& command = source.commands[c];
+            ImDrawCmd& drawCommand = list->CmdBuffer[static_cast<int>(c)];
+
+            drawCommand = ImDrawCmd();
+            drawCommand.ClipRect = ImVec4(command.clipRect[0], command.clipRect[1], command.clipRect[2], command.clipRect[3]);
+            drawCommand.TextureId = fontTexture;
+            drawCommand.VtxOffset = command.vertexOffset;
+            drawCommand.IdxOffset = command.indexOffset;
+            drawCommand.ElemCount = command.elementCount;
+
+            if (command.flags & CAPTURED_COMMAND_RESET_RENDER_STATE)
+                drawCommand.UserCallback = ImDrawCallback_ResetRenderState;
+        }
+
+        // Not AddDrawList(), its sanity checks look at write cursors only the ImDrawList API moves.
+        drawData.CmdLists.push_back(list);
+        drawData.CmdListsCount++;
+        drawData.TotalVtxCount += list->VtxBuffer.Size;
+        drawData.TotalIdxCount += list->IdxBuffer.Size;
+    }
+}
+
+FrameTimes FrameReplay::replayFrame(const CapturedFrame& frame)
+{
+    FrameTimes times;
+
+    auto start = std::chrono::steady_clock::now();
+
+    queue.clear();
+
+    for (const CapturedDraw& draw : frame.draws)
+        queue.add(draw.item, draw.depth);
+
+    queue.sort();
+
+    CountingRecorder recorder;
+    queue.record(recorder);
+
+    times.sortMs = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+
+    buildDrawData(frame);
+    double buildMs = MillisecondsSince(start);
+
+    HeadlessFrameTimes uiTimes = renderer.render(&drawData);
+    times.recordMs = buildMs + uiTimes.recordMs;
+    times.gpuMs = uiTimes.gpuMs;
+
+    return times;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: FrameReplay <capture> [--loops N] [--device NAME] [--csv FILE] [--validate]\n");
+    printf("Replays a frame capture offscreen and reports UI record, UI GPU and engine draw sort times.\n");
+    printf("  --loops N      replay the capture N times, defaults to 1\n");
+    printf("  --device NAME  first device whose name contains NAME, e.g. llvmpipe for lavapipe\n");
+    printf("  --csv FILE     also write every frame's times to FILE\n");
+    printf("  --validate     enable the Khronos validation layer\n");
+}
+
+int main(int argc, char** argv)
+{
+    ReplaySettings settings;
+    std::vector<const char*> positional;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+            settings.loops = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            settings.deviceFilter = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+            settings.csvPath = argv[++i];
+        else if (strcmp(argv[i], "--validate") == 0)
+            settings.validation = true;
+        else
+            positional.push_back(argv[i]);
+    }
+
+    if (positional.size() != 1)
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    settings.capturePath = positional[0];
+
+    try
+    {
+        FrameReplay replay(settings);
+        return replay.run();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,634 @@
+// Runs GpuScene's cull shader on a synthetic scene without a window and checks every draw it writes
+// against FrustumCuller over the same spheres. Runs on any Vulkan 1.2 device, lavapipe included, so
+// it can check the shader where there is no GPU. Run it from the repository root, it loads the
+// compiled shaders from shaders/.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "FrustumCulling.h"
+#include "GpuScene.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include "PipelineLayoutCache.h"
+#include "StagingUploader.h"
+#include "VirtualFileSystem.h"
+
+struct CullTestSettings
+{
+    const char* deviceFilter = nullptr;
+    uint32_t instanceCount = 100000;
+    uint32_t runs = 10;
+    bool validation = false;
+};
+
+struct CameraResult
+{
+    uint32_t cpuVisible = 0;
+    uint32_t gpuVisible = 0;
+    uint32_t borderline = 0; // within rounding of a plane, either answer is accepted
+    uint32_t mismatches = 0;
+    double cpuMs = 0.0;
+    double gpuMs = 0.0; // best of the runs, 0 when the queue has no timestamps
+};
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Right handed view looking from eye to target, with a Vulkan style projection (y down, depth in [0, 1]).
+static glm::mat4 MakeViewProjection(const glm::vec3& eye, const glm::vec3& target, float fovY, float aspect, float zNear, float zFar)
+{
+    glm::vec3 forward = glm::normalize(target - eye);
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+    glm::vec3 up = glm::cross(right, forward);
+
+    glm::mat4 view(1.0f);
+    view[0] = glm::vec4(right.x, up.x, -forward.x, 0.0f);
+    view[1] = glm::vec4(right.y, up.y, -forward.y, 0.0f);
+    view[2] = glm::vec4(right.z, up.z, -forward.z, 0.0f);
+    view[3] = glm::vec4(-glm::dot(right, eye), -glm::dot(up, eye), glm::dot(forward, eye), 1.0f);
+
+    float focal = 1.0f / std::tan(fovY * 0.5f);
+
+    glm::mat4 projection(0.0f);
+    projection[0][0] = focal / aspect;
+    projection[1][1] = -focal;
+    projection[2][2] = zFar / (zNear - zFar);
+    projection[2][3] = -1.0f;
+    projection[3][2] = zNear * zFar / (zNear - zFar);
+
+    return projection * view;
+}
+
+class GpuCullTest
+{
+public:
+    explicit GpuCullTest(const CullTestSettings& settings) : settings(settings) {}
+
+    int run();
+
+private:
+    void initDevice();
+    void buildScene();
+    void cleanup();
+
+    CameraResult testCamera(GpuScene& scene, const glm::mat4& viewProjection);
+    void readBack(GpuScene& scene, const glm::mat4& viewProjection, double& gpuMs);
+
+private:
+    CullTestSettings settings;
+
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    float timestampPeriod = 0.0f;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+
+    VirtualFileSystem vfs;
+    PipelineLayoutCache layouts;
+    StagingUploader uploader;
+    GpuBuffer readback;
+
+    JobSystem jobs;
+    FrustumCuller culler{ &jobs };
+
+    // Never drawn, only their submeshes are read, so they have no buffers.
+    std::vector<Mesh> meshes;
+    std::vector<glm::mat4> transforms;
+
+    std::vector<VkDrawIndexedIndirectCommand> draws;
+    std::vector<uint32_t> counts;
+};
+
+void GpuCullTest::initDevice()
+{
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "GpuCullTest";
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    const char* validationLayer = "VK_LAYER_KHRONOS_validation";
+
+    VkInstanceCreateInfo instanceInfo{};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = settings.validation ? 1 : 0;
+    instanceInfo.ppEnabledLayerNames = &validationLayer;
+
+    CheckVkResult(vkCreateInstance(&instanceInfo, nullptr, &instance));
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    // Lavapipe shows up as "llvmpipe".
+    for (VkPhysicalDevice candidate : devices)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(candidate, &properties);
+
+        if (settings.deviceFilter && !strstr(properties.deviceName, settings.deviceFilter))
+            continue;
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+
+        for (uint32_t i = 0; i < familyCount; i++)
+        {
+            if (!(families[i].queueFlags & VK_QUEUE_COMPUTE_BIT))
+                continue;
+
+            physicalDevice = candidate;
+            queueFamily = i;
+            timestampPeriod = families[i].timestampValidBits > 0 ? properties.limits.timestampPeriod : 0.0f;
+            break;
+        }
+
+        if (physicalDevice != VK_NULL_HANDLE)
+        {
+            printf("device: %s\n", properties.deviceName);
+            break;
+        }
+    }
+
+    if (physicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("no vulkan device with a compute queue matches.");
+
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported12;
+
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+    if (!supported12.timelineSemaphore)
+        throw std::runtime_error("the device has no timeline semaphores.");
+
+    float priority = 1.0f;
+
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queueFamily;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+
+    // Drawing is never recorded, the cull alone needs none of the indirect draw features, even
+    // when it compacts the draws for vkCmdDrawIndexedIndirectCount.
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.pNext = &vulkan12Features;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+
+    CheckVkResult(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    vkGetDeviceQueue(device, queueFamily, 0, &queue);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    CheckVkResult(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool));
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    CheckVkResult(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer));
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    CheckVkResult(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+
+    if (timestampPeriod > 0.0f)
+    {
+        VkQueryPoolCreateInfo queryInfo{};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2;
+
+        CheckVkResult(vkCreateQueryPool(device, &queryInfo, nullptr, &queryPool));
+    }
+
+    vfs.mountDirectory(".");
+    layouts.init(device);
+    uploader.init(physicalDevice, device, queue, queueFamily);
+}
+
+void GpuCullTest::buildScene()
+{
+    // A mix of single and multi submesh meshes, so draws of one instance are spread over several
+    // slots of its mesh's range.
+    const uint32_t submeshCounts[] = { 1, 3, 2, 5 };
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+    meshes.resize(std::size(submeshCounts));
+
+    for (size_t m = 0; m < meshes.size(); m++)
+    {
+        Mesh& mesh = meshes[m];
+        mesh.bounds = AABB::empty();
+
+        for (uint32_t s = 0; s < submeshCounts[m]; s++)
+        {
+            Submesh submesh;
+            submesh.firstIndex = s * 3000;
+            submesh.indexCount = 300 + s * 3;
+            submesh.vertexOffset = static_cast<int32_t>(s * 1000);
+
+            glm::vec3 center(position(random), position(random), position(random));
+            center *= 0.01f;
+
+            glm::vec3 extent(size(random), size(random), size(random));
+            submesh.bounds = { center - extent, center + extent };
+
+            mesh.bounds.expand(submesh.bounds);
+            mesh.submeshes.push_back(submesh);
+        }
+    }
+
+    transforms.resize(settings.instanceCount);
+
+    std::uniform_real_distribution<float> scale(0.25f, 3.0f);
+
+    for (glm::mat4& transform : transforms)
+    {
+        transform = glm::mat4(scale(random));
+        transform[3] = glm::vec4(position(random), position(random), position(random), 1.0f);
+    }
+}
+
+void GpuCullTest::readBack(GpuScene& scene, const glm::mat4& viewProjection, double& gpuMs)
+{
+    const uint32_t objectCount = scene.getObjectCount();
+    const VkDeviceSize drawSize = VkDeviceSize(objectCount) * sizeof(VkDrawIndexedIndirectCommand);
+    const VkDeviceSize countSize = meshes.size() * sizeof(uint32_t);
+
+    CheckVkResult(vkResetCommandBuffer(commandBuffer, 0));
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    CheckVkResult(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+    // Without compaction every slot is rewritten, with it stale draws past the count would look
+    // like real ones, so the readback starts from a known pattern.
+    vkCmdFillBuffer(commandBuffer, scene.getDrawBuffer(), 0, drawSize, 0xffffffffu);
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+    }
+
+    scene.recordCull(commandBuffer, viewProjection);
+
+    if (queryPool != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+
+    // recordCull() leaves the draws visible to indirect reads only.
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copies[] = { { 0, 0, drawSize }, { 0, drawSize, countSize } };
+
+    vkCmdCopyBuffer(commandBuffer, scene.getDrawBuffer(), readback.buffer, 1, &copies[0]);
+    vkCmdCopyBuffer(commandBuffer, scene.getCountBuffer(), readback.buffer, 1, &copies[1]);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    CheckVkResult(vkEndCommandBuffer(commandBuffer));
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    CheckVkResult(vkQueueSubmit(queue, 1, &submitInfo, fence));
+    CheckVkResult(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+    CheckVkResult(vkResetFences(device, 1, &fence));
+
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        uint64_t timestamps[2];
+        CheckVkResult(vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+        gpuMs = double(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6;
+    }
+
+    auto bytes = static_cast<const uint8_t*>(readback.mapped);
+
+    draws.resize(objectCount);
+    counts.resize(meshes.size());
+
+    memcpy(draws.data(), bytes, drawSize);
+    memcpy(counts.data(), bytes + drawSize, countSize);
+}
+
+CameraResult GpuCullTest::testCamera(GpuScene& scene, const glm::mat4& viewProjection)
+{
+    CameraResult result;
+
+    const std::vector<GpuCullObject>& objects = scene.getObjects();
+    const uint32_t objectCount = scene.getObjectCount();
+
+    // The reference, over the spheres the scene uploaded.
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+
+    SphereBoundsSoA spheres;
+    spheres.reserve(objectCount);
+
+    for (uint32_t i = 0; i < objectCount; i++)
+        spheres.add({ glm::vec3(objects[i].sphere), objects[i].sphere.w });
+
+    std::vector<uint32_t> visibleIndices;
+
+    auto start = std::chrono::steady_clock::now();
+    result.cpuVisible = culler.cull(frustum, spheres, visibleIndices);
+    result.cpuMs = MillisecondsSince(start);
+
+    std::vector<uint8_t> visible(objectCount, 0);
+    std::vector<uint8_t> borderline(objectCount, 0);
+
+    for (uint32_t i = 0; i < result.cpuVisible; i++)
+        visible[visibleIndices[i]] = 1;
+
+    // FMA contraction and evaluation order differ between the CPU kernels and the shader, so a
+    // sphere touching a plane to within rounding may go either way.
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        glm::vec4 sphere = objects[i].sphere;
+
+        for (const Plane& plane : frustum.planes)
+        {
+            double distance = double(plane.normal.x) * sphere.x + double(plane.normal.y) * sphere.y + double(plane.normal.z) * sphere.z + plane.distance + sphere.w;
+            double tolerance = 1e-5 * (std::abs(sphere.x) + std::abs(sphere.y) + std::abs(sphere.z) + std::abs(plane.distance) + sphere.w + 1.0);
+
+            if (std::abs(distance) <= tolerance)
+                borderline[i] = 1;
+        }
+
+        result.borderline += borderline[i];
+    }
+
+    result.gpuMs = 0.0;
+
+    for (uint32_t run = 0; run < settings.runs; run++)
+    {
+        double gpuMs = 0.0;
+        readBack(scene, viewProjection, gpuMs);
+
+        result.gpuMs = run == 0 ? gpuMs : std::min(result.gpuMs, gpuMs);
+    }
+
+    auto matches = [](const VkDrawIndexedIndirectCommand& draw, const GpuCullObject& object)
+    {
+        return draw.indexCount == object.indexCount && draw.firstIndex == object.firstIndex &&
+            draw.vertexOffset == object.vertexOffset && draw.firstInstance == object.instanceIndex;
+    };
+
+    auto report = [&](const char* what, uint32_t index)
+    {
+        if (result.mismatches++ < 10)
+            fprintf(stderr, "  mismatch: %s, object %u\n", what, index);
+    };
+
+    if (!scene.compactsDraws())
+    {
+        // Every object keeps its slot, hidden ones draw zero instances.
+        for (uint32_t i = 0; i < objectCount; i++)
+        {
+            const VkDrawIndexedIndirectCommand& draw = draws[objects[i].slot];
+
+            if (!matches(draw, objects[i]))
+                report("draw doesn't match its object", i);
+            else if (draw.instanceCount != visible[i] && !borderline[i])
+                report(visible[i] ? "visible object drawn with no instances" : "hidden object drawn", i);
+
+            result.gpuVisible += draw.instanceCount == 1;
+        }
+
+        return result;
+    }
+
+    // Compacted, each mesh's visible draws fill the front of its range in any order. Objects of
+    // one mesh are contiguous and in draw order, so the first one holds the range's base. Draws
+    // of one mesh are told apart by instance and submesh, which the first index names.
+    std::vector<uint8_t> drawn(objectCount, 0);
+    std::unordered_map<uint64_t, uint32_t> objectsByDraw;
+
+    for (uint32_t i = 0; i < objectCount; i++)
+        objectsByDraw[uint64_t(objects[i].instanceIndex) << 32 | objects[i].firstIndex] = i;
+
+    for (uint32_t begin = 0; begin < objectCount;)
+    {
+        uint32_t mesh = objects[begin].meshIndex;
+        uint32_t end = begin;
+
+        while (end < objectCount && objects[end].meshIndex == mesh)
+            end++;
+
+        uint32_t base = objects[begin].commandBase;
+        uint32_t count = counts[mesh];
+
+        if (count > end - begin)
+        {
+            report("draw count larger than the mesh's range", begin);
+            count = end - begin;
+        }
+
+        for (uint32_t slot = base; slot < base + count; slot++)
+        {
+            const VkDrawIndexedIndirectCommand& draw = draws[slot];
+
+            auto object = objectsByDraw.find(uint64_t(draw.firstInstance) << 32 | draw.firstIndex);
+            uint32_t found = object != objectsByDraw.end() ? object->second : end;
+
+            if (found < begin || found >= end || !matches(draw, objects[found]) || draw.instanceCount != 1)
+                report("draw doesn't match any object of its mesh", slot);
+            else if (drawn[found]++)
+                report("object drawn twice", found);
+            else if (!visible[found] && !borderline[found])
+                report("hidden object drawn", found);
+        }
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            if (visible[i] && !drawn[i] && !borderline[i])
+                report("visible object not drawn", i);
+        }
+
+        result.gpuVisible += count;
+        begin = end;
+    }
+
+    return result;
+}
+
+int GpuCullTest::run()
+{
+    initDevice();
+    buildScene();
+
+    const glm::vec3 targets[] =
+    {
+        glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(1.0f, 0.2f, 0.0f),
+        glm::vec3(-0.3f, -1.0f, 0.4f),
+        glm::vec3(0.5f, 0.5f, 0.5f),
+    };
+
+    bool failed = false;
+
+    // Both ways of writing the draws.
+    for (bool compact : { false, true })
+    {
+        GpuScene scene;
+        scene.init(physicalDevice, device, vfs, layouts, compact);
+
+        for (size_t m = 0; m < meshes.size(); m++)
+            scene.addMesh(meshes[m]);
+
+        for (size_t i = 0; i < transforms.size(); i++)
+            scene.addInstance(static_cast<uint32_t>(i % meshes.size()), transforms[i]);
+
+        scene.upload(uploader);
+        uploader.flush();
+
+        readback = CreateBuffer(physicalDevice, device,
+            VkDeviceSize(scene.getObjectCount()) * sizeof(VkDrawIndexedIndirectCommand) + meshes.size() * sizeof(uint32_t),
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        printf("%s draws, %u instances, %u objects\n", compact ? "compacted" : "per object", scene.getInstanceCount(), scene.getObjectCount());
+
+        for (const glm::vec3& target : targets)
+        {
+            glm::mat4 viewProjection = MakeViewProjection(glm::vec3(0.0f), target, 1.2f, 16.0f / 9.0f, 0.1f, 400.0f);
+            CameraResult result = testCamera(scene, viewProjection);
+
+            printf("  camera (%5.2f %5.2f %5.2f)  cpu %6u visible %8.3f ms  gpu %6u visible %8.3f ms  %u borderline  %s\n",
+                target.x, target.y, target.z, result.cpuVisible, result.cpuMs, result.gpuVisible, result.gpuMs,
+                result.borderline, result.mismatches == 0 ? "ok" : "FAILED");
+
+            failed |= result.mismatches > 0;
+        }
+
+        DestroyBuffer(device, readback);
+        scene.destroy();
+    }
+
+    cleanup();
+
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+void GpuCullTest::cleanup()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    vkDeviceWaitIdle(device);
+
+    uploader.destroy();
+    layouts.destroy();
+
+    if (queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device, queryPool, nullptr);
+
+    vkDestroyFence(device, fence, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+
+    device = VK_NULL_HANDLE;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: GpuCullTest [--instances N] [--runs N] [--device NAME] [--validate]\n");
+    printf("Culls a synthetic scene with the GPU cull shader and checks every draw against a CPU cull.\n");
+    printf("  --instances N  instances in the scene, defaults to 100000\n");
+    printf("  --runs N       culls per camera, the best GPU time is reported, defaults to 10\n");
+    printf("  --device NAME  first device whose name contains NAME, e.g. llvmpipe for lavapipe\n");
+    printf("  --validate     enable the Khronos validation layer\n");
+}
+
+int main(int argc, char** argv)
+{
+    CullTestSettings settings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+            settings.instanceCount = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            settings.runs = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            settings.deviceFilter = argv[++i];
+        else if (strcmp(argv[i], "--validate") == 0)
+            settings.validation = true;
+        else
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        GpuCullTest test(settings);
+        return test.run();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,343 @@
+#include "HeadlessRenderer.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <imgui_impl_vulkan.h>
+
+// VulkanUtils pulls in GLFW, which a tool without a window shouldn't need.
+static void CheckVkResult(VkResult result)
+{
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("vulkan call failed with " + std::to_string(result) + ".");
+}
+
+static uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("failed to find a suitable memory type.");
+}
+
+void HeadlessRenderer::init(const HeadlessRendererSettings& settings)
+{
+    initDevice(settings);
+    initTarget(settings.width, settings.height);
+    initImGui();
+}
+
+void HeadlessRenderer::initImGui()
+{
+    ImGui_ImplVulkan_InitInfo initInfo{};
+    initInfo.Instance = instance;
+    initInfo.PhysicalDevice = physicalDevice;
+    initInfo.Device = device;
+    initInfo.QueueFamily = queueFamily;
+    initInfo.Queue = graphicsQueue;
+    initInfo.DescriptorPool = descriptorPool;
+    initInfo.RenderPass = renderPass;
+    initInfo.MinImageCount = 2;
+    initInfo.ImageCount = 2;
+    initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+    initInfo.CheckVkResultFn = CheckVkResult;
+
+    ImGui_ImplVulkan_Init(&initInfo);
+    ImGui_ImplVulkan_CreateFontsTexture();
+
+    imguiReady = true;
+}
+
+void HeadlessRenderer::shutdownImGui()
+{
+    if (!imguiReady)
+        return;
+
+    vkDeviceWaitIdle(device);
+    ImGui_ImplVulkan_Shutdown();
+
+    imguiReady = false;
+}
+
+void HeadlessRenderer::destroy()
+{
+    if (device == VK_NULL_HANDLE)
+        return;
+
+    vkDeviceWaitIdle(device);
+    shutdownImGui();
+
+    if (queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(device, queryPool, nullptr);
+
+    vkDestroyFence(device, fence, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    vkDestroyFramebuffer(device, framebuffer, nullptr);
+    vkDestroyRenderPass(device, renderPass, nullptr);
+    vkDestroyImageView(device, targetView, nullptr);
+    vkDestroyImage(device, targetImage, nullptr);
+    vkFreeMemory(device, targetMemory, nullptr);
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+
+    device = VK_NULL_HANDLE;
+}
+
+void HeadlessRenderer::initDevice(const HeadlessRendererSettings& settings)
+{
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "VulkanEngine headless";
+    appInfo.apiVersion = VK_API_VERSION_1_2;
+
+    const char* validationLayer = "VK_LAYER_KHRONOS_validation";
+
+    VkInstanceCreateInfo instanceInfo{};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledLayerCount = settings.validation ? 1 : 0;
+    instanceInfo.ppEnabledLayerNames = &validationLayer;
+
+    CheckVkResult(vkCreateInstance(&instanceInfo, nullptr, &instance));
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    // Headless, so any queue that can draw will do. Lavapipe shows up as "llvmpipe".
+    for (VkPhysicalDevice candidate : devices)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(candidate, &properties);
+
+        if (settings.deviceFilter && !strstr(properties.deviceName, settings.deviceFilter))
+            continue;
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+
+        for (uint32_t i = 0; i < familyCount; i++)
+        {
+            if (!(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                continue;
+
+            physicalDevice = candidate;
+            queueFamily = i;
+            timestampPeriod = families[i].timestampValidBits > 0 ? properties.limits.timestampPeriod : 0.0f;
+            deviceName = properties.deviceName;
+            break;
+        }
+
+        if (physicalDevice != VK_NULL_HANDLE)
+            break;
+    }
+
+    if (physicalDevice == VK_NULL_HANDLE)
+        throw std::runtime_error("no vulkan device with a graphics queue matches.");
+
+    float priority = 1.0f;
+
+    VkDeviceQueueCreateInfo queueInfo{};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queueFamily;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+
+    VkDeviceCreateInfo deviceInfo{};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+
+    CheckVkResult(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+    vkGetDeviceQueue(device, queueFamily, 0, &graphicsQueue);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    CheckVkResult(vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool));
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    CheckVkResult(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer));
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    CheckVkResult(vkCreateFence(device, &fenceInfo, nullptr, &fence));
+
+    if (timestampPeriod > 0.0f)
+    {
+        VkQueryPoolCreateInfo queryInfo{};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2;
+
+        CheckVkResult(vkCreateQueryPool(device, &queryInfo, nullptr, &queryPool));
+    }
+
+    // Everything is drawn with the font atlas, so one set is plenty.
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 };
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    descriptorPoolInfo.maxSets = 1;
+    descriptorPoolInfo.poolSizeCount = 1;
+    descriptorPoolInfo.pPoolSizes = &poolSize;
+
+    CheckVkResult(vkCreateDescriptorPool(device, &descriptorPoolInfo, nullptr, &descriptorPool));
+}
+
+void HeadlessRenderer::initTarget(uint32_t width, uint32_t height)
+{
+    extent = { width, height };
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    CheckVkResult(vkCreateImage(device, &imageInfo, nullptr, &targetImage));
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, targetImage, &requirements);
+
+    VkMemoryAllocateInfo memoryInfo{};
+    memoryInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memoryInfo.allocationSize = requirements.size;
+    memoryInfo.memoryTypeIndex = FindMemoryType(physicalDevice, requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    CheckVkResult(vkAllocateMemory(device, &memoryInfo, nullptr, &targetMemory));
+    CheckVkResult(vkBindImageMemory(device, targetImage, targetMemory, 0));
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = targetImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = imageInfo.format;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+    CheckVkResult(vkCreateImageView(device, &viewInfo, nullptr, &targetView));
+
+    VkAttachmentDescription attachment{};
+    attachment.format = imageInfo.format;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorReference;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    CheckVkResult(vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass));
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = renderPass;
+    framebufferInfo.attachmentCount = 1;
+    framebufferInfo.pAttachments = &targetView;
+    framebufferInfo.width = width;
+    framebufferInfo.height = height;
+    framebufferInfo.layers = 1;
+
+    CheckVkResult(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer));
+}
+
+HeadlessFrameTimes HeadlessRenderer::render(ImDrawData* drawData)
+{
+    HeadlessFrameTimes times;
+
+    auto start = std::chrono::steady_clock::now();
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    CheckVkResult(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+    }
+
+    VkClearValue clear{};
+
+    VkRenderPassBeginInfo passInfo{};
+    passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    passInfo.renderPass = renderPass;
+    passInfo.framebuffer = framebuffer;
+    passInfo.renderArea.extent = extent;
+    passInfo.clearValueCount = 1;
+    passInfo.pClearValues = &clear;
+
+    vkCmdBeginRenderPass(commandBuffer, &passInfo, VK_SUBPASS_CONTENTS_INLINE);
+    ImGui_ImplVulkan_RenderDrawData(drawData, commandBuffer);
+    vkCmdEndRenderPass(commandBuffer);
+
+    if (queryPool != VK_NULL_HANDLE)
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+
+    CheckVkResult(vkEndCommandBuffer(commandBuffer));
+
+    times.recordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+
+    CheckVkResult(vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence));
+    CheckVkResult(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
+    CheckVkResult(vkResetFences(device, 1, &fence));
+
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        uint64_t timestamps[2];
+        CheckVkResult(vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+        times.gpuMs = double(timestamps[1] - timestamps[0]) * timestampPeriod * 1e-6;
+    }
+
+    return times;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <imgui.h>
+#include <vulkan/vulkan.h>
+
+struct HeadlessRendererSettings
+{
+    const char* deviceFilter = nullptr; // first device whose name contains it, e.g. llvmpipe
+    bool validation = false;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+};
+
+struct HeadlessFrameTimes
+{
+    double recordMs = 0.0; // ImGui_ImplVulkan_RenderDrawData and the command buffer around it
+    double gpuMs = 0.0;    // from timestamps, 0 when the queue has none
+};
+
+// Draws ImGui draw data with the Vulkan backend into an offscreen image, no window or surface.
+// Every frame is submitted and waited for, so the times don't overlap. Needs the ImGui context
+// created before init() and destroyed after destroy().
+class HeadlessRenderer
+{
+public:
+    // Sets up the backend for the current ImGui context as well.
+    void init(const HeadlessRendererSettings& settings);
+    void destroy();
+
+    // For moving the backend to a new context: shut down before destroying the old context, init
+    // once the new one is current. The font texture is uploaded again.
+    void initImGui();
+    void shutdownImGui();
+
+    HeadlessFrameTimes render(ImDrawData* drawData);
+
+    bool hasTimestamps() const { return timestampPeriod > 0.0f; }
+    const std::string& getDeviceName() const { return deviceName; }
+
+private:
+    void initDevice(const HeadlessRendererSettings& settings);
+    void initTarget(uint32_t width, uint32_t height);
+
+private:
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue graphicsQueue = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    float timestampPeriod = 0.0f;
+    std::string deviceName;
+    bool imguiReady = false;
+
+    VkImage targetImage = VK_NULL_HANDLE;
+    VkDeviceMemory targetMemory = VK_NULL_HANDLE;
+    VkImageView targetView = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+};
@@ -0,0 +1,650 @@
+// Drives scripted ImGui scenes for a fixed number of frames without a window and times each stage
+// of the UI frame separately: NewFrame, the scene's widget calls, Render and the Vulkan backend's
+// RenderDrawData. Results can be written as JSON and checked against an earlier run, failing when
+// any stage's p95 got slower by more than a threshold.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+#include "HeadlessRenderer.h"
+#include "Json.h"
+#include "MappedFile.h"
+
+struct BenchmarkSettings
+{
+    const char* deviceFilter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 10.0; // percent
+    uint32_t frames = 300;
+    uint32_t warmup = 30;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    bool cpuOnly = false;
+    bool validation = false;
+    std::vector<std::string> scenes; // all when empty
+};
+
+enum Stage
+{
+    STAGE_NEW_FRAME,
+    STAGE_BUILD,
+    STAGE_RENDER,
+    STAGE_RENDER_DRAW_DATA,
+    STAGE_GPU,
+    STAGE_COUNT,
+};
+
+static const char* STAGE_NAMES[STAGE_COUNT] = { "new_frame", "build", "render", "render_draw_data", "gpu" };
+
+// Times under this much over the baseline are noise whatever the percentage, sub 10us stages
+// would otherwise fail on scheduler jitter alone.
+static constexpr double REGRESSION_SLACK_MS = 0.02;
+
+struct StageStats
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+struct SceneResult
+{
+    std::string name;
+    StageStats stages[STAGE_COUNT];
+    bool measured[STAGE_COUNT] = {};
+
+    // From the last frame, to tell whether a change in time came with a change in work.
+    int drawLists = 0;
+    int vertices = 0;
+    int indices = 0;
+};
+
+struct Scene
+{
+    const char* name;
+    void (*draw)(uint32_t frame);
+};
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static StageStats Summarize(std::vector<double>& values)
+{
+    std::sort(values.begin(), values.end());
+
+    double total = 0.0;
+
+    for (double value : values)
+        total += value;
+
+    StageStats stats;
+    stats.mean = total / values.size();
+    stats.p50 = values[values.size() / 2];
+    stats.p95 = values[values.size() * 95 / 100];
+    stats.max = values.back();
+    return stats;
+}
+
+static void DrawDemoScene(uint32_t frame)
+{
+    ImGuiIO& io = ImGui::GetIO();
+
+    // Its sections start collapsed, which leaves little more than headers. Opened through the
+    // window's storage, where the headers keep their state.
+    if (frame == 0)
+    {
+        ImGui::Begin("Dear ImGui Demo");
+
+        for (const char* section : { "Widgets", "Layout & Scrolling", "Tables & Columns" })
+            ImGui::GetStateStorage()->SetInt(ImGui::GetID(section), 1);
+
+        ImGui::End();
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::ShowDemoWindow();
+
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::Begin("Style editor");
+    ImGui::ShowStyleEditor();
+    ImGui::End();
+}
+
+static void DrawTablesScene(uint32_t frame)
+{
+    static constexpr int COLUMNS = 12;
+    static constexpr int CLIPPED_ROWS = 100000;
+    static constexpr int FULL_ROWS = 400;
+
+    ImGuiIO& io = ImGui::GetIO();
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable
+        | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY;
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::Begin("Clipped table");
+
+    // Scrolls a little every frame so the visible rows keep changing.
+    if (ImGui::BeginTable("clipped", COLUMNS, flags))
+    {
+        ImGui::TableSetupScrollFreeze(1, 1);
+
+        for (int column = 0; column < COLUMNS; column++)
+            ImGui::TableSetupColumn(column == 0 ? "Id" : "Value");
+
+        ImGui::TableHeadersRow();
+        ImGui::SetScrollY(float(frame * 7 % 50000));
+
+        ImGuiListClipper clipper;
+        clipper.Begin(CLIPPED_ROWS);
+
+        while (clipper.Step())
+        {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+            {
+                ImGui::TableNextRow();
+
+                for (int column = 0; column < COLUMNS; column++)
+                {
+                    ImGui::TableSetColumnIndex(column);
+                    ImGui::Text("%d:%d", row, column * 31 + row % 97);
+                }
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::Begin("Full table");
+
+    // Every row submitted, the worst case for a table someone forgot to clip.
+    if (ImGui::BeginTable("full", COLUMNS / 2, flags & ~ImGuiTableFlags_ScrollY))
+    {
+        for (int row = 0; row < FULL_ROWS; row++)
+        {
+            ImGui::TableNextRow();
+            ImGui::PushID(row);
+
+            for (int column = 0; column < COLUMNS / 2; column++)
+            {
+                ImGui::TableSetColumnIndex(column);
+
+                if (column == 0)
+                    ImGui::Selectable("row", row == int(frame % FULL_ROWS), ImGuiSelectableFlags_SpanAllColumns);
+                else
+                    ImGui::Text("%.3f", row * 0.25f + column);
+            }
+
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+static void DrawWindowsScene(uint32_t frame)
+{
+    static constexpr int WINDOWS = 2000;
+    static constexpr float WIDTH = 160.0f;
+    static constexpr float HEIGHT = 90.0f;
+
+    ImGuiIO& io = ImGui::GetIO();
+    int perRow = std::max(1, int(io.DisplaySize.x / (WIDTH * 0.5f)));
+
+    // Overlapping so the hovered window and focus order have real work to do.
+    for (int i = 0; i < WINDOWS; i++)
+    {
+        char title[32];
+        snprintf(title, sizeof(title), "Window %d", i);
+
+        float x = float(i % perRow) * WIDTH * 0.5f;
+        float y = float((i / perRow) % int(io.DisplaySize.y / (HEIGHT * 0.5f))) * HEIGHT * 0.5f;
+
+        ImGui::SetNextWindowPos(ImVec2(x, y), ImGuiCond_Once);
+        ImGui::SetNextWindowSize(ImVec2(WIDTH, HEIGHT), ImGuiCond_Once);
+        ImGui::Begin(title);
+
+        ImGui::Text("Frame %u", frame);
+        ImGui::Button("Button");
+        ImGui::SameLine();
+        ImGui::ProgressBar(float((frame + i) % 100) / 100.0f, ImVec2(-1.0f, 0.0f));
+
+        ImGui::End();
+    }
+}
+
+static void DrawTextScene(uint32_t frame)
+{
+    static constexpr int PARAGRAPHS = 400;
+
+    static std::string text;
+
+    if (text.empty())
+    {
+        const char* words[] = { "vertex", "buffer", "descriptor", "pipeline", "shader", "frame", "queue", "fence", "a", "the" };
+
+        for (int i = 0; i < 20000; i++)
+        {
+            text += words[(i * 7 + i / 13) % 10];
+            text += i % 17 == 16 ? '\n' : ' ';
+        }
+    }
+
+    ImGuiIO& io = ImGui::GetIO();
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::Begin("Wrapped text");
+
+    for (int i = 0; i < PARAGRAPHS; i++)
+    {
+        const char* start = text.c_str() + (i * 131 + frame) % (text.size() / 2);
+        ImGui::TextWrapped("%.*s", 300, start);
+    }
+
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x * 0.5f, io.DisplaySize.y));
+    ImGui::Begin("Log");
+
+    // One large unformatted block, like a log or console view.
+    ImGui::SetScrollY(float(frame % 200) * ImGui::GetTextLineHeight());
+    ImGui::TextUnformatted(text.c_str(), text.c_str() + text.size());
+
+    ImGui::End();
+}
+
+static const Scene SCENES[] = {
+    { "demo", DrawDemoScene },
+    { "tables", DrawTablesScene },
+    { "windows", DrawWindowsScene },
+    { "text", DrawTextScene },
+};
+
+class UiBenchmark
+{
+public:
+    explicit UiBenchmark(const BenchmarkSettings& settings) : settings(settings) {}
+
+    int run();
+
+private:
+    void createContext();
+    SceneResult runScene(const Scene& scene);
+
+    bool writeJson(const char* path) const;
+    bool checkBaseline(const char* path) const;
+
+private:
+    BenchmarkSettings settings;
+
+    HeadlessRenderer renderer;
+    bool rendererReady = false;
+
+    std::vector<SceneResult> results;
+};
+
+int UiBenchmark::run()
+{
+    std::vector<const Scene*> scenes;
+
+    for (const Scene& scene : SCENES)
+    {
+        if (settings.scenes.empty() || std::find(settings.scenes.begin(), settings.scenes.end(), scene.name) != settings.scenes.end())
+            scenes.push_back(&scene);
+    }
+
+    if (!settings.scenes.empty() && scenes.size() != settings.scenes.size())
+    {
+        fprintf(stderr, "error: unknown scene, expected demo, tables, windows or text\n");
+        return EXIT_FAILURE;
+    }
+
+    createContext();
+
+    if (!settings.cpuOnly)
+    {
+        HeadlessRendererSettings rendererSettings;
+        rendererSettings.deviceFilter = settings.deviceFilter;
+        rendererSettings.validation = settings.validation;
+        rendererSettings.width = settings.width;
+        rendererSettings.height = settings.height;
+
+        renderer.init(rendererSettings);
+        rendererReady = true;
+        printf("device: %s\n", renderer.getDeviceName().c_str());
+    }
+
+    printf("%u frames per scene after %u warmup at %ux%u\n", settings.frames, settings.warmup, settings.width, settings.height);
+
+    for (size_t i = 0; i < scenes.size(); i++)
+    {
+        // A fresh context per scene, windows left over from the last one would add to NewFrame.
+        if (i > 0)
+        {
+            if (rendererReady)
+                renderer.shutdownImGui();
+
+            ImGui::DestroyContext();
+            createContext();
+
+            if (rendererReady)
+                renderer.initImGui();
+        }
+
+        results.push_back(runScene(*scenes[i]));
+
+        const SceneResult& result = results.back();
+        printf("\n%s: %d lists, %d vertices, %d indices\n", result.name.c_str(), result.drawLists, result.vertices, result.indices);
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            if (!result.measured[stage])
+                continue;
+
+            const StageStats& stats = result.stages[stage];
+            printf("  %-16s mean %8.4f ms  p50 %8.4f ms  p95 %8.4f ms  max %8.4f ms\n", STAGE_NAMES[stage],
+                stats.mean, stats.p50, stats.p95, stats.max);
+        }
+    }
+
+    if (rendererReady)
+        renderer.destroy();
+
+    ImGui::DestroyContext();
+
+    if (settings.jsonPath && !writeJson(settings.jsonPath))
+    {
+        fprintf(stderr, "error: failed to write %s\n", settings.jsonPath);
+        return EXIT_FAILURE;
+    }
+
+    if (settings.baselinePath && !checkBaseline(settings.baselinePath))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
+
+void UiBenchmark::createContext()
+{
+    ImGui::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2(float(settings.width), float(settings.height));
+    io.DeltaTime = 1.0f / 60.0f;
+
+    // Without the renderer nothing builds the atlas, NewFrame needs it built.
+    if (settings.cpuOnly)
+    {
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+}
+
+SceneResult UiBenchmark::runScene(const Scene& scene)
+{
+    SceneResult result;
+    result.name = scene.name;
+    result.measured[STAGE_NEW_FRAME] = true;
+    result.measured[STAGE_BUILD] = true;
+    result.measured[STAGE_RENDER] = true;
+    result.measured[STAGE_RENDER_DRAW_DATA] = rendererReady;
+    result.measured[STAGE_GPU] = rendererReady && renderer.hasTimestamps();
+
+    std::vector<double> times[STAGE_COUNT];
+
+    for (std::vector<double>& values : times)
+        values.reserve(settings.frames);
+
+    ImGuiIO& io = ImGui::GetIO();
+
+    for (uint32_t frame = 0; frame < settings.warmup + settings.frames; frame++)
+    {
+        // The same scripted sweep every run, so hover and highlight work is repeatable.
+        float t = float(frame) / float(settings.warmup + settings.frames);
+        io.AddMousePosEvent(io.DisplaySize.x * t, io.DisplaySize.y * (0.5f + 0.4f * sinf(t * 20.0f)));
+
+        double stageMs[STAGE_COUNT] = {};
+
+        auto start = std::chrono::steady_clock::now();
+        ImGui::NewFrame();
+        stageMs[STAGE_NEW_FRAME] = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        scene.draw(frame);
+        stageMs[STAGE_BUILD] = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        ImGui::Render();
+        stageMs[STAGE_RENDER] = MillisecondsSince(start);
+
+        ImDrawData* drawData = ImGui::GetDrawData();
+
+        if (rendererReady)
+        {
+            HeadlessFrameTimes frameTimes = renderer.render(drawData);
+            stageMs[STAGE_RENDER_DRAW_DATA] = frameTimes.recordMs;
+            stageMs[STAGE_GPU] = frameTimes.gpuMs;
+        }
+
+        if (frame < settings.warmup)
+            continue;
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+            times[stage].push_back(stageMs[stage]);
+
+        result.drawLists = drawData->CmdListsCount;
+        result.vertices = drawData->TotalVtxCount;
+        result.indices = drawData->TotalIdxCount;
+    }
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        if (result.measured[stage])
+            result.stages[stage] = Summarize(times[stage]);
+    }
+
+    return result;
+}
+
+bool UiBenchmark::writeJson(const char* path) const
+{
+    FILE* handle = fopen(path, "w");
+
+    if (!handle)
+        return false;
+
+    std::string device = rendererReady ? renderer.getDeviceName() : "none";
+    device.erase(std::remove_if(device.begin(), device.end(), [](char c) { return c == '"' || c == '\\' || c < ' '; }), device.end());
+
+    fprintf(handle, "{\n");
+    fprintf(handle, "  \"device\": \"%s\",\n", device.c_str());
+    fprintf(handle, "  \"frames\": %u,\n", settings.frames);
+    fprintf(handle, "  \"width\": %u,\n", settings.width);
+    fprintf(handle, "  \"height\": %u,\n", settings.height);
+    fprintf(handle, "  \"scenes\": {\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const SceneResult& result = results[i];
+
+        fprintf(handle, "    \"%s\": {\n", result.name.c_str());
+        fprintf(handle, "      \"draw_lists\": %d,\n", result.drawLists);
+        fprintf(handle, "      \"vertices\": %d,\n", result.vertices);
+        fprintf(handle, "      \"indices\": %d", result.indices);
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            if (!result.measured[stage])
+                continue;
+
+            const StageStats& stats = result.stages[stage];
+            fprintf(handle, ",\n      \"%s\": { \"mean\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"max\": %.6f }", STAGE_NAMES[stage],
+                stats.mean, stats.p50, stats.p95, stats.max);
+        }
+
+        fprintf(handle, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(handle, "  }\n}\n");
+
+    return fclose(handle) == 0;
+}
+
+bool UiBenchmark::checkBaseline(const char* path) const
+{
+    MappedFile file;
+
+    if (!file.open(path))
+    {
+        fprintf(stderr, "error: failed to open baseline %s\n", path);
+        return false;
+    }
+
+    JsonValue baseline;
+    std::string error;
+
+    if (!JsonValue::parse(reinterpret_cast<const char*>(file.data()), file.size(), baseline, error))
+    {
+        fprintf(stderr, "error: %s: %s\n", path, error.c_str());
+        return false;
+    }
+
+    printf("\ncompared to %s, failing past +%.1f%% p95:\n", path, settings.threshold);
+
+    uint32_t regressions = 0;
+
+    // Stages or scenes the baseline doesn't have, say a GPU stage on a device without timestamps,
+    // are skipped rather than failed.
+    for (const SceneResult& result : results)
+    {
+        const JsonValue& scene = baseline["scenes"][result.name.c_str()];
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            const JsonValue& before = scene[STAGE_NAMES[stage]]["p95"];
+
+            if (!result.measured[stage] || !before.isNumber())
+                continue;
+
+            double previous = before.asNumber();
+            double current = result.stages[stage].p95;
+            double change = previous > 0.0 ? (current / previous - 1.0) * 100.0 : 0.0;
+            bool regressed = current > previous * (1.0 + settings.threshold / 100.0) + REGRESSION_SLACK_MS;
+
+            printf("  %-8s %-16s %8.4f -> %8.4f ms  %+7.1f%%%s\n", result.name.c_str(), STAGE_NAMES[stage],
+                previous, current, change, regressed ? "  REGRESSED" : "");
+
+            if (regressed)
+                regressions++;
+        }
+    }
+
+    if (regressions > 0)
+    {
+        fprintf(stderr, "error: %u stages regressed past the threshold\n", regressions);
+        return false;
+    }
+
+    return true;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: UiBenchmark [scene...] [--frames N] [--warmup N] [--size WxH] [--device NAME] [--cpu-only]\n");
+    printf("                   [--json FILE] [--baseline FILE] [--threshold PCT] [--validate]\n");
+    printf("Runs scripted ImGui scenes offscreen and times NewFrame, widget calls, Render and RenderDrawData.\n");
+    printf("Scenes are demo, tables, windows and text, all of them when none are given.\n");
+    printf("  --frames N       measured frames per scene, defaults to 300\n");
+    printf("  --warmup N       frames per scene before measuring, defaults to 30\n");
+    printf("  --size WxH       display size, defaults to 1920x1080\n");
+    printf("  --device NAME    first device whose name contains NAME, e.g. llvmpipe for lavapipe\n");
+    printf("  --cpu-only       skip Vulkan, only the ImGui stages are measured\n");
+    printf("  --json FILE      write the results to FILE\n");
+    printf("  --baseline FILE  compare against the results in FILE, exit with failure on a regression\n");
+    printf("  --threshold PCT  allowed p95 slowdown against the baseline, defaults to 10\n");
+    printf("  --validate       enable the Khronos validation layer\n");
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            settings.frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            settings.warmup = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            unsigned width = 0;
+            unsigned height = 0;
+
+            if (sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+            {
+                fprintf(stderr, "error: --size expects WxH, e.g. 1920x1080\n");
+                return EXIT_FAILURE;
+            }
+
+            settings.width = width;
+            settings.height = height;
+        }
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            settings.deviceFilter = argv[++i];
+        else if (strcmp(argv[i], "--cpu-only") == 0)
+            settings.cpuOnly = true;
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            settings.jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            settings.baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            settings.threshold = std::max(0.0, atof(argv[++i]));
+        else if (strcmp(argv[i], "--validate") == 0)
+            settings.validation = true;
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+        else
+            settings.scenes.push_back(argv[i]);
+    }
+
+    try
+    {
+        UiBenchmark benchmark(settings);
+        return benchmark.run();
+    }
+    catch (const std::exception& e)
+    {
+        fprintf(stderr, "error: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+}